@@ -58,6 +58,9 @@ AdiTrx::AdiTrx()
     // signal data
     , mFrameLength( 0 )
     , mFramesNr( 0 )
+    // streaming
+    , mContinuousStreaming( false )
+    , mCapture( nullptr )
 {
     memset( &mTxBandwidthParams, 0, sizeof( mTxBandwidthParams ) );
     memset( &mTxSamplingFrequencyParams, 0, sizeof( mTxSamplingFrequencyParams ) );
@@ -257,6 +260,8 @@ bool AdiTrx::extractIntegerRange
 //!************************************************************************
 void AdiTrx::freeResources()
 {
+    mStreamEngine.stop();
+
     if( mTxBuf )
     {
         iio_buffer_destroy( mTxBuf );
@@ -299,32 +304,69 @@ void AdiTrx::freeResources()
 
 
 //!************************************************************************
-//! Get the name of the file where to dump data
+//! Get the signal data for a modulation-SNR combination.
+//! Only a reference is taken, the frames stay in the dataset snapshot.
+//! A null pointer releases the previous signal data.
 //!
 //! @returns nothing
 //!************************************************************************
-void AdiTrx::getDumpFilename
+void AdiTrx::getSignalData
     (
-    std::string&                aFilename   //!< filename
+    const Dataset::SignalDataPtr& aSignalData   //!< signal data for a modulation-SNR combination
     )
 {
-    mDumpFilename = aFilename;
+    mSignalData = aSignalData;
+    mFramesNr = aSignalData ? aSignalData->frameStore.getFramesNr() : 0;
+    mFrameLength = aSignalData ? aSignalData->frameStore.getFrameLength() : 0;
 }
 
 
 //!************************************************************************
-//! Get the signal data for a modulation-SNR combination
+//! Get the sequence of signal data for non-cyclic streaming. Only
+//! references are taken. An empty sequence streams the current signal data.
 //!
 //! @returns nothing
 //!************************************************************************
-void AdiTrx::getSignalData
+void AdiTrx::getSignalSequence
     (
-    Dataset::SignalData&        aSignalData //!< signal data for a modulation-SNR combination
+    const std::vector<Dataset::SignalDataPtr>& aSequenceVec    //!< signal data streamed in order, empty for the current signal data
     )
 {
-    mSignalData = aSignalData;
-    mFramesNr = aSignalData.frameDataVec.size();
-    mFrameLength = aSignalData.frameDataVec.at( 0 ).size();
+    mSignalSequenceVec = aSequenceVec;
+}
+
+
+//!************************************************************************
+//! Get the number of (I,Q) pairs pushed through non-cyclic buffers. A
+//! cyclic buffer is pushed once and replayed by the DAC, it is not counted.
+//!
+//! @returns The number of pairs pushed since the stream started
+//!************************************************************************
+uint64_t AdiTrx::getStreamPairsNr() const
+{
+    return mContinuousStreaming ? mStreamEngine.getBuffersPushed() * STREAM_BUFFER_PAIRS_NR : 0;
+}
+
+
+//!************************************************************************
+//! Get the number of times non-cyclic streaming ran out of converted data
+//!
+//! @returns The number of underflows since the stream started
+//!************************************************************************
+uint64_t AdiTrx::getStreamUnderflowsNr() const
+{
+    return mStreamEngine.getUnderflowsNr();
+}
+
+
+//!************************************************************************
+//! Check if non-cyclic streaming is selected
+//!
+//! @returns true if the signal data is streamed through non-cyclic buffers
+//!************************************************************************
+bool AdiTrx::isContinuousStreaming() const
+{
+    return mContinuousStreaming;
 }
 
 
@@ -339,6 +381,35 @@ bool AdiTrx::isInitialized() const
 }
 
 
+//!************************************************************************
+//! Fill a cyclic Tx buffer with zeros and push it
+//!
+//! @returns nothing
+//!************************************************************************
+void AdiTrx::pushSilence()
+{
+    bool status = resetTxBuffer( 1024, true );
+
+    if( status )
+    {
+        std::ptrdiff_t pBufStep = iio_buffer_step( mTxBuf );
+        uint8_t* pBufEnd = static_cast< uint8_t* >( iio_buffer_end( mTxBuf ) );
+        uint8_t* dataBuf;
+
+        for( dataBuf = static_cast< uint8_t* >( iio_buffer_first( mTxBuf, mTx0_I ) );
+             dataBuf < pBufEnd;
+             dataBuf += pBufStep
+           )
+        {
+            reinterpret_cast< int16_t* >( dataBuf )[0] = 0;
+            reinterpret_cast< int16_t* >( dataBuf )[1] = 0;
+        }
+
+        iio_buffer_push( mTxBuf );
+    }
+}
+
+
 //!************************************************************************
 //! Read a byte from a register
 //!
@@ -371,6 +442,9 @@ bool AdiTrx::resetTxBuffer
     bool status = true;
     mTxBufIqPairsCount = aLength;
 
+    // the engine pushes the current buffer
+    mStreamEngine.stop();
+
     if( mTxBuf )
     {
         iio_buffer_destroy( mTxBuf );
@@ -378,6 +452,18 @@ bool AdiTrx::resetTxBuffer
     }
 
     if( mTxBufIqPairsCount )
+    {
+        // a non-cyclic buffer needs several kernel buffers to be streamed without gaps
+        const unsigned int KERNEL_BUFFERS_NR = aIsCyclic ? CYCLIC_KERNEL_BUFFERS_NR : STREAM_KERNEL_BUFFERS_NR;
+
+        if( 0 != iio_device_set_kernel_buffers_count( mTxDev, KERNEL_BUFFERS_NR ) )
+        {
+            std::cout << "Cannot set " << KERNEL_BUFFERS_NR << " kernel buffers" << std::endl;
+            status = aIsCyclic;
+        }
+    }
+
+    if( status && mTxBufIqPairsCount )
     {
         mTxBuf = iio_device_create_buffer( mTxDev, mTxBufIqPairsCount, aIsCyclic );
         status = nullptr != mTxBuf;
@@ -387,6 +473,82 @@ bool AdiTrx::resetTxBuffer
 }
 
 
+//!************************************************************************
+//! Set the capture recording the pairs pushed to the Tx buffer, used from
+//! the next start. The capture only records while open.
+//!
+//! @returns nothing
+//!************************************************************************
+void AdiTrx::setCapture
+    (
+    TxCapture*                  aCapture    //!< capture, null for none
+    )
+{
+    mCapture = aCapture;
+}
+
+
+//!************************************************************************
+//! Select cyclic or non-cyclic streaming, used from the next start
+//!
+//! @returns nothing
+//!************************************************************************
+void AdiTrx::setContinuousStreaming
+    (
+    const bool aEnable          //!< true for non-cyclic streaming
+    )
+{
+    mContinuousStreaming = aEnable;
+}
+
+
+//!************************************************************************
+//! Start streaming the signal sequence through non-cyclic buffers, pushed
+//! back to back by the stream engine
+//!
+//! @returns true if the engine is started
+//!************************************************************************
+bool AdiTrx::startStreamEngine
+    (
+    const TxStreamEngine::SampleWriter  aWriter,    //!< writer of the DAC samples
+    const bool                          aQFirst     //!< true if Q leads each pair
+    )
+{
+    std::vector<Dataset::SignalDataPtr> sequenceVec = mSignalSequenceVec;
+
+    if( sequenceVec.empty() && mSignalData )
+    {
+        sequenceVec.push_back( mSignalData );
+    }
+
+    bool status = sequenceVec.size() && resetTxBuffer( STREAM_BUFFER_PAIRS_NR, false );
+
+    if( status )
+    {
+        status = mStreamEngine.start( mTxBuf, aQFirst ? mTx0_Q : mTx0_I, STREAM_BUFFER_PAIRS_NR, sequenceVec, aWriter, STREAM_HOST_BLOCKS_NR, mCapture );
+    }
+
+    if( !status )
+    {
+        std::cout << "Cannot start non-cyclic Tx streaming" << std::endl;
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Stop streaming, leaving a cyclic buffer of zeros
+//!
+//! @returns nothing
+//!************************************************************************
+void AdiTrx::stopStreaming()
+{
+    mStreamEngine.stop();
+    pushSilence();
+}
+
+
 //!************************************************************************
 //! Write a byte to a register
 //!
@@ -24,12 +24,18 @@ This file contains the definitions for ADI transceivers.
 #ifndef AdiTrx_h
 #define AdiTrx_h
 
+#include "DacFormat.h"
 #include "Dataset.h"
+#include "TxCapture.h"
+#include "TxStreamEngine.h"
+#include "WaveformCache.h"
 
 #include <iio.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -57,6 +63,12 @@ class AdiTrx
             int64_t max;                //!< upper limit
         }IntegerRange;
 
+    private:
+        static const size_t STREAM_BUFFER_PAIRS_NR = 65536;        //!< (I,Q) pairs per non-cyclic Tx buffer
+        static const unsigned int STREAM_KERNEL_BUFFERS_NR = 4;     //!< kernel buffers queued for non-cyclic streaming
+        static const size_t STREAM_HOST_BLOCKS_NR = 4;              //!< host blocks converted ahead of the pushes
+        static const unsigned int CYCLIC_KERNEL_BUFFERS_NR = 1;     //!< kernel buffers for cyclic streaming
+
 
     //************************************************************************
     // functions
@@ -68,14 +80,30 @@ class AdiTrx
 
         void freeResources();
 
-        void getDumpFilename
+        void getSignalData
             (
-            std::string&                aFilename   //!< filename
+            const Dataset::SignalDataPtr& aSignalData   //!< signal data for a modulation-SNR combination
             );
 
-        void getSignalData
+        void getSignalSequence
+            (
+            const std::vector<Dataset::SignalDataPtr>& aSequenceVec    //!< signal data streamed in order, empty for the current signal data
+            );
+
+        uint64_t getStreamPairsNr() const;
+
+        uint64_t getStreamUnderflowsNr() const;
+
+        bool isContinuousStreaming() const;
+
+        void setCapture
+            (
+            TxCapture*                  aCapture    //!< capture, null for none
+            );
+
+        void setContinuousStreaming
             (
-            Dataset::SignalData&        aSignalData //!< signal data for a modulation-SNR combination
+            const bool aEnable          //!< true for non-cyclic streaming
             );
 
     protected:
@@ -157,12 +185,23 @@ class AdiTrx
 
         bool isInitialized() const;
 
+        template<typename DacFormatT>
+        void pushSignalData();
+
+        void pushSilence();
+
         bool readRegister
             (
             const uint16_t aAddress,    //!< register address
             uint8_t&       aValue       //!< read value
             );
 
+        template<typename DacFormatT>
+        void renderWaveform
+            (
+            const Dataset::SignalDataPtr& aSignalData   //!< signal data
+            ) const;
+
         bool resetTxBuffer
             (
             const size_t aLength,       //!< new buffer length
@@ -200,8 +239,19 @@ class AdiTrx
             const int64_t aFrequency    //!< frequency [Hz]
             ) = 0;
 
+        template<typename DacFormatT>
+        void startStreaming();
+
+        bool startStreamEngine
+            (
+            const TxStreamEngine::SampleWriter  aWriter,    //!< writer of the DAC samples
+            const bool                          aQFirst     //!< true if Q leads each pair
+            );
+
         virtual void startTxStreaming() = 0;
 
+        void stopStreaming();
+
         virtual void stopTxStreaming() = 0;
 
         bool writeRegister
@@ -251,11 +301,101 @@ class AdiTrx
 
         std::vector<int16_t>    mTxDataVec;                 //!< vector with Tx data
 
-        Dataset::SignalData     mSignalData;                //!< signal data for a modulation-SNR combination
+        Dataset::SignalDataPtr  mSignalData;                //!< signal data for a modulation-SNR combination, shared with the dataset snapshot
         uint16_t                mFrameLength;               //!< frame length in (I,Q) pairs
-        uint16_t                mFramesNr;                  //!< frames count per modulation-SNR combination
+        size_t                  mFramesNr;                  //!< frames count per modulation-SNR combination
 
-        std::string             mDumpFilename;              //!< name of file where to dump data
+        bool                    mContinuousStreaming;       //!< true for non-cyclic streaming
+        std::vector<Dataset::SignalDataPtr> mSignalSequenceVec;    //!< signal data streamed in order, empty for the current signal data
+        TxStreamEngine          mStreamEngine;              //!< non-cyclic streaming engine
+        TxCapture*              mCapture;                   //!< capture of the pushed pairs, null for none
 };
 
+
+//!************************************************************************
+//! Fill a cyclic Tx buffer with the signal data, written in the DAC format
+//! of the transceiver, and push it. The DAC samples come from the waveform
+//! cache, so that a signal sent before is only copied.
+//!
+//! @returns nothing
+//!************************************************************************
+template<typename DacFormatT>
+void AdiTrx::pushSignalData()
+{
+    bool status = ( nullptr != mSignalData ) && resetTxBuffer( mFrameLength * mFramesNr, true );
+
+    if( status )
+    {
+        std::ptrdiff_t pBufStep = iio_buffer_step( mTxBuf );
+        uint8_t* pBufEnd = static_cast< uint8_t* >( iio_buffer_end( mTxBuf ) );
+        uint8_t* pBufFirst = static_cast< uint8_t* >( iio_buffer_first( mTxBuf, DacFormatT::Q_FIRST ? mTx0_Q : mTx0_I ) );
+        const size_t BUFFER_POINTS_NR = ( pBufEnd - pBufFirst + pBufStep - 1 ) / pBufStep;
+        const size_t POINTS_NR = std::min( BUFFER_POINTS_NR, mSignalData->frameStore.getPointsNr() );
+
+        WaveformCache::WaveformPtr waveform = WaveformCache::getInstance()->get<DacFormatT>( *mSignalData, Dataset::getScale( *mSignalData ) );
+        const uint8_t* samples = waveform->data();
+
+        if( static_cast<std::ptrdiff_t>( WaveformCache::PAIR_BYTES ) == pBufStep )
+        {
+            memcpy( pBufFirst, samples, POINTS_NR * WaveformCache::PAIR_BYTES );
+        }
+        else
+        {
+            // other channels are interleaved with I and Q
+            for( size_t i = 0; i < POINTS_NR; i++ )
+            {
+                memcpy( pBufFirst + i * pBufStep, samples + i * WaveformCache::PAIR_BYTES, WaveformCache::PAIR_BYTES );
+            }
+        }
+
+        if( mCapture )
+        {
+            mCapture->write( samples, POINTS_NR );
+        }
+
+        iio_buffer_push( mTxBuf );
+    }
+}
+
+
+//!************************************************************************
+//! Write signal data in a DAC format into the waveform cache, so that
+//! pushing it later is a single copy. Non-cyclic streaming converts the
+//! samples buffer by buffer and does not use the cache.
+//!
+//! @returns nothing
+//!************************************************************************
+template<typename DacFormatT>
+void AdiTrx::renderWaveform
+    (
+    const Dataset::SignalDataPtr& aSignalData   //!< signal data
+    ) const
+{
+    if( !mContinuousStreaming && aSignalData && !aSignalData->frameStore.isEmpty() )
+    {
+        WaveformCache::getInstance()->get<DacFormatT>( *aSignalData, Dataset::getScale( *aSignalData ) );
+    }
+}
+
+
+//!************************************************************************
+//! Start streaming the signal data, written in the DAC format of the
+//! transceiver: pushed once through a cyclic buffer, or back to back
+//! through non-cyclic buffers
+//!
+//! @returns nothing
+//!************************************************************************
+template<typename DacFormatT>
+void AdiTrx::startStreaming()
+{
+    if( mContinuousStreaming )
+    {
+        startStreamEngine( DacFormatT::write, DacFormatT::Q_FIRST );
+    }
+    else
+    {
+        pushSignalData<DacFormatT>();
+    }
+}
+
 #endif // AdiTrx_h
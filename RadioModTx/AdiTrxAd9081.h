@@ -35,6 +35,9 @@ class AdiTrxAd9081 : public AdiTrx
     //************************************************************************
     // constants and types
     //************************************************************************
+    public:
+        typedef DacFormat<16, DAC_JUSTIFY_MSB, DAC_ENDIAN_LITTLE, DAC_INTERLEAVE_IQ> TxDacFormat;   //!< AD9081 => 16-bit DAC
+
     private:
         const std::string AD9081_TX_DEV_STR = "axi-ad9081-tx-hpc";  //!< AD9081 Tx device string
         const std::string AD9081_RX_DEV_STR = "axi-ad9081-rx-hpc";  //!< AD9081 Rx device string
@@ -95,6 +98,11 @@ class AdiTrxAd9081 : public AdiTrx
             const std::string aUri      //!< URI
             );
 
+        void prerenderSignalData
+            (
+            const Dataset::SignalDataPtr& aSignalData   //!< signal data transmitted next
+            ) const;
+
         bool setTxBandwidth
             (
             const int64_t aBandwidth    //!< bandwidth [Hz]
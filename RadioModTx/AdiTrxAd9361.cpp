@@ -25,14 +25,8 @@ This file contains the sources for AD9361/AD9363/AD9364 transceivers.
 
 #include <QtGlobal>
 
-#define DUMP_FRAMES_TO_FILE 0
-
 #include <cmath>
 #include <iostream>
-#if DUMP_FRAMES_TO_FILE
-    #include <cstring>
-    #include <fstream>
-#endif
 
 
 //!************************************************************************
@@ -429,6 +423,21 @@ bool AdiTrxAd9361::initialize
 }
 
 
+//!************************************************************************
+//! Write the signal data transmitted next in the DAC format
+//! of the transceiver, ahead of the switch
+//!
+//! @returns nothing
+//!************************************************************************
+void AdiTrxAd9361::prerenderSignalData
+    (
+    const Dataset::SignalDataPtr& aSignalData   //!< signal data transmitted next
+    ) const
+{
+    renderWaveform<TxDacFormat>( aSignalData );
+}
+
+
 //!************************************************************************
 //! Set the Tx bandwidth [Hz]
 //!
@@ -575,63 +584,7 @@ bool AdiTrxAd9361::setTxSamplingFrequency
 //!************************************************************************
 void AdiTrxAd9361::startTxStreaming()
 {
-    bool status = resetTxBuffer( mFrameLength * mFramesNr, true );
-
-    if( status )
-    {
-        std::ptrdiff_t pBufStep = iio_buffer_step( mTxBuf );
-        uint8_t* pBufEnd = static_cast< uint8_t* >( iio_buffer_end( mTxBuf ) );
-        uint8_t* dataBuf;
-        uint32_t i = 0;
-        uint16_t crtFrame = 0;
-        uint16_t crtPoint = 0;
-        const double SCALE_RATIO = 2047.0 / mSignalData.maxVal;
-#if DUMP_FRAMES_TO_FILE
-        const uint16_t NR_OF_FRAMES_TO_DUMP = 2;
-        char crtLine[80] = "";
-        std::ofstream dumpFile( mDumpFilename );
-
-        if( !dumpFile.is_open() )
-        {
-            std::cout << "Cannot create dump file " << mDumpFilename << std::endl;
-        }
-#endif
-
-        for( dataBuf = static_cast< uint8_t* >( iio_buffer_first( mTxBuf, mTx0_I ) );
-             dataBuf < pBufEnd;
-             dataBuf += pBufStep
-           )
-        {
-            crtFrame = i / mFrameLength;
-            crtPoint = crtFrame ? ( i % mFrameLength ) : i;
-
-            Dataset::IQPoint pt = mSignalData.frameDataVec.at( crtFrame ).at( crtPoint );
-
-            // AD9361 => 12-bit DAC
-            reinterpret_cast< int16_t* >( dataBuf )[0] = ( static_cast<int16_t>( pt.i * SCALE_RATIO ) ) << 4;
-            reinterpret_cast< int16_t* >( dataBuf )[1] = ( static_cast<int16_t>( pt.q * SCALE_RATIO ) ) << 4;
-            i++;
-
-#if DUMP_FRAMES_TO_FILE
-            if( crtFrame < NR_OF_FRAMES_TO_DUMP )
-            {
-                if( dumpFile.is_open() )
-                {
-                    sprintf( crtLine, "%u %lf %lf\n", i - 1,  pt.i / mSignalData.maxVal, pt.q / mSignalData.maxVal );
-                    dumpFile.write( crtLine, strlen( crtLine ) );
-                }
-            }
-#endif
-        }
-
-#if DUMP_FRAMES_TO_FILE
-        if( dumpFile.is_open() )
-        {
-            dumpFile.close();
-        }
-#endif
-        iio_buffer_push( mTxBuf );
-    }
+    startStreaming<TxDacFormat>();
 }
 
 
@@ -642,23 +595,5 @@ void AdiTrxAd9361::startTxStreaming()
 //!************************************************************************
 void AdiTrxAd9361::stopTxStreaming()
 {
-    bool status = resetTxBuffer( 1024, true );
-
-    if( status )
-    {
-        std::ptrdiff_t pBufStep = iio_buffer_step( mTxBuf );
-        uint8_t* pBufEnd = static_cast< uint8_t* >( iio_buffer_end( mTxBuf ) );
-        uint8_t* dataBuf;
-
-        for( dataBuf = static_cast< uint8_t* >( iio_buffer_first( mTxBuf, mTx0_I ) );
-             dataBuf < pBufEnd;
-             dataBuf += pBufStep
-           )
-        {
-            reinterpret_cast< int16_t* >( dataBuf )[0] = 0;
-            reinterpret_cast< int16_t* >( dataBuf )[1] = 0;
-        }
-
-        iio_buffer_push( mTxBuf );
-    }
+    stopStreaming();
 }
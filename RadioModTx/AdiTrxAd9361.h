@@ -35,6 +35,9 @@ class AdiTrxAd9361 : public AdiTrx
     //************************************************************************
     // constants and types
     //************************************************************************
+    public:
+        typedef DacFormat<12, DAC_JUSTIFY_MSB, DAC_ENDIAN_LITTLE, DAC_INTERLEAVE_IQ> TxDacFormat;   //!< AD9361 => 12-bit DAC, MSB-justified
+
     private:
         const std::string AD9361_PHY_DEV_STR = "ad9361-phy";            //!< AD9361 phy device string
         const std::string AD9361_TX_DEV_STR = "cf-ad9361-dds-core-lpc"; //!< AD9361 Tx device string
@@ -95,6 +98,11 @@ class AdiTrxAd9361 : public AdiTrx
             const std::string aUri      //!< URI
             );
 
+        void prerenderSignalData
+            (
+            const Dataset::SignalDataPtr& aSignalData   //!< signal data transmitted next
+            ) const;
+
         bool setTxBandwidth
             (
             const int64_t aBandwidth    //!< bandwidth [Hz]
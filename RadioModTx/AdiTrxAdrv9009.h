@@ -35,6 +35,9 @@ class AdiTrxAdrv9009 : public AdiTrx
     //************************************************************************
     // constants and types
     //************************************************************************
+    public:
+        typedef DacFormat<14, DAC_JUSTIFY_MSB, DAC_ENDIAN_LITTLE, DAC_INTERLEAVE_IQ> TxDacFormat;   //!< ADRV9009 => 14-bit DAC, MSB-justified
+
     private:
         const std::string ADRV9009_PHY_DEV_STR = "adrv9009-phy";        //!< ADRV9009 phy device string
         const std::string ADRV9009_TX_DEV_STR = "axi-adrv9009-tx-hpc";  //!< ADRV9009 Tx device string
@@ -95,6 +98,11 @@ class AdiTrxAdrv9009 : public AdiTrx
             const std::string aUri      //!< URI
             );
 
+        void prerenderSignalData
+            (
+            const Dataset::SignalDataPtr& aSignalData   //!< signal data transmitted next
+            ) const;
+
         bool setTxBandwidth
             (
             const int64_t aBandwidth    //!< bandwidth [Hz]
@@ -0,0 +1,704 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+/*
+AdiTrxSim.cpp
+
+This file contains the sources for simulated transceiver.
+*/
+
+#include "AdiTrxSim.h"
+#include "AdiTrxAd9081.h"
+#include "AdiTrxAd9361.h"
+#include "AdiTrxAdrv9009.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+
+const std::string AdiTrxSim::URI_PREFIX = "sim:";
+
+
+//!************************************************************************
+//! Constructor
+//!************************************************************************
+AdiTrxSim::AdiTrxSim()
+    : mSimDevice( SIM_DEVICE_UNKNOWN )
+    , mTxLoPower( true )
+    , mSinkRate( -1 )
+    , mSinkWriter( nullptr )
+    , mSinkPairsPerSec( 0 )
+    , mSinkStopRequested( false )
+    , mSinkPairsNr( 0 )
+    , mSinkLateNr( 0 )
+{
+}
+
+
+//!************************************************************************
+//! Destructor
+//!************************************************************************
+AdiTrxSim::~AdiTrxSim()
+{
+    stopSink();
+}
+
+
+//!************************************************************************
+//! Free the resources, stopping the sink
+//!
+//! @returns nothing
+//!************************************************************************
+void AdiTrxSim::freeResources()
+{
+    stopSink();
+    AdiTrx::freeResources();
+
+    mSimDevice = SIM_DEVICE_UNKNOWN;
+    mInitialized = false;
+}
+
+
+//!************************************************************************
+//! Get the number of (I,Q) pairs consumed by the sink, in both streaming
+//! modes
+//!
+//! @returns The number of pairs consumed since the stream started
+//!************************************************************************
+uint64_t AdiTrxSim::getStreamPairsNr() const
+{
+    return mSinkPairsNr.load();
+}
+
+
+//!************************************************************************
+//! Get the number of sink buffers which were not ready in time
+//!
+//! @returns The number of underflows since the stream started
+//!************************************************************************
+uint64_t AdiTrxSim::getStreamUnderflowsNr() const
+{
+    return mSinkLateNr.load();
+}
+
+
+//!************************************************************************
+//! Get the Tx bandwidth [Hz]
+//!
+//! @returns true if the parameter can be read
+//!************************************************************************
+bool AdiTrxSim::getTxBandwidth
+    (
+    int64_t& aBandwidth         //!< bandwidth [Hz]
+    )
+{
+    aBandwidth = ( SIM_DEVICE_AD9081 == mSimDevice ) ? 0 : mTxBandwidth;
+    return mInitialized;
+}
+
+
+//!************************************************************************
+//! Get the Tx bandwidth parameters
+//!
+//! @returns true if the parameters can be read
+//!************************************************************************
+bool AdiTrxSim::getTxBandwidthParams()
+{
+    return mInitialized && ( SIM_DEVICE_AD9081 != mSimDevice );
+}
+
+
+//!************************************************************************
+//! Get the Tx bandwidth range
+//!
+//! @returns The range for Tx bandwidth
+//!************************************************************************
+AdiTrx::IntegerRange AdiTrxSim::getTxBandwidthRange() const
+{
+    return mTxBandwidthParams;
+}
+
+
+//!************************************************************************
+//! Get the Tx hardware gain [dB]
+//!
+//! @returns true if the parameter can be read
+//!************************************************************************
+bool AdiTrxSim::getTxHwGain
+    (
+    double& aHwGainDb           //!< hardware gain [dB]
+    )
+{
+    aHwGainDb = ( SIM_DEVICE_AD9081 == mSimDevice ) ? 0 : mTxHwGainDb;
+    return mInitialized;
+}
+
+
+//!************************************************************************
+//! Get the Tx hardware gain parameters
+//!
+//! @returns true if the parameters can be read
+//!************************************************************************
+bool AdiTrxSim::getTxHwGainParams()
+{
+    return mInitialized && ( SIM_DEVICE_AD9081 != mSimDevice );
+}
+
+
+//!************************************************************************
+//! Get the Tx LO frequency [Hz], the main NCO frequency of AD9081
+//!
+//! @returns true if the parameter can be read
+//!************************************************************************
+bool AdiTrxSim::getTxLoFrequency
+    (
+    int64_t& aFrequency         //!< frequency [Hz]
+    )
+{
+    aFrequency = mTxLoFrequency;
+    return mInitialized;
+}
+
+
+//!************************************************************************
+//! Get the Tx LO frequency parameters
+//!
+//! @returns true if the parameters can be read
+//!************************************************************************
+bool AdiTrxSim::getTxLoFrequencyParams()
+{
+    return mInitialized;
+}
+
+
+//!************************************************************************
+//! Get the Tx LO frequency range
+//!
+//! @returns The range for Tx LO frequency
+//!************************************************************************
+AdiTrx::IntegerRange AdiTrxSim::getTxLoFrequencyRange() const
+{
+    return mTxLoFrequencyParams;
+}
+
+
+//!************************************************************************
+//! Get the status of Tx LO power
+//!
+//! @returns true if the parameter can be read
+//!************************************************************************
+bool AdiTrxSim::getTxLoPower
+    (
+    bool& aEnable               //!< true if power is enabled
+    ) const
+{
+    aEnable = mTxLoPower;
+    return mInitialized && ( SIM_DEVICE_AD9081 != mSimDevice );
+}
+
+
+//!************************************************************************
+//! Get the Tx NCO gain scale
+//! It applies to AD9081/AD9082 only.
+//!
+//! @returns true if the parameter can be read
+//!************************************************************************
+bool AdiTrxSim::getTxNcoGainScale
+    (
+    double& aGainScale          //!< gain scale [0..1]
+    )
+{
+    const bool HAS_NCO_GAIN = mInitialized && ( SIM_DEVICE_AD9081 == mSimDevice );
+
+    aGainScale = HAS_NCO_GAIN ? mTxNcoGainScale : 0;
+    return HAS_NCO_GAIN;
+}
+
+
+//!************************************************************************
+//! Get the Tx sampling frequency [Hz]
+//!
+//! @returns true if the parameter can be read
+//!************************************************************************
+bool AdiTrxSim::getTxSamplingFrequency
+    (
+    int64_t& aFrequency         //!< sampling frequency [Hz]
+    )
+{
+    aFrequency = mTxSamplingFrequency;
+    return mInitialized;
+}
+
+
+//!************************************************************************
+//! Get the Tx sampling frequency parameters
+//!
+//! @returns true if the parameters can be read
+//!************************************************************************
+bool AdiTrxSim::getTxSamplingFrequencyParams()
+{
+    return mInitialized;
+}
+
+
+//!************************************************************************
+//! Get the Tx sampling frequency range
+//!
+//! @returns The range for Tx sampling frequency
+//!************************************************************************
+AdiTrx::IntegerRange AdiTrxSim::getTxSamplingFrequencyRange() const
+{
+    return mTxSamplingFrequencyParams;
+}
+
+
+//!************************************************************************
+//! Initialize the emulated transceiver, named after the URI prefix
+//!
+//! @returns true if the URI designates a device which can be emulated
+//!************************************************************************
+bool AdiTrxSim::initialize
+    (
+    const std::string aUri      //!< URI
+    )
+{
+    std::string deviceName = isSimulatedUri( aUri ) ? aUri.substr( URI_PREFIX.size() ) : "";
+    std::transform( deviceName.begin(), deviceName.end(), deviceName.begin(), ::tolower );
+
+    mSimDevice = SIM_DEVICE_UNKNOWN;
+
+    memset( &mTxBandwidthParams, 0, sizeof( mTxBandwidthParams ) );
+    memset( &mTxSamplingFrequencyParams, 0, sizeof( mTxSamplingFrequencyParams ) );
+    memset( &mTxLoFrequencyParams, 0, sizeof( mTxLoFrequencyParams ) );
+    memset( &mTxHwGainDbParams, 0, sizeof( mTxHwGainDbParams ) );
+
+    mTxBandwidth = 0;
+    mTxHwGainDb = 0;
+    mTxNcoGainScale = 0;
+    mTxLoPower = true;
+
+    // ranges as reported by the devices
+    if( "ad9361" == deviceName )
+    {
+        mSimDevice = SIM_DEVICE_AD9361;
+
+        mTxBandwidthParams = { 200000, 1, 56000000 };
+        mTxBandwidth = 18000000;
+
+        mTxSamplingFrequencyParams = { 2083333, 1, 61440000 };
+        mTxSamplingFrequency = 30720000;
+
+        mTxLoFrequencyParams = { 70000000, 1, 6000000000 };
+        mTxLoFrequency = 2400000000;
+
+        mTxHwGainDbParams = { -89.75, 0.25, 0 };
+        mTxHwGainDb = -10;
+    }
+    else if( "ad9081" == deviceName )
+    {
+        mSimDevice = SIM_DEVICE_AD9081;
+
+        mTxSamplingFrequencyParams = { 250000000, 0, 250000000 };
+        mTxSamplingFrequency = 250000000;
+
+        mTxLoFrequencyParams = { -6000000000, 1, 6000000000 };
+        mTxLoFrequency = 1000000000;
+
+        mTxNcoGainScale = 0.5;
+    }
+    else if( "adrv9009" == deviceName )
+    {
+        mSimDevice = SIM_DEVICE_ADRV9009;
+
+        mTxBandwidthParams = { 100000000, 0, 100000000 };
+        mTxBandwidth = 100000000;
+
+        mTxSamplingFrequencyParams = { 122880000, 0, 122880000 };
+        mTxSamplingFrequency = 122880000;
+
+        mTxLoFrequencyParams = { 70000000, 1, 6000000000 };
+        mTxLoFrequency = 2400000000;
+
+        mTxHwGainDbParams = { -30, 0.05, 0 };
+        mTxHwGainDb = -10;
+    }
+
+    bool status = ( SIM_DEVICE_UNKNOWN != mSimDevice );
+
+    if( status )
+    {
+        const char* SINK_FILE_NAME = std::getenv( "RADIOMODTX_SIM_SINK" );
+        const char* SINK_RATE = std::getenv( "RADIOMODTX_SIM_RATE" );
+
+        mSinkFileName = SINK_FILE_NAME ? SINK_FILE_NAME : "";
+        mSinkRate = SINK_RATE ? std::max( std::atoll( SINK_RATE ), 0ll ) : -1;
+    }
+    else
+    {
+        std::cout << "Cannot emulate a device for " << aUri << std::endl;
+    }
+
+    mInitialized = status;
+    return status;
+}
+
+
+//!************************************************************************
+//! Check if a URI designates an emulated device
+//!
+//! @returns true for a simulated device URI
+//!************************************************************************
+bool AdiTrxSim::isSimulatedUri
+    (
+    const std::string& aUri     //!< URI
+    )
+{
+    return 0 == aUri.compare( 0, URI_PREFIX.size(), URI_PREFIX );
+}
+
+
+//!************************************************************************
+//! Write the signal data transmitted next in the DAC format
+//! of the emulated device, ahead of the switch
+//!
+//! @returns nothing
+//!************************************************************************
+void AdiTrxSim::prerenderSignalData
+    (
+    const Dataset::SignalDataPtr& aSignalData   //!< signal data transmitted next
+    ) const
+{
+    switch( mSimDevice )
+    {
+        case SIM_DEVICE_AD9361:
+            renderWaveform<AdiTrxAd9361::TxDacFormat>( aSignalData );
+            break;
+
+        case SIM_DEVICE_AD9081:
+            renderWaveform<AdiTrxAd9081::TxDacFormat>( aSignalData );
+            break;
+
+        case SIM_DEVICE_ADRV9009:
+            renderWaveform<AdiTrxAdrv9009::TxDacFormat>( aSignalData );
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+//!************************************************************************
+//! Sink thread: consume the DAC samples one buffer at a time, at the
+//! sampling frequency, writing them to the sink file if there is one
+//!
+//! @returns nothing
+//!************************************************************************
+void AdiTrxSim::runSink()
+{
+    const size_t PAIR_BYTES = WaveformCache::PAIR_BYTES;
+    const std::chrono::nanoseconds BUFFER_DURATION( mSinkPairsPerSec ? static_cast<int64_t>( SINK_BUFFER_PAIRS_NR ) * 1000000000 / mSinkPairsPerSec : 0 );
+
+    std::vector<uint8_t> bufferVec( SINK_BUFFER_PAIRS_NR * PAIR_BYTES );
+    std::ofstream sinkFile;
+
+    if( mSinkFileName.size() )
+    {
+        sinkFile.open( mSinkFileName, std::ios::binary | std::ios::trunc );
+
+        if( !sinkFile.is_open() )
+        {
+            std::cout << "Cannot create sink file " << mSinkFileName << ", discarding the samples." << std::endl;
+        }
+    }
+
+    size_t crtBlock = 0;
+    size_t crtPoint = 0;
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now();
+    bool done = false;
+
+    while( !done )
+    {
+        size_t filledNr = 0;
+
+        while( filledNr < SINK_BUFFER_PAIRS_NR )
+        {
+            size_t copyNr = 0;
+
+            if( mSinkWaveform )
+            {
+                const size_t WAVEFORM_PAIRS_NR = mSinkWaveform->size() / PAIR_BYTES;
+                copyNr = std::min( SINK_BUFFER_PAIRS_NR - filledNr, WAVEFORM_PAIRS_NR - crtPoint );
+
+                memcpy( bufferVec.data() + filledNr * PAIR_BYTES, mSinkWaveform->data() + crtPoint * PAIR_BYTES, copyNr * PAIR_BYTES );
+                crtPoint = ( crtPoint + copyNr ) % WAVEFORM_PAIRS_NR;
+            }
+            else
+            {
+                const Dataset::SignalData& block = *mSinkSequenceVec.at( crtBlock );
+                const size_t BLOCK_PAIRS_NR = block.frameStore.getPointsNr();
+                copyNr = std::min( SINK_BUFFER_PAIRS_NR - filledNr, BLOCK_PAIRS_NR - crtPoint );
+
+                mSinkWriter( block.frameStore.data() + crtPoint, copyNr, Dataset::getScale( block ), bufferVec.data() + filledNr * PAIR_BYTES, PAIR_BYTES );
+                crtPoint += copyNr;
+
+                if( BLOCK_PAIRS_NR == crtPoint )
+                {
+                    crtPoint = 0;
+                    crtBlock = ( crtBlock + 1 ) % mSinkSequenceVec.size();
+                }
+            }
+
+            filledNr += copyNr;
+        }
+
+        if( sinkFile.is_open() )
+        {
+            sinkFile.write( reinterpret_cast<const char*>( bufferVec.data() ), bufferVec.size() );
+        }
+
+        // a cyclic buffer is captured once, when pushed
+        if( mCapture && !mSinkWaveform )
+        {
+            mCapture->write( bufferVec.data(), SINK_BUFFER_PAIRS_NR );
+        }
+
+        mSinkPairsNr += SINK_BUFFER_PAIRS_NR;
+
+        std::unique_lock<std::mutex> lock( mSinkMutex );
+
+        if( mSinkPairsPerSec )
+        {
+            const std::chrono::steady_clock::time_point NOW = std::chrono::steady_clock::now();
+
+            // the previous buffer ran out before this one was ready
+            if( NOW > deadline + BUFFER_DURATION )
+            {
+                mSinkLateNr++;
+                deadline = NOW;
+            }
+
+            deadline += BUFFER_DURATION;
+            done = mSinkStopCv.wait_until( lock, deadline, [this]{ return mSinkStopRequested; } );
+        }
+        else
+        {
+            done = mSinkStopRequested;
+        }
+    }
+}
+
+
+//!************************************************************************
+//! Set the Tx bandwidth [Hz]
+//!
+//! @returns true if the setting can be applied
+//!************************************************************************
+bool AdiTrxSim::setTxBandwidth
+    (
+    const int64_t aBandwidth    //!< bandwidth [Hz]
+    )
+{
+    bool status = ( SIM_DEVICE_AD9081 != mSimDevice
+                 && aBandwidth >= mTxBandwidthParams.min
+                 && aBandwidth <= mTxBandwidthParams.max );
+
+    if( status )
+    {
+        mTxBandwidth = aBandwidth;
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Set the Tx hardware gain [dB]
+//!
+//! @returns true if the setting can be applied
+//!************************************************************************
+bool AdiTrxSim::setTxHwGain
+    (
+    const double& aHwGainDb     //!< hardware gain [dB]
+    )
+{
+    bool status = ( SIM_DEVICE_AD9081 != mSimDevice
+                 && aHwGainDb >= mTxHwGainDbParams.min
+                 && aHwGainDb <= mTxHwGainDbParams.max );
+
+    if( status )
+    {
+        mTxHwGainDb = aHwGainDb;
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Set the Tx LO frequency [Hz]
+//!
+//! @returns true if the setting can be applied
+//!************************************************************************
+bool AdiTrxSim::setTxLoFrequency
+    (
+    const int64_t aFrequency    //!< frequency [Hz]
+    )
+{
+    bool status = ( mInitialized
+                 && aFrequency >= mTxLoFrequencyParams.min
+                 && aFrequency <= mTxLoFrequencyParams.max );
+
+    if( status )
+    {
+        mTxLoFrequency = aFrequency;
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Enable or disable the Tx LO power
+//!
+//! @returns true if the setting can be applied
+//!************************************************************************
+bool AdiTrxSim::setTxLoPower
+    (
+    const bool aEnable          //!< true for enabling power
+    )
+{
+    bool status = mInitialized && ( SIM_DEVICE_AD9081 != mSimDevice );
+
+    if( status )
+    {
+        mTxLoPower = aEnable;
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Set the Tx NCO gain scale
+//! It applies to AD9081/AD9082 only.
+//!
+//! @returns true if the setting can be applied
+//!************************************************************************
+bool AdiTrxSim::setTxNcoGainScale
+    (
+    const double aGainScale     //!< gain scale [0..1]
+    )
+{
+    bool status = ( SIM_DEVICE_AD9081 == mSimDevice
+                 && aGainScale >= 0
+                 && aGainScale <= 1 );
+
+    if( status )
+    {
+        mTxNcoGainScale = aGainScale;
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Set the Tx sampling frequency [Hz], which paces the sink from the next
+//! start
+//!
+//! @returns true if the setting can be applied
+//!************************************************************************
+bool AdiTrxSim::setTxSamplingFrequency
+    (
+    const int64_t aFrequency    //!< frequency [Hz]
+    )
+{
+    bool status = ( mInitialized
+                 && aFrequency >= mTxSamplingFrequencyParams.min
+                 && aFrequency <= mTxSamplingFrequencyParams.max );
+
+    if( status )
+    {
+        mTxSamplingFrequency = aFrequency;
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Start Tx streaming
+//!
+//! @returns nothing
+//!************************************************************************
+void AdiTrxSim::startTxStreaming()
+{
+    switch( mSimDevice )
+    {
+        case SIM_DEVICE_AD9361:
+            startSink<AdiTrxAd9361::TxDacFormat>();
+            break;
+
+        case SIM_DEVICE_AD9081:
+            startSink<AdiTrxAd9081::TxDacFormat>();
+            break;
+
+        case SIM_DEVICE_ADRV9009:
+            startSink<AdiTrxAdrv9009::TxDacFormat>();
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+//!************************************************************************
+//! Stop the sink thread, if running
+//!
+//! @returns nothing
+//!************************************************************************
+void AdiTrxSim::stopSink()
+{
+    {
+        std::lock_guard<std::mutex> lock( mSinkMutex );
+        mSinkStopRequested = true;
+    }
+
+    mSinkStopCv.notify_all();
+
+    if( mSinkThread.joinable() )
+    {
+        mSinkThread.join();
+    }
+}
+
+
+//!************************************************************************
+//! Stop Tx streaming
+//!
+//! @returns nothing
+//!************************************************************************
+void AdiTrxSim::stopTxStreaming()
+{
+    stopSink();
+}
@@ -0,0 +1,256 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+/*
+AdiTrxSim.h
+
+This file contains the definitions for simulated transceiver.
+*/
+
+#ifndef AdiTrxSim_h
+#define AdiTrxSim_h
+
+#include "AdiTrx.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+//************************************************************************
+// Class for emulating an AD9361, AD9081 or ADRV9009 transceiver without
+// hardware, selected by URIs like "sim:ad9361".
+//
+// The attributes have the ranges of the emulated device, and the signal
+// data is written in its DAC format to a sink thread, which consumes the
+// buffers at the sampling frequency and writes them to a file or
+// discards them. The sink is configured from the environment:
+//  - RADIOMODTX_SIM_SINK: file receiving the DAC samples, none to discard
+//  - RADIOMODTX_SIM_RATE: consumption rate [Hz], 0 for as fast as possible,
+//    the sampling frequency if not set
+//************************************************************************
+class AdiTrxSim : public AdiTrx
+{
+    //************************************************************************
+    // constants and types
+    //************************************************************************
+    public:
+        typedef enum
+        {
+            SIM_DEVICE_UNKNOWN,
+
+            SIM_DEVICE_AD9361,
+            SIM_DEVICE_AD9081,
+            SIM_DEVICE_ADRV9009
+        }SimDevice;
+
+        static const std::string URI_PREFIX;                            //!< prefix of simulated device URIs
+
+    private:
+        static const size_t SINK_BUFFER_PAIRS_NR = 65536;               //!< (I,Q) pairs consumed per sink buffer
+
+
+    //************************************************************************
+    // functions
+    //************************************************************************
+    public:
+        AdiTrxSim();
+
+        ~AdiTrxSim();
+
+        void freeResources();
+
+        uint64_t getStreamPairsNr() const;
+
+        uint64_t getStreamUnderflowsNr() const;
+
+        bool getTxBandwidth
+            (
+            int64_t& aBandwidth         //!< bandwidth [Hz]
+            );
+
+        bool getTxBandwidthParams();
+
+        IntegerRange getTxBandwidthRange() const;
+
+        bool getTxHwGain
+            (
+            double& aHwGainDb           //!< hardware gain [dB]
+            );
+
+        bool getTxHwGainParams();
+
+        bool getTxLoFrequency
+            (
+            int64_t& aFrequency         //!< frequency [Hz]
+            );
+
+        bool getTxLoFrequencyParams();
+
+        IntegerRange getTxLoFrequencyRange() const;
+
+        bool getTxLoPower
+            (
+            bool& aEnable               //!< true if power is enabled
+            ) const;
+
+        bool getTxNcoGainScale
+            (
+            double& aGainScale          //!< gain scale [0..1]
+            );
+
+        bool getTxSamplingFrequency
+            (
+            int64_t& aFrequency         //!< sampling frequency [Hz]
+            );
+
+        bool getTxSamplingFrequencyParams();
+
+        IntegerRange getTxSamplingFrequencyRange() const;
+
+        bool initialize
+            (
+            const std::string aUri      //!< URI
+            );
+
+        static bool isSimulatedUri
+            (
+            const std::string& aUri     //!< URI
+            );
+
+        void prerenderSignalData
+            (
+            const Dataset::SignalDataPtr& aSignalData   //!< signal data transmitted next
+            ) const;
+
+        bool setTxBandwidth
+            (
+            const int64_t aBandwidth    //!< bandwidth [Hz]
+            );
+
+        bool setTxHwGain
+            (
+            const double& aHwGainDb     //!< hardware gain [dB]
+            );
+
+        bool setTxLoFrequency
+            (
+            const int64_t aFrequency    //!< frequency [Hz]
+            );
+
+        bool setTxLoPower
+            (
+            const bool aEnable          //!< true for enabling power
+            );
+
+        bool setTxNcoGainScale
+            (
+            const double aGainScale     //!< gain scale [0..1]
+            );
+
+        bool setTxSamplingFrequency
+            (
+            const int64_t aFrequency    //!< frequency [Hz]
+            );
+
+        void startTxStreaming();
+
+        void stopTxStreaming();
+
+    private:
+        void runSink();
+
+        template<typename DacFormatT>
+        void startSink();
+
+        void stopSink();
+
+
+    //************************************************************************
+    // variables
+    //************************************************************************
+    private:
+        SimDevice                                   mSimDevice;         //!< emulated device
+        bool                                        mTxLoPower;         //!< Tx LO power
+
+        std::string                                 mSinkFileName;      //!< file receiving the DAC samples, empty to discard them
+        int64_t                                     mSinkRate;          //!< consumption rate [Hz], 0 for unpaced, negative for the sampling frequency
+
+        TxStreamEngine::SampleWriter                mSinkWriter;        //!< writer of the DAC samples, non-cyclic streaming
+        WaveformCache::WaveformPtr                  mSinkWaveform;      //!< DAC samples replayed, cyclic streaming
+        std::vector<Dataset::SignalDataPtr>         mSinkSequenceVec;   //!< signal data streamed in order, non-cyclic streaming
+        int64_t                                     mSinkPairsPerSec;   //!< consumption rate of the running sink [Hz], 0 for unpaced
+
+        std::thread                                 mSinkThread;        //!< sink thread
+        std::mutex                                  mSinkMutex;         //!< protects the stop request
+        std::condition_variable                     mSinkStopCv;        //!< wakes up the sink when stopping
+        bool                                        mSinkStopRequested; //!< true when the sink must stop
+
+        std::atomic<uint64_t>                       mSinkPairsNr;       //!< (I,Q) pairs consumed since the start
+        std::atomic<uint64_t>                       mSinkLateNr;        //!< buffers the sink was kept waiting for
+};
+
+
+//!************************************************************************
+//! Start the sink with the signal data written in the DAC format of the
+//! emulated device: replayed from the waveform cache for cyclic streaming,
+//! converted buffer by buffer for non-cyclic streaming
+//!
+//! @returns nothing
+//!************************************************************************
+template<typename DacFormatT>
+void AdiTrxSim::startSink()
+{
+    stopSink();
+
+    mSinkWriter = DacFormatT::write;
+    mSinkWaveform.reset();
+    mSinkSequenceVec.clear();
+
+    if( mContinuousStreaming )
+    {
+        mSinkSequenceVec = mSignalSequenceVec.empty() ? std::vector<Dataset::SignalDataPtr>( 1, mSignalData ) : mSignalSequenceVec;
+        mSinkSequenceVec.erase( std::remove_if( mSinkSequenceVec.begin(), mSinkSequenceVec.end(),
+                                                []( const Dataset::SignalDataPtr& aSignalData ){ return !aSignalData || aSignalData->frameStore.isEmpty(); } ),
+                                mSinkSequenceVec.end() );
+    }
+    else if( mSignalData && !mSignalData->frameStore.isEmpty() )
+    {
+        mSinkWaveform = WaveformCache::getInstance()->get<DacFormatT>( *mSignalData, Dataset::getScale( *mSignalData ) );
+
+        if( mCapture )
+        {
+            mCapture->write( mSinkWaveform->data(), mSinkWaveform->size() / WaveformCache::PAIR_BYTES );
+        }
+    }
+
+    if( mSinkWaveform || mSinkSequenceVec.size() )
+    {
+        mSinkPairsPerSec = ( mSinkRate >= 0 ) ? mSinkRate : mTxSamplingFrequency;
+        mSinkStopRequested = false;
+        mSinkPairsNr = 0;
+        mSinkLateNr = 0;
+
+        mSinkThread = std::thread( &AdiTrxSim::runSink, this );
+    }
+}
+
+#endif // AdiTrxSim_h
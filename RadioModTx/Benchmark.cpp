@@ -0,0 +1,715 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+
+/*
+Benchmark.cpp
+
+This file contains the sources for microbenchmarks.
+*/
+
+#include "Benchmark.h"
+#include "AdiTrxAd9081.h"
+#include "AdiTrxAd9361.h"
+#include "AdiTrxAdrv9009.h"
+#include "CsvParser.h"
+#include "DacConverter.h"
+#include "DatasetCache.h"
+#include "DatasetIndex.h"
+#include "Hdf5Parser.h"
+#include "PklParser.h"
+#include "SourceIndex.h"
+#include "WaveformCache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <thread>
+
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+//!************************************************************************
+//! Constructor
+//!************************************************************************
+Benchmark::Benchmark()
+    : mIterationsNr( DEFAULT_ITERATIONS_NR )
+{
+}
+
+
+//!************************************************************************
+//! Measure the conversion of points to the DAC samples of a device, the
+//! loop run for every buffer of a non-cyclic stream
+//!
+//! @returns nothing
+//!************************************************************************
+void Benchmark::benchConversion
+    (
+    const std::string&                  aName,      //!< case name
+    const DacWriter                     aWriter,    //!< writer of the DAC format of the device
+    const std::ptrdiff_t                aStep,      //!< step between pairs of the buffer [bytes]
+    const std::vector<Dataset::IQPoint>& aPointVec  //!< points to convert
+    )
+{
+    std::vector<uint8_t> bufferVec( aPointVec.size() * aStep );
+
+    measure( aName, "sample", [&]( uint64_t& aUnitsNr, uint64_t& aBytesNr, uint64_t& aChecksum )
+    {
+        aWriter( aPointVec.data(), aPointVec.size(), 1.0, bufferVec.data(), aStep );
+
+        int16_t lastPair[2] = { 0, 0 };
+        memcpy( lastPair, bufferVec.data() + ( aPointVec.size() - 1 ) * aStep, sizeof( lastPair ) );
+
+        aUnitsNr = aPointVec.size();
+        aBytesNr = aPointVec.size() * sizeof( Dataset::IQPoint );
+        aChecksum += static_cast<uint16_t>( lastPair[0] ) + static_cast<uint16_t>( lastPair[1] );
+        return true;
+    });
+}
+
+
+//!************************************************************************
+//! Measure the modulation-SNR lookups of a dataset index sized like the
+//! largest dataset, on a random sequence of combinations
+//!
+//! @returns nothing
+//!************************************************************************
+void Benchmark::benchIndexLookups
+    (
+    const size_t            aLookupsNr      //!< lookups per iteration
+    )
+{
+    const size_t MODULATIONS_NR = Dataset::MODULATIONS_NR.at( Dataset::DATASET_SOURCE_HISARMOD_2019_1 );
+    const size_t SNRS_NR = Dataset::SNRS_NR.at( Dataset::DATASET_SOURCE_RADIOML_2018_01 );
+
+    std::vector<Modulation::ModulationName> modVec;
+    std::vector<int> snrVec;
+
+    for( auto it = Modulation::MODULATION_NAME_ALIAS.begin(); modVec.size() < MODULATIONS_NR && it != Modulation::MODULATION_NAME_ALIAS.end(); it++ )
+    {
+        if( Modulation::NAME_UNKNOWN != it->first )
+        {
+            modVec.push_back( it->first );
+        }
+    }
+
+    for( size_t i = 0; i < SNRS_NR; i++ )
+    {
+        snrVec.push_back( -20 + 2 * static_cast<int>( i ) );
+    }
+
+    std::shared_ptr<Dataset::ModulationSnrSignalDataMap> map = std::make_shared<Dataset::ModulationSnrSignalDataMap>();
+    map->build( modVec, snrVec );
+
+    for( size_t m = 0; m < modVec.size(); m++ )
+    {
+        for( size_t s = 0; s < snrVec.size(); s++ )
+        {
+            Dataset::SignalData signalData;
+            signalData.frameStore.allocate( 1, LOOKUP_FRAME_LENGTH );
+            signalData.maxVal = 1;
+            map->insert( std::make_pair( modVec.at( m ), snrVec.at( s ) ), std::move( signalData ) );
+        }
+    }
+
+    // one lookup in eight misses, on an odd SNR
+    std::mt19937 generator( RANDOM_SEED );
+    std::vector<Dataset::ModulationSnrPair> pairVec( aLookupsNr );
+
+    for( size_t i = 0; i < aLookupsNr; i++ )
+    {
+        pairVec.at( i ) = std::make_pair( modVec.at( generator() % modVec.size() ), snrVec.at( generator() % snrVec.size() ) + ( 0 == generator() % 8 ) );
+    }
+
+    measure( "index_contains", "lookup", [&]( uint64_t& aUnitsNr, uint64_t& aBytesNr, uint64_t& aChecksum )
+    {
+        for( size_t i = 0; i < pairVec.size(); i++ )
+        {
+            aChecksum += map->contains( pairVec[i] );
+        }
+
+        aUnitsNr = pairVec.size();
+        aBytesNr = 0;
+        return true;
+    });
+
+    measure( "index_get_block", "lookup", [&]( uint64_t& aUnitsNr, uint64_t& aBytesNr, uint64_t& aChecksum )
+    {
+        for( size_t i = 0; i < pairVec.size(); i++ )
+        {
+            Dataset::SignalDataPtr signalData = map->getBlock( pairVec[i] );
+            aChecksum += ( nullptr != signalData );
+        }
+
+        aUnitsNr = pairVec.size();
+        aBytesNr = 0;
+        return true;
+    });
+}
+
+
+//!************************************************************************
+//! Measure the lookups of modulation names, over all their aliases and an
+//! unknown name
+//!
+//! @returns nothing
+//!************************************************************************
+void Benchmark::benchModulationNames
+    (
+    const size_t            aLookupsNr      //!< lookups per iteration
+    )
+{
+    const Modulation* MOD_INSTANCE = Modulation::getInstance();
+    std::vector<std::string> nameVec;
+
+    for( auto it = Modulation::MODULATION_NAME_ALIAS.begin(); it != Modulation::MODULATION_NAME_ALIAS.end(); it++ )
+    {
+        if( Modulation::NAME_UNKNOWN != it->first )
+        {
+            nameVec.insert( nameVec.end(), it->second.begin(), it->second.end() );
+        }
+    }
+
+    nameVec.push_back( "NOT-A-MODULATION" );
+
+    measure( "modulation_name", "lookup", [&]( uint64_t& aUnitsNr, uint64_t& aBytesNr, uint64_t& aChecksum )
+    {
+        for( size_t i = 0; i < aLookupsNr; i++ )
+        {
+            aChecksum += MOD_INSTANCE->getModulationName( nameVec[i % nameVec.size()] );
+        }
+
+        aUnitsNr = aLookupsNr;
+        aBytesNr = 0;
+        return true;
+    });
+}
+
+
+//!************************************************************************
+//! Measure the parse of a dataset file, loading all its samples (or those
+//! of the "modulation" option). The cache and the sidecar index are kept
+//! in a temporary directory, so the files next to the dataset are neither
+//! read, written nor removed. The timed parses do not use the cache and
+//! start without an index; the cache is then written by an untimed parse
+//! and its load is measured on its own.
+//!
+//! @returns nothing
+//!************************************************************************
+void Benchmark::benchParser
+    (
+    const Dataset::DatasetSource    aSource,        //!< dataset source
+    const std::string&              aFileName       //!< dataset file
+    )
+{
+    const std::string MODULATION_NAME = getString( "modulation", "" );
+    const Modulation::ModulationName MODULATION = Modulation::getInstance()->getModulationName( MODULATION_NAME );
+
+    char directoryTemplate[] = "/tmp/RadioModTxBench.XXXXXX";
+    const char* DIRECTORY = mkdtemp( directoryTemplate );
+    const std::string SIDECAR_DIRECTORY = DIRECTORY ? DIRECTORY : "";
+
+    DatasetCache cacheFile( aFileName, aSource );
+    cacheFile.setDirectory( SIDECAR_DIRECTORY );
+    const std::string CACHE_FILE_NAME = cacheFile.getFileName();
+
+    SourceIndex indexFile( aFileName, aSource );
+    indexFile.setDirectory( SIDECAR_DIRECTORY );
+    const std::string INDEX_FILE_NAME = indexFile.getFileName();
+
+    std::string suffix;
+
+    switch( aSource )
+    {
+        case Dataset::DATASET_SOURCE_RADIOML_2016_10A:
+            suffix = "pkl";
+            break;
+
+        case Dataset::DATASET_SOURCE_RADIOML_2018_01:
+            suffix = "hdf5";
+            break;
+
+        case Dataset::DATASET_SOURCE_HISARMOD_2019_1:
+            suffix = "csv";
+            break;
+
+        default:
+            break;
+    }
+
+    struct stat fileStat;
+    const uint64_t FILE_BYTES = ( 0 == stat( aFileName.c_str(), &fileStat ) ) ? fileStat.st_size : 0;
+
+    Dataset::getInstance()->getSource() = aSource;
+
+    // parses the file, or loads its cache when enabled and there is one
+    auto parse = [&]( const bool aCacheEnabled, uint64_t& aUnitsNr, uint64_t& aBytesNr, uint64_t& aChecksum )
+    {
+        std::unique_ptr<DatasetParser> parser;
+
+        switch( aSource )
+        {
+            case Dataset::DATASET_SOURCE_RADIOML_2016_10A:
+                parser.reset( new PklParser() );
+                break;
+
+            case Dataset::DATASET_SOURCE_RADIOML_2018_01:
+                parser.reset( new Hdf5Parser() );
+                break;
+
+            default:
+                parser.reset( new CsvParser() );
+                break;
+        }
+
+        parser->setIndexOnly( false, Dataset::BLOCK_CACHE_BUDGET_BYTES );
+        parser->setCacheEnabled( aCacheEnabled );
+        parser->setSidecarDirectory( SIDECAR_DIRECTORY );
+        parser->setFile( aFileName );
+
+        if( MODULATION_NAME.size() )
+        {
+            parser->setSingleModulation( MODULATION );
+            parser->parseDatasetSingleModulation();
+        }
+        else
+        {
+            parser->parseDataset();
+        }
+
+        bool status = false;
+        Dataset::Snapshot map = parser->takeMap( status );
+
+        aUnitsNr = 0;
+        aBytesNr = FILE_BYTES;
+
+        for( size_t m = 0; status && map && m < map->getModulationsNr(); m++ )
+        {
+            for( size_t s = 0; s < map->getSnrsNr(); s++ )
+            {
+                const Dataset::SignalData* signalData = map->getSignalData( m, s );
+
+                if( signalData )
+                {
+                    aUnitsNr += signalData->frameStore.getPointsNr();
+                    aChecksum += static_cast<uint64_t>( signalData->maxVal * 1000 );
+                }
+            }
+        }
+
+        return status && aUnitsNr;
+    };
+
+    if( !DIRECTORY )
+    {
+        std::cerr << "Cannot create the temporary directory " << directoryTemplate << std::endl;
+    }
+    else if( Modulation::NAME_UNKNOWN == MODULATION && MODULATION_NAME.size() )
+    {
+        std::cerr << "Unknown modulation " << MODULATION_NAME << std::endl;
+    }
+    else
+    {
+        measure( "parse_" + suffix, "sample", [&]( uint64_t& aUnitsNr, uint64_t& aBytesNr, uint64_t& aChecksum )
+        {
+            return parse( false, aUnitsNr, aBytesNr, aChecksum );
+        },
+        [&]()
+        {
+            std::remove( INDEX_FILE_NAME.c_str() );
+        });
+
+        // only full parses of text and pickle files are cached
+        uint64_t unitsNr = 0;
+        uint64_t bytesNr = 0;
+        uint64_t checksum = 0;
+        struct stat cacheStat;
+
+        if( isSelected( "load_cache_" + suffix )
+            && parse( true, unitsNr, bytesNr, checksum )
+            && 0 == stat( CACHE_FILE_NAME.c_str(), &cacheStat ) )
+        {
+            measure( "load_cache_" + suffix, "sample", [&]( uint64_t& aUnitsNr, uint64_t& aBytesNr, uint64_t& aChecksum )
+            {
+                bool status = parse( true, aUnitsNr, aBytesNr, aChecksum );
+                aBytesNr = cacheStat.st_size;
+                return status;
+            });
+        }
+    }
+
+    if( DIRECTORY )
+    {
+        std::remove( CACHE_FILE_NAME.c_str() );
+        std::remove( INDEX_FILE_NAME.c_str() );
+        rmdir( DIRECTORY );
+    }
+}
+
+
+//!************************************************************************
+//! Get an option as an integer
+//!
+//! @returns true if the option is not set or is an integer
+//!************************************************************************
+bool Benchmark::getInteger
+    (
+    const std::string&      aKey,           //!< option key
+    const int64_t           aDefault,       //!< value if the option is not set
+    int64_t&                aValue          //!< option value
+    ) const
+{
+    bool status = true;
+    auto it = mOptionMap.find( aKey );
+    aValue = aDefault;
+
+    if( mOptionMap.end() != it )
+    {
+        char* end = nullptr;
+        aValue = std::strtoll( it->second.c_str(), &end, 10 );
+        status = it->second.size() && '\0' == *end && aValue > 0;
+
+        if( !status )
+        {
+            std::cerr << "Invalid positive integer for " << aKey << ": " << it->second << std::endl;
+        }
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Get the peak resident set size of the process since the last reset
+//!
+//! @returns The peak resident set size [kB]
+//!************************************************************************
+uint64_t Benchmark::getPeakRssKb()
+{
+    std::ifstream statusFile( "/proc/self/status" );
+    std::string line;
+    uint64_t peakRssKb = 0;
+
+    while( 0 == peakRssKb && std::getline( statusFile, line ) )
+    {
+        if( 0 == line.compare( 0, 6, "VmHWM:" ) )
+        {
+            peakRssKb = std::strtoull( line.c_str() + 6, nullptr, 10 );
+        }
+    }
+
+    // the peak of the whole run, when /proc is not available
+    if( 0 == peakRssKb )
+    {
+        struct rusage usage;
+
+        if( 0 == getrusage( RUSAGE_SELF, &usage ) )
+        {
+            peakRssKb = usage.ru_maxrss;
+        }
+    }
+
+    return peakRssKb;
+}
+
+
+//!************************************************************************
+//! Get an option as a string
+//!
+//! @returns The option value
+//!************************************************************************
+std::string Benchmark::getString
+    (
+    const std::string&      aKey,           //!< option key
+    const std::string&      aDefault        //!< value if the option is not set
+    ) const
+{
+    auto it = mOptionMap.find( aKey );
+    return ( mOptionMap.end() != it ) ? it->second : aDefault;
+}
+
+
+//!************************************************************************
+//! Check if a case is selected by the "cases" option, a comma separated
+//! list of name prefixes
+//!
+//! @returns true if the case is selected
+//!************************************************************************
+bool Benchmark::isSelected
+    (
+    const std::string&      aName           //!< case name
+    ) const
+{
+    const std::string CASES = getString( "cases", "" );
+    bool selected = CASES.empty();
+    size_t start = 0;
+
+    while( !selected && start <= CASES.size() )
+    {
+        size_t end = CASES.find( ',', start );
+
+        if( std::string::npos == end )
+        {
+            end = CASES.size();
+        }
+
+        const std::string PREFIX = CASES.substr( start, end - start );
+        selected = PREFIX.size() && 0 == aName.compare( 0, PREFIX.size(), PREFIX );
+        start = end + 1;
+    }
+
+    return selected;
+}
+
+
+//!************************************************************************
+//! Run a case: one untimed iteration, then the timed ones, each preceded
+//! by the untimed setup if any. The result is printed and kept for the
+//! JSON report.
+//!
+//! @returns nothing
+//!************************************************************************
+void Benchmark::measure
+    (
+    const std::string&      aName,          //!< case name
+    const std::string&      aUnit,          //!< unit of work
+    const Iteration&        aIteration,     //!< one iteration of the case
+    const Setup&            aSetup          //!< untimed preparation of each iteration
+    )
+{
+    if( isSelected( aName ) )
+    {
+        CaseResult result = { aName, aUnit, 0, 0, mIterationsNr, 0, 0, 0, 0, true };
+        double totalSeconds = 0;
+
+        resetPeakRss();
+
+        if( aSetup )
+        {
+            aSetup();
+        }
+
+        result.status = aIteration( result.unitsNr, result.bytesNr, result.checksum );
+
+        for( size_t i = 0; result.status && i < mIterationsNr; i++ )
+        {
+            if( aSetup )
+            {
+                aSetup();
+            }
+
+            const std::chrono::steady_clock::time_point START = std::chrono::steady_clock::now();
+            result.status = aIteration( result.unitsNr, result.bytesNr, result.checksum );
+            const double SECONDS = std::chrono::duration<double>( std::chrono::steady_clock::now() - START ).count();
+
+            result.minSeconds = i ? std::min( result.minSeconds, SECONDS ) : SECONDS;
+            totalSeconds += SECONDS;
+        }
+
+        result.meanSeconds = totalSeconds / mIterationsNr;
+        result.peakRssKb = getPeakRssKb();
+
+        std::cerr << std::left << std::setw( 20 ) << aName << std::right;
+
+        if( result.status && result.minSeconds > 0 )
+        {
+            std::cerr << std::fixed << std::setprecision( 2 ) << std::setw( 12 ) << result.minSeconds * 1e9 / result.unitsNr << " ns/" << aUnit;
+
+            if( result.bytesNr )
+            {
+                std::cerr << std::setw( 12 ) << result.bytesNr / result.minSeconds / 1e6 << " MB/s";
+            }
+
+            std::cerr << std::defaultfloat << std::setw( 12 ) << result.peakRssKb << " kB peak RSS" << std::endl;
+        }
+        else
+        {
+            std::cerr << "failed" << std::endl;
+            result.status = false;
+        }
+
+        mResultVec.push_back( result );
+    }
+}
+
+
+//!************************************************************************
+//! Reset the peak resident set size of the process, so that each case
+//! reports its own peak
+//!
+//! @returns nothing
+//!************************************************************************
+void Benchmark::resetPeakRss()
+{
+    std::ofstream clearRefsFile( "/proc/self/clear_refs" );
+
+    if( clearRefsFile.is_open() )
+    {
+        clearRefsFile << "5";
+    }
+}
+
+
+//!************************************************************************
+//! Run the selected cases, the ones using little memory first
+//!
+//! @returns true if all the cases run succeeded
+//!************************************************************************
+bool Benchmark::run()
+{
+    int64_t iterationsNr = 0;
+    int64_t conversionPointsNr = 0;
+    int64_t lookupsNr = 0;
+    int64_t nameLookupsNr = 0;
+
+    bool status = getInteger( "iterations", DEFAULT_ITERATIONS_NR, iterationsNr )
+               && getInteger( "conversion_points", DEFAULT_CONVERSION_POINTS_NR, conversionPointsNr )
+               && getInteger( "lookups", DEFAULT_LOOKUPS_NR, lookupsNr )
+               && getInteger( "name_lookups", DEFAULT_NAME_LOOKUPS_NR, nameLookupsNr );
+
+    if( status )
+    {
+        mIterationsNr = iterationsNr;
+        mResultVec.clear();
+
+        std::cerr << "DAC conversion kernel: " << DacConverter::getKernelName() << std::endl;
+
+        benchModulationNames( nameLookupsNr );
+        benchIndexLookups( lookupsNr );
+
+        // points spread over the full scale, some of them saturating
+        std::mt19937 generator( RANDOM_SEED );
+        std::uniform_real_distribution<float> distribution( -1.05f, 1.05f );
+        std::vector<Dataset::IQPoint> pointVec( conversionPointsNr );
+
+        for( size_t i = 0; i < pointVec.size(); i++ )
+        {
+            pointVec.at( i ) = { distribution( generator ), distribution( generator ) };
+        }
+
+        const std::ptrdiff_t PAIR_STEP = WaveformCache::PAIR_BYTES;
+
+        benchConversion( "convert_ad9361", AdiTrxAd9361::TxDacFormat::write, PAIR_STEP, pointVec );
+        benchConversion( "convert_ad9361_2ch", AdiTrxAd9361::TxDacFormat::write, 2 * PAIR_STEP, pointVec );
+        benchConversion( "convert_adrv9009", AdiTrxAdrv9009::TxDacFormat::write, PAIR_STEP, pointVec );
+        benchConversion( "convert_ad9081", AdiTrxAd9081::TxDacFormat::write, PAIR_STEP, pointVec );
+
+        pointVec.clear();
+        pointVec.shrink_to_fit();
+
+        const std::string PKL_FILE_NAME = getString( "pkl", "" );
+        const std::string HDF5_FILE_NAME = getString( "hdf5", "" );
+        const std::string CSV_FILE_NAME = getString( "csv", "" );
+
+        if( PKL_FILE_NAME.size() )
+        {
+            benchParser( Dataset::DATASET_SOURCE_RADIOML_2016_10A, PKL_FILE_NAME );
+        }
+
+        if( HDF5_FILE_NAME.size() )
+        {
+            benchParser( Dataset::DATASET_SOURCE_RADIOML_2018_01, HDF5_FILE_NAME );
+        }
+
+        if( CSV_FILE_NAME.size() )
+        {
+            benchParser( Dataset::DATASET_SOURCE_HISARMOD_2019_1, CSV_FILE_NAME );
+        }
+
+        for( size_t i = 0; i < mResultVec.size(); i++ )
+        {
+            status = status && mResultVec.at( i ).status;
+        }
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Set an option from a "key=value" string
+//!
+//! @returns true if the string has a key and a value
+//!************************************************************************
+bool Benchmark::setOption
+    (
+    const std::string&      aOption         //!< "key=value"
+    )
+{
+    const size_t SEPARATOR = aOption.find( '=' );
+    bool status = std::string::npos != SEPARATOR && SEPARATOR > 0 && SEPARATOR + 1 < aOption.size();
+
+    if( status )
+    {
+        mOptionMap[aOption.substr( 0, SEPARATOR )] = aOption.substr( SEPARATOR + 1 );
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Write the results of the cases run as JSON
+//!
+//! @returns nothing
+//!************************************************************************
+void Benchmark::writeJson
+    (
+    std::ostream&           aStream         //!< output stream
+    ) const
+{
+    aStream << "{" << std::endl;
+    aStream << "  \"dac_kernel\": \"" << DacConverter::getKernelName() << "\"," << std::endl;
+    aStream << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << "," << std::endl;
+    aStream << "  \"iterations\": " << mIterationsNr << "," << std::endl;
+    aStream << "  \"cases\": [" << std::endl;
+
+    for( size_t i = 0; i < mResultVec.size(); i++ )
+    {
+        const CaseResult& result = mResultVec.at( i );
+        const bool TIMED = result.status && result.minSeconds > 0;
+
+        aStream << std::setprecision( 6 );
+        aStream << "    {" << std::endl;
+        aStream << "      \"name\": \"" << result.name << "\"," << std::endl;
+        aStream << "      \"unit\": \"" << result.unit << "\"," << std::endl;
+        aStream << "      \"status\": " << ( result.status ? "true" : "false" ) << "," << std::endl;
+        aStream << "      \"units\": " << result.unitsNr << "," << std::endl;
+        aStream << "      \"bytes\": " << result.bytesNr << "," << std::endl;
+        aStream << "      \"iterations\": " << result.iterationsNr << "," << std::endl;
+        aStream << "      \"min_s\": " << result.minSeconds << "," << std::endl;
+        aStream << "      \"mean_s\": " << result.meanSeconds << "," << std::endl;
+        aStream << "      \"ns_per_unit\": " << ( TIMED && result.unitsNr ? result.minSeconds * 1e9 / result.unitsNr : 0 ) << "," << std::endl;
+        aStream << "      \"mb_per_s\": " << ( TIMED ? result.bytesNr / result.minSeconds / 1e6 : 0 ) << "," << std::endl;
+        aStream << "      \"peak_rss_kb\": " << result.peakRssKb << "," << std::endl;
+        aStream << "      \"checksum\": " << result.checksum << std::endl;
+        aStream << "    }" << ( i + 1 < mResultVec.size() ? "," : "" ) << std::endl;
+    }
+
+    aStream << "  ]" << std::endl;
+    aStream << "}" << std::endl;
+}
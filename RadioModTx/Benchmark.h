@@ -0,0 +1,180 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+
+/*
+Benchmark.h
+
+This file contains the definitions for microbenchmarks.
+*/
+
+#ifndef Benchmark_h
+#define Benchmark_h
+
+#include "Dataset.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+//************************************************************************
+// Class for measuring the hot paths of the application, configured by
+// "key=value" options (see the RadioModTxBench usage for the keys):
+//  - the ingest rate of the dataset parsers, on the given dataset files
+//  - the conversion of (I,Q) points to the DAC samples of each device
+//  - the modulation-SNR lookups of the dataset index
+//  - the modulation name lookups
+//
+// Each case runs one untimed iteration, then the timed ones. It reports
+// the time per unit of work from its fastest iteration, the throughput
+// and the peak resident set size, and the results are written as JSON.
+//************************************************************************
+class Benchmark
+{
+    //************************************************************************
+    // constants and types
+    //************************************************************************
+    public:
+        typedef struct
+        {
+            std::string     name;           //!< case name
+            std::string     unit;           //!< unit of work: sample, lookup
+            uint64_t        unitsNr;        //!< units of work per iteration
+            uint64_t        bytesNr;        //!< bytes processed per iteration, 0 if not relevant
+            size_t          iterationsNr;   //!< timed iterations
+            double          minSeconds;     //!< fastest iteration [s]
+            double          meanSeconds;    //!< mean of the timed iterations [s]
+            uint64_t        peakRssKb;      //!< peak resident set size during the case [kB]
+            uint64_t        checksum;       //!< checksum of the results, keeps the work from being optimized out
+            bool            status;         //!< false if an iteration failed
+        }CaseResult;
+
+    private:
+        static const size_t DEFAULT_ITERATIONS_NR = 5;                  //!< default timed iterations of a case
+        static const size_t DEFAULT_CONVERSION_POINTS_NR = 1048576;     //!< default points converted per iteration
+        static const size_t DEFAULT_LOOKUPS_NR = 1000000;               //!< default index lookups per iteration
+        static const size_t DEFAULT_NAME_LOOKUPS_NR = 100000;           //!< default modulation name lookups per iteration
+        static const size_t LOOKUP_FRAME_LENGTH = 16;                   //!< frame length of the lookup index cells
+        static const uint32_t RANDOM_SEED = 2024;                       //!< seed of the synthetic inputs
+
+        // writes points as DAC samples, see DacFormat::write()
+        typedef void ( *DacWriter )
+            (
+            const Dataset::IQPoint*     aPoints,        //!< first point
+            const size_t                aPointsNr,      //!< number of points
+            const double                aScale,         //!< scale of the points to [-1..1]
+            uint8_t*                    aBuffer,        //!< first pair of the buffer
+            const std::ptrdiff_t        aStep           //!< step between pairs of the buffer [bytes]
+            );
+
+        // runs one iteration of a case, setting the units of work and bytes
+        // processed, and adding to the checksum
+        typedef std::function<bool( uint64_t&, uint64_t&, uint64_t& )> Iteration;
+
+        // prepares one iteration of a case, outside of the timed section
+        typedef std::function<void()> Setup;
+
+
+    //************************************************************************
+    // functions
+    //************************************************************************
+    public:
+        Benchmark();
+
+        bool run();
+
+        bool setOption
+            (
+            const std::string&      aOption         //!< "key=value"
+            );
+
+        void writeJson
+            (
+            std::ostream&           aStream         //!< output stream
+            ) const;
+
+    private:
+        void benchConversion
+            (
+            const std::string&                  aName,      //!< case name
+            const DacWriter                     aWriter,    //!< writer of the DAC format of the device
+            const std::ptrdiff_t                aStep,      //!< step between pairs of the buffer [bytes]
+            const std::vector<Dataset::IQPoint>& aPointVec  //!< points to convert
+            );
+
+        void benchIndexLookups
+            (
+            const size_t            aLookupsNr      //!< lookups per iteration
+            );
+
+        void benchModulationNames
+            (
+            const size_t            aLookupsNr      //!< lookups per iteration
+            );
+
+        void benchParser
+            (
+            const Dataset::DatasetSource    aSource,        //!< dataset source
+            const std::string&              aFileName       //!< dataset file
+            );
+
+        bool getInteger
+            (
+            const std::string&      aKey,           //!< option key
+            const int64_t           aDefault,       //!< value if the option is not set
+            int64_t&                aValue          //!< option value
+            ) const;
+
+        static uint64_t getPeakRssKb();
+
+        std::string getString
+            (
+            const std::string&      aKey,           //!< option key
+            const std::string&      aDefault        //!< value if the option is not set
+            ) const;
+
+        bool isSelected
+            (
+            const std::string&      aName           //!< case name
+            ) const;
+
+        void measure
+            (
+            const std::string&      aName,          //!< case name
+            const std::string&      aUnit,          //!< unit of work
+            const Iteration&        aIteration,     //!< one iteration of the case
+            const Setup&            aSetup = Setup()    //!< untimed preparation of each iteration
+            );
+
+        static void resetPeakRss();
+
+
+    //************************************************************************
+    // variables
+    //************************************************************************
+    private:
+        std::map<std::string, std::string>  mOptionMap;         //!< options by key
+        size_t                              mIterationsNr;      //!< timed iterations of a case
+        std::vector<CaseResult>             mResultVec;         //!< results of the cases run
+};
+
+#endif // Benchmark_h
@@ -0,0 +1,174 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+/*
+BlockCache.cpp
+
+This file contains the sources for block cache.
+*/
+
+#include "BlockCache.h"
+
+#include <iostream>
+#include <memory>
+#include <utility>
+
+
+//!************************************************************************
+//! Constructor
+//!************************************************************************
+BlockCache::BlockCache
+    (
+    const Dataset::BlockLoader&     aLoader,        //!< block loader
+    const size_t                    aBudgetBytes    //!< memory budget [bytes]
+    )
+    : mLoader( aLoader )
+    , mBudgetBytes( aBudgetBytes )
+    , mResidentBytes( 0 )
+{
+}
+
+
+//!************************************************************************
+//! Drop the least recently used blocks until a new block fits the budget.
+//! The mutex must be held by the caller.
+//!
+//! @returns nothing
+//!************************************************************************
+void BlockCache::evict
+    (
+    const size_t                    aIncomingBytes  //!< size of the block to be added [bytes]
+    )
+{
+    while( mLruList.size() && mResidentBytes + aIncomingBytes > mBudgetBytes )
+    {
+        auto it = mEntryMap.find( mLruList.back() );
+
+        mResidentBytes -= it->second.signalData->frameStore.getSizeBytes();
+        mEntryMap.erase( it );
+        mLruList.pop_back();
+    }
+}
+
+
+//!************************************************************************
+//! Get a block, loading it from the source file if not resident.
+//! The mutex is released during the load; concurrent requests for the
+//! same block wait for the first load to finish.
+//!
+//! @returns The signal data of the block, nullptr if it cannot be loaded
+//!************************************************************************
+Dataset::SignalDataPtr BlockCache::get
+    (
+    const size_t                    aKey,           //!< block key
+    const Dataset::BlockLocation&   aLocation,      //!< block location in the source file
+    const Dataset::SignalOrigin&    aOrigin         //!< origin stamped on the loaded block
+    )
+{
+    std::unique_lock<std::mutex> lock( mMutex );
+    Dataset::SignalDataPtr signalDataPtr;
+
+    // wait for a load of the same block by another thread
+    mLoadedCv.wait( lock, [this, aKey]{ return 0 == mLoadingSet.count( aKey ); } );
+
+    auto it = mEntryMap.find( aKey );
+
+    if( mEntryMap.end() != it )
+    {
+        mLruList.splice( mLruList.begin(), mLruList, it->second.lruIt );
+        signalDataPtr = it->second.signalData;
+    }
+    else
+    {
+        mLoadingSet.insert( aKey );
+        lock.unlock();
+
+        std::shared_ptr<Dataset::SignalData> signalData = std::make_shared<Dataset::SignalData>();
+        signalData->maxVal = 0;
+        signalData->origin = aOrigin;
+
+        const bool LOADED = mLoader && mLoader( aLocation, *signalData );
+
+        lock.lock();
+        mLoadingSet.erase( aKey );
+
+        if( LOADED )
+        {
+            const size_t BLOCK_BYTES = signalData->frameStore.getSizeBytes();
+
+            // a block larger than the budget is handed out without being kept
+            if( BLOCK_BYTES <= mBudgetBytes )
+            {
+                evict( BLOCK_BYTES );
+
+                mLruList.push_front( aKey );
+                mEntryMap[aKey] = { signalData, mLruList.begin() };
+                mResidentBytes += BLOCK_BYTES;
+            }
+
+            signalDataPtr = signalData;
+        }
+        else
+        {
+            std::cout << "Could not load block at " << aLocation.offset << " from the source file." << std::endl;
+        }
+
+        mLoadedCv.notify_all();
+    }
+
+    return signalDataPtr;
+}
+
+
+//!************************************************************************
+//! Get the memory budget
+//!
+//! @returns The memory budget [bytes]
+//!************************************************************************
+size_t BlockCache::getBudgetBytes() const
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    return mBudgetBytes;
+}
+
+
+//!************************************************************************
+//! Get the memory used by the resident blocks
+//!
+//! @returns The resident size [bytes]
+//!************************************************************************
+size_t BlockCache::getResidentBytes() const
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    return mResidentBytes;
+}
+
+
+//!************************************************************************
+//! Set the memory budget, evicting blocks if needed
+//!
+//! @returns nothing
+//!************************************************************************
+void BlockCache::setBudgetBytes
+    (
+    const size_t                    aBudgetBytes    //!< memory budget [bytes]
+    )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    mBudgetBytes = aBudgetBytes;
+    evict( 0 );
+}
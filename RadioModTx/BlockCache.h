@@ -0,0 +1,110 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+/*
+BlockCache.h
+
+This file contains the definitions for block cache.
+*/
+
+#ifndef BlockCache_h
+#define BlockCache_h
+
+#include "Dataset.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+
+//************************************************************************
+// Class for handling the modulation-SNR blocks loaded on demand.
+// Blocks are loaded the first time they are requested and kept in a
+// least recently used list, within a memory budget. An evicted block
+// stays alive for as long as a caller still holds it.
+//
+// Blocks are loaded without holding the mutex, so lookups of resident
+// blocks do not wait for a slow load. A caller asking for a block that
+// another thread is loading waits for that load instead of repeating
+// it. A block larger than the whole budget is returned but not kept.
+//************************************************************************
+class BlockCache
+{
+    //************************************************************************
+    // constants and types
+    //************************************************************************
+    private:
+        typedef struct
+        {
+            Dataset::SignalDataPtr          signalData;     //!< resident signal data
+            std::list<size_t>::iterator     lruIt;          //!< position in the LRU list
+        }Entry;
+
+
+    //************************************************************************
+    // functions
+    //************************************************************************
+    public:
+        BlockCache
+            (
+            const Dataset::BlockLoader&     aLoader,        //!< block loader
+            const size_t                    aBudgetBytes    //!< memory budget [bytes]
+            );
+
+        Dataset::SignalDataPtr get
+            (
+            const size_t                    aKey,           //!< block key
+            const Dataset::BlockLocation&   aLocation,      //!< block location in the source file
+            const Dataset::SignalOrigin&    aOrigin         //!< origin stamped on the loaded block
+            );
+
+        size_t getBudgetBytes() const;
+
+        size_t getResidentBytes() const;
+
+        void setBudgetBytes
+            (
+            const size_t                    aBudgetBytes    //!< memory budget [bytes]
+            );
+
+    private:
+        void evict
+            (
+            const size_t                    aIncomingBytes  //!< size of the block to be added [bytes]
+            );
+
+
+    //************************************************************************
+    // variables
+    //************************************************************************
+    private:
+        Dataset::BlockLoader                mLoader;        //!< block loader
+        size_t                              mBudgetBytes;   //!< memory budget [bytes]
+        size_t                              mResidentBytes; //!< memory used by resident blocks [bytes]
+
+        std::list<size_t>                   mLruList;       //!< block keys, most recently used first
+        std::unordered_map<size_t, Entry>   mEntryMap;      //!< resident blocks
+        std::unordered_set<size_t>          mLoadingSet;    //!< keys of the blocks being loaded
+
+        mutable std::mutex                  mMutex;         //!< protects all the above
+        std::condition_variable             mLoadedCv;      //!< signals the end of a load
+};
+
+#endif // BlockCache_h
@@ -22,10 +22,28 @@ This file contains the sources for CSV parser.
 */
 
 #include "CsvParser.h"
+#include "SourceIndex.h"
+#include "WorkerPool.h"
 
+#include <algorithm>
+#include <atomic>
+#include <charconv>
 #include <cmath>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined( __SSE2__ )
+#include <emmintrin.h>
+#endif
 
 
 const std::map<int, Modulation::ModulationName> CsvParser::MODULATION_MAPPING =
@@ -75,6 +93,8 @@ const std::vector<int> CsvParser::MODULATION_SERIES =
     61, 31,  1, 41, 11, 24
 };
 
+const std::string CsvParser::FRAMES_FILE_EXTENSION = ".frames";
+
 //!************************************************************************
 //! Constructor
 //!************************************************************************
@@ -84,172 +104,510 @@ CsvParser::CsvParser()
 
 
 //!************************************************************************
-//! Get a complex number (I,Q) from a string like "I+Qi"
+//! Count the lines of a range of characters, 16 bytes at a time when SSE2
+//! is available. A last line without newline is counted too.
+//!
+//! @returns The number of lines
+//!************************************************************************
+size_t CsvParser::countLines
+    (
+    const char*         aBegin,     //!< first character
+    const char*         aEnd        //!< end of the characters
+    )
+{
+    const char* crtPtr = aBegin;
+    size_t linesNr = 0;
+
+#if defined( __SSE2__ )
+    const __m128i PATTERN = _mm_set1_epi8( '\n' );
+
+    while( aEnd - crtPtr >= 16 )
+    {
+        __m128i block = _mm_loadu_si128( reinterpret_cast<const __m128i*>( crtPtr ) );
+        linesNr += __builtin_popcount( _mm_movemask_epi8( _mm_cmpeq_epi8( block, PATTERN ) ) );
+        crtPtr += 16;
+    }
+#endif
+
+    while( crtPtr < aEnd )
+    {
+        linesNr += ( '\n' == *crtPtr );
+        crtPtr++;
+    }
+
+    if( aEnd > aBegin && '\n' != aEnd[-1] )
+    {
+        linesNr++;
+    }
+
+    return linesNr;
+}
+
+
+//!************************************************************************
+//! Find the first occurrence of a byte, 16 bytes at a time when SSE2 is
+//! available
+//!
+//! @returns The position of the byte, aEnd if not found
+//!************************************************************************
+const char* CsvParser::findByte
+    (
+    const char*         aBegin,     //!< first character
+    const char*         aEnd,       //!< end of the characters
+    const char          aByte       //!< byte to find
+    )
+{
+    const char* crtPtr = aBegin;
+    const char* foundPtr = nullptr;
+
+#if defined( __SSE2__ )
+    const __m128i PATTERN = _mm_set1_epi8( aByte );
+
+    while( !foundPtr && aEnd - crtPtr >= 16 )
+    {
+        __m128i block = _mm_loadu_si128( reinterpret_cast<const __m128i*>( crtPtr ) );
+        int mask = _mm_movemask_epi8( _mm_cmpeq_epi8( block, PATTERN ) );
+
+        if( mask )
+        {
+            foundPtr = crtPtr + __builtin_ctz( mask );
+        }
+        else
+        {
+            crtPtr += 16;
+        }
+    }
+#endif
+
+    while( !foundPtr && crtPtr < aEnd )
+    {
+        if( aByte == *crtPtr )
+        {
+            foundPtr = crtPtr;
+        }
+        else
+        {
+            crtPtr++;
+        }
+    }
+
+    return foundPtr ? foundPtr : aEnd;
+}
+
+
+//!************************************************************************
+//! Get the loader of the blocks of the source file, used in index-only
+//! mode and by single-modulation parses
+//!
+//! @returns The block loader
+//!************************************************************************
+Dataset::BlockLoader CsvParser::getBlockLoader() const
+{
+    const std::string FILE_NAME = mFileName;
+
+    return [FILE_NAME]( const Dataset::BlockLocation& aLocation, Dataset::SignalData& aSignalData )
+    {
+        return loadBlock( FILE_NAME, aLocation, aSignalData );
+    };
+}
+
+
+//!************************************************************************
+//! Get the decoder of the bytes of one frame located by the sidecar index:
+//! its line, newline included
+//!
+//! @returns The frame decoder
+//!************************************************************************
+Dataset::FrameDecoder CsvParser::getFrameDecoder()
+{
+    return []( const char* aData, size_t aLength, Dataset::IQPoint* aFrame, float& aMaxVal )
+    {
+        const char* lineEnd = aData + aLength;
+
+        if( lineEnd > aData && '\n' == lineEnd[-1] )
+        {
+            lineEnd--;
+        }
+
+        return parseLine( aData, lineEnd, aFrame, aMaxVal );
+    };
+}
+
+
+//!************************************************************************
+//! Get the frames per modulation-SNR block of a CSV file. The lines carry
+//! no labels, so a file with another number of frames than the original
+//! dataset, such as a generated one, needs a frames file next to it,
+//! holding that number.
+//!
+//! @returns The frames per block, the nominal one without a valid frames file
+//!************************************************************************
+size_t CsvParser::getFramesNr
+    (
+    const std::string&  aFileName   //!< CSV filename
+    )
+{
+    const std::string FRAMES_FILE_NAME = aFileName + FRAMES_FILE_EXTENSION;
+    std::ifstream framesFile( FRAMES_FILE_NAME );
+    size_t framesNr = Dataset::FRAMES_PER_MOD_SNR_NR.at( Dataset::DATASET_SOURCE_HISARMOD_2019_1 );
+
+    if( framesFile.is_open() )
+    {
+        size_t fileFramesNr = 0;
+
+        if( ( framesFile >> fileFramesNr ) && fileFramesNr )
+        {
+            framesNr = fileFramesNr;
+        }
+        else
+        {
+            std::cout << "Invalid frames file " << FRAMES_FILE_NAME << ", parsing with " << framesNr << " frames per block." << std::endl;
+        }
+    }
+
+    return framesNr;
+}
+
+
+//!************************************************************************
+//! Get the modulations of the HisarMod 2019.1 dataset
+//!
+//! @returns The vector with modulations, sorted
+//!************************************************************************
+std::vector<Modulation::ModulationName> CsvParser::getModulationVec()
+{
+    std::vector<Modulation::ModulationName> modVec;
+
+    for( int modInt : MODULATION_SERIES )
+    {
+        modVec.push_back( MODULATION_MAPPING.at( modInt ) );
+    }
+
+    std::sort( modVec.begin(), modVec.end() );
+
+    return modVec;
+}
+
+
+//!************************************************************************
+//! Get the modulation and SNR of a line: the file holds aFramesNr lines
+//! per modulation-SNR block (500 in the original dataset), the modulations
+//! following MODULATION_SERIES within each SNR
+//!
+//! @returns The modulation-SNR pair of the line
+//!************************************************************************
+Dataset::ModulationSnrPair CsvParser::getModulationSnr
+    (
+    const size_t        aLineNr,    //!< line number, from 0
+    const size_t        aFramesNr   //!< number of lines per block
+    )
+{
+    const size_t NR_LINES_PER_SNR = aFramesNr * Dataset::MODULATIONS_NR.at( Dataset::DATASET_SOURCE_HISARMOD_2019_1 );
+
+    int snrDb = SNR_MIN_DB + SNR_STEP_DB * static_cast<int>( aLineNr / NR_LINES_PER_SNR );
+    int modInt = MODULATION_SERIES.at( ( aLineNr % NR_LINES_PER_SNR ) / aFramesNr );
+
+    return std::make_pair( MODULATION_MAPPING.at( modInt ), snrDb );
+}
+
+
+//!************************************************************************
+//! Get a complex number (I,Q) from text like "I+Qi" or "I-Qi", in place
 //!
-//! @returns The point represented by its I and Q parts
+//! @returns The position after the number, at the next comma or aEnd
 //!************************************************************************
-Dataset::IQPoint CsvParser::getPoint
+const char* CsvParser::getPoint
     (
-    std::string aString     //!< string with complex number
-    ) const
+    const char*         aBegin,     //!< first character of the number
+    const char*         aEnd,       //!< end of the line
+    Dataset::IQPoint&   aPoint      //!< point represented by its I and Q parts
+    )
 {
-    Dataset::IQPoint iqPoint = { 0, 0 };   
-    size_t sepSignIndex = aString.find( "+", 1 );
+    const char* crtPtr = aBegin;
+
+    aPoint = { 0, 0 };
 
-    if( std::string::npos == sepSignIndex )
+    if( parseFloat( crtPtr, aEnd, aPoint.i ) && crtPtr < aEnd && ( '+' == *crtPtr || '-' == *crtPtr ) )
     {
-        sepSignIndex = aString.find( "-", 1 );
+        parseFloat( crtPtr, aEnd, aPoint.q );
     }
 
-    if( std::string::npos != sepSignIndex )
+    // skip the imaginary unit
+    return findByte( crtPtr, aEnd, ',' );
+}
+
+
+//!************************************************************************
+//! Load a block located by an index-only parse
+//!
+//! @returns true if the block could be loaded
+//!************************************************************************
+bool CsvParser::loadBlock
+    (
+    const std::string&              aFileName,      //!< input filename
+    const Dataset::BlockLocation&   aLocation,      //!< block location in the file
+    Dataset::SignalData&            aSignalData     //!< signal data
+    )
+{
+    const uint16_t FRAME_LENGTH = Dataset::FRAME_LENGTH.at( Dataset::DATASET_SOURCE_HISARMOD_2019_1 );
+
+    std::ifstream inputFile( aFileName, std::ios::binary );
+    std::string blockStr;
+    size_t framesNr = 0;
+    bool status = inputFile.is_open();
+
+    if( status )
+    {
+        blockStr.resize( aLocation.length );
+        inputFile.seekg( aLocation.offset );
+        inputFile.read( &blockStr[0], aLocation.length );
+        blockStr.resize( inputFile.gcount() );
+
+        // one frame per line
+        framesNr = countLines( blockStr.data(), blockStr.data() + blockStr.size() );
+        status = framesNr && aSignalData.frameStore.allocate( framesNr, FRAME_LENGTH );
+    }
+
+    const char* crtPtr = blockStr.data();
+    const char* const BLOCK_END = blockStr.data() + blockStr.size();
+    size_t crtFrame = 0;
+
+    aSignalData.maxVal = 0;
+
+    while( status && crtFrame < framesNr && crtPtr < BLOCK_END )
     {
-        std::string dblStr = aString.substr( 0, sepSignIndex );
-        iqPoint.i = ::atof( dblStr.c_str() );
+        const char* lineEnd = findByte( crtPtr, BLOCK_END, '\n' );
+
+        status = parseLine( crtPtr, lineEnd, aSignalData.frameStore.getFrame( crtFrame ), aSignalData.maxVal );
+        crtFrame++;
 
-        dblStr = aString.substr( sepSignIndex, aString.size() - sepSignIndex - 1 );
-        iqPoint.q = ::atof( dblStr.c_str() );
+        crtPtr = lineEnd + 1;
     }
 
-    return iqPoint;
+    return status && ( framesNr == crtFrame );
 }
 
 
 //!************************************************************************
-//! Parse a CSV file using the HisarMod 2019.1 dataset syntax
+//! Parse a HisarMod 2019.1 dataset, from its cache if available.
+//! The first successful parse of the source file writes the cache.
+//! Index-only mode bypasses the cache, which holds all the samples.
 //!
 //! @returns nothing
 //!************************************************************************
 /* slot */ void CsvParser::parseDataset()
+{
+    bool status = !mIndexOnly && mCacheEnabled && loadCache( Dataset::DATASET_SOURCE_HISARMOD_2019_1 );
+
+    if( !status )
+    {
+        status = parseCsv( mIndexOnly );
+
+        if( status && !mIndexOnly && mCacheEnabled )
+        {
+            saveCache( Dataset::DATASET_SOURCE_HISARMOD_2019_1 );
+        }
+    }
+
+    mStatus = status;
+    emit parseFinished();
+}
+
+
+//!************************************************************************
+//! Parse a CSV file using the HisarMod 2019.1 dataset syntax.
+//! The file is split in newline-aligned chunks parsed concurrently: a
+//! first pass counts the lines of each chunk, giving the number of its
+//! first line, from which each worker knows the block and frame of every
+//! line it parses.
+//! In index-only mode only the byte range of each block is recorded.
+//! The offset of every line and the maximum value of every block are
+//! saved to the sidecar index of the file.
+//!
+//! @returns true if the file could be parsed
+//!************************************************************************
+bool CsvParser::parseCsv
+    (
+    const bool          aIndexOnly  //!< true to index the blocks without loading them
+    )
 {
     mUniqueModVec.clear();
     mUniqueSnrVec.clear();
+    mBlockVec.clear();
+    mLocationVec.clear();
     mMap.clear();
 
-    std::ifstream inputFile( mFileName );
+    int fd = open( mFileName.c_str(), O_RDONLY );
+    struct stat fileStat;
+    void* mapAddr = MAP_FAILED;
     bool parseFailed = false;
 
-    if( inputFile.is_open() )
+    SourceIndex sourceIndex( mFileName, Dataset::DATASET_SOURCE_HISARMOD_2019_1 );
+    sourceIndex.setDirectory( mSidecarDirectory );
+
+    if( fd >= 0 && 0 == fstat( fd, &fileStat ) && fileStat.st_size > 0 )
     {
-        size_t crtLineNr = 0;
-        std::string currentLine;
+        mapAddr = mmap( nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    }
+
+    if( MAP_FAILED != mapAddr )
+    {
+        const char* const FILE_BEGIN = static_cast<const char*>( mapAddr );
+        const char* const FILE_END = FILE_BEGIN + fileStat.st_size;
+
+        const uint16_t FRAME_LENGTH = Dataset::FRAME_LENGTH.at( Dataset::DATASET_SOURCE_HISARMOD_2019_1 );
 
-        int crtSnrDb = -100;
-        int oldSnrDb = crtSnrDb;
+        WorkerPool workerPool;
 
-        size_t crtModInt = SIZE_MAX;
-        size_t oldModInt = crtModInt;        
-        Modulation::ModulationName modName = Modulation::NAME_UNKNOWN;
+        // chunk boundaries, each one just after a newline
+        const size_t CHUNKS_NR = std::max<size_t>( 1, std::min<size_t>( 4 * workerPool.getThreadsNr(), fileStat.st_size / CHUNK_MIN_BYTES ) );
+        std::vector<const char*> chunkBeginVec( 1, FILE_BEGIN );
 
-        bool newCombination = false;
-        Dataset::ModulationSnrPair modSnrPair;
+        for( size_t crtChunk = 1; crtChunk < CHUNKS_NR; crtChunk++ )
+        {
+            const char* chunkBegin = std::max( chunkBeginVec.back(), FILE_BEGIN + crtChunk * fileStat.st_size / CHUNKS_NR );
+            chunkBegin = std::min( findByte( chunkBegin, FILE_END, '\n' ) + 1, FILE_END );
+            chunkBeginVec.push_back( chunkBegin );
+        }
 
-        Dataset::SignalData signalData;
-        Dataset::FrameData frameData;
-        Dataset::IQPoint iqPoint = { 0, 0 };
+        chunkBeginVec.push_back( FILE_END );
 
-        const size_t NR_LINES_PER_SNR = Dataset::FRAMES_PER_MOD_SNR_NR.at( Dataset::DATASET_SOURCE_HISARMOD_2019_1 )
-                                      * Dataset::MODULATIONS_NR.at( Dataset::DATASET_SOURCE_HISARMOD_2019_1 );        
+        // first pass: number of lines of each chunk
+        std::vector<size_t> chunkLinesVec( CHUNKS_NR, 0 );
 
-        while( std::getline( inputFile, currentLine ) )
+        for( size_t crtChunk = 0; crtChunk < CHUNKS_NR; crtChunk++ )
         {
-            crtSnrDb = -20 + 2 * ( crtLineNr / NR_LINES_PER_SNR );
+            workerPool.submit( [&, crtChunk]()
+            {
+                chunkLinesVec.at( crtChunk ) = countLines( chunkBeginVec.at( crtChunk ), chunkBeginVec.at( crtChunk + 1 ) );
+            });
+        }
 
-            crtModInt = ( crtLineNr % NR_LINES_PER_SNR ) / Dataset::FRAMES_PER_MOD_SNR_NR.at( Dataset::DATASET_SOURCE_HISARMOD_2019_1 );
-            crtModInt = MODULATION_SERIES.at( crtModInt );
+        workerPool.wait();
 
-            modName = MODULATION_MAPPING.at( crtModInt );
+        std::vector<size_t> chunkFirstLineVec( CHUNKS_NR, 0 );
+        size_t linesNr = 0;
 
-            newCombination = ( crtSnrDb != oldSnrDb || crtModInt != oldModInt );
+        for( size_t crtChunk = 0; crtChunk < CHUNKS_NR; crtChunk++ )
+        {
+            chunkFirstLineVec.at( crtChunk ) = linesNr;
+            linesNr += chunkLinesVec.at( crtChunk );
+        }
 
-            if( newCombination )
-            {
-                mUniqueModVec.push_back( modName );
-                mUniqueSnrVec.push_back( crtSnrDb );
+        // the lines carry no labels: a file of another length, such as a truncated
+        // one, is still parsed with these frames per block, but its labels may shift
+        const size_t SWEEP_BLOCKS_NR = Dataset::MODULATIONS_NR.at( Dataset::DATASET_SOURCE_HISARMOD_2019_1 ) * Dataset::SNRS_NR.at( Dataset::DATASET_SOURCE_HISARMOD_2019_1 );
+        const size_t FRAMES_NR = getFramesNr( mFileName );
+
+        if( SWEEP_BLOCKS_NR * FRAMES_NR != linesNr )
+        {
+            std::cout << "CSV file " << mFileName << " has " << linesNr << " lines instead of " << SWEEP_BLOCKS_NR
+                      << " blocks of " << FRAMES_NR << " frames, its labels may be wrong." << std::endl;
+        }
+
+        // the last block may be incomplete, it is then parsed but not kept
+        const size_t BLOCKS_NR = ( linesNr + FRAMES_NR - 1 ) / FRAMES_NR;
+        std::vector<Dataset::ModulationSnrPair> modSnrPairVec( BLOCKS_NR );
+        std::vector<Dataset::SignalData> signalDataVec( BLOCKS_NR );
+        std::vector<uint64_t> lineOffsetVec( linesNr + 1, fileStat.st_size );
+
+        for( size_t crtBlock = 0; crtBlock < BLOCKS_NR; crtBlock++ )
+        {
+            modSnrPairVec.at( crtBlock ) = getModulationSnr( crtBlock * FRAMES_NR, FRAMES_NR );
+
+            mUniqueModVec.push_back( modSnrPairVec.at( crtBlock ).first );
+            mUniqueSnrVec.push_back( modSnrPairVec.at( crtBlock ).second );
 
-                modSnrPair = std::make_pair( modName, crtSnrDb );
+            signalDataVec.at( crtBlock ).maxVal = 0;
 
-                signalData.frameDataVec.clear();
-                signalData.maxVal = 0;
+            if( !aIndexOnly && !signalDataVec.at( crtBlock ).frameStore.allocate( FRAMES_NR, FRAME_LENGTH ) )
+            {
+                parseFailed = true;
+                break;
             }
+        }
 
-            const size_t DATA_STR_LEN = currentLine.size();
-            frameData.clear();
+        // second pass: each worker writes its frames to their final place
+        std::vector<std::vector<float>> chunkMaxValVec( CHUNKS_NR );
+        std::atomic<bool> chunkFailed( false );
 
-            for( size_t j = 0; j < DATA_STR_LEN; j++ )
+        for( size_t crtChunk = 0; !parseFailed && crtChunk < CHUNKS_NR; crtChunk++ )
+        {
+            workerPool.submit( [&, crtChunk]()
             {
-                size_t commaIndex = currentLine.find( ",", j + 1 );
-                std::string cxStr;
+                const char* crtPtr = chunkBeginVec.at( crtChunk );
+                const char* const CHUNK_END = chunkBeginVec.at( crtChunk + 1 );
+                size_t crtLineNr = chunkFirstLineVec.at( crtChunk );
+
+                std::vector<float>& maxValVec = chunkMaxValVec.at( crtChunk );
+                maxValVec.assign( BLOCKS_NR, 0 );
 
-                if( std::string::npos != commaIndex )
+                while( !chunkFailed && crtPtr < CHUNK_END )
                 {
-                    cxStr = currentLine.substr( j, commaIndex - j );
-                    iqPoint = getPoint( cxStr );
-                    frameData.push_back( iqPoint );
+                    const char* lineEnd = findByte( crtPtr, CHUNK_END, '\n' );
+                    const size_t CRT_BLOCK = crtLineNr / FRAMES_NR;
 
-                    if( fabs( iqPoint.i ) > signalData.maxVal )
-                    {
-                        signalData.maxVal = fabs( iqPoint.i );
-                    }
+                    lineOffsetVec.at( crtLineNr ) = crtPtr - FILE_BEGIN;
 
-                    if( fabs( iqPoint.q ) > signalData.maxVal )
+                    if( !aIndexOnly )
                     {
-                        signalData.maxVal = fabs( iqPoint.q );
+                        Dataset::IQPoint* frame = signalDataVec.at( CRT_BLOCK ).frameStore.getFrame( crtLineNr % FRAMES_NR );
+
+                        if( !parseLine( crtPtr, lineEnd, frame, maxValVec.at( CRT_BLOCK ) ) )
+                        {
+                            chunkFailed = true;
+                        }
                     }
 
-                    j = commaIndex;
+                    crtLineNr++;
+                    crtPtr = lineEnd + 1;
                 }
-                else // last value
-                {
-                    cxStr = currentLine.substr( j, DATA_STR_LEN - j );
-                    iqPoint = getPoint( cxStr );
-                    frameData.push_back( iqPoint );
+            });
+        }
 
-                    if( fabs( iqPoint.i ) > signalData.maxVal )
-                    {
-                        signalData.maxVal = fabs( iqPoint.i );
-                    }
+        workerPool.wait();
 
-                    if( fabs( iqPoint.q ) > signalData.maxVal )
-                    {
-                        signalData.maxVal = fabs( iqPoint.q );
-                    }
+        parseFailed = parseFailed || chunkFailed;
 
-                    j = DATA_STR_LEN;
-                }
-            }
+        // keep the complete blocks, the offset of each of their lines going to the index
+        for( size_t crtBlock = 0; !parseFailed && crtBlock < linesNr / FRAMES_NR; crtBlock++ )
+        {
+            const std::vector<uint64_t> FRAME_OFFSET_VEC( lineOffsetVec.begin() + crtBlock * FRAMES_NR, lineOffsetVec.begin() + ( crtBlock + 1 ) * FRAMES_NR );
+            const uint64_t BLOCK_END = lineOffsetVec.at( ( crtBlock + 1 ) * FRAMES_NR );
+
+            Dataset::BlockLocation location = { FRAME_OFFSET_VEC.front(), BLOCK_END - FRAME_OFFSET_VEC.front() };
 
-            if( Dataset::FRAME_LENGTH.at( Dataset::DATASET_SOURCE_HISARMOD_2019_1 ) != frameData.size() )
+            if( aIndexOnly )
             {
-                parseFailed = true;
-                break;
+                sourceIndex.addBlock( modSnrPairVec.at( crtBlock ), location, -1, FRAME_OFFSET_VEC );
+                mLocationVec.emplace_back( modSnrPairVec.at( crtBlock ), location );
             }
-
-            signalData.frameDataVec.push_back( frameData );
-
-            if( crtLineNr
-           && ( 0 == ( crtLineNr + 1 ) % Dataset::FRAMES_PER_MOD_SNR_NR.at( Dataset::DATASET_SOURCE_HISARMOD_2019_1 ) )
-              )
+            else
             {
-                if( Dataset::FRAMES_PER_MOD_SNR_NR.at( Dataset::DATASET_SOURCE_HISARMOD_2019_1 ) != signalData.frameDataVec.size() )
+                for( size_t crtChunk = 0; crtChunk < CHUNKS_NR; crtChunk++ )
                 {
-                    parseFailed = true;
-                    break;
+                    signalDataVec.at( crtBlock ).maxVal = std::max( signalDataVec.at( crtBlock ).maxVal, chunkMaxValVec.at( crtChunk ).at( crtBlock ) );
                 }
 
-                mMap.insert( std::pair<Dataset::ModulationSnrPair, Dataset::SignalData>( modSnrPair, signalData ) );
+                sourceIndex.addBlock( modSnrPairVec.at( crtBlock ), location, signalDataVec.at( crtBlock ).maxVal, FRAME_OFFSET_VEC );
+                mBlockVec.emplace_back( modSnrPairVec.at( crtBlock ), std::move( signalDataVec.at( crtBlock ) ) );
             }
+        }
 
-            oldSnrDb = crtSnrDb;
-            oldModInt = crtModInt;
+        munmap( mapAddr, fileStat.st_size );
+    }
 
-            crtLineNr++;
-        }
+    if( fd >= 0 )
+    {
+        close( fd );
+    }
 
-        inputFile.close();
+    if( aIndexOnly )
+    {
+        mBlockLoader = getBlockLoader();
     }
 
-    removeDuplicates( mUniqueModVec );
-    removeDuplicates( mUniqueSnrVec );
+    buildMap( Dataset::DATASET_SOURCE_HISARMOD_2019_1 );
 
     if( Dataset::MODULATIONS_NR.at( Dataset::DATASET_SOURCE_HISARMOD_2019_1 ) != mUniqueModVec.size()
      || Dataset::SNRS_NR.at( Dataset::DATASET_SOURCE_HISARMOD_2019_1 ) != mUniqueSnrVec.size()
@@ -258,16 +616,163 @@ Dataset::IQPoint CsvParser::getPoint
         parseFailed = true;
     }
 
-    mStatus = !parseFailed;
-    emit parseFinished();
+    if( !parseFailed )
+    {
+        sourceIndex.save();
+    }
+
+    return !parseFailed;
 }
 
 
 //!************************************************************************
-//! Parse a dataset looking for a single modulation
+//! Parse a floating point number in place, an explicit '+' sign and
+//! leading blanks being accepted. Values too small for a float are
+//! flushed to zero, values too large are rejected.
+//!
+//! @returns true if a number could be parsed
+//!************************************************************************
+bool CsvParser::parseFloat
+    (
+    const char*&        aPtr,       //!< first character, moved after the number
+    const char*         aEnd,       //!< end of the characters
+    float&              aValue      //!< parsed value
+    )
+{
+    const char* crtPtr = aPtr;
+
+    while( crtPtr < aEnd && ' ' == *crtPtr )
+    {
+        crtPtr++;
+    }
+
+    if( crtPtr < aEnd && '+' == *crtPtr )
+    {
+        crtPtr++;
+    }
+
+    std::from_chars_result result = std::from_chars( crtPtr, aEnd, aValue );
+    bool status = ( result.ptr != crtPtr );
+
+    if( status && std::errc::result_out_of_range == result.ec )
+    {
+        // only a negative exponent makes a value too small for a float
+        const char* exponentPtr = std::find_if( crtPtr, result.ptr, []( const char aChar ){ return 'e' == aChar || 'E' == aChar; } );
+        status = ( exponentPtr + 1 < result.ptr ) && ( '-' == exponentPtr[1] );
+
+        if( status )
+        {
+            aValue = 0;
+        }
+    }
+
+    if( status )
+    {
+        aPtr = result.ptr;
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Parse one line of the CSV file, holding one frame
+//!
+//! @returns true if the line holds exactly one frame
+//!************************************************************************
+bool CsvParser::parseLine
+    (
+    const char*         aBegin,     //!< first character of the line
+    const char*         aEnd,       //!< end of the line, at the newline
+    Dataset::IQPoint*   aFrame,     //!< frame to fill
+    float&              aMaxVal     //!< maximum absolute value, updated
+    )
+{
+    const uint16_t FRAME_LENGTH = Dataset::FRAME_LENGTH.at( Dataset::DATASET_SOURCE_HISARMOD_2019_1 );
+    const char* lineEnd = aEnd;
+    Dataset::IQPoint iqPoint = { 0, 0 };
+    size_t crtPoint = 0;
+
+    if( lineEnd > aBegin && '\r' == lineEnd[-1] )
+    {
+        lineEnd--;
+    }
+
+    for( const char* crtPtr = aBegin; crtPtr < lineEnd; crtPtr++ )
+    {
+        crtPtr = getPoint( crtPtr, lineEnd, iqPoint );
+
+        if( crtPoint < FRAME_LENGTH )
+        {
+            aFrame[crtPoint] = iqPoint;
+        }
+
+        crtPoint++;
+
+        if( fabs( iqPoint.i ) > aMaxVal )
+        {
+            aMaxVal = fabs( iqPoint.i );
+        }
+
+        if( fabs( iqPoint.q ) > aMaxVal )
+        {
+            aMaxVal = fabs( iqPoint.q );
+        }
+    }
+
+    return ( FRAME_LENGTH == crtPoint );
+}
+
+
+//!************************************************************************
+//! Parse a HisarMod 2019.1 dataset looking for a single modulation.
+//! The 20 blocks of the modulation are read straight from their byte
+//! ranges, found in the sidecar index of the file. Without an up-to-date
+//! index, the file is first scanned for its line boundaries only, which
+//! writes the index.
 //!
 //! @returns nothing
 //!************************************************************************
 /* slot */ void CsvParser::parseDatasetSingleModulation()
 {
+    const Dataset::BlockLoader BLOCK_LOADER = getBlockLoader();
+
+    bool status = loadSingleModulation( Dataset::DATASET_SOURCE_HISARMOD_2019_1, BLOCK_LOADER, getFrameDecoder() );
+
+    if( !status )
+    {
+        status = parseCsv( true )
+              && loadSingleModulation( Dataset::DATASET_SOURCE_HISARMOD_2019_1, BLOCK_LOADER, getFrameDecoder() );
+    }
+
+    if( 1 != mUniqueModVec.size()
+     || Dataset::SNRS_NR.at( Dataset::DATASET_SOURCE_HISARMOD_2019_1 ) != mUniqueSnrVec.size()
+      )
+    {
+        status = false;
+    }
+
+    mStatus = status;
+    emit parseFinished();
+}
+
+
+//!************************************************************************
+//! Write the frames file of a CSV file, giving its frames per
+//! modulation-SNR block to the parser
+//!
+//! @returns true if the file could be written
+//!************************************************************************
+bool CsvParser::writeFramesFile
+    (
+    const std::string&  aFileName,  //!< CSV filename
+    const size_t        aFramesNr   //!< frames per modulation-SNR block
+    )
+{
+    std::ofstream framesFile( aFileName + FRAMES_FILE_EXTENSION, std::ios::trunc );
+
+    framesFile << aFramesNr << std::endl;
+    framesFile.close();
+
+    return framesFile.good();
 }
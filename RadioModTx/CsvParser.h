@@ -26,7 +26,9 @@ This file contains the definitions for CSV parser.
 
 #include "DatasetParser.h"
 
+#include <cstddef>
 #include <map>
+#include <string>
 #include <vector>
 
 
@@ -39,11 +41,19 @@ class CsvParser : public DatasetParser
     //************************************************************************
     // constants and types
     //************************************************************************
-    private:
+    public:
         static const std::map<int, Modulation::ModulationName> MODULATION_MAPPING;
 
         static const std::vector<int> MODULATION_SERIES;  //!< sequence of modulations
 
+        static const int SNR_MIN_DB = -20;      //!< SNR of the first lines of the file [dB]
+        static const int SNR_STEP_DB = 2;       //!< SNR step between sweeps of the modulations [dB]
+
+        static const std::string FRAMES_FILE_EXTENSION;   //!< extension of the file giving the frames per block of a CSV file
+
+    private:
+        static const size_t CHUNK_MIN_BYTES = 4 * 1048576;  //!< minimum size of a chunk parsed by one worker [bytes]
+
 
     //************************************************************************
     // functions
@@ -51,6 +61,14 @@ class CsvParser : public DatasetParser
     public:
         CsvParser();
 
+        static std::vector<Modulation::ModulationName> getModulationVec();
+
+        static bool writeFramesFile
+            (
+            const std::string&  aFileName,  //!< CSV filename
+            const size_t        aFramesNr   //!< frames per modulation-SNR block
+            );
+
     public slots:
         void parseDataset();
 
@@ -60,10 +78,67 @@ class CsvParser : public DatasetParser
         void parseFinished();
 
     private:
-        Dataset::IQPoint getPoint
+        static size_t countLines
+            (
+            const char*         aBegin,     //!< first character
+            const char*         aEnd        //!< end of the characters
+            );
+
+        static const char* findByte
+            (
+            const char*         aBegin,     //!< first character
+            const char*         aEnd,       //!< end of the characters
+            const char          aByte       //!< byte to find
+            );
+
+        Dataset::BlockLoader getBlockLoader() const;
+
+        static Dataset::FrameDecoder getFrameDecoder();
+
+        static size_t getFramesNr
+            (
+            const std::string&  aFileName   //!< CSV filename
+            );
+
+        static Dataset::ModulationSnrPair getModulationSnr
+            (
+            const size_t        aLineNr,    //!< line number, from 0
+            const size_t        aFramesNr   //!< number of lines per block
+            );
+
+        static const char* getPoint
+            (
+            const char*         aBegin,     //!< first character of the number
+            const char*         aEnd,       //!< end of the line
+            Dataset::IQPoint&   aPoint      //!< point represented by its I and Q parts
+            );
+
+        static bool loadBlock
+            (
+            const std::string&              aFileName,      //!< input filename
+            const Dataset::BlockLocation&   aLocation,      //!< block location in the file
+            Dataset::SignalData&            aSignalData     //!< signal data
+            );
+
+        bool parseCsv
+            (
+            const bool          aIndexOnly  //!< true to index the blocks without loading them
+            );
+
+        static bool parseFloat
+            (
+            const char*&        aPtr,       //!< first character, moved after the number
+            const char*         aEnd,       //!< end of the characters
+            float&              aValue      //!< parsed value
+            );
+
+        static bool parseLine
             (
-            std::string aString     //!< string with complex number
-            ) const;
+            const char*         aBegin,     //!< first character of the line
+            const char*         aEnd,       //!< end of the line, at the newline
+            Dataset::IQPoint*   aFrame,     //!< frame to fill
+            float&              aMaxVal     //!< maximum absolute value, updated
+            );
 };
 
 #endif // CsvParser_h
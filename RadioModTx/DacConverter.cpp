@@ -0,0 +1,320 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+/*
+DacConverter.cpp
+
+This file contains the sources for DAC sample converter.
+*/
+
+#include "DacConverter.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+    #define DAC_CONVERTER_X86 1
+    #include <immintrin.h>
+#else
+    #define DAC_CONVERTER_X86 0
+#endif
+
+
+//!************************************************************************
+//! Convert points to DAC samples, written to a buffer holding one (I,Q)
+//! pair every aStep bytes. A buffer with packed pairs is written directly
+//! by the kernel, any other step through a small block of samples.
+//!
+//! @returns nothing
+//!************************************************************************
+void DacConverter::convert
+    (
+    const Dataset::IQPoint*     aPoints,        //!< first point
+    const size_t                aPointsNr,      //!< number of points
+    const double                aScale,         //!< scale of the points
+    const int16_t               aFullScale,     //!< full scale of the DAC
+    const int                   aShift,         //!< left shift of the DAC samples
+    uint8_t*                    aBuffer,        //!< first (I,Q) pair of the buffer
+    const std::ptrdiff_t        aStep           //!< step between (I,Q) pairs of the buffer [bytes]
+    )
+{
+    const KernelFunction KERNEL_FUNCTION = getKernelFunction();
+    const size_t PAIR_BYTES = 2 * sizeof( int16_t );
+
+    if( static_cast<std::ptrdiff_t>( PAIR_BYTES ) == aStep )
+    {
+        KERNEL_FUNCTION( aPoints, aPointsNr, aScale, aFullScale, aShift, reinterpret_cast<int16_t*>( aBuffer ) );
+    }
+    else
+    {
+        int16_t samples[2 * STRIDED_BLOCK_POINTS];
+
+        for( size_t firstPoint = 0; firstPoint < aPointsNr; firstPoint += STRIDED_BLOCK_POINTS )
+        {
+            const size_t POINTS_NR = std::min( aPointsNr - firstPoint, static_cast<size_t>( STRIDED_BLOCK_POINTS ) );
+
+            KERNEL_FUNCTION( aPoints + firstPoint, POINTS_NR, aScale, aFullScale, aShift, samples );
+
+            for( size_t i = 0; i < POINTS_NR; i++ )
+            {
+                memcpy( aBuffer + ( firstPoint + i ) * aStep, samples + 2 * i, PAIR_BYTES );
+            }
+        }
+    }
+}
+
+
+#if DAC_CONVERTER_X86
+//!************************************************************************
+//! Convert points to DAC samples, 8 points at a time with AVX2
+//!
+//! @returns nothing
+//!************************************************************************
+__attribute__(( target( "avx2" ) ))
+void DacConverter::convertAvx2
+    (
+    const Dataset::IQPoint*     aPoints,        //!< first point
+    const size_t                aPointsNr,      //!< number of points
+    const float                 aScale,         //!< scale of the points
+    const float                 aFullScale,     //!< full scale of the DAC
+    const int                   aShift,         //!< left shift of the DAC samples
+    int16_t*                    aSamples        //!< interleaved (I,Q) samples
+    )
+{
+    const __m256 SCALE = _mm256_set1_ps( aScale );
+    const __m256 MAX_VAL = _mm256_set1_ps( aFullScale );
+    const __m256 MIN_VAL = _mm256_set1_ps( -aFullScale );
+    const __m128i SHIFT = _mm_cvtsi32_si128( aShift );
+
+    // the points are interleaved I and Q floats, just like the samples
+    const float* values = reinterpret_cast<const float*>( aPoints );
+    size_t crtPoint = 0;
+
+    for( ; crtPoint + 8 <= aPointsNr; crtPoint += 8 )
+    {
+        __m256 lowVal = _mm256_mul_ps( _mm256_loadu_ps( values + 2 * crtPoint ), SCALE );
+        __m256 highVal = _mm256_mul_ps( _mm256_loadu_ps( values + 2 * crtPoint + 8 ), SCALE );
+
+        // a NaN saturates to the full scale
+        lowVal = _mm256_max_ps( _mm256_min_ps( lowVal, MAX_VAL ), MIN_VAL );
+        highVal = _mm256_max_ps( _mm256_min_ps( highVal, MAX_VAL ), MIN_VAL );
+
+        // packing works within 128-bit lanes, the permutation restores the order
+        __m256i samples = _mm256_packs_epi32( _mm256_cvttps_epi32( lowVal ), _mm256_cvttps_epi32( highVal ) );
+        samples = _mm256_permute4x64_epi64( samples, 0xD8 );
+        samples = _mm256_sll_epi16( samples, SHIFT );
+
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( aSamples + 2 * crtPoint ), samples );
+    }
+
+    convertScalar( aPoints + crtPoint, aPointsNr - crtPoint, aScale, aFullScale, aShift, aSamples + 2 * crtPoint );
+}
+#else
+//!************************************************************************
+//! Convert points to DAC samples, AVX2 not being available
+//!
+//! @returns nothing
+//!************************************************************************
+void DacConverter::convertAvx2
+    (
+    const Dataset::IQPoint*     aPoints,        //!< first point
+    const size_t                aPointsNr,      //!< number of points
+    const float                 aScale,         //!< scale of the points
+    const float                 aFullScale,     //!< full scale of the DAC
+    const int                   aShift,         //!< left shift of the DAC samples
+    int16_t*                    aSamples        //!< interleaved (I,Q) samples
+    )
+{
+    convertScalar( aPoints, aPointsNr, aScale, aFullScale, aShift, aSamples );
+}
+#endif
+
+
+//!************************************************************************
+//! Convert points to DAC samples, one value at a time
+//!
+//! @returns nothing
+//!************************************************************************
+void DacConverter::convertScalar
+    (
+    const Dataset::IQPoint*     aPoints,        //!< first point
+    const size_t                aPointsNr,      //!< number of points
+    const float                 aScale,         //!< scale of the points
+    const float                 aFullScale,     //!< full scale of the DAC
+    const int                   aShift,         //!< left shift of the DAC samples
+    int16_t*                    aSamples        //!< interleaved (I,Q) samples
+    )
+{
+    const float* values = reinterpret_cast<const float*>( aPoints );
+
+    for( size_t i = 0; i < 2 * aPointsNr; i++ )
+    {
+        float value = values[i] * aScale;
+
+        // same saturation as the vector kernels, a NaN going to the full scale
+        value = ( value < aFullScale ) ? value : aFullScale;
+        value = ( value > -aFullScale ) ? value : -aFullScale;
+
+        aSamples[i] = static_cast<int16_t>( static_cast<uint16_t>( static_cast<int16_t>( value ) ) << aShift );
+    }
+}
+
+
+#if DAC_CONVERTER_X86
+//!************************************************************************
+//! Convert points to DAC samples, 4 points at a time with SSE2
+//!
+//! @returns nothing
+//!************************************************************************
+void DacConverter::convertSse2
+    (
+    const Dataset::IQPoint*     aPoints,        //!< first point
+    const size_t                aPointsNr,      //!< number of points
+    const float                 aScale,         //!< scale of the points
+    const float                 aFullScale,     //!< full scale of the DAC
+    const int                   aShift,         //!< left shift of the DAC samples
+    int16_t*                    aSamples        //!< interleaved (I,Q) samples
+    )
+{
+    const __m128 SCALE = _mm_set1_ps( aScale );
+    const __m128 MAX_VAL = _mm_set1_ps( aFullScale );
+    const __m128 MIN_VAL = _mm_set1_ps( -aFullScale );
+    const __m128i SHIFT = _mm_cvtsi32_si128( aShift );
+
+    const float* values = reinterpret_cast<const float*>( aPoints );
+    size_t crtPoint = 0;
+
+    for( ; crtPoint + 4 <= aPointsNr; crtPoint += 4 )
+    {
+        __m128 lowVal = _mm_mul_ps( _mm_loadu_ps( values + 2 * crtPoint ), SCALE );
+        __m128 highVal = _mm_mul_ps( _mm_loadu_ps( values + 2 * crtPoint + 4 ), SCALE );
+
+        lowVal = _mm_max_ps( _mm_min_ps( lowVal, MAX_VAL ), MIN_VAL );
+        highVal = _mm_max_ps( _mm_min_ps( highVal, MAX_VAL ), MIN_VAL );
+
+        __m128i samples = _mm_packs_epi32( _mm_cvttps_epi32( lowVal ), _mm_cvttps_epi32( highVal ) );
+        samples = _mm_sll_epi16( samples, SHIFT );
+
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( aSamples + 2 * crtPoint ), samples );
+    }
+
+    convertScalar( aPoints + crtPoint, aPointsNr - crtPoint, aScale, aFullScale, aShift, aSamples + 2 * crtPoint );
+}
+#else
+//!************************************************************************
+//! Convert points to DAC samples, SSE2 not being available
+//!
+//! @returns nothing
+//!************************************************************************
+void DacConverter::convertSse2
+    (
+    const Dataset::IQPoint*     aPoints,        //!< first point
+    const size_t                aPointsNr,      //!< number of points
+    const float                 aScale,         //!< scale of the points
+    const float                 aFullScale,     //!< full scale of the DAC
+    const int                   aShift,         //!< left shift of the DAC samples
+    int16_t*                    aSamples        //!< interleaved (I,Q) samples
+    )
+{
+    convertScalar( aPoints, aPointsNr, aScale, aFullScale, aShift, aSamples );
+}
+#endif
+
+
+//!************************************************************************
+//! Get the conversion kernel supported by the CPU, detected once
+//!
+//! @returns The conversion kernel
+//!************************************************************************
+DacConverter::Kernel DacConverter::getKernel()
+{
+    static const Kernel KERNEL = []()
+    {
+        Kernel kernel = KERNEL_SCALAR;
+
+#if DAC_CONVERTER_X86
+        __builtin_cpu_init();
+
+        if( __builtin_cpu_supports( "avx2" ) )
+        {
+            kernel = KERNEL_AVX2;
+        }
+        else if( __builtin_cpu_supports( "sse2" ) )
+        {
+            kernel = KERNEL_SSE2;
+        }
+#endif
+
+        return kernel;
+    }();
+
+    return KERNEL;
+}
+
+
+//!************************************************************************
+//! Get the function of the conversion kernel supported by the CPU
+//!
+//! @returns The kernel function
+//!************************************************************************
+DacConverter::KernelFunction DacConverter::getKernelFunction()
+{
+    KernelFunction kernelFunction = convertScalar;
+
+    switch( getKernel() )
+    {
+        case KERNEL_AVX2:
+            kernelFunction = convertAvx2;
+            break;
+
+        case KERNEL_SSE2:
+            kernelFunction = convertSse2;
+            break;
+
+        default:
+            break;
+    }
+
+    return kernelFunction;
+}
+
+
+//!************************************************************************
+//! Get the name of the conversion kernel supported by the CPU
+//!
+//! @returns The kernel name
+//!************************************************************************
+const char* DacConverter::getKernelName()
+{
+    const char* kernelName = "scalar";
+
+    switch( getKernel() )
+    {
+        case KERNEL_AVX2:
+            kernelName = "AVX2";
+            break;
+
+        case KERNEL_SSE2:
+            kernelName = "SSE2";
+            break;
+
+        default:
+            break;
+    }
+
+    return kernelName;
+}
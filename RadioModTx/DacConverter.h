@@ -0,0 +1,125 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+/*
+DacConverter.h
+
+This file contains the definitions for DAC sample converter.
+*/
+
+#ifndef DacConverter_h
+#define DacConverter_h
+
+#include "Dataset.h"
+
+#include <cstddef>
+#include <cstdint>
+
+
+//************************************************************************
+// Class for converting (I,Q) float points to the signed 16-bit samples of
+// a DAC: scale, saturate to the full scale, truncate toward zero, shift
+// left to align the DAC bits to the MSB, then interleave I and Q into a
+// buffer with a given step between (I,Q) pairs.
+//
+// The conversion kernel is chosen once at runtime from the CPU features:
+// AVX2, SSE2 or scalar.
+//************************************************************************
+class DacConverter
+{
+    // compares the kernels with each other
+    friend class DacConverterTest;
+
+    //************************************************************************
+    // constants and types
+    //************************************************************************
+    public:
+        typedef enum
+        {
+            KERNEL_SCALAR,
+            KERNEL_SSE2,
+            KERNEL_AVX2
+        }Kernel;
+
+    private:
+        static const size_t STRIDED_BLOCK_POINTS = 256;     //!< points converted at once for a strided buffer
+
+        typedef void ( *KernelFunction )
+            (
+            const Dataset::IQPoint*     aPoints,        //!< first point
+            const size_t                aPointsNr,      //!< number of points
+            const float                 aScale,         //!< scale of the points
+            const float                 aFullScale,     //!< full scale of the DAC
+            const int                   aShift,         //!< left shift of the DAC samples
+            int16_t*                    aSamples        //!< interleaved (I,Q) samples
+            );
+
+
+    //************************************************************************
+    // functions
+    //************************************************************************
+    public:
+        static void convert
+            (
+            const Dataset::IQPoint*     aPoints,        //!< first point
+            const size_t                aPointsNr,      //!< number of points
+            const double                aScale,         //!< scale of the points
+            const int16_t               aFullScale,     //!< full scale of the DAC
+            const int                   aShift,         //!< left shift of the DAC samples
+            uint8_t*                    aBuffer,        //!< first (I,Q) pair of the buffer
+            const std::ptrdiff_t        aStep           //!< step between (I,Q) pairs of the buffer [bytes]
+            );
+
+        static Kernel getKernel();
+
+        static const char* getKernelName();
+
+    private:
+        static void convertAvx2
+            (
+            const Dataset::IQPoint*     aPoints,        //!< first point
+            const size_t                aPointsNr,      //!< number of points
+            const float                 aScale,         //!< scale of the points
+            const float                 aFullScale,     //!< full scale of the DAC
+            const int                   aShift,         //!< left shift of the DAC samples
+            int16_t*                    aSamples        //!< interleaved (I,Q) samples
+            );
+
+        static void convertScalar
+            (
+            const Dataset::IQPoint*     aPoints,        //!< first point
+            const size_t                aPointsNr,      //!< number of points
+            const float                 aScale,         //!< scale of the points
+            const float                 aFullScale,     //!< full scale of the DAC
+            const int                   aShift,         //!< left shift of the DAC samples
+            int16_t*                    aSamples        //!< interleaved (I,Q) samples
+            );
+
+        static void convertSse2
+            (
+            const Dataset::IQPoint*     aPoints,        //!< first point
+            const size_t                aPointsNr,      //!< number of points
+            const float                 aScale,         //!< scale of the points
+            const float                 aFullScale,     //!< full scale of the DAC
+            const int                   aShift,         //!< left shift of the DAC samples
+            int16_t*                    aSamples        //!< interleaved (I,Q) samples
+            );
+
+        static KernelFunction getKernelFunction();
+};
+
+#endif // DacConverter_h
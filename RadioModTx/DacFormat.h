@@ -0,0 +1,151 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+/*
+DacFormat.h
+
+This file contains the definitions for DAC sample formats.
+*/
+
+#ifndef DacFormat_h
+#define DacFormat_h
+
+#include "DacConverter.h"
+#include "Dataset.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+
+typedef enum
+{
+    DAC_JUSTIFY_LSB,                    //!< DAC bits in the low bits of the sample
+    DAC_JUSTIFY_MSB                     //!< DAC bits in the high bits of the sample
+}DacJustification;
+
+typedef enum
+{
+    DAC_ENDIAN_LITTLE,                  //!< little-endian samples
+    DAC_ENDIAN_BIG                      //!< big-endian samples
+}DacEndianness;
+
+typedef enum
+{
+    DAC_INTERLEAVE_IQ,                  //!< I sample first in a pair
+    DAC_INTERLEAVE_QI                   //!< Q sample first in a pair
+}DacInterleave;
+
+
+//************************************************************************
+// Compile-time format of the 16-bit (I,Q) samples of a DAC: bit width,
+// justification, endianness and interleave.
+//
+// A format matching the host (I first, host byte order) is written by the
+// vectorized DacConverter kernel; any other format by a loop specialised
+// and inlined for that format.
+//************************************************************************
+template
+    <
+    uint8_t             BITS,           //!< DAC resolution [bits]
+    DacJustification    JUSTIFICATION,  //!< justification in the 16-bit sample
+    DacEndianness       ENDIANNESS,     //!< byte order of the samples
+    DacInterleave       INTERLEAVE      //!< order of the samples in a pair
+    >
+class DacFormat
+{
+    static_assert( BITS > 1 && BITS <= 16, "DAC resolution must be 2 to 16 bits" );
+
+    //************************************************************************
+    // constants and types
+    //************************************************************************
+    public:
+        static constexpr int16_t FULL_SCALE = static_cast<int16_t>( ( 1 << ( BITS - 1 ) ) - 1 );   //!< largest DAC value
+        static constexpr int SHIFT = ( DAC_JUSTIFY_MSB == JUSTIFICATION ) ? 16 - BITS : 0;          //!< left shift of the DAC value
+        static constexpr bool Q_FIRST = ( DAC_INTERLEAVE_QI == INTERLEAVE );                         //!< true if Q leads each pair
+        static constexpr uint32_t FORMAT_ID = BITS | ( JUSTIFICATION << 8 ) | ( ENDIANNESS << 9 ) | ( INTERLEAVE << 10 );  //!< identifies the format in cache keys
+
+    private:
+        static constexpr DacEndianness HOST_ENDIANNESS = ( __ORDER_LITTLE_ENDIAN__ == __BYTE_ORDER__ ) ? DAC_ENDIAN_LITTLE : DAC_ENDIAN_BIG;
+        static constexpr bool SWAP_BYTES = ( HOST_ENDIANNESS != ENDIANNESS );                        //!< true if samples are byte-swapped
+        static constexpr bool IS_HOST_LAYOUT = !SWAP_BYTES && !Q_FIRST;                               //!< true if the converter kernel applies
+
+
+    //************************************************************************
+    // functions
+    //************************************************************************
+    public:
+        //!************************************************************************
+        //! Write points as DAC samples to a buffer holding one pair every aStep
+        //! bytes. aScale maps the points to [-1..1] and is scaled to full scale.
+        //!
+        //! @returns nothing
+        //!************************************************************************
+        static void write
+            (
+            const Dataset::IQPoint*     aPoints,        //!< first point
+            const size_t                aPointsNr,      //!< number of points
+            const double                aScale,         //!< scale of the points to [-1..1]
+            uint8_t*                    aBuffer,        //!< first pair of the buffer
+            const std::ptrdiff_t        aStep           //!< step between pairs of the buffer [bytes]
+            )
+        {
+            if constexpr( IS_HOST_LAYOUT )
+            {
+                DacConverter::convert( aPoints, aPointsNr, FULL_SCALE * aScale, FULL_SCALE, SHIFT, aBuffer, aStep );
+            }
+            else
+            {
+                const float SCALE = static_cast<float>( FULL_SCALE * aScale );
+
+                for( size_t i = 0; i < aPointsNr; i++ )
+                {
+                    const int16_t I_SAMPLE = toSample( aPoints[i].i * SCALE );
+                    const int16_t Q_SAMPLE = toSample( aPoints[i].q * SCALE );
+                    const int16_t PAIR[2] = { Q_FIRST ? Q_SAMPLE : I_SAMPLE, Q_FIRST ? I_SAMPLE : Q_SAMPLE };
+
+                    memcpy( aBuffer + i * aStep, PAIR, sizeof( PAIR ) );
+                }
+            }
+        }
+
+    private:
+        //!************************************************************************
+        //! Convert a scaled value to a sample, saturated like DacConverter
+        //!
+        //! @returns The sample
+        //!************************************************************************
+        static inline int16_t toSample
+            (
+            float                       aValue          //!< value scaled to full scale
+            )
+        {
+            aValue = ( aValue < FULL_SCALE ) ? aValue : FULL_SCALE;
+            aValue = ( aValue > -FULL_SCALE ) ? aValue : -FULL_SCALE;
+
+            uint16_t sample = static_cast<uint16_t>( static_cast<uint16_t>( static_cast<int16_t>( aValue ) ) << SHIFT );
+
+            if constexpr( SWAP_BYTES )
+            {
+                sample = __builtin_bswap16( sample );
+            }
+
+            return static_cast<int16_t>( sample );
+        }
+};
+
+#endif // DacFormat_h
@@ -26,6 +26,13 @@ This file contains the sources for dataset.
 
 Dataset* Dataset::sInstance = nullptr;
 
+const std::map<Dataset::DatasetSource, std::string> Dataset::SOURCE_NAME =
+{
+    { Dataset::DATASET_SOURCE_RADIOML_2016_10A,  "RadioML2016.10A" },
+    { Dataset::DATASET_SOURCE_RADIOML_2018_01,   "RadioML2018.01" },
+    { Dataset::DATASET_SOURCE_HISARMOD_2019_1,   "HisarMod2019.1" }
+};
+
 const std::map<Dataset::DatasetSource, uint16_t> Dataset::FRAME_LENGTH =
 {
     { Dataset::DATASET_SOURCE_RADIOML_2016_10A,   128 },
@@ -54,6 +61,8 @@ const std::map<Dataset::DatasetSource, uint8_t> Dataset::SNRS_NR =
     { Dataset::DATASET_SOURCE_HISARMOD_2019_1,   20 }
 };
 
+const size_t Dataset::BLOCK_CACHE_BUDGET_BYTES = 1024 * 1048576;   // 1 GB
+
 //!************************************************************************
 //! Constructor
 //!************************************************************************
@@ -79,6 +88,22 @@ Dataset* Dataset::getInstance()
 }
 
 
+//!************************************************************************
+//! Get the scale of the points of signal data to [-1..1]. An all-zero
+//! block is scaled by 0 rather than by infinity, which would turn it into
+//! NaN and then into full-scale DAC samples.
+//!
+//! @returns The scale
+//!************************************************************************
+double Dataset::getScale
+    (
+    const SignalData&       aSignalData     //!< signal data
+    )
+{
+    return ( aSignalData.maxVal > 0 ) ? 1.0 / aSignalData.maxVal : 0;
+}
+
+
 //!************************************************************************
 //! Get the address of the dataset source
 //!
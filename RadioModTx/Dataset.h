@@ -24,13 +24,21 @@ This file contains the definitions for dataset.
 #ifndef Dataset_h
 #define Dataset_h
 
+#include "FrameStore.h"
 #include "Modulation.h"
 
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <list>
 #include <map>
+#include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
+class DatasetIndex;
+
 
 //************************************************************************
 // Class for handling the dataset
@@ -48,6 +56,9 @@ class Dataset
             DATASET_SOURCE_HISARMOD_2019_1
         }DatasetSource;
 
+        // dataset name
+        static const std::map<DatasetSource, std::string> SOURCE_NAME;
+
         // number of (I,Q) pairs per frame
         static const std::map<DatasetSource, uint16_t> FRAME_LENGTH;
 
@@ -60,22 +71,49 @@ class Dataset
         // number of different SNRs
         static const std::map<DatasetSource, uint8_t> SNRS_NR;
 
+        // default memory budget of the blocks loaded on demand
+        static const size_t BLOCK_CACHE_BUDGET_BYTES;
+
+        typedef FrameStore::IQPoint                             IQPoint;
+        typedef FrameStore::FrameView                           FrameView;
+
+        // where signal data was read from, set when it enters a dataset index
         typedef struct
         {
-            float i;
-            float q;
-        }IQPoint;
-
-        typedef std::vector<IQPoint>                            FrameData;
+            uint64_t                sourceFingerprint;  //!< fingerprint of the source file, 0 if unknown
+            int32_t                 modulation;         //!< modulation name
+            int32_t                 snrDb;              //!< SNR [dB]
+        }SignalOrigin;
 
         typedef struct
         {
-            std::vector<FrameData>  frameDataVec;
-            float                   maxVal;
+            FrameStore              frameStore;     //!< contiguous store with all frames
+            float                   maxVal;         //!< maximum absolute value of I and Q
+            SignalOrigin            origin;         //!< source file and modulation-SNR combination
         }SignalData;
 
         typedef std::pair<Modulation::ModulationName, int>      ModulationSnrPair;
-        typedef std::map<ModulationSnrPair, SignalData>         ModulationSnrSignalDataMap;
+        typedef std::vector<std::pair<ModulationSnrPair, SignalData>> ModulationSnrSignalDataVec;
+        typedef DatasetIndex                                    ModulationSnrSignalDataMap;
+
+        // where a modulation-SNR block lives in the source file
+        typedef struct
+        {
+            uint64_t                offset;         //!< first byte (CSV, PKL) or first row (HDF5) of the block
+            uint64_t                length;         //!< number of bytes (CSV, PKL) or rows (HDF5) of the block
+        }BlockLocation;
+
+        typedef std::vector<std::pair<ModulationSnrPair, BlockLocation>> ModulationSnrLocationVec;
+
+        // loads the samples of a block from the source file
+        typedef std::function<bool( const BlockLocation&, SignalData& )> BlockLoader;
+
+        // decodes the bytes of one frame read from the source file, updating the maximum absolute value
+        typedef std::function<bool( const char*, size_t, IQPoint*, float& )> FrameDecoder;
+
+        // immutable, reference-counted views shared by the UI and the transmitter
+        typedef std::shared_ptr<const ModulationSnrSignalDataMap> Snapshot;
+        typedef std::shared_ptr<const SignalData>               SignalDataPtr;
 
 
     //************************************************************************
@@ -86,6 +124,11 @@ class Dataset
 
         static Dataset* getInstance();
 
+        static double getScale
+            (
+            const SignalData&       aSignalData     //!< signal data
+            );
+
         DatasetSource& getSource();
 
 
@@ -105,8 +148,6 @@ class Dataset
 
         uint32_t            mNrOfFrames;                //!< total number of frames
         uint16_t            mFrameLength;               //!< frame length
-
-        ModulationSnrSignalDataMap  mModulationSnrSignalDataMap;  //!< map with data signals for modulation-SNR combinations
 };
 
 #endif // Dataset_h
@@ -0,0 +1,414 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+/*
+DatasetCache.cpp
+
+This file contains the sources for dataset cache.
+*/
+
+#include "DatasetCache.h"
+#include "DatasetIndex.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+const std::string DatasetCache::FILE_EXTENSION = ".amrc";
+
+static const char CACHE_MAGIC[8] = { 'A', 'M', 'R', 'C', 'A', 'C', 'H', 'E' };
+
+
+//!************************************************************************
+//! Round an offset up to a multiple of an alignment
+//!
+//! @returns The aligned offset
+//!************************************************************************
+static uint64_t alignOffset
+    (
+    const uint64_t  aOffset,        //!< offset [bytes]
+    const uint64_t  aAlignment      //!< alignment [bytes]
+    )
+{
+    return ( aOffset + aAlignment - 1 ) / aAlignment * aAlignment;
+}
+
+
+//!************************************************************************
+//! Constructor
+//!************************************************************************
+DatasetCache::DatasetCache
+    (
+    const std::string&              aSourceFileName,    //!< dataset source file
+    const Dataset::DatasetSource    aSource             //!< dataset source
+    )
+    : mSourceFileName( aSourceFileName )
+    , mSource( aSource )
+{
+}
+
+
+//!************************************************************************
+//! Get the name of the cache file
+//!
+//! @returns The source file name followed by the cache extension, in the
+//! directory of the source file or in the one set by setDirectory()
+//!************************************************************************
+std::string DatasetCache::getFileName() const
+{
+    std::string fileName = mSourceFileName + FILE_EXTENSION;
+
+    if( mDirectory.size() )
+    {
+        fileName = mDirectory + "/" + fileName.substr( fileName.find_last_of( '/' ) + 1 );
+    }
+
+    return fileName;
+}
+
+
+//!************************************************************************
+//! Get the size and modification time of the source file, used to detect
+//! a stale cache
+//!
+//! @returns true if the source file can be queried
+//!************************************************************************
+bool DatasetCache::getSourceInfo
+    (
+    uint64_t&                       aSize,              //!< size of the source file [bytes]
+    int64_t&                        aMtime              //!< modification time of the source file [ns]
+    ) const
+{
+    struct stat sourceStat;
+    bool status = ( 0 == stat( mSourceFileName.c_str(), &sourceStat ) );
+
+    if( status )
+    {
+        aSize = sourceStat.st_size;
+        aMtime = static_cast<int64_t>( sourceStat.st_mtim.tv_sec ) * 1000000000 + sourceStat.st_mtim.tv_nsec;
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Load the cache by memory-mapping it.
+//! The frame stores of the returned blocks point into the mapped pages,
+//! which are unmapped when the last of them is released.
+//!
+//! @returns true if a valid, up-to-date cache could be loaded
+//!************************************************************************
+bool DatasetCache::load
+    (
+    std::vector<Modulation::ModulationName>&    aModVec,    //!< unique modulations
+    std::vector<int>&                           aSnrVec,    //!< unique SNRs
+    Dataset::ModulationSnrSignalDataVec&        aBlockVec   //!< modulation-SNR blocks
+    ) const
+{
+    const std::string CACHE_FILE_NAME = getFileName();
+
+    uint64_t sourceSize = 0;
+    int64_t sourceMtime = 0;
+    bool status = getSourceInfo( sourceSize, sourceMtime );
+
+    int fd = -1;
+    struct stat cacheStat;
+    void* mapAddr = MAP_FAILED;
+
+    if( status )
+    {
+        fd = open( CACHE_FILE_NAME.c_str(), O_RDONLY );
+        status = ( fd >= 0 );
+    }
+
+    if( status )
+    {
+        status = ( 0 == fstat( fd, &cacheStat ) )
+              && ( cacheStat.st_size >= static_cast<off_t>( sizeof( Header ) ) );
+    }
+
+    if( status )
+    {
+        // private writable mapping, so that the non-const frame store accessors stay safe
+        mapAddr = mmap( nullptr, cacheStat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+        status = ( MAP_FAILED != mapAddr );
+    }
+
+    if( fd >= 0 )
+    {
+        close( fd );
+    }
+
+    aModVec.clear();
+    aSnrVec.clear();
+    aBlockVec.clear();
+
+    if( status )
+    {
+        const uint64_t MAP_SIZE = cacheStat.st_size;
+        std::shared_ptr<uint8_t> mapping( static_cast<uint8_t*>( mapAddr ),
+                                          [MAP_SIZE]( uint8_t* aAddr ){ munmap( aAddr, MAP_SIZE ); } );
+
+        Header header;
+        memcpy( &header, mapping.get(), sizeof( Header ) );
+
+        status = ( 0 == memcmp( header.magic, CACHE_MAGIC, sizeof( CACHE_MAGIC ) ) )
+              && ( VERSION == header.version )
+              && ( BYTE_ORDER_MARK == header.byteOrder )
+              && ( static_cast<uint32_t>( mSource ) == header.source )
+              && ( sourceSize == header.sourceSize )
+              && ( sourceMtime == header.sourceMtime )
+              && ( MAP_SIZE == header.fileSize );
+
+        const uint64_t MOD_TABLE_OFFSET = sizeof( Header );
+        const uint64_t SNR_TABLE_OFFSET = MOD_TABLE_OFFSET + header.modulationsNr * sizeof( int32_t );
+        const uint64_t BLOCK_TABLE_OFFSET = alignOffset( SNR_TABLE_OFFSET + header.snrsNr * sizeof( int32_t ), sizeof( uint64_t ) );
+        const uint64_t TABLES_END = BLOCK_TABLE_OFFSET + static_cast<uint64_t>( header.blocksNr ) * sizeof( BlockEntry );
+
+        status = status && ( TABLES_END <= MAP_SIZE );
+
+        for( uint32_t i = 0; status && i < header.modulationsNr; i++ )
+        {
+            int32_t modulation = 0;
+            memcpy( &modulation, mapping.get() + MOD_TABLE_OFFSET + i * sizeof( int32_t ), sizeof( int32_t ) );
+            status = ( modulation >= 0 && modulation <= Modulation::NAME_256QAM );
+            aModVec.push_back( static_cast<Modulation::ModulationName>( modulation ) );
+        }
+
+        for( uint32_t i = 0; status && i < header.snrsNr; i++ )
+        {
+            int32_t snrDb = 0;
+            memcpy( &snrDb, mapping.get() + SNR_TABLE_OFFSET + i * sizeof( int32_t ), sizeof( int32_t ) );
+            aSnrVec.push_back( snrDb );
+        }
+
+        for( uint32_t i = 0; status && i < header.blocksNr; i++ )
+        {
+            BlockEntry entry;
+            memcpy( &entry, mapping.get() + BLOCK_TABLE_OFFSET + i * sizeof( BlockEntry ), sizeof( BlockEntry ) );
+
+            status = ( entry.frameLength <= UINT16_MAX )
+                  && ( entry.dataBytes == entry.framesNr * entry.frameLength * sizeof( Dataset::IQPoint ) )
+                  && ( 0 == entry.dataOffset % FrameStore::ALIGNMENT )
+                  && ( entry.dataOffset >= TABLES_END )
+                  && ( entry.dataOffset + entry.dataBytes <= MAP_SIZE );
+
+            if( status )
+            {
+                Dataset::SignalData signalData;
+                signalData.maxVal = entry.maxVal;
+
+                std::shared_ptr<Dataset::IQPoint> arena( mapping, reinterpret_cast<Dataset::IQPoint*>( mapping.get() + entry.dataOffset ) );
+                signalData.frameStore.adopt( arena, entry.framesNr, entry.frameLength );
+
+                Dataset::ModulationSnrPair modSnrPair = std::make_pair( static_cast<Modulation::ModulationName>( entry.modulation ), entry.snrDb );
+                aBlockVec.emplace_back( modSnrPair, std::move( signalData ) );
+            }
+        }
+
+        if( status )
+        {
+            std::cout << "Loaded dataset cache " << CACHE_FILE_NAME << std::endl;
+        }
+        else
+        {
+            std::cout << "Dataset cache " << CACHE_FILE_NAME << " is stale or invalid, parsing the source file." << std::endl;
+            aModVec.clear();
+            aSnrVec.clear();
+            aBlockVec.clear();
+        }
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Save the dataset index to the cache file.
+//! The file is written under a temporary name and renamed when complete,
+//! so that a reader never maps a partially written cache.
+//!
+//! @returns true if the cache could be written
+//!************************************************************************
+bool DatasetCache::save
+    (
+    const DatasetIndex&             aIndex              //!< dataset index
+    ) const
+{
+    const std::string CACHE_FILE_NAME = getFileName();
+    const std::string TMP_FILE_NAME = CACHE_FILE_NAME + ".tmp";
+
+    const std::vector<Modulation::ModulationName>& modVec = aIndex.getModulationVec();
+    const std::vector<int>& snrVec = aIndex.getSnrVec();
+
+    Header header;
+    memset( &header, 0, sizeof( Header ) );
+    memcpy( header.magic, CACHE_MAGIC, sizeof( CACHE_MAGIC ) );
+    header.version = VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.source = static_cast<uint32_t>( mSource );
+    header.modulationsNr = modVec.size();
+    header.snrsNr = snrVec.size();
+
+    bool status = getSourceInfo( header.sourceSize, header.sourceMtime );
+
+    //**************
+    // block table
+    //**************
+    std::vector<BlockEntry> blockVec;
+    std::vector<const Dataset::SignalData*> signalDataVec;
+
+    const uint64_t SNR_TABLE_OFFSET = sizeof( Header ) + header.modulationsNr * sizeof( int32_t );
+    const uint64_t BLOCK_TABLE_OFFSET = alignOffset( SNR_TABLE_OFFSET + header.snrsNr * sizeof( int32_t ), sizeof( uint64_t ) );
+
+    for( size_t modIndex = 0; modIndex < aIndex.getModulationsNr(); modIndex++ )
+    {
+        for( size_t snrIndex = 0; snrIndex < aIndex.getSnrsNr(); snrIndex++ )
+        {
+            const Dataset::SignalData* signalData = aIndex.getSignalData( modIndex, snrIndex );
+
+            if( signalData )
+            {
+                const FrameStore& frameStore = signalData->frameStore;
+                const size_t POINTS_NR = frameStore.getPointsNr();
+                const Dataset::IQPoint* points = frameStore.data();
+                double sumI = 0;
+                double sumQ = 0;
+                double sumPower = 0;
+
+                for( size_t i = 0; i < POINTS_NR; i++ )
+                {
+                    sumI += points[i].i;
+                    sumQ += points[i].q;
+                    sumPower += points[i].i * points[i].i + points[i].q * points[i].q;
+                }
+
+                BlockEntry entry;
+                memset( &entry, 0, sizeof( BlockEntry ) );
+                entry.modulation = modVec.at( modIndex );
+                entry.snrDb = snrVec.at( snrIndex );
+                entry.framesNr = frameStore.getFramesNr();
+                entry.frameLength = frameStore.getFrameLength();
+                entry.maxVal = signalData->maxVal;
+                entry.rms = POINTS_NR ? sqrt( sumPower / POINTS_NR ) : 0;
+                entry.meanI = POINTS_NR ? sumI / POINTS_NR : 0;
+                entry.meanQ = POINTS_NR ? sumQ / POINTS_NR : 0;
+                entry.dataBytes = frameStore.getSizeBytes();
+
+                blockVec.push_back( entry );
+                signalDataVec.push_back( signalData );
+            }
+        }
+    }
+
+    header.blocksNr = blockVec.size();
+
+    uint64_t offset = BLOCK_TABLE_OFFSET + blockVec.size() * sizeof( BlockEntry );
+
+    for( size_t i = 0; i < blockVec.size(); i++ )
+    {
+        offset = alignOffset( offset, FrameStore::ALIGNMENT );
+        blockVec.at( i ).dataOffset = offset;
+        offset += blockVec.at( i ).dataBytes;
+    }
+
+    header.fileSize = offset;
+
+    //**************
+    // file
+    //**************
+    std::ofstream cacheFile;
+
+    if( status )
+    {
+        cacheFile.open( TMP_FILE_NAME, std::ios::binary | std::ios::trunc );
+        status = cacheFile.is_open();
+    }
+
+    if( status )
+    {
+        const char PADDING[FrameStore::ALIGNMENT] = {};
+
+        cacheFile.write( reinterpret_cast<const char*>( &header ), sizeof( Header ) );
+
+        for( size_t i = 0; i < modVec.size(); i++ )
+        {
+            int32_t modulation = modVec.at( i );
+            cacheFile.write( reinterpret_cast<const char*>( &modulation ), sizeof( int32_t ) );
+        }
+
+        for( size_t i = 0; i < snrVec.size(); i++ )
+        {
+            int32_t snrDb = snrVec.at( i );
+            cacheFile.write( reinterpret_cast<const char*>( &snrDb ), sizeof( int32_t ) );
+        }
+
+        cacheFile.write( PADDING, BLOCK_TABLE_OFFSET - SNR_TABLE_OFFSET - header.snrsNr * sizeof( int32_t ) );
+        cacheFile.write( reinterpret_cast<const char*>( blockVec.data() ), blockVec.size() * sizeof( BlockEntry ) );
+
+        uint64_t written = BLOCK_TABLE_OFFSET + blockVec.size() * sizeof( BlockEntry );
+
+        for( size_t i = 0; i < blockVec.size() && cacheFile.good(); i++ )
+        {
+            cacheFile.write( PADDING, blockVec.at( i ).dataOffset - written );
+            cacheFile.write( reinterpret_cast<const char*>( signalDataVec.at( i )->frameStore.data() ), blockVec.at( i ).dataBytes );
+            written = blockVec.at( i ).dataOffset + blockVec.at( i ).dataBytes;
+        }
+
+        cacheFile.close();
+        status = !cacheFile.fail();
+    }
+
+    if( status )
+    {
+        status = ( 0 == std::rename( TMP_FILE_NAME.c_str(), CACHE_FILE_NAME.c_str() ) );
+    }
+
+    if( !status )
+    {
+        std::remove( TMP_FILE_NAME.c_str() );
+        std::cout << "Could not write dataset cache " << CACHE_FILE_NAME << std::endl;
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Set the directory of the cache file, instead of the one of the source
+//! file, for instance to keep the source directory untouched
+//!
+//! @returns nothing
+//!************************************************************************
+void DatasetCache::setDirectory
+    (
+    const std::string&              aDirectory          //!< directory of the cache file, empty for the one of the source file
+    )
+{
+    mDirectory = aDirectory;
+}
@@ -0,0 +1,140 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+/*
+DatasetCache.h
+
+This file contains the definitions for dataset cache.
+*/
+
+#ifndef DatasetCache_h
+#define DatasetCache_h
+
+#include "Dataset.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class DatasetIndex;
+
+
+//************************************************************************
+// Class for handling the native binary dataset cache (*.amrc).
+// The cache is written next to the source file after a successful parse
+// and memory-mapped on later opens, the frame stores pointing directly
+// into the mapped pages.
+//
+// Layout (native byte order):
+//  - Header
+//  - modulation table (int32 x modulationsNr)
+//  - SNR table (int32 x snrsNr)
+//  - block table (BlockEntry x blocksNr)
+//  - one 64-byte aligned float32 (I,Q) arena per block
+//************************************************************************
+class DatasetCache
+{
+    //************************************************************************
+    // constants and types
+    //************************************************************************
+    public:
+        static const std::string FILE_EXTENSION;    //!< cache file extension
+
+        static const uint32_t VERSION = 1;          //!< cache format version
+
+    private:
+        static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+        typedef struct
+        {
+            char        magic[8];           //!< "AMRCACHE"
+            uint32_t    version;            //!< format version
+            uint32_t    byteOrder;          //!< byte order mark
+            uint32_t    source;             //!< dataset source
+            uint32_t    modulationsNr;      //!< number of modulations
+            uint32_t    snrsNr;             //!< number of SNRs
+            uint32_t    blocksNr;           //!< number of modulation-SNR blocks
+            uint64_t    sourceSize;         //!< size of the source file [bytes]
+            int64_t     sourceMtime;        //!< modification time of the source file [ns]
+            uint64_t    fileSize;           //!< size of the cache file [bytes]
+            uint64_t    reserved;           //!< reserved
+        }Header;
+
+        typedef struct
+        {
+            int32_t     modulation;         //!< modulation name
+            int32_t     snrDb;              //!< SNR [dB]
+            uint64_t    framesNr;           //!< number of frames
+            uint32_t    frameLength;        //!< frame length in (I,Q) pairs
+            float       maxVal;             //!< maximum absolute value
+            float       rms;                //!< RMS of the complex samples
+            float       meanI;              //!< mean of the I values
+            float       meanQ;              //!< mean of the Q values
+            uint32_t    reserved;           //!< reserved
+            uint64_t    dataOffset;         //!< offset of the arena in the file [bytes]
+            uint64_t    dataBytes;          //!< size of the arena [bytes]
+        }BlockEntry;
+
+
+    //************************************************************************
+    // functions
+    //************************************************************************
+    public:
+        DatasetCache
+            (
+            const std::string&              aSourceFileName,    //!< dataset source file
+            const Dataset::DatasetSource    aSource             //!< dataset source
+            );
+
+        std::string getFileName() const;
+
+        bool load
+            (
+            std::vector<Modulation::ModulationName>&    aModVec,    //!< unique modulations
+            std::vector<int>&                           aSnrVec,    //!< unique SNRs
+            Dataset::ModulationSnrSignalDataVec&        aBlockVec   //!< modulation-SNR blocks
+            ) const;
+
+        bool save
+            (
+            const DatasetIndex&             aIndex              //!< dataset index
+            ) const;
+
+        void setDirectory
+            (
+            const std::string&              aDirectory          //!< directory of the cache file, empty for the one of the source file
+            );
+
+    private:
+        bool getSourceInfo
+            (
+            uint64_t&                       aSize,              //!< size of the source file [bytes]
+            int64_t&                        aMtime              //!< modification time of the source file [ns]
+            ) const;
+
+
+    //************************************************************************
+    // variables
+    //************************************************************************
+    private:
+        std::string                 mSourceFileName;    //!< dataset source file
+        Dataset::DatasetSource      mSource;            //!< dataset source
+        std::string                 mDirectory;         //!< directory of the cache file, empty for the one of the source file
+};
+
+#endif // DatasetCache_h
@@ -0,0 +1,725 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+
+/*
+DatasetGenerator.cpp
+
+This file contains the sources for synthetic dataset generator.
+*/
+
+#include "DatasetGenerator.h"
+#include "CsvParser.h"
+#include "Hdf5Parser.h"
+#include "PklParser.h"
+
+#include "hdf5.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+
+//!************************************************************************
+//! Constructor
+//!************************************************************************
+DatasetGenerator::DatasetGenerator()
+    : mFramesNr( 0 )
+    , mFrameLength( 0 )
+    , mBytesWritten( 0 )
+{
+}
+
+
+//!************************************************************************
+//! Append an integer to a buffer, little-endian
+//!
+//! @returns nothing
+//!************************************************************************
+void DatasetGenerator::appendLe
+    (
+    std::string&            aBuffer,        //!< buffer
+    const int64_t           aValue,         //!< value
+    const size_t            aBytesNr        //!< number of bytes
+    )
+{
+    for( size_t i = 0; i < aBytesNr; i++ )
+    {
+        aBuffer.push_back( static_cast<char>( static_cast<uint64_t>( aValue ) >> ( 8 * i ) ) );
+    }
+}
+
+
+//!************************************************************************
+//! Generate a frame: PSK symbols of unit power, 2, 4 or 8 of them
+//! depending on the modulation, each held for SAMPLES_PER_SYMBOL samples,
+//! plus gaussian noise at the SNR
+//!
+//! @returns nothing
+//!************************************************************************
+void DatasetGenerator::generateFrame
+    (
+    const Modulation::ModulationName aModulation,   //!< modulation of the frame
+    const int               aSnrDb,         //!< SNR of the frame [dB]
+    Dataset::IQPoint*       aFrame          //!< frame to fill
+    )
+{
+    const int SYMBOLS_NR = 2 << ( static_cast<int>( aModulation ) % 3 );
+    const float NOISE_SIGMA = std::sqrt( 0.5 * std::pow( 10.0, -aSnrDb / 10.0 ) );
+
+    std::uniform_int_distribution<int> symbolDistribution( 0, SYMBOLS_NR - 1 );
+    std::normal_distribution<float> noiseDistribution( 0, NOISE_SIGMA );
+
+    Dataset::IQPoint symbol = { 0, 0 };
+
+    for( size_t i = 0; i < mFrameLength; i++ )
+    {
+        if( 0 == i % SAMPLES_PER_SYMBOL )
+        {
+            const double PHASE = 2 * M_PI * symbolDistribution( mGenerator ) / SYMBOLS_NR;
+            symbol = { static_cast<float>( std::cos( PHASE ) ), static_cast<float>( std::sin( PHASE ) ) };
+        }
+
+        aFrame[i].i = symbol.i + noiseDistribution( mGenerator );
+        aFrame[i].q = symbol.q + noiseDistribution( mGenerator );
+    }
+}
+
+
+//!************************************************************************
+//! Get an option as a floating point number
+//!
+//! @returns true if the option is not set or is a number
+//!************************************************************************
+bool DatasetGenerator::getDouble
+    (
+    const std::string&      aKey,           //!< option key
+    const double            aDefault,       //!< value if the option is not set
+    double&                 aValue          //!< option value
+    ) const
+{
+    bool status = true;
+    auto it = mOptionMap.find( aKey );
+    aValue = aDefault;
+
+    if( mOptionMap.end() != it )
+    {
+        char* end = nullptr;
+        aValue = std::strtod( it->second.c_str(), &end );
+        status = it->second.size() && '\0' == *end;
+
+        if( !status )
+        {
+            std::cout << "Invalid number for " << aKey << ": " << it->second << std::endl;
+        }
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Get an option as an integer
+//!
+//! @returns true if the option is not set or is an integer
+//!************************************************************************
+bool DatasetGenerator::getInteger
+    (
+    const std::string&      aKey,           //!< option key
+    const int64_t           aDefault,       //!< value if the option is not set
+    int64_t&                aValue          //!< option value
+    ) const
+{
+    bool status = true;
+    auto it = mOptionMap.find( aKey );
+    aValue = aDefault;
+
+    if( mOptionMap.end() != it )
+    {
+        char* end = nullptr;
+        aValue = std::strtoll( it->second.c_str(), &end, 10 );
+        status = it->second.size() && '\0' == *end;
+
+        if( !status )
+        {
+            std::cout << "Invalid integer for " << aKey << ": " << it->second << std::endl;
+        }
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Get an option as a string
+//!
+//! @returns The option value
+//!************************************************************************
+std::string DatasetGenerator::getString
+    (
+    const std::string&      aKey,           //!< option key
+    const std::string&      aDefault        //!< value if the option is not set
+    ) const
+{
+    auto it = mOptionMap.find( aKey );
+    return ( mOptionMap.end() != it ) ? it->second : aDefault;
+}
+
+
+//!************************************************************************
+//! Write the dataset selected by the options. A file left incomplete by
+//! an error is removed.
+//!
+//! @returns true if the dataset could be written
+//!************************************************************************
+bool DatasetGenerator::run()
+{
+    const std::string FORMAT = getString( "format", "" );
+    const std::string FILE_NAME = getString( "output", "" );
+    const std::string LAYOUT = getString( "hdf5_layout", "contiguous" );
+
+    Dataset::DatasetSource source = Dataset::DATASET_SOURCE_RADIOML_2016_10A;
+    bool status = true;
+
+    if( "pkl" == FORMAT )
+    {
+        source = Dataset::DATASET_SOURCE_RADIOML_2016_10A;
+    }
+    else if( "hdf5" == FORMAT )
+    {
+        source = Dataset::DATASET_SOURCE_RADIOML_2018_01;
+    }
+    else if( "csv" == FORMAT )
+    {
+        source = Dataset::DATASET_SOURCE_HISARMOD_2019_1;
+    }
+    else
+    {
+        std::cout << "Unknown format \"" << FORMAT << "\", set format to pkl, hdf5 or csv" << std::endl;
+        status = false;
+    }
+
+    if( status && FILE_NAME.empty() )
+    {
+        std::cout << "No output file, set output" << std::endl;
+        status = false;
+    }
+
+    double scale = 0;
+    int64_t framesNr = 0;
+    int64_t frameLength = 0;
+    int64_t snrMinDb = 0;
+    int64_t snrStepDb = 0;
+    int64_t snrsNr = 0;
+    int64_t chunkRows = 0;
+    int64_t deflateLevel = 0;
+    int64_t seed = 0;
+
+    status = status
+          && getDouble( "scale", 1, scale )
+          && getInteger( "frames", std::llround( scale * Dataset::FRAMES_PER_MOD_SNR_NR.at( source ) ), framesNr )
+          && getInteger( "frame_length", Dataset::FRAME_LENGTH.at( source ), frameLength )
+          && getInteger( "snr_min", DEFAULT_SNR_MIN_DB, snrMinDb )
+          && getInteger( "snr_step", DEFAULT_SNR_STEP_DB, snrStepDb )
+          && getInteger( "snrs_nr", Dataset::SNRS_NR.at( source ), snrsNr )
+          && getInteger( "chunk_rows", DEFAULT_CHUNK_ROWS, chunkRows )
+          && getInteger( "deflate", 0, deflateLevel )
+          && getInteger( "seed", DEFAULT_SEED, seed );
+
+    if( status )
+    {
+        status = ( framesNr > 0 && framesNr <= INT32_MAX )
+              && ( frameLength > 0 && frameLength <= UINT16_MAX )
+              && ( snrsNr > 0 )
+              && ( chunkRows > 0 )
+              && ( deflateLevel >= 0 && deflateLevel <= 9 )
+              && ( "contiguous" == LAYOUT || "chunked" == LAYOUT );
+
+        if( !status )
+        {
+            std::cout << "Invalid options: frames, frame_length, snrs_nr and chunk_rows must be positive,"
+                      << " deflate in 0..9, hdf5_layout contiguous or chunked" << std::endl;
+        }
+    }
+
+    // the CSV lines carry no SNR, the parser derives it from the line number
+    if( status && Dataset::DATASET_SOURCE_HISARMOD_2019_1 == source )
+    {
+        status = ( CsvParser::SNR_MIN_DB == snrMinDb )
+              && ( CsvParser::SNR_STEP_DB == snrStepDb )
+              && ( Dataset::SNRS_NR.at( source ) == snrsNr );
+
+        if( !status )
+        {
+            std::cout << "Invalid options: the csv format has no SNR labels, snr_min must be " << CsvParser::SNR_MIN_DB
+                      << ", snr_step " << CsvParser::SNR_STEP_DB << " and snrs_nr " << static_cast<int>( Dataset::SNRS_NR.at( source ) ) << std::endl;
+        }
+    }
+
+    if( status )
+    {
+        mFramesNr = framesNr;
+        mFrameLength = frameLength;
+        mSnrVec.clear();
+
+        for( int64_t i = 0; i < snrsNr; i++ )
+        {
+            mSnrVec.push_back( snrMinDb + i * snrStepDb );
+        }
+
+        mGenerator.seed( seed );
+        mBytesWritten = 0;
+
+        const std::chrono::steady_clock::time_point START = std::chrono::steady_clock::now();
+
+        switch( source )
+        {
+            case Dataset::DATASET_SOURCE_RADIOML_2016_10A:
+                status = writePkl( FILE_NAME );
+                break;
+
+            case Dataset::DATASET_SOURCE_RADIOML_2018_01:
+                // deflated chunks imply the chunked layout
+                status = writeHdf5( FILE_NAME, ( "chunked" == LAYOUT || deflateLevel ) ? chunkRows : 0, deflateLevel );
+                break;
+
+            case Dataset::DATASET_SOURCE_HISARMOD_2019_1:
+                // the lines carry no labels, the frames per block go to a file next to them
+                status = writeCsv( FILE_NAME ) && CsvParser::writeFramesFile( FILE_NAME, mFramesNr );
+                break;
+        }
+
+        const double SECONDS = std::chrono::duration<double>( std::chrono::steady_clock::now() - START ).count();
+
+        if( status )
+        {
+            std::cout << "Wrote " << FILE_NAME << ": " << Dataset::SOURCE_NAME.at( source ) << " layout, "
+                      << static_cast<size_t>( Dataset::MODULATIONS_NR.at( source ) ) << " modulations x "
+                      << mSnrVec.size() << " SNRs x " << mFramesNr << " frames of " << mFrameLength << " points, "
+                      << mBytesWritten / 1048576.0 << " MB in " << SECONDS << " s ("
+                      << mBytesWritten / 1048576.0 / std::max( SECONDS, 1e-9 ) << " MB/s)" << std::endl;
+        }
+        else
+        {
+            std::cout << "Cannot write " << FILE_NAME << std::endl;
+            std::remove( FILE_NAME.c_str() );
+            std::remove( ( FILE_NAME + CsvParser::FRAMES_FILE_EXTENSION ).c_str() );
+        }
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Set an option from a "key=value" string
+//!
+//! @returns true if the string has a key and a value
+//!************************************************************************
+bool DatasetGenerator::setOption
+    (
+    const std::string&      aOption         //!< "key=value"
+    )
+{
+    const size_t SEPARATOR = aOption.find( '=' );
+    bool status = std::string::npos != SEPARATOR && SEPARATOR > 0 && SEPARATOR + 1 < aOption.size();
+
+    if( status )
+    {
+        mOptionMap[aOption.substr( 0, SEPARATOR )] = aOption.substr( SEPARATOR + 1 );
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Write a HisarMod 2019.1 style CSV file: one frame per line, each point
+//! as "I+Qi" or "I-Qi", the blocks of each SNR following MODULATION_SERIES
+//!
+//! @returns true if the file could be written
+//!************************************************************************
+bool DatasetGenerator::writeCsv
+    (
+    const std::string&      aFileName       //!< output filename
+    )
+{
+    std::ofstream outputFile( aFileName, std::ios::binary );
+    std::vector<Dataset::IQPoint> frameVec( mFrameLength );
+    std::string buffer;
+    bool status = outputFile.is_open();
+
+    for( size_t crtSnrIndex = 0; status && crtSnrIndex < mSnrVec.size(); crtSnrIndex++ )
+    {
+        for( size_t crtSeries = 0; status && crtSeries < CsvParser::MODULATION_SERIES.size(); crtSeries++ )
+        {
+            const Modulation::ModulationName MOD_NAME = CsvParser::MODULATION_MAPPING.at( CsvParser::MODULATION_SERIES.at( crtSeries ) );
+
+            for( size_t crtFrame = 0; status && crtFrame < mFramesNr; crtFrame++ )
+            {
+                generateFrame( MOD_NAME, mSnrVec.at( crtSnrIndex ), frameVec.data() );
+
+                for( size_t i = 0; i < mFrameLength; i++ )
+                {
+                    char text[64];
+                    char* crtPtr = std::to_chars( text, text + sizeof( text ), frameVec.at( i ).i ).ptr;
+
+                    if( !std::signbit( frameVec.at( i ).q ) )
+                    {
+                        *crtPtr++ = '+';
+                    }
+
+                    crtPtr = std::to_chars( crtPtr, text + sizeof( text ) - 2, frameVec.at( i ).q ).ptr;
+                    *crtPtr++ = 'i';
+                    *crtPtr++ = ( i + 1 < mFrameLength ) ? ',' : '\n';
+
+                    buffer.append( text, crtPtr );
+                }
+
+                if( buffer.size() >= WRITE_BATCH_BYTES )
+                {
+                    outputFile.write( buffer.data(), buffer.size() );
+                    mBytesWritten += buffer.size();
+                    buffer.clear();
+
+                    status = outputFile.good();
+                }
+            }
+        }
+    }
+
+    if( status )
+    {
+        outputFile.write( buffer.data(), buffer.size() );
+        mBytesWritten += buffer.size();
+
+        outputFile.close();
+        status = outputFile.good();
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Write a RadioML 2018.01 style HDF5 file:
+//!  - X: float32 frames, rows x frame length x (I,Q)
+//!  - Y: int64 one-hot modulations, rows x modulations
+//!  - Z: int64 SNRs, rows x 1
+//! The rows are ordered by modulation, then by SNR, mFramesNr frames per
+//! block, and written in batches of whole chunks.
+//!
+//! @returns true if the file could be written
+//!************************************************************************
+bool DatasetGenerator::writeHdf5
+    (
+    const std::string&      aFileName,      //!< output filename
+    const size_t            aChunkRows,     //!< rows per chunk, 0 for a contiguous layout
+    const int               aDeflateLevel   //!< deflate level of the chunks, 0 for none
+    )
+{
+    const hsize_t MODULATIONS_NR = Hdf5Parser::MODULATION_MAPPING.size();
+    const hsize_t ROWS_NR = MODULATIONS_NR * mSnrVec.size() * mFramesNr;
+    const hsize_t ROW_BYTES = mFrameLength * sizeof( Dataset::IQPoint ) + ( MODULATIONS_NR + 1 ) * sizeof( int64_t );
+    const hsize_t CHUNK_ROWS = std::min<hsize_t>( aChunkRows, ROWS_NR );
+
+    hsize_t batchRows = std::max<hsize_t>( 1, WRITE_BATCH_BYTES / ROW_BYTES );
+
+    if( CHUNK_ROWS )
+    {
+        batchRows = std::max<hsize_t>( CHUNK_ROWS, batchRows / CHUNK_ROWS * CHUNK_ROWS );
+    }
+
+    const hsize_t X_DIMS[3] = { ROWS_NR, mFrameLength, 2 };
+    const hsize_t Y_DIMS[2] = { ROWS_NR, MODULATIONS_NR };
+    const hsize_t Z_DIMS[2] = { ROWS_NR, 1 };
+
+    hid_t fileId = H5Fcreate( aFileName.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT );
+    hid_t xSpaceId = H5Screate_simple( 3, X_DIMS, nullptr );
+    hid_t ySpaceId = H5Screate_simple( 2, Y_DIMS, nullptr );
+    hid_t zSpaceId = H5Screate_simple( 2, Z_DIMS, nullptr );
+    hid_t xPlistId = H5Pcreate( H5P_DATASET_CREATE );
+    hid_t yPlistId = H5Pcreate( H5P_DATASET_CREATE );
+    hid_t zPlistId = H5Pcreate( H5P_DATASET_CREATE );
+
+    bool status = ( fileId >= 0 )
+               && ( xSpaceId >= 0 ) && ( ySpaceId >= 0 ) && ( zSpaceId >= 0 )
+               && ( xPlistId >= 0 ) && ( yPlistId >= 0 ) && ( zPlistId >= 0 );
+
+    if( status && CHUNK_ROWS )
+    {
+        const hsize_t X_CHUNK[3] = { CHUNK_ROWS, mFrameLength, 2 };
+        const hsize_t Y_CHUNK[2] = { CHUNK_ROWS, MODULATIONS_NR };
+        const hsize_t Z_CHUNK[2] = { CHUNK_ROWS, 1 };
+
+        status = ( H5Pset_chunk( xPlistId, 3, X_CHUNK ) >= 0 )
+              && ( H5Pset_chunk( yPlistId, 2, Y_CHUNK ) >= 0 )
+              && ( H5Pset_chunk( zPlistId, 2, Z_CHUNK ) >= 0 );
+
+        if( status && aDeflateLevel )
+        {
+            status = ( H5Pset_deflate( xPlistId, aDeflateLevel ) >= 0 )
+                  && ( H5Pset_deflate( yPlistId, aDeflateLevel ) >= 0 )
+                  && ( H5Pset_deflate( zPlistId, aDeflateLevel ) >= 0 );
+        }
+    }
+
+    hid_t xId = status ? H5Dcreate2( fileId, "X", H5T_IEEE_F32LE, xSpaceId, H5P_DEFAULT, xPlistId, H5P_DEFAULT ) : -1;
+    hid_t yId = status ? H5Dcreate2( fileId, "Y", H5T_STD_I64LE, ySpaceId, H5P_DEFAULT, yPlistId, H5P_DEFAULT ) : -1;
+    hid_t zId = status ? H5Dcreate2( fileId, "Z", H5T_STD_I64LE, zSpaceId, H5P_DEFAULT, zPlistId, H5P_DEFAULT ) : -1;
+
+    status = status && ( xId >= 0 ) && ( yId >= 0 ) && ( zId >= 0 );
+
+    // writes the rows of a batch to one dataset
+    auto writeRows = []( hid_t aDatasetId, hid_t aSpaceId, hid_t aMemTypeId, int aRank, const hsize_t* aStart, const hsize_t* aCount, const void* aData )
+    {
+        hid_t memSpaceId = H5Screate_simple( aRank, aCount, nullptr );
+
+        bool written = ( memSpaceId >= 0 )
+                    && ( H5Sselect_hyperslab( aSpaceId, H5S_SELECT_SET, aStart, nullptr, aCount, nullptr ) >= 0 )
+                    && ( H5Dwrite( aDatasetId, aMemTypeId, memSpaceId, aSpaceId, H5P_DEFAULT, aData ) >= 0 );
+
+        if( memSpaceId >= 0 )
+        {
+            H5Sclose( memSpaceId );
+        }
+
+        return written;
+    };
+
+    std::vector<Dataset::IQPoint> xVec( status ? batchRows * mFrameLength : 0 );
+    std::vector<int64_t> yVec( status ? batchRows * MODULATIONS_NR : 0 );
+    std::vector<int64_t> zVec( status ? batchRows : 0 );
+
+    for( hsize_t startRow = 0; status && startRow < ROWS_NR; startRow += batchRows )
+    {
+        const hsize_t ROWS = std::min( batchRows, ROWS_NR - startRow );
+
+        std::fill( yVec.begin(), yVec.end(), 0 );
+
+        for( hsize_t i = 0; i < ROWS; i++ )
+        {
+            const size_t BLOCK_INDEX = ( startRow + i ) / mFramesNr;
+            const size_t MODULATION_INDEX = BLOCK_INDEX / mSnrVec.size();
+            const int SNR_DB = mSnrVec.at( BLOCK_INDEX % mSnrVec.size() );
+
+            generateFrame( Hdf5Parser::MODULATION_MAPPING.at( MODULATION_INDEX ), SNR_DB, xVec.data() + i * mFrameLength );
+            yVec.at( i * MODULATIONS_NR + MODULATION_INDEX ) = 1;
+            zVec.at( i ) = SNR_DB;
+        }
+
+        const hsize_t START[3] = { startRow, 0, 0 };
+        const hsize_t X_COUNT[3] = { ROWS, mFrameLength, 2 };
+        const hsize_t Y_COUNT[2] = { ROWS, MODULATIONS_NR };
+        const hsize_t Z_COUNT[2] = { ROWS, 1 };
+
+        status = writeRows( xId, xSpaceId, H5T_NATIVE_FLOAT, 3, START, X_COUNT, xVec.data() )
+              && writeRows( yId, ySpaceId, H5T_NATIVE_INT64, 2, START, Y_COUNT, yVec.data() )
+              && writeRows( zId, zSpaceId, H5T_NATIVE_INT64, 2, START, Z_COUNT, zVec.data() );
+
+        mBytesWritten += ROWS * ROW_BYTES;
+    }
+
+    for( hid_t datasetId : { xId, yId, zId } )
+    {
+        if( datasetId >= 0 )
+        {
+            H5Dclose( datasetId );
+        }
+    }
+
+    for( hid_t plistId : { xPlistId, yPlistId, zPlistId } )
+    {
+        if( plistId >= 0 )
+        {
+            H5Pclose( plistId );
+        }
+    }
+
+    for( hid_t spaceId : { xSpaceId, ySpaceId, zSpaceId } )
+    {
+        if( spaceId >= 0 )
+        {
+            H5Sclose( spaceId );
+        }
+    }
+
+    if( fileId >= 0 )
+    {
+        status = ( H5Fclose( fileId ) >= 0 ) && status;
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Write a RadioML 2016.10A style pickle, protocol 2 as written by
+//! Python 2: a dict of (modulation, SNR) -> numpy float32 array of frames
+//! x (I,Q) x frame length, each array pickled as
+//! _reconstruct( ndarray, (0,), 'b' ) followed by its state
+//! (1, shape, dtype('<f4'), False, raw data).
+//! The raw data of each array is written as it is generated.
+//!
+//! @returns true if the file could be written
+//!************************************************************************
+bool DatasetGenerator::writePkl
+    (
+    const std::string&      aFileName       //!< output filename
+    )
+{
+    const size_t FRAME_VALUES_NR = 2 * mFrameLength;
+    const uint64_t DATA_BYTES = mFramesNr * FRAME_VALUES_NR * sizeof( float );
+    const size_t BATCH_FRAMES_NR = std::max<size_t>( 1, WRITE_BATCH_BYTES / ( FRAME_VALUES_NR * sizeof( float ) ) );
+
+    Modulation* modInstance = Modulation::getInstance();
+
+    std::ofstream outputFile( aFileName, std::ios::binary );
+    std::vector<Dataset::IQPoint> frameVec( mFrameLength );
+    std::vector<float> batchVec( BATCH_FRAMES_NR * FRAME_VALUES_NR );
+    std::string buffer;
+    bool status = outputFile.is_open();
+
+    // PROTO 2, EMPTY_DICT
+    appendLe( buffer, 0x80, 1 );
+    appendLe( buffer, 2, 1 );
+    buffer.push_back( '}' );
+
+    for( size_t modOffset = 0; status && modOffset < PklParser::MODULATION_MAPPING.size(); modOffset++ )
+    {
+        const Modulation::ModulationName MOD_NAME = PklParser::MODULATION_MAPPING.at( modOffset );
+        const std::string MOD_STRING = modInstance->getModulationString( MOD_NAME );
+
+        for( size_t crtSnrIndex = 0; status && crtSnrIndex < mSnrVec.size(); crtSnrIndex++ )
+        {
+            // key: SHORT_BINSTRING modulation, BININT SNR, TUPLE2
+            buffer.push_back( 'U' );
+            appendLe( buffer, MOD_STRING.size(), 1 );
+            buffer += MOD_STRING;
+            buffer.push_back( 'J' );
+            appendLe( buffer, mSnrVec.at( crtSnrIndex ), 4 );
+            appendLe( buffer, 0x86, 1 );
+
+            // value: GLOBAL _reconstruct, (GLOBAL ndarray, (0,), 'b'), REDUCE
+            buffer += "cnumpy.core.multiarray\n_reconstruct\n";
+            buffer += "cnumpy\nndarray\n";
+            buffer.push_back( 'K' );
+            appendLe( buffer, 0, 1 );
+            appendLe( buffer, 0x85, 1 );
+            buffer += "U";
+            appendLe( buffer, 1, 1 );
+            buffer += "b";
+            appendLe( buffer, 0x87, 1 );
+            buffer.push_back( 'R' );
+
+            // state: MARK, 1, (frames, 2, frame length)
+            buffer += "(K";
+            appendLe( buffer, 1, 1 );
+            buffer.push_back( 'J' );
+            appendLe( buffer, mFramesNr, 4 );
+            buffer.push_back( 'K' );
+            appendLe( buffer, 2, 1 );
+            buffer.push_back( 'J' );
+            appendLe( buffer, mFrameLength, 4 );
+            appendLe( buffer, 0x87, 1 );
+
+            // dtype( 'f4', 0, 1 ) with state (3, '<', None, None, None, -1, -1, 0)
+            buffer += "cnumpy\ndtype\nU";
+            appendLe( buffer, 2, 1 );
+            buffer += "f4K";
+            appendLe( buffer, 0, 1 );
+            buffer.push_back( 'K' );
+            appendLe( buffer, 1, 1 );
+            appendLe( buffer, 0x87, 1 );
+            buffer += "R(K";
+            appendLe( buffer, 3, 1 );
+            buffer += "U";
+            appendLe( buffer, 1, 1 );
+            buffer += "<NNNJ";
+            appendLe( buffer, -1, 4 );
+            buffer.push_back( 'J' );
+            appendLe( buffer, -1, 4 );
+            buffer.push_back( 'K' );
+            appendLe( buffer, 0, 1 );
+            buffer += "tb";
+
+            // NEWFALSE, then the raw data as BINSTRING, or BINBYTES8 past 2 GB
+            appendLe( buffer, 0x89, 1 );
+
+            if( DATA_BYTES <= PKL_BINSTRING_MAX_BYTES )
+            {
+                buffer.push_back( 'T' );
+                appendLe( buffer, DATA_BYTES, 4 );
+            }
+            else
+            {
+                appendLe( buffer, 0x8E, 1 );
+                appendLe( buffer, DATA_BYTES, 8 );
+            }
+
+            outputFile.write( buffer.data(), buffer.size() );
+            mBytesWritten += buffer.size();
+            buffer.clear();
+
+            // each frame holds its I values, then its Q values
+            for( size_t startFrame = 0; status && startFrame < mFramesNr; startFrame += BATCH_FRAMES_NR )
+            {
+                const size_t FRAMES_NR = std::min( BATCH_FRAMES_NR, mFramesNr - startFrame );
+
+                for( size_t crtFrame = 0; crtFrame < FRAMES_NR; crtFrame++ )
+                {
+                    float* const FRAME_VALUES = batchVec.data() + crtFrame * FRAME_VALUES_NR;
+
+                    generateFrame( MOD_NAME, mSnrVec.at( crtSnrIndex ), frameVec.data() );
+
+                    for( size_t i = 0; i < mFrameLength; i++ )
+                    {
+                        FRAME_VALUES[i] = frameVec.at( i ).i;
+                        FRAME_VALUES[mFrameLength + i] = frameVec.at( i ).q;
+                    }
+                }
+
+                outputFile.write( reinterpret_cast<const char*>( batchVec.data() ), FRAMES_NR * FRAME_VALUES_NR * sizeof( float ) );
+                mBytesWritten += FRAMES_NR * FRAME_VALUES_NR * sizeof( float );
+
+                status = outputFile.good();
+            }
+
+            // TUPLE, BUILD, SETITEM
+            buffer += "tbs";
+        }
+    }
+
+    // STOP
+    buffer.push_back( '.' );
+
+    if( status )
+    {
+        outputFile.write( buffer.data(), buffer.size() );
+        mBytesWritten += buffer.size();
+
+        outputFile.close();
+        status = outputFile.good();
+    }
+
+    return status;
+}
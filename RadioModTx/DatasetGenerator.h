@@ -0,0 +1,153 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+
+/*
+DatasetGenerator.h
+
+This file contains the definitions for synthetic dataset generator.
+*/
+
+#ifndef DatasetGenerator_h
+#define DatasetGenerator_h
+
+#include "Dataset.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+
+//************************************************************************
+// Class for writing synthetic datasets in the layouts read by the
+// parsers, configured by "key=value" options (see the RadioModTxGen usage
+// for the keys):
+//  - RadioML 2016.10A: pickled dict of (modulation, SNR) -> float32
+//    array of frames x (I,Q) x frame length
+//  - RadioML 2018.01: HDF5 file with the X frames, the one-hot Y
+//    modulations and the Z SNRs, rows ordered by modulation then SNR
+//  - HisarMod 2019.1: CSV file of one "I+Qi" frame per line, blocks
+//    ordered by SNR then MODULATION_SERIES
+//
+// The frames per modulation-SNR combination default to the ones of the
+// original dataset times the "scale" option. Frames are PSK symbols plus
+// gaussian noise at the SNR of their block, written as they are
+// generated, so the memory used does not grow with the size of the file.
+//
+// The frame length and the SNR grid can be changed too, the parsers only
+// accepting the ones of the original datasets: other values give files
+// for testing the rejection of malformed inputs.
+//************************************************************************
+class DatasetGenerator
+{
+    //************************************************************************
+    // constants and types
+    //************************************************************************
+    private:
+        static const uint32_t DEFAULT_SEED = 2024;                      //!< default seed of the frames
+        static const int DEFAULT_SNR_MIN_DB = -20;                      //!< default lowest SNR [dB]
+        static const int DEFAULT_SNR_STEP_DB = 2;                       //!< default SNR step [dB]
+        static const size_t DEFAULT_CHUNK_ROWS = 32;                    //!< default rows per HDF5 chunk
+        static const size_t SAMPLES_PER_SYMBOL = 8;                     //!< samples per PSK symbol
+        static const size_t WRITE_BATCH_BYTES = 16 * 1048576;           //!< bytes generated per write [bytes]
+        static const uint64_t PKL_BINSTRING_MAX_BYTES = INT32_MAX;      //!< largest payload of a BINSTRING [bytes]
+
+
+    //************************************************************************
+    // functions
+    //************************************************************************
+    public:
+        DatasetGenerator();
+
+        bool run();
+
+        bool setOption
+            (
+            const std::string&      aOption         //!< "key=value"
+            );
+
+    private:
+        static void appendLe
+            (
+            std::string&            aBuffer,        //!< buffer
+            const int64_t           aValue,         //!< value
+            const size_t            aBytesNr        //!< number of bytes
+            );
+
+        void generateFrame
+            (
+            const Modulation::ModulationName aModulation,   //!< modulation of the frame
+            const int               aSnrDb,         //!< SNR of the frame [dB]
+            Dataset::IQPoint*       aFrame          //!< frame to fill
+            );
+
+        bool getDouble
+            (
+            const std::string&      aKey,           //!< option key
+            const double            aDefault,       //!< value if the option is not set
+            double&                 aValue          //!< option value
+            ) const;
+
+        bool getInteger
+            (
+            const std::string&      aKey,           //!< option key
+            const int64_t           aDefault,       //!< value if the option is not set
+            int64_t&                aValue          //!< option value
+            ) const;
+
+        std::string getString
+            (
+            const std::string&      aKey,           //!< option key
+            const std::string&      aDefault        //!< value if the option is not set
+            ) const;
+
+        bool writeCsv
+            (
+            const std::string&      aFileName       //!< output filename
+            );
+
+        bool writeHdf5
+            (
+            const std::string&      aFileName,      //!< output filename
+            const size_t            aChunkRows,     //!< rows per chunk, 0 for a contiguous layout
+            const int               aDeflateLevel   //!< deflate level of the chunks, 0 for none
+            );
+
+        bool writePkl
+            (
+            const std::string&      aFileName       //!< output filename
+            );
+
+
+    //************************************************************************
+    // variables
+    //************************************************************************
+    private:
+        std::map<std::string, std::string>  mOptionMap;         //!< options by key
+
+        size_t                              mFramesNr;          //!< frames per modulation-SNR combination
+        uint16_t                            mFrameLength;       //!< frame length in (I,Q) pairs
+        std::vector<int>                    mSnrVec;            //!< SNRs of the blocks [dB]
+
+        std::mt19937                        mGenerator;         //!< random generator of the frames
+        uint64_t                            mBytesWritten;      //!< bytes written to the file
+};
+
+#endif // DatasetGenerator_h
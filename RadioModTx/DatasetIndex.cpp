@@ -0,0 +1,473 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+/*
+DatasetIndex.cpp
+
+This file contains the sources for dataset index.
+*/
+
+#include "DatasetIndex.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+
+//!************************************************************************
+//! Constructor
+//!************************************************************************
+DatasetIndex::DatasetIndex()
+    : mMinSnrDb( 0 )
+    , mPresentCount( 0 )
+    , mSourceFingerprint( 0 )
+{
+}
+
+
+//!************************************************************************
+//! Get the signal data for a modulation-SNR combination
+//!
+//! @returns The signal data. Throws std::out_of_range if not present or
+//! not resident (use getBlock() for blocks loaded on demand).
+//!************************************************************************
+const Dataset::SignalData& DatasetIndex::at
+    (
+    const Dataset::ModulationSnrPair&   aPair       //!< modulation-SNR combination
+    ) const
+{
+    size_t cell = 0;
+
+    if( !getCell( aPair, cell ) || mLocationTable[cell].length )
+    {
+        throw std::out_of_range( "DatasetIndex::at" );
+    }
+
+    return mTable.at( cell );
+}
+
+
+//!************************************************************************
+//! Build an empty table for the given modulations and SNRs
+//!
+//! @returns nothing
+//!************************************************************************
+void DatasetIndex::build
+    (
+    const std::vector<Modulation::ModulationName>&  aModVec,    //!< unique modulations
+    const std::vector<int>&                         aSnrVec     //!< unique SNRs
+    )
+{
+    clear();
+
+    mModVec = aModVec;
+    mSnrVec = aSnrVec;
+
+    if( mModVec.size() )
+    {
+        Modulation::ModulationName maxMod = *std::max_element( mModVec.begin(), mModVec.end() );
+        mModLookup.assign( maxMod + 1, -1 );
+
+        for( size_t i = 0; i < mModVec.size(); i++ )
+        {
+            mModLookup.at( mModVec.at( i ) ) = static_cast<int16_t>( i );
+        }
+    }
+
+    if( mSnrVec.size() )
+    {
+        mMinSnrDb = *std::min_element( mSnrVec.begin(), mSnrVec.end() );
+        int maxSnrDb = *std::max_element( mSnrVec.begin(), mSnrVec.end() );
+        mSnrLookup.assign( maxSnrDb - mMinSnrDb + 1, -1 );
+
+        for( size_t i = 0; i < mSnrVec.size(); i++ )
+        {
+            mSnrLookup.at( mSnrVec.at( i ) - mMinSnrDb ) = static_cast<int16_t>( i );
+        }
+    }
+
+    const size_t CELLS_NR = mModVec.size() * mSnrVec.size();
+    mTable.resize( CELLS_NR );
+    mPresentBitmap.assign( ( CELLS_NR + 63 ) / 64, 0 );
+    mLocationTable.assign( CELLS_NR, { 0, 0 } );
+}
+
+
+//!************************************************************************
+//! Remove all modulations, SNRs and signal data
+//!
+//! @returns nothing
+//!************************************************************************
+void DatasetIndex::clear()
+{
+    mModVec.clear();
+    mSnrVec.clear();
+    mModLookup.clear();
+    mSnrLookup.clear();
+    mMinSnrDb = 0;
+    mTable.clear();
+    mPresentBitmap.clear();
+    mPresentCount = 0;
+    mLocationTable.clear();
+    mBlockCache.reset();
+    mSourceFingerprint = 0;
+}
+
+
+//!************************************************************************
+//! Check if a modulation-SNR combination is present
+//!
+//! @returns true if signal data is present
+//!************************************************************************
+bool DatasetIndex::contains
+    (
+    const Dataset::ModulationSnrPair&   aPair       //!< modulation-SNR combination
+    ) const
+{
+    size_t cell = 0;
+    return getCell( aPair, cell );
+}
+
+
+//!************************************************************************
+//! Check if the index holds no signal data
+//!
+//! @returns true if empty
+//!************************************************************************
+bool DatasetIndex::empty() const
+{
+    return ( 0 == mPresentCount );
+}
+
+
+//!************************************************************************
+//! Get the signal data for a modulation-SNR combination, as a reference
+//! that keeps it alive. Resident blocks are shared with the snapshot
+//! owning this index, the others are loaded on demand through the block
+//! cache. Must be called on an index owned by a snapshot.
+//!
+//! @returns The signal data, nullptr if not present or not loadable
+//!************************************************************************
+Dataset::SignalDataPtr DatasetIndex::getBlock
+    (
+    const Dataset::ModulationSnrPair&   aPair       //!< modulation-SNR combination
+    ) const
+{
+    Dataset::SignalDataPtr signalData;
+    size_t cell = 0;
+
+    if( getCell( aPair, cell ) )
+    {
+        if( 0 == mLocationTable[cell].length )
+        {
+            signalData = Dataset::SignalDataPtr( shared_from_this(), &mTable[cell] );
+        }
+        else if( mBlockCache )
+        {
+            const Dataset::SignalOrigin ORIGIN = { mSourceFingerprint, aPair.first, aPair.second };
+            signalData = mBlockCache->get( cell, mLocationTable[cell], ORIGIN );
+        }
+    }
+
+    return signalData;
+}
+
+
+//!************************************************************************
+//! Get the table cell of a modulation-SNR combination
+//!
+//! @returns true if the combination is present
+//!************************************************************************
+bool DatasetIndex::getCell
+    (
+    const Dataset::ModulationSnrPair&   aPair,      //!< modulation-SNR combination
+    size_t&                             aCell       //!< table cell
+    ) const
+{
+    int modIndex = getModulationIndex( aPair.first );
+    int snrIndex = getSnrIndex( aPair.second );
+    bool status = ( modIndex >= 0 && snrIndex >= 0 );
+
+    if( status )
+    {
+        status = isPresent( modIndex, snrIndex );
+    }
+
+    if( status )
+    {
+        aCell = modIndex * mSnrVec.size() + snrIndex;
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Get the ordinal of a modulation
+//!
+//! @returns The modulation ordinal, -1 if the modulation is not indexed
+//!************************************************************************
+int DatasetIndex::getModulationIndex
+    (
+    const Modulation::ModulationName    aModulation //!< modulation
+    ) const
+{
+    return ( aModulation < mModLookup.size() ) ? mModLookup[aModulation] : -1;
+}
+
+
+//!************************************************************************
+//! Get the number of indexed modulations
+//!
+//! @returns The number of modulations
+//!************************************************************************
+size_t DatasetIndex::getModulationsNr() const
+{
+    return mModVec.size();
+}
+
+
+//!************************************************************************
+//! Get the indexed modulations
+//!
+//! @returns The vector with modulations, in ordinal order
+//!************************************************************************
+const std::vector<Modulation::ModulationName>& DatasetIndex::getModulationVec() const
+{
+    return mModVec;
+}
+
+
+//!************************************************************************
+//! Get the signal data placed at a modulation and SNR ordinal
+//!
+//! @returns The address of the signal data, nullptr if not present or
+//! not resident
+//!************************************************************************
+const Dataset::SignalData* DatasetIndex::getSignalData
+    (
+    const size_t                        aModIndex,  //!< modulation ordinal
+    const size_t                        aSnrIndex   //!< SNR ordinal
+    ) const
+{
+    bool status = isPresent( aModIndex, aSnrIndex ) && !isLazy( aModIndex, aSnrIndex );
+    return status ? &mTable[aModIndex * mSnrVec.size() + aSnrIndex] : nullptr;
+}
+
+
+//!************************************************************************
+//! Get the ordinal of a SNR
+//!
+//! @returns The SNR ordinal, -1 if the SNR is not indexed
+//!************************************************************************
+int DatasetIndex::getSnrIndex
+    (
+    const int                           aSnrDb      //!< SNR [dB]
+    ) const
+{
+    int offset = aSnrDb - mMinSnrDb;
+    return ( offset >= 0 && offset < static_cast<int>( mSnrLookup.size() ) ) ? mSnrLookup[offset] : -1;
+}
+
+
+//!************************************************************************
+//! Get the number of indexed SNRs
+//!
+//! @returns The number of SNRs
+//!************************************************************************
+size_t DatasetIndex::getSnrsNr() const
+{
+    return mSnrVec.size();
+}
+
+
+//!************************************************************************
+//! Get the indexed SNRs
+//!
+//! @returns The vector with SNRs, in ordinal order
+//!************************************************************************
+const std::vector<int>& DatasetIndex::getSnrVec() const
+{
+    return mSnrVec;
+}
+
+
+//!************************************************************************
+//! Insert the signal data for a modulation-SNR combination.
+//! The combination must be part of the table built beforehand. The
+//! signal data is stamped with the source fingerprint and the combination.
+//!
+//! @returns true if the signal data can be inserted
+//!************************************************************************
+bool DatasetIndex::insert
+    (
+    const Dataset::ModulationSnrPair&   aPair,      //!< modulation-SNR combination
+    Dataset::SignalData&&               aSignalData //!< signal data
+    )
+{
+    size_t cell = 0;
+    bool status = markPresent( aPair, cell );
+
+    if( status )
+    {
+        mTable[cell] = std::move( aSignalData );
+        mTable[cell].origin = { mSourceFingerprint, aPair.first, aPair.second };
+        mLocationTable[cell] = { 0, 0 };
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Insert the source file location of a block to be loaded on demand.
+//! The combination must be part of the table built beforehand.
+//!
+//! @returns true if the location can be inserted
+//!************************************************************************
+bool DatasetIndex::insertLocation
+    (
+    const Dataset::ModulationSnrPair&   aPair,      //!< modulation-SNR combination
+    const Dataset::BlockLocation&       aLocation   //!< block location in the source file
+    )
+{
+    size_t cell = 0;
+    bool status = ( aLocation.length > 0 ) && markPresent( aPair, cell );
+
+    if( status )
+    {
+        mTable[cell] = Dataset::SignalData();
+        mLocationTable[cell] = aLocation;
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Check if a present block is loaded on demand
+//!
+//! @returns true if only the location of the block is indexed
+//!************************************************************************
+bool DatasetIndex::isLazy
+    (
+    const size_t                        aModIndex,  //!< modulation ordinal
+    const size_t                        aSnrIndex   //!< SNR ordinal
+    ) const
+{
+    bool status = isPresent( aModIndex, aSnrIndex );
+
+    if( status )
+    {
+        status = ( mLocationTable[aModIndex * mSnrVec.size() + aSnrIndex].length > 0 );
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Check if signal data is present at a modulation and SNR ordinal
+//!
+//! @returns true if present
+//!************************************************************************
+bool DatasetIndex::isPresent
+    (
+    const size_t                        aModIndex,  //!< modulation ordinal
+    const size_t                        aSnrIndex   //!< SNR ordinal
+    ) const
+{
+    bool status = ( aModIndex < mModVec.size() && aSnrIndex < mSnrVec.size() );
+
+    if( status )
+    {
+        const size_t CELL = aModIndex * mSnrVec.size() + aSnrIndex;
+        status = ( mPresentBitmap[CELL / 64] >> ( CELL % 64 ) ) & 1;
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Mark a modulation-SNR combination as present
+//!
+//! @returns true if the combination is part of the table
+//!************************************************************************
+bool DatasetIndex::markPresent
+    (
+    const Dataset::ModulationSnrPair&   aPair,      //!< modulation-SNR combination
+    size_t&                             aCell       //!< table cell
+    )
+{
+    int modIndex = getModulationIndex( aPair.first );
+    int snrIndex = getSnrIndex( aPair.second );
+    bool status = ( modIndex >= 0 && snrIndex >= 0 );
+
+    if( status )
+    {
+        aCell = modIndex * mSnrVec.size() + snrIndex;
+
+        if( !isPresent( modIndex, snrIndex ) )
+        {
+            mPresentBitmap[aCell / 64] |= ( 1ULL << ( aCell % 64 ) );
+            mPresentCount++;
+        }
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Set the cache used for the blocks loaded on demand
+//!
+//! @returns nothing
+//!************************************************************************
+void DatasetIndex::setBlockCache
+    (
+    const std::shared_ptr<BlockCache>&  aBlockCache //!< cache for blocks loaded on demand
+    )
+{
+    mBlockCache = aBlockCache;
+}
+
+
+//!************************************************************************
+//! Set the fingerprint of the source file, stamped on the signal data
+//! inserted or loaded afterwards
+//!
+//! @returns nothing
+//!************************************************************************
+void DatasetIndex::setSourceFingerprint
+    (
+    const uint64_t                      aFingerprint    //!< fingerprint of the source file, 0 if unknown
+    )
+{
+    mSourceFingerprint = aFingerprint;
+}
+
+
+//!************************************************************************
+//! Get the number of present modulation-SNR combinations
+//!
+//! @returns The number of combinations with signal data
+//!************************************************************************
+size_t DatasetIndex::size() const
+{
+    return mPresentCount;
+}
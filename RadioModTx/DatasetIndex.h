@@ -0,0 +1,170 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+/*
+DatasetIndex.h
+
+This file contains the definitions for dataset index.
+*/
+
+#ifndef DatasetIndex_h
+#define DatasetIndex_h
+
+#include "BlockCache.h"
+#include "Dataset.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+
+//************************************************************************
+// Class for handling the dense (modulation x SNR) index of a dataset.
+// Signal data is kept in a row-major table, one row per modulation and
+// one column per SNR, so that all SNRs of a modulation are contiguous.
+// In index-only mode a cell holds the location of the block in the source
+// file instead of its samples, which are loaded on demand by getBlock().
+//************************************************************************
+class DatasetIndex : public std::enable_shared_from_this<DatasetIndex>
+{
+    //************************************************************************
+    // functions
+    //************************************************************************
+    public:
+        DatasetIndex();
+
+        const Dataset::SignalData& at
+            (
+            const Dataset::ModulationSnrPair&   aPair       //!< modulation-SNR combination
+            ) const;
+
+        void build
+            (
+            const std::vector<Modulation::ModulationName>&  aModVec,    //!< unique modulations
+            const std::vector<int>&                         aSnrVec     //!< unique SNRs
+            );
+
+        void clear();
+
+        bool contains
+            (
+            const Dataset::ModulationSnrPair&   aPair       //!< modulation-SNR combination
+            ) const;
+
+        bool empty() const;
+
+        Dataset::SignalDataPtr getBlock
+            (
+            const Dataset::ModulationSnrPair&   aPair       //!< modulation-SNR combination
+            ) const;
+
+        int getModulationIndex
+            (
+            const Modulation::ModulationName    aModulation //!< modulation
+            ) const;
+
+        size_t getModulationsNr() const;
+
+        const std::vector<Modulation::ModulationName>& getModulationVec() const;
+
+        const Dataset::SignalData* getSignalData
+            (
+            const size_t                        aModIndex,  //!< modulation ordinal
+            const size_t                        aSnrIndex   //!< SNR ordinal
+            ) const;
+
+        int getSnrIndex
+            (
+            const int                           aSnrDb      //!< SNR [dB]
+            ) const;
+
+        size_t getSnrsNr() const;
+
+        const std::vector<int>& getSnrVec() const;
+
+        bool insert
+            (
+            const Dataset::ModulationSnrPair&   aPair,      //!< modulation-SNR combination
+            Dataset::SignalData&&               aSignalData //!< signal data
+            );
+
+        bool insertLocation
+            (
+            const Dataset::ModulationSnrPair&   aPair,      //!< modulation-SNR combination
+            const Dataset::BlockLocation&       aLocation   //!< block location in the source file
+            );
+
+        bool isLazy
+            (
+            const size_t                        aModIndex,  //!< modulation ordinal
+            const size_t                        aSnrIndex   //!< SNR ordinal
+            ) const;
+
+        bool isPresent
+            (
+            const size_t                        aModIndex,  //!< modulation ordinal
+            const size_t                        aSnrIndex   //!< SNR ordinal
+            ) const;
+
+        void setBlockCache
+            (
+            const std::shared_ptr<BlockCache>&  aBlockCache //!< cache for blocks loaded on demand
+            );
+
+        void setSourceFingerprint
+            (
+            const uint64_t                      aFingerprint    //!< fingerprint of the source file, 0 if unknown
+            );
+
+        size_t size() const;
+
+    private:
+        bool getCell
+            (
+            const Dataset::ModulationSnrPair&   aPair,      //!< modulation-SNR combination
+            size_t&                             aCell       //!< table cell
+            ) const;
+
+        bool markPresent
+            (
+            const Dataset::ModulationSnrPair&   aPair,      //!< modulation-SNR combination
+            size_t&                             aCell       //!< table cell
+            );
+
+
+    //************************************************************************
+    // variables
+    //************************************************************************
+    private:
+        std::vector<Modulation::ModulationName> mModVec;        //!< modulations, in ordinal order
+        std::vector<int>                        mSnrVec;        //!< SNRs, in ordinal order
+
+        std::vector<int16_t>                    mModLookup;     //!< modulation name to ordinal (-1 if absent)
+        std::vector<int16_t>                    mSnrLookup;     //!< SNR offset from minimum to ordinal (-1 if absent)
+        int                                     mMinSnrDb;      //!< minimum SNR [dB]
+
+        std::vector<Dataset::SignalData>        mTable;         //!< row-major (modulation x SNR) table
+        std::vector<uint64_t>                   mPresentBitmap; //!< one bit per table cell
+        size_t                                  mPresentCount;  //!< number of present cells
+
+        std::vector<Dataset::BlockLocation>     mLocationTable; //!< block locations of cells loaded on demand (length 0 if resident)
+        std::shared_ptr<BlockCache>             mBlockCache;    //!< cache for blocks loaded on demand
+        uint64_t                                mSourceFingerprint; //!< fingerprint of the source file, stamped on the signal data
+};
+
+#endif // DatasetIndex_h
@@ -22,9 +22,14 @@ This file contains the sources for dataset parser.
 */
 
 #include "DatasetParser.h"
+#include "DatasetCache.h"
+#include "SourceIndex.h"
+#include "WorkerPool.h"
 
 #include <algorithm>
+#include <memory>
 #include <unordered_set>
+#include <utility>
 
 
 //!************************************************************************
@@ -33,22 +38,55 @@ This file contains the sources for dataset parser.
 DatasetParser::DatasetParser()
     : mStatus( true )
     , mSingleModulation( Modulation::NAME_UNKNOWN )
+    , mIndexOnly( false )
+    , mBlockCacheBudget( Dataset::BLOCK_CACHE_BUDGET_BYTES )
+    , mCacheEnabled( true )
 {
 }
 
 
 //!************************************************************************
-//! Get the dataset map
+//! Build the dataset map from the unique modulations and SNRs, then move
+//! the parsed blocks and the located blocks into it. The blocks are
+//! stamped with the fingerprint of the source file, so that the converted
+//! waveforms of different datasets are never mixed up.
 //!
-//! @returns The map containing signal data for all modulation-SNR combinations
+//! @returns nothing
 //!************************************************************************
-Dataset::ModulationSnrSignalDataMap DatasetParser::getMap
+void DatasetParser::buildMap
     (
-    bool& aStatus           //!< status
-    ) const
+    const Dataset::DatasetSource aSource    //!< dataset source
+    )
 {
-    aStatus = mStatus;
-    return mMap;
+    removeDuplicates( mUniqueModVec );
+    removeDuplicates( mUniqueSnrVec );
+
+    mMap.build( mUniqueModVec, mUniqueSnrVec );
+
+    uint64_t sourceFingerprint = 0;
+
+    if( SourceIndex( mFileName, aSource ).getSourceFingerprint( sourceFingerprint ) )
+    {
+        mMap.setSourceFingerprint( sourceFingerprint );
+    }
+
+    for( size_t i = 0; i < mBlockVec.size(); i++ )
+    {
+        mMap.insert( mBlockVec.at( i ).first, std::move( mBlockVec.at( i ).second ) );
+    }
+
+    for( size_t i = 0; i < mLocationVec.size(); i++ )
+    {
+        mMap.insertLocation( mLocationVec.at( i ).first, mLocationVec.at( i ).second );
+    }
+
+    if( mLocationVec.size() )
+    {
+        mMap.setBlockCache( std::make_shared<BlockCache>( mBlockLoader, mBlockCacheBudget ) );
+    }
+
+    mBlockVec.clear();
+    mLocationVec.clear();
 }
 
 
@@ -74,6 +112,135 @@ std::vector<int> DatasetParser::getUniqueSnrVec() const
 }
 
 
+//!************************************************************************
+//! Load the dataset from its native binary cache, if one is present and
+//! up to date with the source file
+//!
+//! @returns true if the dataset was loaded from the cache
+//!************************************************************************
+bool DatasetParser::loadCache
+    (
+    const Dataset::DatasetSource aSource    //!< dataset source
+    )
+{
+    mUniqueModVec.clear();
+    mUniqueSnrVec.clear();
+    mBlockVec.clear();
+    mLocationVec.clear();
+    mMap.clear();
+
+    DatasetCache cache( mFileName, aSource );
+    cache.setDirectory( mSidecarDirectory );
+    bool status = cache.load( mUniqueModVec, mUniqueSnrVec, mBlockVec );
+
+    if( status )
+    {
+        buildMap( aSource );
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Load the blocks of the selected modulation through the sidecar index
+//! of the source file, seeking straight to each of them. The blocks are
+//! loaded in parallel, or only located in index-only mode.
+//! Before the index is trusted, a few frames of the first block are
+//! sampled through it: they must decode and stay within the maximum
+//! recorded for the block.
+//!
+//! @returns true if the index is up to date and the blocks could be loaded
+//!************************************************************************
+bool DatasetParser::loadSingleModulation
+    (
+    const Dataset::DatasetSource aSource,   //!< dataset source
+    const Dataset::BlockLoader&  aLoader,   //!< loader of the blocks of the source file
+    const Dataset::FrameDecoder& aDecoder   //!< decoder of the frame bytes
+    )
+{
+    mUniqueModVec.clear();
+    mUniqueSnrVec.clear();
+    mBlockVec.clear();
+    mLocationVec.clear();
+    mMap.clear();
+
+    SourceIndex sourceIndex( mFileName, aSource );
+    sourceIndex.setDirectory( mSidecarDirectory );
+    bool status = sourceIndex.load();
+
+    const Dataset::ModulationSnrLocationVec locationVec = sourceIndex.getLocationVec();
+
+    Dataset::ModulationSnrLocationVec selectedVec;
+
+    for( size_t i = 0; i < locationVec.size(); i++ )
+    {
+        if( mSingleModulation == locationVec.at( i ).first.first )
+        {
+            selectedVec.push_back( locationVec.at( i ) );
+        }
+    }
+
+    status = status && selectedVec.size();
+
+    if( status )
+    {
+        Dataset::SignalData sampledData;
+        status = sampleIndexedFrames( sourceIndex, selectedVec.front().first, VALIDATION_FRAMES_NR, aDecoder, sampledData );
+    }
+
+    if( status && mIndexOnly )
+    {
+        mLocationVec = selectedVec;
+        mBlockLoader = aLoader;
+    }
+    else if( status )
+    {
+        std::vector<Dataset::SignalData> signalDataVec( selectedVec.size() );
+        std::unique_ptr<bool[]> loadedArray( new bool[selectedVec.size()]() );
+        WorkerPool workerPool;
+
+        for( size_t i = 0; i < selectedVec.size(); i++ )
+        {
+            workerPool.submit( [&, i]()
+            {
+                loadedArray[i] = aLoader( selectedVec.at( i ).second, signalDataVec.at( i ) );
+            });
+        }
+
+        workerPool.wait();
+
+        for( size_t i = 0; status && i < selectedVec.size(); i++ )
+        {
+            status = loadedArray[i];
+
+            if( status )
+            {
+                mBlockVec.emplace_back( selectedVec.at( i ).first, std::move( signalDataVec.at( i ) ) );
+            }
+        }
+    }
+
+    if( status )
+    {
+        for( size_t i = 0; i < selectedVec.size(); i++ )
+        {
+            mUniqueModVec.push_back( selectedVec.at( i ).first.first );
+            mUniqueSnrVec.push_back( selectedVec.at( i ).first.second );
+        }
+    }
+    else
+    {
+        mBlockVec.clear();
+        mLocationVec.clear();
+    }
+
+    buildMap( aSource );
+
+    return status;
+}
+
+
 //!************************************************************************
 //! Remove the duplicates and sorts a vector
 //!
@@ -118,6 +285,75 @@ void DatasetParser::removeDuplicates
 }
 
 
+//!************************************************************************
+//! Sample frames of a block, evenly spread over it, straight from the
+//! source file through its sidecar index. Each frame is read with one
+//! pread(), without parsing the rest of the file.
+//!
+//! @returns true if the block is indexed and the frames could be read
+//!************************************************************************
+bool DatasetParser::sampleIndexedFrames
+    (
+    const SourceIndex&                  aSourceIndex,   //!< loaded sidecar index of the source file
+    const Dataset::ModulationSnrPair&   aPair,          //!< modulation-SNR combination
+    const size_t                        aFramesNr,      //!< number of frames to sample
+    const Dataset::FrameDecoder&        aDecoder,       //!< decoder of the frame bytes
+    Dataset::SignalData&                aSignalData     //!< signal data with the sampled frames
+    )
+{
+    const int BLOCK = aSourceIndex.findBlock( aPair );
+    bool status = ( BLOCK >= 0 );
+
+    std::vector<size_t> frameVec;
+
+    if( status )
+    {
+        const size_t BLOCK_FRAMES_NR = aSourceIndex.getFramesNr( BLOCK );
+        const size_t FRAMES_NR = std::min( aFramesNr, BLOCK_FRAMES_NR );
+
+        for( size_t i = 0; i < FRAMES_NR; i++ )
+        {
+            frameVec.push_back( i * BLOCK_FRAMES_NR / FRAMES_NR );
+        }
+
+        status = aSourceIndex.readFrames( BLOCK, frameVec, aDecoder, aSignalData );
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Save the parsed dataset to its native binary cache
+//!
+//! @returns nothing
+//!************************************************************************
+void DatasetParser::saveCache
+    (
+    const Dataset::DatasetSource aSource    //!< dataset source
+    ) const
+{
+    DatasetCache cache( mFileName, aSource );
+    cache.setDirectory( mSidecarDirectory );
+    cache.save( mMap );
+}
+
+
+//!************************************************************************
+//! Enable the native binary cache of the dataset, loaded instead of
+//! parsing the source file and saved after a full parse
+//!
+//! @returns nothing
+//!************************************************************************
+void DatasetParser::setCacheEnabled
+    (
+    const bool      aEnabled        //!< false to neither load nor save the dataset cache
+    )
+{
+    mCacheEnabled = aEnabled;
+}
+
+
 //!************************************************************************
 //! Set the filename
 //!
@@ -132,6 +368,39 @@ void DatasetParser::setFile
 }
 
 
+//!************************************************************************
+//! Set the index-only mode. In this mode the parsers only record where
+//! each modulation-SNR block lives in the source file, the samples being
+//! loaded the first time the block is requested.
+//!
+//! @returns nothing
+//!************************************************************************
+void DatasetParser::setIndexOnly
+    (
+    const bool      aIndexOnly,     //!< true to index the blocks without loading them
+    const size_t    aBudgetBytes    //!< memory budget of the blocks loaded on demand [bytes]
+    )
+{
+    mIndexOnly = aIndexOnly;
+    mBlockCacheBudget = aBudgetBytes;
+}
+
+
+//!************************************************************************
+//! Set the directory where the cache and the index of the source file are
+//! read and written
+//!
+//! @returns nothing
+//!************************************************************************
+void DatasetParser::setSidecarDirectory
+    (
+    const std::string& aDirectory   //!< directory of the cache and index files, empty for the one of the source file
+    )
+{
+    mSidecarDirectory = aDirectory;
+}
+
+
 //!************************************************************************
 //! Set the single modulation
 //!
@@ -144,3 +413,22 @@ void DatasetParser::setSingleModulation
 {
     mSingleModulation = aModulation;
 }
+
+
+//!************************************************************************
+//! Take the dataset map out of the parser.
+//! The map is moved into an immutable snapshot, without copying any frame.
+//!
+//! @returns The snapshot containing signal data for all modulation-SNR combinations
+//!************************************************************************
+Dataset::Snapshot DatasetParser::takeMap
+    (
+    bool& aStatus           //!< status
+    )
+{
+    aStatus = mStatus;
+    Dataset::Snapshot snapshot = std::make_shared<const Dataset::ModulationSnrSignalDataMap>( std::move( mMap ) );
+    mMap.clear();
+
+    return snapshot;
+}
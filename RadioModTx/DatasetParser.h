@@ -25,11 +25,13 @@ This file contains the definitions for dataset parser.
 #define DatasetParser_h
 
 #include "Dataset.h"
+#include "DatasetIndex.h"
 
 #include <string>
 
 #include <QObject>
 
+class SourceIndex;
 
 //************************************************************************
 // Class for handling the dataset parser
@@ -38,17 +40,19 @@ class DatasetParser : public QObject
 {
     Q_OBJECT
 
+    //************************************************************************
+    // constants and types
+    //************************************************************************
+    private:
+        static const size_t VALIDATION_FRAMES_NR = 4;  //!< frames sampled to validate a sidecar index
+
+
     //************************************************************************
     // functions
     //************************************************************************
     public:
         DatasetParser();
 
-        Dataset::ModulationSnrSignalDataMap getMap
-            (
-            bool& aStatus               //!< status
-            ) const;
-
         std::vector<Modulation::ModulationName> getUniqueModVec() const;
 
         std::vector<int> getUniqueSnrVec() const;
@@ -67,16 +71,69 @@ class DatasetParser : public QObject
             std::vector<Modulation::ModulationName>& aVector   //!< vector
             );
 
+        void setCacheEnabled
+            (
+            const bool      aEnabled        //!< false to neither load nor save the dataset cache
+            );
+
         void setFile
             (
             std::string aFileName       //!< input filename
             );
 
+        void setIndexOnly
+            (
+            const bool      aIndexOnly,     //!< true to index the blocks without loading them
+            const size_t    aBudgetBytes    //!< memory budget of the blocks loaded on demand [bytes]
+            );
+
+        void setSidecarDirectory
+            (
+            const std::string& aDirectory   //!< directory of the cache and index files, empty for the one of the source file
+            );
+
         void setSingleModulation
             (
             Modulation::ModulationName aModulation  //!< modulation
             );
 
+        Dataset::Snapshot takeMap
+            (
+            bool& aStatus               //!< status
+            );
+
+    protected:
+        void buildMap
+            (
+            const Dataset::DatasetSource aSource    //!< dataset source
+            );
+
+        bool loadCache
+            (
+            const Dataset::DatasetSource aSource    //!< dataset source
+            );
+
+        bool loadSingleModulation
+            (
+            const Dataset::DatasetSource aSource,   //!< dataset source
+            const Dataset::BlockLoader&  aLoader,   //!< loader of the blocks of the source file
+            const Dataset::FrameDecoder& aDecoder   //!< decoder of the frame bytes
+            );
+
+        void saveCache
+            (
+            const Dataset::DatasetSource aSource    //!< dataset source
+            ) const;
+
+        static bool sampleIndexedFrames
+            (
+            const SourceIndex&                  aSourceIndex,   //!< loaded sidecar index of the source file
+            const Dataset::ModulationSnrPair&   aPair,          //!< modulation-SNR combination
+            const size_t                        aFramesNr,      //!< number of frames to sample
+            const Dataset::FrameDecoder&        aDecoder,       //!< decoder of the frame bytes
+            Dataset::SignalData&                aSignalData     //!< signal data with the sampled frames
+            );
+
     //************************************************************************
     // variables
     //************************************************************************
@@ -87,6 +144,13 @@ class DatasetParser : public QObject
         std::vector<Modulation::ModulationName> mUniqueModVec;  //!< vector with unique modulations
         std::vector<int>                        mUniqueSnrVec;  //!< vector with unique SNRs
         Modulation::ModulationName              mSingleModulation;  //!< selected modulation
+        Dataset::ModulationSnrSignalDataVec     mBlockVec;      //!< parsed modulation-SNR blocks, not yet indexed
+        Dataset::ModulationSnrLocationVec       mLocationVec;   //!< located modulation-SNR blocks, not yet indexed
+        Dataset::BlockLoader                    mBlockLoader;   //!< loader of the located blocks
+        bool                                    mIndexOnly;     //!< true to index the blocks without loading them
+        size_t                                  mBlockCacheBudget;  //!< memory budget of the blocks loaded on demand [bytes]
+        bool                                    mCacheEnabled;  //!< false to neither load nor save the dataset cache
+        std::string                             mSidecarDirectory;  //!< directory of the cache and index files, empty for the one of the source file
         Dataset::ModulationSnrSignalDataMap     mMap;           //!< map with data signals for modulation-SNR combinations
         double                                  mMaxVal;        //!< maximum value
 };
@@ -0,0 +1,378 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+/*
+FrameStore.cpp
+
+This file contains the sources for frame store.
+*/
+
+#include "FrameStore.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+
+//!************************************************************************
+//! Constructor
+//!************************************************************************
+FrameStore::FrameView::FrameView
+    (
+    const IQPoint*  aData,      //!< first point of the frame
+    const size_t    aLength     //!< frame length in (I,Q) pairs
+    )
+    : mData( aData )
+    , mLength( aLength )
+{
+}
+
+
+//!************************************************************************
+//! Get the first point of the frame
+//!
+//! @returns The address of the first point
+//!************************************************************************
+const FrameStore::IQPoint* FrameStore::FrameView::begin() const
+{
+    return mData;
+}
+
+
+//!************************************************************************
+//! Get the first point of the frame
+//!
+//! @returns The address of the first point
+//!************************************************************************
+const FrameStore::IQPoint* FrameStore::FrameView::data() const
+{
+    return mData;
+}
+
+
+//!************************************************************************
+//! Get the position after the last point of the frame
+//!
+//! @returns The address after the last point
+//!************************************************************************
+const FrameStore::IQPoint* FrameStore::FrameView::end() const
+{
+    return mData + mLength;
+}
+
+
+//!************************************************************************
+//! Get the frame length
+//!
+//! @returns The number of (I,Q) pairs in the frame
+//!************************************************************************
+size_t FrameStore::FrameView::size() const
+{
+    return mLength;
+}
+
+
+//!************************************************************************
+//! Get a point of the frame
+//!
+//! @returns The point placed at the given index
+//!************************************************************************
+const FrameStore::IQPoint& FrameStore::FrameView::operator[]
+    (
+    const size_t    aIndex      //!< point index
+    ) const
+{
+    return mData[aIndex];
+}
+
+
+//!************************************************************************
+//! Constructor
+//!************************************************************************
+FrameStore::FrameStore()
+    : mFramesNr( 0 )
+    , mFrameLength( 0 )
+{
+}
+
+
+//!************************************************************************
+//! Copy constructor
+//!************************************************************************
+FrameStore::FrameStore
+    (
+    const FrameStore&   aOther      //!< store to copy
+    )
+    : mFramesNr( 0 )
+    , mFrameLength( 0 )
+{
+    *this = aOther;
+}
+
+
+//!************************************************************************
+//! Move constructor
+//!************************************************************************
+FrameStore::FrameStore
+    (
+    FrameStore&&        aOther      //!< store to move
+    ) noexcept
+    : mArena( std::move( aOther.mArena ) )
+    , mFramesNr( aOther.mFramesNr )
+    , mFrameLength( aOther.mFrameLength )
+{
+    aOther.mFramesNr = 0;
+    aOther.mFrameLength = 0;
+}
+
+
+//!************************************************************************
+//! Copy assignment
+//!
+//! @returns The current store
+//!************************************************************************
+FrameStore& FrameStore::operator=
+    (
+    const FrameStore&   aOther      //!< store to copy
+    )
+{
+    if( this != &aOther )
+    {
+        clear();
+
+        if( allocate( aOther.mFramesNr, aOther.mFrameLength ) )
+        {
+            memcpy( mArena.get(), aOther.mArena.get(), getSizeBytes() );
+        }
+    }
+
+    return *this;
+}
+
+
+//!************************************************************************
+//! Move assignment
+//!
+//! @returns The current store
+//!************************************************************************
+FrameStore& FrameStore::operator=
+    (
+    FrameStore&&        aOther      //!< store to move
+    ) noexcept
+{
+    if( this != &aOther )
+    {
+        mArena = std::move( aOther.mArena );
+        mFramesNr = aOther.mFramesNr;
+        mFrameLength = aOther.mFrameLength;
+
+        aOther.mFramesNr = 0;
+        aOther.mFrameLength = 0;
+    }
+
+    return *this;
+}
+
+
+//!************************************************************************
+//! Adopt an arena owned by someone else, e.g. a memory-mapped file.
+//! The owner is kept alive for as long as the store references it.
+//!
+//! @returns nothing
+//!************************************************************************
+void FrameStore::adopt
+    (
+    const std::shared_ptr<IQPoint>& aArena,     //!< externally owned arena
+    const size_t        aFramesNr,      //!< number of frames
+    const uint16_t      aFrameLength    //!< frame length in (I,Q) pairs
+    )
+{
+    mArena = aArena;
+    mFramesNr = aFramesNr;
+    mFrameLength = aFrameLength;
+}
+
+
+//!************************************************************************
+//! Allocate the arena for a number of frames.
+//! The previous content is discarded, the new content is not initialized.
+//!
+//! @returns true if the arena can be allocated
+//!************************************************************************
+bool FrameStore::allocate
+    (
+    const size_t        aFramesNr,      //!< number of frames
+    const uint16_t      aFrameLength    //!< frame length in (I,Q) pairs
+    )
+{
+    clear();
+
+    const size_t TOTAL_BYTES = aFramesNr * aFrameLength * sizeof( IQPoint );
+    bool status = ( TOTAL_BYTES > 0 );
+
+    if( status )
+    {
+        void* arena = nullptr;
+        status = ( 0 == posix_memalign( &arena, ALIGNMENT, TOTAL_BYTES ) );
+
+        if( status )
+        {
+            mArena = std::shared_ptr<IQPoint>( static_cast<IQPoint*>( arena ), free );
+            mFramesNr = aFramesNr;
+            mFrameLength = aFrameLength;
+        }
+        else
+        {
+            std::cout << "Could not allocate " << TOTAL_BYTES / 1048576.0 << " MB. Not enough memory." << std::endl;
+        }
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Release the arena
+//!
+//! @returns nothing
+//!************************************************************************
+void FrameStore::clear()
+{
+    mArena.reset();
+    mFramesNr = 0;
+    mFrameLength = 0;
+}
+
+
+//!************************************************************************
+//! Get the first point of the arena
+//!
+//! @returns The address of the first point
+//!************************************************************************
+FrameStore::IQPoint* FrameStore::data()
+{
+    return mArena.get();
+}
+
+
+//!************************************************************************
+//! Get the first point of the arena
+//!
+//! @returns The address of the first point
+//!************************************************************************
+const FrameStore::IQPoint* FrameStore::data() const
+{
+    return mArena.get();
+}
+
+
+//!************************************************************************
+//! Get the first point of a frame
+//!
+//! @returns The address of the first point of the frame
+//!************************************************************************
+FrameStore::IQPoint* FrameStore::getFrame
+    (
+    const size_t        aFrame          //!< frame index
+    )
+{
+    return mArena.get() + aFrame * mFrameLength;
+}
+
+
+//!************************************************************************
+//! Get the first point of a frame
+//!
+//! @returns The address of the first point of the frame
+//!************************************************************************
+const FrameStore::IQPoint* FrameStore::getFrame
+    (
+    const size_t        aFrame          //!< frame index
+    ) const
+{
+    return mArena.get() + aFrame * mFrameLength;
+}
+
+
+//!************************************************************************
+//! Get the frame length
+//!
+//! @returns The number of (I,Q) pairs per frame
+//!************************************************************************
+uint16_t FrameStore::getFrameLength() const
+{
+    return mFrameLength;
+}
+
+
+//!************************************************************************
+//! Get the number of frames
+//!
+//! @returns The number of frames
+//!************************************************************************
+size_t FrameStore::getFramesNr() const
+{
+    return mFramesNr;
+}
+
+
+//!************************************************************************
+//! Get a read-only view of a frame
+//!
+//! @returns The frame view
+//!************************************************************************
+FrameStore::FrameView FrameStore::getFrameView
+    (
+    const size_t        aFrame          //!< frame index
+    ) const
+{
+    return FrameView( getFrame( aFrame ), mFrameLength );
+}
+
+
+//!************************************************************************
+//! Get the total number of points
+//!
+//! @returns The number of (I,Q) pairs in all frames
+//!************************************************************************
+size_t FrameStore::getPointsNr() const
+{
+    return mFramesNr * mFrameLength;
+}
+
+
+//!************************************************************************
+//! Get the size of the arena
+//!
+//! @returns The size in bytes
+//!************************************************************************
+size_t FrameStore::getSizeBytes() const
+{
+    return getPointsNr() * sizeof( IQPoint );
+}
+
+
+//!************************************************************************
+//! Check if the store is empty
+//!
+//! @returns true if no frame is stored
+//!************************************************************************
+bool FrameStore::isEmpty() const
+{
+    return ( nullptr == mArena || 0 == mFramesNr );
+}
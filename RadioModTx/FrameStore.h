@@ -0,0 +1,162 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+/*
+FrameStore.h
+
+This file contains the definitions for frame store.
+*/
+
+#ifndef FrameStore_h
+#define FrameStore_h
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+
+//************************************************************************
+// Class for handling a contiguous store of (I,Q) frames.
+// All frames of a modulation-SNR combination are kept in a single
+// 64-byte aligned arena, addressed by frame index and point index.
+//************************************************************************
+class FrameStore
+{
+    //************************************************************************
+    // constants and types
+    //************************************************************************
+    public:
+        typedef struct
+        {
+            float i;
+            float q;
+        }IQPoint;
+
+        static const size_t ALIGNMENT = 64;     //!< arena alignment [bytes]
+
+        //************************************************************************
+        // Class for a read-only view over the points of one frame
+        //************************************************************************
+        class FrameView
+        {
+            public:
+                FrameView
+                    (
+                    const IQPoint*  aData,      //!< first point of the frame
+                    const size_t    aLength     //!< frame length in (I,Q) pairs
+                    );
+
+                const IQPoint* begin() const;
+
+                const IQPoint* data() const;
+
+                const IQPoint* end() const;
+
+                size_t size() const;
+
+                const IQPoint& operator[]
+                    (
+                    const size_t    aIndex      //!< point index
+                    ) const;
+
+            private:
+                const IQPoint*  mData;          //!< first point of the frame
+                size_t          mLength;        //!< frame length in (I,Q) pairs
+        };
+
+
+    //************************************************************************
+    // functions
+    //************************************************************************
+    public:
+        FrameStore();
+
+        FrameStore
+            (
+            const FrameStore&   aOther          //!< store to copy
+            );
+
+        FrameStore
+            (
+            FrameStore&&        aOther          //!< store to move
+            ) noexcept;
+
+        FrameStore& operator=
+            (
+            const FrameStore&   aOther          //!< store to copy
+            );
+
+        FrameStore& operator=
+            (
+            FrameStore&&        aOther          //!< store to move
+            ) noexcept;
+
+        void adopt
+            (
+            const std::shared_ptr<IQPoint>& aArena,     //!< externally owned arena
+            const size_t        aFramesNr,      //!< number of frames
+            const uint16_t      aFrameLength    //!< frame length in (I,Q) pairs
+            );
+
+        bool allocate
+            (
+            const size_t        aFramesNr,      //!< number of frames
+            const uint16_t      aFrameLength    //!< frame length in (I,Q) pairs
+            );
+
+        void clear();
+
+        IQPoint* data();
+
+        const IQPoint* data() const;
+
+        IQPoint* getFrame
+            (
+            const size_t        aFrame          //!< frame index
+            );
+
+        const IQPoint* getFrame
+            (
+            const size_t        aFrame          //!< frame index
+            ) const;
+
+        uint16_t getFrameLength() const;
+
+        size_t getFramesNr() const;
+
+        FrameView getFrameView
+            (
+            const size_t        aFrame          //!< frame index
+            ) const;
+
+        size_t getPointsNr() const;
+
+        size_t getSizeBytes() const;
+
+        bool isEmpty() const;
+
+
+    //************************************************************************
+    // variables
+    //************************************************************************
+    private:
+        std::shared_ptr<IQPoint>    mArena;         //!< aligned arena with all points
+        size_t                      mFramesNr;      //!< number of frames
+        uint16_t                    mFrameLength;   //!< frame length in (I,Q) pairs
+};
+
+#endif // FrameStore_h
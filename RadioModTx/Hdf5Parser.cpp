@@ -23,9 +23,11 @@ This file contains the sources for HDF5 parser.
 
 #include "Hdf5Parser.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <iostream>
+#include <mutex>
 #include <new>
 #include <utility>
 
@@ -281,10 +283,14 @@ const std::vector<Modulation::ModulationName> Hdf5Parser::MODULATION_MAPPING =
     Modulation::NAME_OQPSK
 };
 
+std::mutex Hdf5Parser::sHdf5Mutex;
+
 //!************************************************************************
 //! Constructor
 //!************************************************************************
 Hdf5Parser::Hdf5Parser()
+    : mFramesNr( 0 )
+    , mThroughputMBps( 0 )
 {
 }
 
@@ -334,6 +340,38 @@ Hdf5Visit::ObjInfoSize* Hdf5Parser::findObject
 }
 
 
+//!************************************************************************
+//! Get the number of rows read at once when streaming X.
+//! The batch covers about STREAM_BATCH_BYTES and is a multiple of the
+//! chunk rows when X is chunked, so that each chunk is read only once.
+//!
+//! @returns The number of rows per batch
+//!************************************************************************
+hsize_t Hdf5Parser::getBatchRows
+    (
+    const Hdf5RowReader&    aReader         //!< X reader
+    )
+{
+    const hsize_t ROW_BYTES = Dataset::FRAME_LENGTH.at( Dataset::DATASET_SOURCE_RADIOML_2018_01 ) * sizeof( Dataset::IQPoint );
+    const hsize_t CHUNK_ROWS = aReader.getChunkRows();
+
+    hsize_t batchRows = STREAM_BATCH_BYTES / ROW_BYTES / CHUNK_ROWS * CHUNK_ROWS;
+
+    return std::max( batchRows, CHUNK_ROWS );
+}
+
+
+//!************************************************************************
+//! Get the read throughput of the last parse
+//!
+//! @returns The throughput [MB/s], 0 if X was not read
+//!************************************************************************
+double Hdf5Parser::getThroughputMBps() const
+{
+    return mThroughputMBps;
+}
+
+
 //!************************************************************************
 //! Callback function for getting the type and name of an object
 //!
@@ -457,13 +495,49 @@ int Hdf5Parser::iterateGroup
 
 
 //!************************************************************************
-//! Load a HDF5 tree item
+//! Load a block located by an index-only parse. The blocks are loaded
+//! on the threads of the block cache, so they are serialized here; the
+//! reader of the file is opened by the first block and kept for the
+//! others.
+//!
+//! @returns true if the block could be loaded
+//!************************************************************************
+bool Hdf5Parser::loadBlock
+    (
+    Hdf5RowReader&                  aReader,        //!< X reader shared by the blocks of the file
+    const std::string&              aFileName,      //!< input filename
+    const std::string&              aDatasetPath,   //!< path of the X dataset
+    const Dataset::BlockLocation&   aLocation,      //!< rows of the block
+    Dataset::SignalData&            aSignalData     //!< signal data
+    )
+{
+    std::lock_guard<std::mutex> lock( sHdf5Mutex );
+    bool status = aReader.isOpen() || aReader.open( aFileName, aDatasetPath, Dataset::FRAME_LENGTH.at( Dataset::DATASET_SOURCE_RADIOML_2018_01 ) );
+
+    if( status )
+    {
+        status = readBlock( aReader, aLocation.offset, aLocation.length, aSignalData );
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Load a HDF5 tree item.
+//! Only the rows of the selected modulation are read, one hyperslab per
+//! SNR block, straight into the frame store of that block.
+//! When all modulations are requested, X is streamed in one sequential
+//! pass instead.
+//! In index-only mode nothing is read: the rows of every modulation-SNR
+//! block are recorded, so all modulations become available.
 //!
 //! @returns true at success
 //!************************************************************************
 bool Hdf5Parser::loadTreeItem
     (
-    Hdf5TreeItem* aTreeItem     //!< tree item
+    Hdf5TreeItem*   aTreeItem,          //!< tree item
+    const bool      aAllModulations     //!< true to load all modulations
     )
 {
     Hdf5ItemData* itemData = getTreeItemData( aTreeItem );
@@ -471,70 +545,60 @@ bool Hdf5Parser::loadTreeItem
 
     if( status )
     {
-        status = ( nullptr == itemData->mDataset->mDataBuffer );
+        status = ( H5T_FLOAT == itemData->mDataset->mDatatypeClass );
     }
 
-    if( status )
-    {
-        hid_t fileId = H5Fopen( itemData->mFileName.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT );
-        hid_t datasetId = H5Dopen2( fileId, itemData->mDataset->mFilePath.c_str(), H5P_DEFAULT );
-        hid_t spaceId = H5Dget_space( datasetId );
-        hid_t datatypeId = H5Dget_type( datasetId );
-        hid_t nativeDatatypeId = H5Tget_native_type( datatypeId, H5T_DIR_DEFAULT );
-        hsize_t nrOfElements = 1;
-
-        for( size_t j = 0; j < itemData->mDataset->mDimensionsVec.size(); j++ )
-        {
-            nrOfElements *= itemData->mDataset->mDimensionsVec.at( j );
-        }
-        // nrOfElements = 5234491392 = 2555904 * 1024 * 2
-
-        // 20937965568 = 4 * 5234491392 (approx. 19.5 GB)
-        const size_t TOTAL_BYTES = itemData->mDataset->mDatatypeSize * nrOfElements;
-
-        status = ( H5T_FLOAT == itemData->mDataset->mDatatypeClass );
+    const size_t FRAMES_NR = mFramesNr;
+    const size_t SNRS_NR = Dataset::SNRS_NR.at( Dataset::DATASET_SOURCE_RADIOML_2018_01 );
 
-        if( status )
+    if( status && mIndexOnly )
+    {
+        // rows are ordered by modulation, then by SNR, mFramesNr frames per block
+        for( size_t modOffset = 0; modOffset < MODULATION_MAPPING.size(); modOffset++ )
         {
-            itemData->mDataset->mDataBuffer = malloc( TOTAL_BYTES );
-
-            status = ( nullptr != itemData->mDataset->mDataBuffer );
+            mUniqueModVec.push_back( MODULATION_MAPPING.at( modOffset ) );
 
-            if( !status )
+            for( size_t crtSnrIndex = 0; crtSnrIndex < SNRS_NR; crtSnrIndex++ )
             {
-                std::cout << "Could not allocate " << TOTAL_BYTES / 1048576.0 << " MB. Not enough memory." << std::endl;
+                int crtSnrDb = -20 + 2 * crtSnrIndex;
+                mUniqueSnrVec.push_back( crtSnrDb );
+
+                Dataset::ModulationSnrPair modSnrPair = std::make_pair( MODULATION_MAPPING.at( modOffset ), crtSnrDb );
+                Dataset::BlockLocation location = { ( modOffset * SNRS_NR + crtSnrIndex ) * FRAMES_NR, FRAMES_NR };
+                mLocationVec.emplace_back( modSnrPair, location );
             }
         }
 
-        if( status )
-        {
-            status = ( H5Dread( datasetId, nativeDatatypeId, H5S_ALL, H5S_ALL, H5P_DEFAULT, itemData->mDataset->mDataBuffer ) >= 0 );
-        }
+        const std::string FILE_NAME = itemData->mFileName;
+        const std::string DATASET_PATH = itemData->mDataset->mFilePath;
 
-        if( status )
+        // one reader and worker pool for all the blocks, closed under the lock with the last loader
+        std::shared_ptr<Hdf5RowReader> reader( new Hdf5RowReader, []( Hdf5RowReader* aReader )
         {
-            float* fltBuf = static_cast<float*>( itemData->mDataset->mDataBuffer );
+            std::lock_guard<std::mutex> lock( sHdf5Mutex );
+            delete aReader;
+        } );
 
-            int crtSnrDb = -100;
-            int oldSnrDb = crtSnrDb;
+        mBlockLoader = [reader, FILE_NAME, DATASET_PATH]( const Dataset::BlockLocation& aLocation, Dataset::SignalData& aSignalData )
+        {
+            return loadBlock( *reader, FILE_NAME, DATASET_PATH, aLocation, aSignalData );
+        };
+    }
+    else if( status )
+    {
+        Hdf5RowReader reader;
+        status = reader.open( itemData->mFileName, itemData->mDataset->mFilePath, Dataset::FRAME_LENGTH.at( Dataset::DATASET_SOURCE_RADIOML_2018_01 ) );
 
+        if( status && aAllModulations )
+        {
+            status = readAllBlocks( reader );
+        }
+        else if( status )
+        {
             mUniqueModVec.push_back( mSingleModulation );
 
             Dataset::ModulationSnrPair modSnrPair;
 
-            Dataset::SignalData signalData;
-            Dataset::FrameData frameData;
-            Dataset::IQPoint iqPoint = { 0, 0 };
-
-            // 218103808 = 5234491392 / 24
-            const hsize_t NR_ELEMENTS_PER_MOD = nrOfElements / Dataset::MODULATIONS_NR.at( Dataset::DATASET_SOURCE_RADIOML_2018_01 );
-
-            // 2048 = 2 * 1024
-            const hsize_t NR_ELEMENTS_PER_FRAME = 2 * Dataset::FRAME_LENGTH.at( Dataset::DATASET_SOURCE_RADIOML_2018_01 );
-
-            // 8388608 = 218103808 / 26
-            const hsize_t NR_ELEMENTS_PER_MOD_SNR = NR_ELEMENTS_PER_MOD / Dataset::SNRS_NR.at( Dataset::DATASET_SOURCE_RADIOML_2018_01 );;
-
             size_t modOffset = 0;
 
             for( size_t i = 0; i < MODULATION_MAPPING.size(); i++ )
@@ -546,81 +610,38 @@ bool Hdf5Parser::loadTreeItem
                 }
             }
 
-            const hsize_t START_ELEMENT = modOffset * NR_ELEMENTS_PER_MOD;
-            const hsize_t STOP_ELEMENT = START_ELEMENT + NR_ELEMENTS_PER_MOD;
+            // rows are ordered by modulation, then by SNR, mFramesNr frames per block
+            const hsize_t START_ROW = modOffset * SNRS_NR * FRAMES_NR;
 
-            for( hsize_t i = START_ELEMENT; i < STOP_ELEMENT; i += 2 )
+            for( size_t crtSnrIndex = 0; status && crtSnrIndex < SNRS_NR; crtSnrIndex++ )
             {
-                crtSnrDb = -20 + 2 * ( ( i % NR_ELEMENTS_PER_MOD ) / NR_ELEMENTS_PER_MOD_SNR );
-
-                if( crtSnrDb != oldSnrDb )
-                {                    
-                    mUniqueSnrVec.push_back( crtSnrDb );
-
-                    modSnrPair = std::make_pair( mSingleModulation, crtSnrDb );
-
-                    signalData.frameDataVec.clear();
-                    signalData.maxVal = 0;
-                }
+                int crtSnrDb = -20 + 2 * crtSnrIndex;
+                mUniqueSnrVec.push_back( crtSnrDb );
 
-                if( 0 == i % NR_ELEMENTS_PER_FRAME )
-                {
-                    frameData.clear();
-                }
+                modSnrPair = std::make_pair( mSingleModulation, crtSnrDb );
 
-                hsize_t j = i;
+                Dataset::SignalData signalData;
+                status = readBlock( reader, START_ROW + crtSnrIndex * FRAMES_NR, FRAMES_NR, signalData );
 
-                for( ; j < i + NR_ELEMENTS_PER_FRAME; j += 2 )
+                if( status )
                 {
-                    float iPart = static_cast<float>( fltBuf[j] );
-                    float qPart = static_cast<float>( fltBuf[j + 1] );
-                    iqPoint = { iPart, qPart };
-                    frameData.push_back( iqPoint );
-
-                    if( fabs( iPart ) > signalData.maxVal )
-                    {
-                        signalData.maxVal = fabs( iPart );
-                    }
-
-                    if( fabs( qPart ) > signalData.maxVal )
-                    {
-                        signalData.maxVal = fabs( qPart );
-                    }
+                    mBlockVec.emplace_back( modSnrPair, std::move( signalData ) );
+                    emit parseProgress( 100 * ( crtSnrIndex + 1 ) / SNRS_NR );
                 }
+            }
+        }
 
-                if( Dataset::FRAME_LENGTH.at( Dataset::DATASET_SOURCE_RADIOML_2018_01 ) != frameData.size() )
-                {
-                    status = false;
-                    break;
-                }
-
-                signalData.frameDataVec.push_back( frameData );
-                i = j - 2;
-
-                if( i
-               && ( 0 == ( i + 2 ) % NR_ELEMENTS_PER_MOD_SNR )
-                  )
-                {
-                    if( Dataset::FRAMES_PER_MOD_SNR_NR.at( Dataset::DATASET_SOURCE_RADIOML_2018_01 ) != signalData.frameDataVec.size() )
-                    {
-                        status = false;
-                        break;
-                    }
+        reader.close();
 
-                    mMap.insert( std::pair<Dataset::ModulationSnrPair, Dataset::SignalData>( modSnrPair, signalData ) );
-                }
+        if( status )
+        {
+            static const char* const READ_MODE_NAMES[] = { "HDF5", "contiguous", "chunked" };
 
-                oldSnrDb = crtSnrDb;
-            }
+            mThroughputMBps = reader.getThroughputMBps();
 
-            free( fltBuf );
+            std::cout << "Read " << reader.getBytesRead() / 1048576 << " MB of " << itemData->mDataset->mFilePath
+                      << " (" << READ_MODE_NAMES[reader.getReadMode()] << ") at " << static_cast<int>( mThroughputMBps ) << " MB/s" << std::endl;
         }
-
-        H5Dclose( datasetId );
-        H5Sclose( spaceId );
-        H5Tclose( datatypeId );
-        H5Tclose( nativeDatatypeId );
-        H5Fclose( fileId );
     }
 
     return status;
@@ -628,12 +649,15 @@ bool Hdf5Parser::loadTreeItem
 
 
 //!************************************************************************
-//! Parse a dataset
+//! Parse a HDF5 file using the RadioML 2018.01 dataset syntax.
+//! All modulations are loaded, in one sequential pass over the file.
 //!
 //! @returns nothing
 //!************************************************************************
 /* slot */ void Hdf5Parser::parseDataset()
 {
+    mStatus = parseHdf5( true );
+    emit parseFinished();
 }
 
 
@@ -644,12 +668,30 @@ bool Hdf5Parser::loadTreeItem
 //! @returns nothing
 //!************************************************************************
 /* slot */ void Hdf5Parser::parseDatasetSingleModulation()
+{
+    mStatus = parseHdf5( false );
+    emit parseFinished();
+}
+
+
+//!************************************************************************
+//! Parse a HDF5 file using the RadioML 2018.01 dataset syntax
+//!
+//! @returns true if the file could be parsed
+//!************************************************************************
+bool Hdf5Parser::parseHdf5
+    (
+    const bool      aAllModulations     //!< true to load all modulations
+    )
 {
     mUniqueModVec.clear();
     mUniqueSnrVec.clear();
+    mBlockVec.clear();
+    mLocationVec.clear();
     mMap.clear();
+    mThroughputMBps = 0;
 
-    bool parseFailed = ( Modulation::NAME_UNKNOWN == mSingleModulation );
+    bool parseFailed = !aAllModulations && ( Modulation::NAME_UNKNOWN == mSingleModulation );
 
     if( !parseFailed )
     {
@@ -680,16 +722,34 @@ bool Hdf5Parser::loadTreeItem
 
     if( !parseFailed )
     {
-        // 2555904 = 4096 * 24 * 26
-        const size_t ROWS_EXPECTED_NR = Dataset::FRAMES_PER_MOD_SNR_NR.at( Dataset::DATASET_SOURCE_RADIOML_2018_01 )
-                                      * Dataset::MODULATIONS_NR.at( Dataset::DATASET_SOURCE_RADIOML_2018_01 )
-                                      * Dataset::SNRS_NR.at( Dataset::DATASET_SOURCE_RADIOML_2018_01 );
+        const size_t BLOCKS_NR = Dataset::MODULATIONS_NR.at( Dataset::DATASET_SOURCE_RADIOML_2018_01 )
+                               * Dataset::SNRS_NR.at( Dataset::DATASET_SOURCE_RADIOML_2018_01 );
+
+        // the frames per block follow from the rows of X, 4096 in the
+        // original dataset: 2555904 = 4096 * 24 * 26
+        mFramesNr = 0;
+
+        for( int i = 0; i < mRootItem->getChildCount(); i++ )
+        {
+            QVariant qvData = mRootItem->getChild( i )->getData();
+            Hdf5ItemData* crtChildData = qvData.value<Hdf5ItemData*>();
+
+            if( "X" == crtChildData->mItemName && crtChildData->mDataset->mDimensionsVec.size() )
+            {
+                const hsize_t ROWS_NR = crtChildData->mDataset->mDimensionsVec.at( 0 );
+                mFramesNr = ( 0 == ROWS_NR % BLOCKS_NR ) ? ROWS_NR / BLOCKS_NR : 0;
+            }
+        }
+
+        const size_t ROWS_EXPECTED_NR = mFramesNr * BLOCKS_NR;
+
+        parseFailed = ( 0 == mFramesNr );
 
         bool foundX = false;
         bool foundY = false;
         bool foundZ = false;
 
-        for( int i = 0; i < mRootItem->getChildCount(); i++ )
+        for( int i = 0; !parseFailed && i < mRootItem->getChildCount(); i++ )
         {
             Hdf5TreeItem* crtChild = mRootItem->getChild( i );
             QVariant qvData = crtChild->getData();
@@ -718,7 +778,7 @@ bool Hdf5Parser::loadTreeItem
                     break;
                 }
 
-                parseFailed = !loadTreeItem( crtChild );
+                parseFailed = !loadTreeItem( crtChild, aAllModulations );
                 foundX = !parseFailed;
             }
             else if( "Y" == childName ) // matrix of modulations
@@ -772,16 +832,120 @@ bool Hdf5Parser::loadTreeItem
         parseFailed = parseFailed || !foundX || !foundY || !foundZ;
     }
 
+    buildMap( Dataset::DATASET_SOURCE_RADIOML_2018_01 );
+
     if( !parseFailed )
     {
-        removeDuplicates( mUniqueSnrVec );
-
         if( Dataset::SNRS_NR.at( Dataset::DATASET_SOURCE_RADIOML_2018_01 ) != mUniqueSnrVec.size() )
         {
             parseFailed = true;
         }
     }
 
-    mStatus = !parseFailed;
-    emit parseFinished();
+    return !parseFailed;
+}
+
+
+//!************************************************************************
+//! Read all modulation-SNR blocks of the X dataset in one sequential pass.
+//! Rows are read in batches aligned to the chunks of X, each batch going
+//! straight into the frame store of its block, so no staging buffer is
+//! needed besides the HDF5 chunk cache.
+//!
+//! @returns true if all blocks could be read
+//!************************************************************************
+bool Hdf5Parser::readAllBlocks
+    (
+    Hdf5RowReader&          aReader         //!< X reader
+    )
+{
+    const hsize_t FRAMES_NR = mFramesNr;
+    const uint16_t FRAME_LENGTH = Dataset::FRAME_LENGTH.at( Dataset::DATASET_SOURCE_RADIOML_2018_01 );
+    const size_t SNRS_NR = Dataset::SNRS_NR.at( Dataset::DATASET_SOURCE_RADIOML_2018_01 );
+
+    const hsize_t ROWS_NR = MODULATION_MAPPING.size() * SNRS_NR * FRAMES_NR;
+    const hsize_t BATCH_ROWS = getBatchRows( aReader );
+
+    for( size_t i = 0; i < MODULATION_MAPPING.size(); i++ )
+    {
+        mUniqueModVec.push_back( MODULATION_MAPPING.at( i ) );
+    }
+
+    for( size_t crtSnrIndex = 0; crtSnrIndex < SNRS_NR; crtSnrIndex++ )
+    {
+        mUniqueSnrVec.push_back( -20 + 2 * crtSnrIndex );
+    }
+
+    Dataset::ModulationSnrPair modSnrPair;
+    Dataset::SignalData signalData;
+    bool status = true;
+    hsize_t crtRow = 0;
+    int oldPercent = -1;
+
+    while( status && crtRow < ROWS_NR )
+    {
+        // rows are ordered by modulation, then by SNR, mFramesNr frames per block
+        const size_t BLOCK_INDEX = crtRow / FRAMES_NR;
+        const hsize_t BLOCK_ROW = crtRow % FRAMES_NR;
+
+        if( 0 == BLOCK_ROW )
+        {
+            modSnrPair = std::make_pair( MODULATION_MAPPING.at( BLOCK_INDEX / SNRS_NR ), -20 + 2 * static_cast<int>( BLOCK_INDEX % SNRS_NR ) );
+            signalData.maxVal = 0;
+            status = signalData.frameStore.allocate( FRAMES_NR, FRAME_LENGTH );
+        }
+
+        // a batch stays within one chunk-aligned window and within one block
+        const hsize_t BATCH_ROWS_NR = std::min( BATCH_ROWS - crtRow % BATCH_ROWS, FRAMES_NR - BLOCK_ROW );
+
+        if( status )
+        {
+            status = aReader.readRows( crtRow, BATCH_ROWS_NR, signalData.frameStore.getFrame( BLOCK_ROW ), signalData.maxVal );
+        }
+
+        crtRow += BATCH_ROWS_NR;
+
+        if( status && 0 == crtRow % FRAMES_NR )
+        {
+            mBlockVec.emplace_back( modSnrPair, std::move( signalData ) );
+        }
+
+        int crtPercent = 100 * crtRow / ROWS_NR;
+
+        if( crtPercent != oldPercent )
+        {
+            emit parseProgress( crtPercent );
+            oldPercent = crtPercent;
+        }
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Read a block of rows of the X dataset into a frame store
+//!
+//! @returns true if the block could be read
+//!************************************************************************
+bool Hdf5Parser::readBlock
+    (
+    Hdf5RowReader&          aReader,        //!< X reader
+    const hsize_t           aStartRow,      //!< first row of the block
+    const hsize_t           aRowsNr,        //!< number of rows of the block
+    Dataset::SignalData&    aSignalData     //!< signal data
+    )
+{
+    const uint16_t FRAME_LENGTH = Dataset::FRAME_LENGTH.at( Dataset::DATASET_SOURCE_RADIOML_2018_01 );
+
+    aSignalData.maxVal = 0;
+
+    bool status = aSignalData.frameStore.allocate( aRowsNr, FRAME_LENGTH );
+
+    if( status )
+    {
+        status = aReader.readRows( aStartRow, aRowsNr, aSignalData.frameStore.data(), aSignalData.maxVal );
+    }
+
+    return status;
 }
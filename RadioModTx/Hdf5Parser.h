@@ -25,10 +25,13 @@ This file contains the definitions for HDF5 parser.
 #define Hdf5Parser_h
 
 #include "DatasetParser.h"
+#include "Hdf5RowReader.h"
 
 #include "hdf5.h"
 
 #include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
 
 #include <QVariant>
@@ -217,12 +220,16 @@ class Hdf5Parser : public DatasetParser
             int     type;       //!< HDF5 object type
         }Hdf5NameType;
 
+        static const hsize_t STREAM_BATCH_BYTES = 16 * 1048576;    //!< bytes read at once when streaming X
+
     //************************************************************************
     // functions
     //************************************************************************
     public:
         Hdf5Parser();
 
+        double getThroughputMBps() const;
+
     public slots:
         void parseDataset();
 
@@ -242,6 +249,11 @@ class Hdf5Parser : public DatasetParser
             haddr_t             aAddress        //!< object address
             );
 
+        static hsize_t getBatchRows
+            (
+            const Hdf5RowReader&    aReader     //!< X reader
+            );
+
         static herr_t getNameTypeCallback
             (
             hid_t               aLocationId,    //!< location ID
@@ -263,20 +275,57 @@ class Hdf5Parser : public DatasetParser
             Hdf5TreeItem*       aTreeItemParent //!< parent item in tree
             );
 
+        static bool loadBlock
+            (
+            Hdf5RowReader&                  aReader,        //!< X reader shared by the blocks of the file
+            const std::string&              aFileName,      //!< input filename
+            const std::string&              aDatasetPath,   //!< path of the X dataset
+            const Dataset::BlockLocation&   aLocation,      //!< rows of the block
+            Dataset::SignalData&            aSignalData     //!< signal data
+            );
+
         bool loadTreeItem
             (
-            Hdf5TreeItem*       aTreeItem       //!< item in tree
+            Hdf5TreeItem*       aTreeItem,      //!< item in tree
+            const bool          aAllModulations //!< true to load all modulations
+            );
+
+        bool parseHdf5
+            (
+            const bool          aAllModulations //!< true to load all modulations
+            );
+
+        bool readAllBlocks
+            (
+            Hdf5RowReader&      aReader         //!< X reader
+            );
+
+        static bool readBlock
+            (
+            Hdf5RowReader&          aReader,        //!< X reader
+            const hsize_t           aStartRow,      //!< first row of the block
+            const hsize_t           aRowsNr,        //!< number of rows of the block
+            Dataset::SignalData&    aSignalData     //!< signal data
             );
 
     signals:
         void parseFinished();
 
+        void parseProgress
+            (
+            int aPercent    //!< parsed part of the file [%]
+            );
+
     //************************************************************************
     // variables
     //************************************************************************
     private:
-        Hdf5Visit       mVisit;     //!< HDF5 visit
-        Hdf5TreeItem*   mRootItem;  //!< root item
+        static std::mutex   sHdf5Mutex;         //!< serializes the blocks loaded on demand, HDF5 not being thread safe
+
+        Hdf5Visit           mVisit;             //!< HDF5 visit
+        Hdf5TreeItem*       mRootItem;          //!< root item
+        hsize_t             mFramesNr;          //!< frames per modulation-SNR combination, from the rows of X
+        double              mThroughputMBps;    //!< read throughput of the last parse [MB/s]
 };
 
 #endif // Hdf5Parser_h
@@ -0,0 +1,609 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+/*
+Hdf5RowReader.cpp
+
+This file contains the sources for HDF5 row reader.
+*/
+
+#include "Hdf5RowReader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+
+
+//!************************************************************************
+//! Constructor
+//!************************************************************************
+Hdf5RowReader::Hdf5RowReader()
+    : mFileId( -1 )
+    , mDatasetId( -1 )
+    , mSpaceId( -1 )
+    , mFd( -1 )
+    , mReadMode( READ_MODE_HDF5 )
+    , mFrameLength( 0 )
+    , mRowsNr( 0 )
+    , mChunkRows( 1 )
+    , mDataOffset( HADDR_UNDEF )
+    , mDeflate( false )
+    , mBytesRead( 0 )
+    , mReadSeconds( 0 )
+{
+}
+
+
+//!************************************************************************
+//! Destructor
+//!************************************************************************
+Hdf5RowReader::~Hdf5RowReader()
+{
+    close();
+}
+
+
+//!************************************************************************
+//! Close the dataset and the file.
+//! The read statistics are kept until the next open.
+//!
+//! @returns nothing
+//!************************************************************************
+void Hdf5RowReader::close()
+{
+    if( mSpaceId >= 0 )
+    {
+        H5Sclose( mSpaceId );
+    }
+
+    if( mDatasetId >= 0 )
+    {
+        H5Dclose( mDatasetId );
+    }
+
+    if( mFileId >= 0 )
+    {
+        H5Fclose( mFileId );
+    }
+
+    if( mFd >= 0 )
+    {
+        ::close( mFd );
+    }
+
+    mFileId = -1;
+    mDatasetId = -1;
+    mSpaceId = -1;
+    mFd = -1;
+}
+
+
+//!************************************************************************
+//! Get the number of bytes delivered since the last open
+//!
+//! @returns The number of bytes read
+//!************************************************************************
+uint64_t Hdf5RowReader::getBytesRead() const
+{
+    return mBytesRead;
+}
+
+
+//!************************************************************************
+//! Get the number of rows per chunk
+//!
+//! @returns The number of rows per chunk, 1 if the dataset is not chunked
+//!************************************************************************
+hsize_t Hdf5RowReader::getChunkRows() const
+{
+    return mChunkRows;
+}
+
+
+//!************************************************************************
+//! Get the read mode selected at open
+//!
+//! @returns The read mode
+//!************************************************************************
+Hdf5RowReader::ReadMode Hdf5RowReader::getReadMode() const
+{
+    return mReadMode;
+}
+
+
+//!************************************************************************
+//! Get the number of rows of the dataset
+//!
+//! @returns The number of rows
+//!************************************************************************
+hsize_t Hdf5RowReader::getRowsNr() const
+{
+    return mRowsNr;
+}
+
+
+//!************************************************************************
+//! Get the read throughput since the last open
+//!
+//! @returns The throughput [MB/s], 0 if nothing was read
+//!************************************************************************
+double Hdf5RowReader::getThroughputMBps() const
+{
+    return mReadSeconds > 0 ? mBytesRead / 1048576.0 / mReadSeconds : 0;
+}
+
+
+//!************************************************************************
+//! Check if the dataset is open
+//!
+//! @returns true if the dataset is open
+//!************************************************************************
+bool Hdf5RowReader::isOpen() const
+{
+    return mFileId >= 0;
+}
+
+
+//!************************************************************************
+//! Open a dataset and select the read mode from its storage layout.
+//! For chunked datasets the raw data chunk cache is sized after the
+//! chunks, so that a chunk shared by two consecutive reads is only
+//! fetched and decompressed once.
+//!
+//! @returns true if the dataset could be opened
+//!************************************************************************
+bool Hdf5RowReader::open
+    (
+    const std::string&      aFileName,      //!< input filename
+    const std::string&      aDatasetPath,   //!< path of the dataset
+    const uint16_t          aFrameLength    //!< frame length in (I,Q) pairs
+    )
+{
+    close();
+
+    mReadMode = READ_MODE_HDF5;
+    mFrameLength = aFrameLength;
+    mRowsNr = 0;
+    mChunkRows = 1;
+    mDataOffset = HADDR_UNDEF;
+    mDeflate = false;
+    mBytesRead = 0;
+    mReadSeconds = 0;
+
+    mFileId = H5Fopen( aFileName.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT );
+    mDatasetId = H5Dopen2( mFileId, aDatasetPath.c_str(), H5P_DEFAULT );
+    mSpaceId = H5Dget_space( mDatasetId );
+
+    bool status = ( mFileId >= 0 && mDatasetId >= 0 && mSpaceId >= 0 );
+
+    if( status )
+    {
+        hsize_t dims[3] = { 0, 0, 0 };
+
+        status = ( 3 == H5Sget_simple_extent_ndims( mSpaceId ) )
+              && ( 3 == H5Sget_simple_extent_dims( mSpaceId, dims, nullptr ) )
+              && ( dims[1] == mFrameLength )
+              && ( 2 == dims[2] );
+
+        mRowsNr = dims[0];
+    }
+
+    hid_t typeId = status ? H5Dget_type( mDatasetId ) : -1;
+    hid_t createPlistId = status ? H5Dget_create_plist( mDatasetId ) : -1;
+
+    status = status && ( typeId >= 0 ) && ( createPlistId >= 0 );
+
+    // other float formats are converted by HDF5
+    const bool NATIVE_FLOAT = status && ( H5Tequal( typeId, H5T_NATIVE_FLOAT ) > 0 );
+
+    if( status && H5D_CONTIGUOUS == H5Pget_layout( createPlistId ) )
+    {
+        mDataOffset = H5Dget_offset( mDatasetId );
+
+        if( NATIVE_FLOAT && HADDR_UNDEF != mDataOffset && 0 == H5Pget_external_count( createPlistId ) )
+        {
+            mFd = ::open( aFileName.c_str(), O_RDONLY );
+
+            if( mFd >= 0 )
+            {
+                mReadMode = READ_MODE_CONTIGUOUS;
+            }
+        }
+    }
+    else if( status && H5D_CHUNKED == H5Pget_layout( createPlistId ) )
+    {
+        hsize_t chunkDims[3] = { 1, 1, 1 };
+
+        if( 3 == H5Pget_chunk( createPlistId, 3, chunkDims ) && chunkDims[0] > 0 )
+        {
+            mChunkRows = chunkDims[0];
+
+            const int FILTERS_NR = H5Pget_nfilters( createPlistId );
+            bool fullRows = ( chunkDims[1] == mFrameLength && 2 == chunkDims[2] );
+            bool rawFilters = ( 0 == FILTERS_NR );
+
+            if( 1 == FILTERS_NR )
+            {
+                unsigned int flags = 0;
+                size_t valuesNr = 0;
+                unsigned int filterConfig = 0;
+
+                mDeflate = ( H5Z_FILTER_DEFLATE == H5Pget_filter2( createPlistId, 0, &flags, &valuesNr, nullptr, 0, nullptr, &filterConfig ) );
+                rawFilters = mDeflate;
+            }
+
+            if( NATIVE_FLOAT && fullRows && rawFilters )
+            {
+                mReadMode = READ_MODE_CHUNKED;
+            }
+
+            // size the chunk cache for the hyperslab reads
+            const size_t CHUNK_BYTES = chunkDims[0] * chunkDims[1] * chunkDims[2] * H5Tget_size( typeId );
+
+            if( CHUNK_BYTES > 0 )
+            {
+                const size_t CHUNKS_NR = ( std::max( static_cast<size_t>( CHUNK_CACHE_MIN_BYTES ), 4 * CHUNK_BYTES ) + CHUNK_BYTES - 1 ) / CHUNK_BYTES;
+                hid_t accessPlistId = H5Pcreate( H5P_DATASET_ACCESS );
+
+                if( accessPlistId >= 0 && H5Pset_chunk_cache( accessPlistId, CHUNK_CACHE_SLOTS_PER_CHUNK * CHUNKS_NR + 1, CHUNKS_NR * CHUNK_BYTES, 1.0 ) >= 0 )
+                {
+                    H5Sclose( mSpaceId );
+                    H5Dclose( mDatasetId );
+
+                    mDatasetId = H5Dopen2( mFileId, aDatasetPath.c_str(), accessPlistId );
+                    mSpaceId = H5Dget_space( mDatasetId );
+
+                    status = ( mDatasetId >= 0 && mSpaceId >= 0 );
+                }
+
+                if( accessPlistId >= 0 )
+                {
+                    H5Pclose( accessPlistId );
+                }
+            }
+        }
+    }
+
+    if( createPlistId >= 0 )
+    {
+        H5Pclose( createPlistId );
+    }
+
+    if( typeId >= 0 )
+    {
+        H5Tclose( typeId );
+    }
+
+    if( !status )
+    {
+        close();
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Read the raw chunks overlapping a range of rows and inflate them in
+//! parallel. The chunks are fetched one after the other on the calling
+//! thread, each one being handed to a worker as soon as it is read.
+//! A chunk fully covered by the range is inflated straight into place.
+//!
+//! @returns true if the rows could be read
+//!************************************************************************
+bool Hdf5RowReader::readChunked
+    (
+    const hsize_t           aStartRow,      //!< first row
+    const hsize_t           aRowsNr,        //!< number of rows
+    Dataset::IQPoint*       aPoints,        //!< destination of the rows
+    float&                  aMaxVal         //!< maximum absolute value, updated
+    )
+{
+    const size_t ROW_BYTES = mFrameLength * sizeof( Dataset::IQPoint );
+    const size_t CHUNK_BYTES = mChunkRows * ROW_BYTES;
+    const hsize_t END_ROW = aStartRow + aRowsNr;
+    const hsize_t FIRST_CHUNK = aStartRow / mChunkRows;
+    const hsize_t LAST_CHUNK = ( END_ROW - 1 ) / mChunkRows;
+
+    std::vector<float> maxValVec( LAST_CHUNK - FIRST_CHUNK + 1, 0 );
+    std::atomic<bool> inflateFailed( false );
+    bool status = true;
+
+    for( hsize_t crtChunk = FIRST_CHUNK; status && crtChunk <= LAST_CHUNK; crtChunk++ )
+    {
+        const hsize_t CHUNK_ROW = crtChunk * mChunkRows;
+        const hsize_t FIRST_ROW = std::max( aStartRow, CHUNK_ROW );
+        const hsize_t ROWS_NR = std::min( END_ROW, CHUNK_ROW + mChunkRows ) - FIRST_ROW;
+
+        Dataset::IQPoint* destination = aPoints + ( FIRST_ROW - aStartRow ) * mFrameLength;
+        float* maxValSlot = &maxValVec.at( crtChunk - FIRST_CHUNK );
+
+        hsize_t offset[3] = { CHUNK_ROW, 0, 0 };
+        hsize_t storedBytes = 0;
+
+        status = ( H5Dget_chunk_storage_size( mDatasetId, offset, &storedBytes ) >= 0 );
+
+        if( status && 0 == storedBytes )
+        {
+            // chunk never written, HDF5 supplies the fill value
+            status = readHdf5( FIRST_ROW, ROWS_NR, destination, *maxValSlot );
+        }
+        else if( status )
+        {
+            std::shared_ptr<std::vector<unsigned char>> stored = std::make_shared<std::vector<unsigned char>>( storedBytes );
+            uint32_t filterMask = 0;
+
+            status = ( H5Dread_chunk( mDatasetId, H5P_DEFAULT, offset, &filterMask, stored->data() ) >= 0 );
+
+            if( status )
+            {
+                // bit 0 of the mask is set when deflate was skipped for this chunk
+                const bool INFLATE = mDeflate && 0 == ( filterMask & 1 );
+                const size_t SKIP_BYTES = ( FIRST_ROW - CHUNK_ROW ) * ROW_BYTES;
+                const size_t COPY_BYTES = ROWS_NR * ROW_BYTES;
+
+                mWorkerPool.submit( [stored, INFLATE, SKIP_BYTES, COPY_BYTES, CHUNK_BYTES, destination, maxValSlot, &inflateFailed]()
+                {
+                    bool inflated = true;
+
+                    if( INFLATE && COPY_BYTES == CHUNK_BYTES )
+                    {
+                        uLongf length = CHUNK_BYTES;
+                        inflated = ( Z_OK == uncompress( reinterpret_cast<Bytef*>( destination ), &length, stored->data(), stored->size() ) )
+                                && ( CHUNK_BYTES == length );
+                    }
+                    else if( INFLATE )
+                    {
+                        std::vector<unsigned char> chunk( CHUNK_BYTES );
+                        uLongf length = CHUNK_BYTES;
+                        inflated = ( Z_OK == uncompress( chunk.data(), &length, stored->data(), stored->size() ) )
+                                && ( SKIP_BYTES + COPY_BYTES <= length );
+
+                        if( inflated )
+                        {
+                            memcpy( destination, chunk.data() + SKIP_BYTES, COPY_BYTES );
+                        }
+                    }
+                    else
+                    {
+                        inflated = ( SKIP_BYTES + COPY_BYTES <= stored->size() );
+
+                        if( inflated )
+                        {
+                            memcpy( destination, stored->data() + SKIP_BYTES, COPY_BYTES );
+                        }
+                    }
+
+                    if( inflated )
+                    {
+                        *maxValSlot = scanMaxVal( destination, COPY_BYTES / sizeof( Dataset::IQPoint ) );
+                    }
+                    else
+                    {
+                        inflateFailed = true;
+                    }
+                });
+            }
+        }
+    }
+
+    // the tasks point into maxValVec, so they must all be done even on failure
+    mWorkerPool.wait();
+
+    status = status && !inflateFailed;
+
+    if( status )
+    {
+        aMaxVal = std::max( aMaxVal, *std::max_element( maxValVec.begin(), maxValVec.end() ) );
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Read a range of rows of a contiguous dataset straight from the file.
+//! The range is split in equal parts, each one read by a worker.
+//!
+//! @returns true if the rows could be read
+//!************************************************************************
+bool Hdf5RowReader::readContiguous
+    (
+    const hsize_t           aStartRow,      //!< first row
+    const hsize_t           aRowsNr,        //!< number of rows
+    Dataset::IQPoint*       aPoints,        //!< destination of the rows
+    float&                  aMaxVal         //!< maximum absolute value, updated
+    )
+{
+    const size_t ROW_BYTES = mFrameLength * sizeof( Dataset::IQPoint );
+    const size_t PARTS_NR = std::max<size_t>( 1, std::min<size_t>( mWorkerPool.getThreadsNr(), aRowsNr * ROW_BYTES / CONTIGUOUS_SPLIT_MIN_BYTES ) );
+    const hsize_t PART_ROWS = ( aRowsNr + PARTS_NR - 1 ) / PARTS_NR;
+
+    std::vector<float> maxValVec( PARTS_NR, 0 );
+    std::atomic<bool> readFailed( false );
+
+    for( size_t crtPart = 0; crtPart < PARTS_NR; crtPart++ )
+    {
+        const hsize_t FIRST_ROW = crtPart * PART_ROWS;
+
+        if( FIRST_ROW >= aRowsNr )
+        {
+            break;
+        }
+
+        const size_t BYTES_NR = ( std::min( aRowsNr, FIRST_ROW + PART_ROWS ) - FIRST_ROW ) * ROW_BYTES;
+        const off_t FILE_OFFSET = mDataOffset + ( aStartRow + FIRST_ROW ) * ROW_BYTES;
+        const int FD = mFd;
+
+        char* destination = reinterpret_cast<char*>( aPoints + FIRST_ROW * mFrameLength );
+        float* maxValSlot = &maxValVec.at( crtPart );
+
+        mWorkerPool.submit( [FD, FILE_OFFSET, BYTES_NR, destination, maxValSlot, &readFailed]()
+        {
+            size_t doneBytes = 0;
+
+            while( doneBytes < BYTES_NR )
+            {
+                ssize_t crtBytes = pread( FD, destination + doneBytes, BYTES_NR - doneBytes, FILE_OFFSET + doneBytes );
+
+                if( crtBytes <= 0 )
+                {
+                    break;
+                }
+
+                doneBytes += crtBytes;
+            }
+
+            if( BYTES_NR == doneBytes )
+            {
+                *maxValSlot = scanMaxVal( reinterpret_cast<const Dataset::IQPoint*>( destination ), BYTES_NR / sizeof( Dataset::IQPoint ) );
+            }
+            else
+            {
+                readFailed = true;
+            }
+        });
+    }
+
+    mWorkerPool.wait();
+
+    if( !readFailed )
+    {
+        aMaxVal = std::max( aMaxVal, *std::max_element( maxValVec.begin(), maxValVec.end() ) );
+    }
+
+    return !readFailed;
+}
+
+
+//!************************************************************************
+//! Read a range of rows through a hyperslab selection.
+//! Each row is a frame of (I,Q) pairs, laid out exactly as in the
+//! frame store, so the rows are read straight to their destination.
+//!
+//! @returns true if the rows could be read
+//!************************************************************************
+bool Hdf5RowReader::readHdf5
+    (
+    const hsize_t           aStartRow,      //!< first row
+    const hsize_t           aRowsNr,        //!< number of rows
+    Dataset::IQPoint*       aPoints,        //!< destination of the rows
+    float&                  aMaxVal         //!< maximum absolute value, updated
+    )
+{
+    const hsize_t ROWS_DIMS[3] = { aRowsNr, mFrameLength, 2 };
+    const hsize_t START[3] = { aStartRow, 0, 0 };
+
+    hid_t memSpaceId = H5Screate_simple( 3, ROWS_DIMS, nullptr );
+
+    bool status = ( memSpaceId >= 0 )
+               && ( H5Sselect_hyperslab( mSpaceId, H5S_SELECT_SET, START, nullptr, ROWS_DIMS, nullptr ) >= 0 );
+
+    if( status )
+    {
+        status = ( H5Dread( mDatasetId, H5T_NATIVE_FLOAT, memSpaceId, mSpaceId, H5P_DEFAULT, aPoints ) >= 0 );
+    }
+
+    if( status )
+    {
+        aMaxVal = std::max( aMaxVal, scanMaxVal( aPoints, aRowsNr * mFrameLength ) );
+    }
+
+    H5Sclose( memSpaceId );
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Read a range of rows into consecutive frames
+//!
+//! @returns true if the rows could be read
+//!************************************************************************
+bool Hdf5RowReader::readRows
+    (
+    const hsize_t           aStartRow,      //!< first row
+    const hsize_t           aRowsNr,        //!< number of rows
+    Dataset::IQPoint*       aPoints,        //!< destination of the rows
+    float&                  aMaxVal         //!< maximum absolute value, updated
+    )
+{
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    bool status = ( mDatasetId >= 0 && aRowsNr > 0 && aStartRow + aRowsNr <= mRowsNr );
+
+    if( status )
+    {
+        switch( mReadMode )
+        {
+            case READ_MODE_CONTIGUOUS:
+                status = readContiguous( aStartRow, aRowsNr, aPoints, aMaxVal );
+                break;
+
+            case READ_MODE_CHUNKED:
+                status = readChunked( aStartRow, aRowsNr, aPoints, aMaxVal );
+                break;
+
+            default:
+                status = readHdf5( aStartRow, aRowsNr, aPoints, aMaxVal );
+                break;
+        }
+    }
+
+    if( status )
+    {
+        mBytesRead += aRowsNr * mFrameLength * sizeof( Dataset::IQPoint );
+        mReadSeconds += std::chrono::duration<double>( std::chrono::steady_clock::now() - startTime ).count();
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Get the maximum absolute value of a range of points
+//!
+//! @returns The maximum absolute value
+//!************************************************************************
+float Hdf5RowReader::scanMaxVal
+    (
+    const Dataset::IQPoint* aPoints,        //!< first point
+    const size_t            aPointsNr       //!< number of points
+    )
+{
+    const float* values = reinterpret_cast<const float*>( aPoints );
+    const size_t VALUES_NR = 2 * aPointsNr;
+    float maxVal = 0;
+
+    for( size_t i = 0; i < VALUES_NR; i++ )
+    {
+        if( fabs( values[i] ) > maxVal )
+        {
+            maxVal = fabs( values[i] );
+        }
+    }
+
+    return maxVal;
+}
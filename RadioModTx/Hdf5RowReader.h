@@ -0,0 +1,162 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+/*
+Hdf5RowReader.h
+
+This file contains the definitions for HDF5 row reader.
+*/
+
+#ifndef Hdf5RowReader_h
+#define Hdf5RowReader_h
+
+#include "Dataset.h"
+#include "WorkerPool.h"
+
+#include "hdf5.h"
+
+#include <cstdint>
+#include <string>
+
+
+//************************************************************************
+// Class for reading rows of a 3D float dataset (rows x frame length x 2),
+// such as the X dataset of RadioML 2018.01, into (I,Q) frames.
+//
+// The read mode is chosen from the storage layout of the dataset:
+//  - contiguous: the rows are read with pread() straight from the file
+//  - chunked, with no filter or deflate only: the raw chunks are read
+//    through HDF5 and inflated in parallel
+//  - anything else: hyperslab reads through HDF5
+//
+// HDF5 itself is only called from the thread owning the reader, only the
+// file reads, decompression and conversion are spread over the workers.
+//************************************************************************
+class Hdf5RowReader
+{
+    //************************************************************************
+    // constants and types
+    //************************************************************************
+    public:
+        typedef enum
+        {
+            READ_MODE_HDF5,
+            READ_MODE_CONTIGUOUS,
+            READ_MODE_CHUNKED
+        }ReadMode;
+
+    private:
+        static const size_t CHUNK_CACHE_MIN_BYTES = 32 * 1048576;      //!< minimum raw data chunk cache [bytes]
+        static const size_t CHUNK_CACHE_SLOTS_PER_CHUNK = 100;         //!< hash slots per cached chunk
+        static const size_t CONTIGUOUS_SPLIT_MIN_BYTES = 1048576;      //!< minimum bytes read by one worker
+
+
+    //************************************************************************
+    // functions
+    //************************************************************************
+    public:
+        Hdf5RowReader();
+
+        ~Hdf5RowReader();
+
+        Hdf5RowReader( const Hdf5RowReader& ) = delete;
+        Hdf5RowReader& operator=( const Hdf5RowReader& ) = delete;
+
+        void close();
+
+        uint64_t getBytesRead() const;
+
+        hsize_t getChunkRows() const;
+
+        ReadMode getReadMode() const;
+
+        hsize_t getRowsNr() const;
+
+        double getThroughputMBps() const;
+
+        bool isOpen() const;
+
+        bool open
+            (
+            const std::string&      aFileName,      //!< input filename
+            const std::string&      aDatasetPath,   //!< path of the dataset
+            const uint16_t          aFrameLength    //!< frame length in (I,Q) pairs
+            );
+
+        bool readRows
+            (
+            const hsize_t           aStartRow,      //!< first row
+            const hsize_t           aRowsNr,        //!< number of rows
+            Dataset::IQPoint*       aPoints,        //!< destination of the rows
+            float&                  aMaxVal         //!< maximum absolute value, updated
+            );
+
+    private:
+        bool readChunked
+            (
+            const hsize_t           aStartRow,      //!< first row
+            const hsize_t           aRowsNr,        //!< number of rows
+            Dataset::IQPoint*       aPoints,        //!< destination of the rows
+            float&                  aMaxVal         //!< maximum absolute value, updated
+            );
+
+        bool readContiguous
+            (
+            const hsize_t           aStartRow,      //!< first row
+            const hsize_t           aRowsNr,        //!< number of rows
+            Dataset::IQPoint*       aPoints,        //!< destination of the rows
+            float&                  aMaxVal         //!< maximum absolute value, updated
+            );
+
+        bool readHdf5
+            (
+            const hsize_t           aStartRow,      //!< first row
+            const hsize_t           aRowsNr,        //!< number of rows
+            Dataset::IQPoint*       aPoints,        //!< destination of the rows
+            float&                  aMaxVal         //!< maximum absolute value, updated
+            );
+
+        static float scanMaxVal
+            (
+            const Dataset::IQPoint* aPoints,        //!< first point
+            const size_t            aPointsNr       //!< number of points
+            );
+
+
+    //************************************************************************
+    // variables
+    //************************************************************************
+    private:
+        hid_t           mFileId;            //!< HDF5 file ID
+        hid_t           mDatasetId;         //!< HDF5 dataset ID
+        hid_t           mSpaceId;           //!< HDF5 dataspace ID
+        int             mFd;                //!< file descriptor for contiguous reads
+
+        ReadMode        mReadMode;          //!< read mode
+        uint16_t        mFrameLength;       //!< frame length in (I,Q) pairs
+        hsize_t         mRowsNr;            //!< number of rows of the dataset
+        hsize_t         mChunkRows;         //!< rows per chunk, 1 if not chunked
+        haddr_t         mDataOffset;        //!< file offset of contiguous data [bytes]
+        bool            mDeflate;           //!< true if chunks are deflated
+
+        uint64_t        mBytesRead;         //!< bytes delivered by readRows()
+        double          mReadSeconds;       //!< time spent in readRows() [s]
+
+        WorkerPool      mWorkerPool;        //!< workers for reading and inflating
+};
+
+#endif // Hdf5RowReader_h
@@ -26,7 +26,9 @@ This file contains the sources for modulation.
 #include <iostream>
 #include <iterator>
 
-#include <QMessageBox>
+#ifdef QT_WIDGETS_LIB
+    #include <QMessageBox>
+#endif
 
 
 Modulation* Modulation::sInstance = nullptr;
@@ -104,10 +106,14 @@ Modulation::Modulation()
 
     if( !verifyAliasNames( duplicate ) )
     {
+#ifdef QT_WIDGETS_LIB
         QMessageBox msgBox;
         msgBox.setWindowTitle( "Modulation names - duplicate" );
         msgBox.setText( "The name \"" + QString::fromStdString( duplicate ) + "\" appears in more than one place." );
         msgBox.exec();
+#else
+        std::cout << "Modulation names - duplicate: the name \"" << duplicate << "\" appears in more than one place." << std::endl;
+#endif
     }
 }
 
@@ -0,0 +1,688 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+/*
+PklDecoder.cpp
+
+This file contains the sources for pickle decoder.
+*/
+
+#include "PklDecoder.h"
+
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+//!************************************************************************
+//! Constructor
+//!************************************************************************
+PklDecoder::PklDecoder()
+    : mData( nullptr )
+    , mSize( 0 )
+    , mPos( 0 )
+{
+}
+
+
+//!************************************************************************
+//! Decode a pickle file, calling the handler for each dict item.
+//! The items point into the mapped file, which is only valid during the
+//! handler call.
+//!
+//! @returns true if the whole file could be decoded
+//!************************************************************************
+bool PklDecoder::decode
+    (
+    const std::string&      aFileName,      //!< input filename
+    const ItemHandler&      aHandler        //!< called for each dict item
+    )
+{
+    int fd = open( aFileName.c_str(), O_RDONLY );
+    struct stat fileStat;
+    void* mapAddr = MAP_FAILED;
+
+    bool status = ( fd >= 0 )
+               && ( 0 == fstat( fd, &fileStat ) )
+               && ( fileStat.st_size > 0 );
+
+    if( status )
+    {
+        mapAddr = mmap( nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+        status = ( MAP_FAILED != mapAddr );
+    }
+
+    if( status )
+    {
+        madvise( mapAddr, fileStat.st_size, MADV_SEQUENTIAL );
+
+        mData = static_cast<const unsigned char*>( mapAddr );
+        mSize = fileStat.st_size;
+        mPos = 0;
+
+        status = decodeBuffer( aHandler );
+
+        mStack.clear();
+        mMarkVec.clear();
+        mMemoMap.clear();
+
+        mData = nullptr;
+        mSize = 0;
+
+        munmap( mapAddr, fileStat.st_size );
+    }
+
+    if( fd >= 0 )
+    {
+        close( fd );
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Run the pickle machine over the mapped file
+//!
+//! @returns true if the file could be decoded up to STOP
+//!************************************************************************
+bool PklDecoder::decodeBuffer
+    (
+    const ItemHandler&      aHandler        //!< called for each dict item
+    )
+{
+    bool status = true;
+    bool stopped = false;
+
+    while( status && !stopped )
+    {
+        const unsigned char* bytes = nullptr;
+        status = take( 1, bytes );
+
+        const unsigned char OPCODE = status ? bytes[0] : 0;
+        size_t lengthBytes = 0;
+
+        if( status )
+        {
+            switch( OPCODE )
+            {
+                case OP_PROTO:
+                    status = take( 1, bytes );
+                    break;
+
+                case OP_FRAME:
+                    status = take( 8, bytes );
+                    break;
+
+                case OP_STOP:
+                    stopped = true;
+                    break;
+
+                case OP_MARK:
+                    mMarkVec.push_back( mStack.size() );
+                    break;
+
+                case OP_EMPTY_DICT:
+                    mStack.push_back( makeValue( VALUE_DICT ) );
+                    break;
+
+                case OP_EMPTY_TUPLE:
+                    mStack.push_back( makeValue( VALUE_TUPLE ) );
+                    break;
+
+                case OP_NONE:
+                    mStack.push_back( makeValue( VALUE_NONE ) );
+                    break;
+
+                case OP_NEWTRUE:
+                case OP_NEWFALSE:
+                {
+                    ValuePtr value = makeValue( VALUE_BOOL );
+                    value->intVal = ( OP_NEWTRUE == OPCODE );
+                    mStack.push_back( value );
+                    break;
+                }
+
+                case OP_BININT:
+                case OP_BININT1:
+                case OP_BININT2:
+                {
+                    const size_t BYTES_NR = ( OP_BININT == OPCODE ) ? 4 : ( ( OP_BININT2 == OPCODE ) ? 2 : 1 );
+                    status = take( BYTES_NR, bytes );
+
+                    if( status )
+                    {
+                        ValuePtr value = makeValue( VALUE_INT );
+                        value->intVal = readLe( bytes, BYTES_NR );
+
+                        // BININT is the only signed one
+                        if( OP_BININT == OPCODE )
+                        {
+                            value->intVal = static_cast<int32_t>( static_cast<uint32_t>( value->intVal ) );
+                        }
+
+                        mStack.push_back( value );
+                    }
+                    break;
+                }
+
+                case OP_LONG1:
+                {
+                    status = take( 1, bytes );
+                    const size_t BYTES_NR = status ? bytes[0] : 0;
+                    status = status && ( BYTES_NR <= 8 ) && take( BYTES_NR, bytes );
+
+                    if( status )
+                    {
+                        ValuePtr value = makeValue( VALUE_INT );
+                        value->intVal = readLe( bytes, BYTES_NR );
+
+                        if( BYTES_NR > 0 && BYTES_NR < 8 && ( bytes[BYTES_NR - 1] & 0x80 ) )
+                        {
+                            value->intVal -= static_cast<int64_t>( 1 ) << ( 8 * BYTES_NR );
+                        }
+
+                        mStack.push_back( value );
+                    }
+                    break;
+                }
+
+                case OP_SHORT_BINSTRING:
+                case OP_SHORT_BINBYTES:
+                case OP_SHORT_BINUNICODE:
+                    lengthBytes = 1;
+                    break;
+
+                case OP_BINSTRING:
+                case OP_BINBYTES:
+                case OP_BINUNICODE:
+                    lengthBytes = 4;
+                    break;
+
+                case OP_BINBYTES8:
+                case OP_BINUNICODE8:
+                    lengthBytes = 8;
+                    break;
+
+                case OP_GLOBAL:
+                {
+                    std::string name;
+
+                    for( int line = 0; status && line < 2; line++ )
+                    {
+                        const unsigned char* lineEnd = static_cast<const unsigned char*>( memchr( mData + mPos, '\n', mSize - mPos ) );
+                        status = ( nullptr != lineEnd );
+
+                        if( status )
+                        {
+                            const size_t LINE_LENGTH = lineEnd - ( mData + mPos );
+                            take( LINE_LENGTH + 1, bytes );
+                            name += ( line ? "." : "" ) + std::string( reinterpret_cast<const char*>( bytes ), LINE_LENGTH );
+                        }
+                    }
+
+                    if( status )
+                    {
+                        ValuePtr value = makeValue( VALUE_GLOBAL );
+                        value->ownedStr = name;
+                        mStack.push_back( value );
+                    }
+                    break;
+                }
+
+                case OP_STACK_GLOBAL:
+                {
+                    status = ( mStack.size() >= 2 )
+                          && ( VALUE_STRING == mStack.at( mStack.size() - 2 )->type )
+                          && ( VALUE_STRING == mStack.back()->type );
+
+                    if( status )
+                    {
+                        ValuePtr nameValue = mStack.back();
+                        mStack.pop_back();
+                        ValuePtr moduleValue = mStack.back();
+                        mStack.pop_back();
+
+                        ValuePtr value = makeValue( VALUE_GLOBAL );
+                        value->ownedStr = std::string( reinterpret_cast<const char*>( moduleValue->bytes ), moduleValue->bytesNr )
+                                        + "." + std::string( reinterpret_cast<const char*>( nameValue->bytes ), nameValue->bytesNr );
+                        mStack.push_back( value );
+                    }
+                    break;
+                }
+
+                case OP_BINPUT:
+                case OP_LONG_BINPUT:
+                {
+                    const size_t BYTES_NR = ( OP_BINPUT == OPCODE ) ? 1 : 4;
+                    status = take( BYTES_NR, bytes ) && mStack.size();
+
+                    if( status )
+                    {
+                        mMemoMap[readLe( bytes, BYTES_NR )] = mStack.back();
+                    }
+                    break;
+                }
+
+                case OP_MEMOIZE:
+                    status = ( mStack.size() > 0 );
+
+                    if( status )
+                    {
+                        mMemoMap[mMemoMap.size()] = mStack.back();
+                    }
+                    break;
+
+                case OP_BINGET:
+                case OP_LONG_BINGET:
+                {
+                    const size_t BYTES_NR = ( OP_BINGET == OPCODE ) ? 1 : 4;
+                    status = take( BYTES_NR, bytes );
+
+                    if( status )
+                    {
+                        auto it = mMemoMap.find( readLe( bytes, BYTES_NR ) );
+                        status = ( mMemoMap.end() != it );
+
+                        if( status )
+                        {
+                            mStack.push_back( it->second );
+                        }
+                    }
+                    break;
+                }
+
+                case OP_TUPLE:
+                {
+                    ValuePtr value = makeValue( VALUE_TUPLE );
+                    status = popMark( value->itemVec );
+
+                    if( status )
+                    {
+                        mStack.push_back( value );
+                    }
+                    break;
+                }
+
+                case OP_TUPLE1:
+                case OP_TUPLE2:
+                case OP_TUPLE3:
+                {
+                    const size_t ITEMS_NR = OPCODE - OP_TUPLE1 + 1;
+                    status = ( mStack.size() >= ITEMS_NR );
+
+                    if( status )
+                    {
+                        ValuePtr value = makeValue( VALUE_TUPLE );
+                        value->itemVec.assign( mStack.end() - ITEMS_NR, mStack.end() );
+                        mStack.resize( mStack.size() - ITEMS_NR );
+                        mStack.push_back( value );
+                    }
+                    break;
+                }
+
+                case OP_REDUCE:
+                {
+                    status = ( mStack.size() >= 2 );
+
+                    if( status )
+                    {
+                        ValuePtr args = mStack.back();
+                        mStack.pop_back();
+                        ValuePtr callable = mStack.back();
+                        mStack.pop_back();
+
+                        ValuePtr result;
+                        status = reduce( callable, args, result );
+
+                        if( status )
+                        {
+                            mStack.push_back( result );
+                        }
+                    }
+                    break;
+                }
+
+                case OP_BUILD:
+                {
+                    status = ( mStack.size() >= 2 ) && ( VALUE_TUPLE == mStack.back()->type );
+
+                    if( status )
+                    {
+                        ValuePtr state = mStack.back();
+                        mStack.pop_back();
+
+                        ValuePtr object = mStack.back();
+                        status = ( VALUE_NDARRAY == object->type || VALUE_DTYPE == object->type );
+
+                        if( status )
+                        {
+                            object->stateVec = state->itemVec;
+                        }
+                    }
+                    break;
+                }
+
+                case OP_SETITEM:
+                case OP_SETITEMS:
+                {
+                    std::vector<ValuePtr> itemVec;
+
+                    if( OP_SETITEM == OPCODE )
+                    {
+                        status = ( mStack.size() >= 3 );
+
+                        if( status )
+                        {
+                            itemVec.assign( mStack.end() - 2, mStack.end() );
+                            mStack.resize( mStack.size() - 2 );
+                        }
+                    }
+                    else
+                    {
+                        status = popMark( itemVec );
+                    }
+
+                    status = status && ( 0 == itemVec.size() % 2 ) && mStack.size() && ( VALUE_DICT == mStack.back()->type );
+
+                    // the items are handed over rather than stored in the dict
+                    for( size_t i = 0; status && i < itemVec.size(); i += 2 )
+                    {
+                        ArrayItem item;
+                        status = getArrayItem( itemVec.at( i ), itemVec.at( i + 1 ), item ) && aHandler( item );
+                    }
+                    break;
+                }
+
+                default:
+                    status = false;
+                    break;
+            }
+        }
+
+        if( status && lengthBytes )
+        {
+            status = take( lengthBytes, bytes );
+
+            const uint64_t LENGTH = status ? readLe( bytes, lengthBytes ) : 0;
+
+            // BINSTRING has a signed length
+            status = status && !( OP_BINSTRING == OPCODE && LENGTH > INT32_MAX ) && take( LENGTH, bytes );
+
+            if( status )
+            {
+                ValuePtr value = makeValue( VALUE_STRING );
+                value->bytes = bytes;
+                value->bytesNr = LENGTH;
+                mStack.push_back( value );
+            }
+        }
+    }
+
+    return status && stopped && ( 1 == mStack.size() ) && ( VALUE_DICT == mStack.back()->type );
+}
+
+
+//!************************************************************************
+//! Check a dict item against the (modulation, SNR) -> float32 array layout
+//!
+//! @returns true if the item has the expected layout
+//!************************************************************************
+bool PklDecoder::getArrayItem
+    (
+    const ValuePtr&         aKey,           //!< dict key
+    const ValuePtr&         aValue,         //!< dict value
+    ArrayItem&              aItem           //!< array item
+    ) const
+{
+    // key: (str, int)
+    bool status = ( VALUE_TUPLE == aKey->type )
+               && ( 2 == aKey->itemVec.size() )
+               && ( VALUE_STRING == aKey->itemVec.at( 0 )->type )
+               && ( VALUE_INT == aKey->itemVec.at( 1 )->type );
+
+    // value state: (version, shape, dtype, is Fortran order, raw data)
+    status = status
+          && ( VALUE_NDARRAY == aValue->type )
+          && ( 5 == aValue->stateVec.size() )
+          && ( VALUE_TUPLE == aValue->stateVec.at( 1 )->type )
+          && ( VALUE_DTYPE == aValue->stateVec.at( 2 )->type )
+          && ( 0 == aValue->stateVec.at( 3 )->intVal )
+          && ( VALUE_STRING == aValue->stateVec.at( 4 )->type );
+
+    if( status )
+    {
+        const ValuePtr& DTYPE = aValue->stateVec.at( 2 );
+        const ValuePtr& DTYPE_NAME = DTYPE->itemVec.at( 0 );
+
+        status = ( 2 == DTYPE_NAME->bytesNr && 0 == memcmp( DTYPE_NAME->bytes, "f4", 2 ) );
+
+        // dtype state: (version, byte order, ...)
+        if( status && DTYPE->stateVec.size() >= 2 )
+        {
+            const ValuePtr& ORDER_CHAR = DTYPE->stateVec.at( 1 );
+
+            status = ( VALUE_STRING == ORDER_CHAR->type )
+                  && ( 1 == ORDER_CHAR->bytesNr )
+                  && ( '<' == ORDER_CHAR->bytes[0] || '=' == ORDER_CHAR->bytes[0] );
+        }
+    }
+
+    if( status )
+    {
+        const ValuePtr& MOD_NAME = aKey->itemVec.at( 0 );
+        const ValuePtr& DATA = aValue->stateVec.at( 4 );
+
+        aItem.modulation = std::string( reinterpret_cast<const char*>( MOD_NAME->bytes ), MOD_NAME->bytesNr );
+        aItem.snrDb = static_cast<int>( aKey->itemVec.at( 1 )->intVal );
+        aItem.shapeVec.clear();
+        aItem.data = DATA->bytes;
+        aItem.dataBytes = DATA->bytesNr;
+        aItem.dataOffset = ( DATA->bytes >= mData && DATA->bytes < mData + mSize ) ? DATA->bytes - mData : NO_OFFSET;
+
+        size_t valuesNr = 1;
+
+        for( size_t i = 0; status && i < aValue->stateVec.at( 1 )->itemVec.size(); i++ )
+        {
+            const ValuePtr& DIMENSION = aValue->stateVec.at( 1 )->itemVec.at( i );
+            status = ( VALUE_INT == DIMENSION->type ) && ( DIMENSION->intVal >= 0 );
+
+            if( status )
+            {
+                aItem.shapeVec.push_back( DIMENSION->intVal );
+                valuesNr *= DIMENSION->intVal;
+            }
+        }
+
+        status = status && ( valuesNr * sizeof( float ) == aItem.dataBytes );
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Create a value
+//!
+//! @returns The new value
+//!************************************************************************
+PklDecoder::ValuePtr PklDecoder::makeValue
+    (
+    const ValueType         aType           //!< value type
+    )
+{
+    ValuePtr value = std::make_shared<Value>();
+    value->type = aType;
+    value->intVal = 0;
+    value->bytes = nullptr;
+    value->bytesNr = 0;
+
+    return value;
+}
+
+
+//!************************************************************************
+//! Pop the values above the last MARK
+//!
+//! @returns true if there was a MARK
+//!************************************************************************
+bool PklDecoder::popMark
+    (
+    std::vector<ValuePtr>&  aItemVec        //!< items above the mark
+    )
+{
+    bool status = ( mMarkVec.size() > 0 ) && ( mMarkVec.back() <= mStack.size() );
+
+    if( status )
+    {
+        aItemVec.assign( mStack.begin() + mMarkVec.back(), mStack.end() );
+        mStack.resize( mMarkVec.back() );
+        mMarkVec.pop_back();
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Read a little-endian unsigned integer
+//!
+//! @returns The integer value
+//!************************************************************************
+int64_t PklDecoder::readLe
+    (
+    const unsigned char*    aBytes,         //!< first byte
+    const size_t            aBytesNr        //!< number of bytes
+    )
+{
+    uint64_t value = 0;
+
+    for( size_t i = 0; i < aBytesNr; i++ )
+    {
+        value |= static_cast<uint64_t>( aBytes[i] ) << ( 8 * i );
+    }
+
+    return static_cast<int64_t>( value );
+}
+
+
+//!************************************************************************
+//! Apply a callable to its arguments. Only the callables found in a
+//! pickled numpy array are known:
+//!  - numpy.core.multiarray._reconstruct, creating the array
+//!  - numpy.dtype, creating its data type
+//!  - _codecs.encode, used by Python 3 for bytes in protocol 2
+//!
+//! @returns true if the callable is known
+//!************************************************************************
+bool PklDecoder::reduce
+    (
+    const ValuePtr&         aCallable,      //!< callable
+    const ValuePtr&         aArgs,          //!< arguments tuple
+    ValuePtr&               aResult         //!< result
+    ) const
+{
+    bool status = ( VALUE_GLOBAL == aCallable->type ) && ( VALUE_TUPLE == aArgs->type );
+    const std::string& NAME = aCallable->ownedStr;
+
+    if( status && ( "numpy.core.multiarray._reconstruct" == NAME || "numpy._core.multiarray._reconstruct" == NAME ) )
+    {
+        status = ( aArgs->itemVec.size() > 0 )
+              && ( VALUE_GLOBAL == aArgs->itemVec.at( 0 )->type )
+              && ( "numpy.ndarray" == aArgs->itemVec.at( 0 )->ownedStr );
+
+        aResult = makeValue( VALUE_NDARRAY );
+    }
+    else if( status && "numpy.dtype" == NAME )
+    {
+        status = ( aArgs->itemVec.size() > 0 ) && ( VALUE_STRING == aArgs->itemVec.at( 0 )->type );
+
+        aResult = makeValue( VALUE_DTYPE );
+        aResult->itemVec = aArgs->itemVec;
+    }
+    else if( status && "_codecs.encode" == NAME )
+    {
+        status = ( 2 == aArgs->itemVec.size() )
+              && ( VALUE_STRING == aArgs->itemVec.at( 0 )->type )
+              && ( VALUE_STRING == aArgs->itemVec.at( 1 )->type );
+
+        const std::string ENCODING = status ? std::string( reinterpret_cast<const char*>( aArgs->itemVec.at( 1 )->bytes ), aArgs->itemVec.at( 1 )->bytesNr ) : "";
+
+        status = status && ( "latin1" == ENCODING || "latin-1" == ENCODING );
+
+        aResult = makeValue( VALUE_STRING );
+
+        // the text holds the bytes as UTF-8 encoded code points below 256
+        const ValuePtr TEXT = status ? aArgs->itemVec.at( 0 ) : makeValue( VALUE_STRING );
+        aResult->ownedStr.reserve( TEXT->bytesNr );
+
+        for( size_t i = 0; status && i < TEXT->bytesNr; i++ )
+        {
+            const unsigned char CRT_BYTE = TEXT->bytes[i];
+
+            if( CRT_BYTE < 0x80 )
+            {
+                aResult->ownedStr.push_back( CRT_BYTE );
+            }
+            else
+            {
+                status = ( 0xC2 == CRT_BYTE || 0xC3 == CRT_BYTE ) && ( i + 1 < TEXT->bytesNr );
+
+                if( status )
+                {
+                    aResult->ownedStr.push_back( ( ( CRT_BYTE & 0x03 ) << 6 ) | ( TEXT->bytes[i + 1] & 0x3F ) );
+                    i++;
+                }
+            }
+        }
+
+        aResult->bytes = reinterpret_cast<const unsigned char*>( aResult->ownedStr.data() );
+        aResult->bytesNr = aResult->ownedStr.size();
+    }
+    else
+    {
+        status = false;
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Take a number of bytes from the decoding position
+//!
+//! @returns true if the bytes are available
+//!************************************************************************
+bool PklDecoder::take
+    (
+    const size_t            aBytesNr,       //!< number of bytes
+    const unsigned char*&   aBytes          //!< first byte
+    )
+{
+    bool status = ( aBytesNr <= mSize - mPos );
+
+    if( status )
+    {
+        aBytes = mData + mPos;
+        mPos += aBytesNr;
+    }
+
+    return status;
+}
@@ -0,0 +1,206 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+/*
+PklDecoder.h
+
+This file contains the definitions for pickle decoder.
+*/
+
+#ifndef PklDecoder_h
+#define PklDecoder_h
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+//************************************************************************
+// Class for decoding a pickled dict of (modulation, SNR) -> numpy array,
+// the layout of the RadioML 2016.10A dataset.
+//
+// The file is memory-mapped and run through a small pickle machine that
+// knows the opcodes of protocols 2 to 4 used for such dicts. Array
+// payloads are not copied: each dict item is handed to the caller as
+// soon as it is set, pointing into the mapped file.
+//
+// Anything outside this layout (other callables, lists, text opcodes)
+// makes the decoding fail, so the caller can fall back to a generic
+// unpickler.
+//************************************************************************
+class PklDecoder
+{
+    //************************************************************************
+    // constants and types
+    //************************************************************************
+    public:
+        static const uint64_t NO_OFFSET = UINT64_MAX;   //!< payload not stored verbatim in the file
+
+        typedef struct
+        {
+            std::string             modulation;     //!< modulation name of the key
+            int                     snrDb;          //!< SNR of the key [dB]
+            std::vector<int64_t>    shapeVec;       //!< array shape
+            const unsigned char*    data;           //!< array payload, little-endian float32
+            size_t                  dataBytes;      //!< size of the payload [bytes]
+            uint64_t                dataOffset;     //!< offset of the payload in the file, NO_OFFSET if transcoded
+        }ArrayItem;
+
+        typedef std::function<bool( const ArrayItem& )> ItemHandler;
+
+    private:
+        typedef enum
+        {
+            OP_MARK             = '(',
+            OP_STOP             = '.',
+            OP_BININT           = 'J',
+            OP_BININT1          = 'K',
+            OP_BININT2          = 'M',
+            OP_NONE             = 'N',
+            OP_REDUCE           = 'R',
+            OP_BINSTRING        = 'T',
+            OP_SHORT_BINSTRING  = 'U',
+            OP_BINUNICODE       = 'X',
+            OP_BUILD            = 'b',
+            OP_GLOBAL           = 'c',
+            OP_BINGET           = 'h',
+            OP_LONG_BINGET      = 'j',
+            OP_BINPUT           = 'q',
+            OP_LONG_BINPUT      = 'r',
+            OP_SETITEM          = 's',
+            OP_TUPLE            = 't',
+            OP_SETITEMS         = 'u',
+            OP_EMPTY_DICT       = '}',
+            OP_EMPTY_TUPLE      = ')',
+            OP_BINBYTES         = 'B',
+            OP_SHORT_BINBYTES   = 'C',
+            OP_PROTO            = 0x80,
+            OP_TUPLE1           = 0x85,
+            OP_TUPLE2           = 0x86,
+            OP_TUPLE3           = 0x87,
+            OP_NEWTRUE          = 0x88,
+            OP_NEWFALSE         = 0x89,
+            OP_LONG1            = 0x8A,
+            OP_SHORT_BINUNICODE = 0x8C,
+            OP_BINUNICODE8      = 0x8D,
+            OP_BINBYTES8        = 0x8E,
+            OP_STACK_GLOBAL     = 0x93,
+            OP_MEMOIZE          = 0x94,
+            OP_FRAME            = 0x95
+        }Opcode;
+
+        typedef enum
+        {
+            VALUE_NONE,
+            VALUE_BOOL,
+            VALUE_INT,
+            VALUE_STRING,
+            VALUE_TUPLE,
+            VALUE_DICT,
+            VALUE_GLOBAL,
+            VALUE_NDARRAY,
+            VALUE_DTYPE
+        }ValueType;
+
+        struct Value;
+        typedef std::shared_ptr<Value> ValuePtr;
+
+        struct Value
+        {
+            ValueType               type;           //!< value type
+            int64_t                 intVal;         //!< integer or boolean value
+            const unsigned char*    bytes;          //!< string bytes
+            size_t                  bytesNr;        //!< number of string bytes
+            std::string             ownedStr;       //!< storage of transcoded strings and global names
+            std::vector<ValuePtr>   itemVec;        //!< tuple items or constructor arguments
+            std::vector<ValuePtr>   stateVec;       //!< state set by BUILD
+        };
+
+
+    //************************************************************************
+    // functions
+    //************************************************************************
+    public:
+        PklDecoder();
+
+        bool decode
+            (
+            const std::string&      aFileName,      //!< input filename
+            const ItemHandler&      aHandler        //!< called for each dict item
+            );
+
+    private:
+        bool decodeBuffer
+            (
+            const ItemHandler&      aHandler        //!< called for each dict item
+            );
+
+        bool getArrayItem
+            (
+            const ValuePtr&         aKey,           //!< dict key
+            const ValuePtr&         aValue,         //!< dict value
+            ArrayItem&              aItem           //!< array item
+            ) const;
+
+        static ValuePtr makeValue
+            (
+            const ValueType         aType           //!< value type
+            );
+
+        bool popMark
+            (
+            std::vector<ValuePtr>&  aItemVec        //!< items above the mark
+            );
+
+        static int64_t readLe
+            (
+            const unsigned char*    aBytes,         //!< first byte
+            const size_t            aBytesNr        //!< number of bytes
+            );
+
+        bool reduce
+            (
+            const ValuePtr&         aCallable,      //!< callable
+            const ValuePtr&         aArgs,          //!< arguments tuple
+            ValuePtr&               aResult         //!< result
+            ) const;
+
+        bool take
+            (
+            const size_t            aBytesNr,       //!< number of bytes
+            const unsigned char*&   aBytes          //!< first byte
+            );
+
+
+    //************************************************************************
+    // variables
+    //************************************************************************
+    private:
+        const unsigned char*                    mData;          //!< mapped file
+        size_t                                  mSize;          //!< size of the mapped file [bytes]
+        size_t                                  mPos;           //!< decoding position [bytes]
+
+        std::vector<ValuePtr>                   mStack;         //!< pickle machine stack
+        std::vector<size_t>                     mMarkVec;       //!< stack sizes at each MARK
+        std::unordered_map<uint64_t, ValuePtr>  mMemoMap;       //!< pickle memo
+};
+
+#endif // PklDecoder_h
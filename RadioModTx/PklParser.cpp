@@ -22,14 +22,43 @@ This file contains the sources for PKL parser.
 */
 
 #include "PklParser.h"
+#include "PklDecoder.h"
+#include "SourceIndex.h"
+#include "WorkerPool.h"
 
 #include "chooseser.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <utility>
+#include <vector>
+
+
+const std::vector<Modulation::ModulationName> PklParser::MODULATION_MAPPING =
+{
+    // analog
+    Modulation::NAME_AM_DSB,
+    Modulation::NAME_AM_SSB,
+    Modulation::NAME_WBFM,
+    // FSK
+    Modulation::NAME_GFSK,
+    Modulation::NAME_CPFSK,
+    // PSK
+    Modulation::NAME_BPSK,
+    Modulation::NAME_QPSK,
+    Modulation::NAME_8PSK,
+    // PAM
+    Modulation::NAME_4PAM,
+    // QAM
+    Modulation::NAME_16QAM,
+    Modulation::NAME_64QAM
+};
 
 
 //!************************************************************************
@@ -41,14 +70,323 @@ PklParser::PklParser()
 
 
 //!************************************************************************
-//! Parse a pickle file using the RadioML 2016.10A dataset syntax
+//! Decode the comma separated values of one tuple of the text
+//! representation straight into a frame store
+//!
+//! @returns true if the tuple holds exactly the values of one block
+//!************************************************************************
+bool PklParser::decodeTuple
+    (
+    const char*                     aData,          //!< first character of the values
+    const size_t                    aLength,        //!< number of characters of the values
+    Dataset::SignalData&            aSignalData     //!< signal data
+    )
+{
+    const uint16_t FRAME_LENGTH = Dataset::FRAME_LENGTH.at( Dataset::DATASET_SOURCE_RADIOML_2016_10A );
+
+    // the number of frames follows from the number of values
+    const size_t VALUES_NR = aLength ? std::count( aData, aData + aLength, ',' ) + 1 : 0;
+    const size_t FRAMES_NR = VALUES_NR / ( 2 * FRAME_LENGTH );
+    const size_t EXPECTED_DBL_VALUES = FRAME_LENGTH * FRAMES_NR * 2;
+
+    aSignalData.maxVal = 0;
+
+    bool status = FRAMES_NR && aSignalData.frameStore.allocate( FRAMES_NR, FRAME_LENGTH );
+
+    const char* const DATA_END = aData + aLength;
+    const char* crtPtr = aData;
+    size_t valuesNr = 0;
+
+    while( status && crtPtr < DATA_END )
+    {
+        float fltValue = ::strtod( crtPtr, nullptr );
+
+        if( valuesNr < EXPECTED_DBL_VALUES )
+        {
+            // each frame holds all I values followed by all Q values
+            const size_t FRAME_INDEX = valuesNr / ( 2 * FRAME_LENGTH );
+            const size_t VALUE_INDEX = valuesNr % ( 2 * FRAME_LENGTH );
+            Dataset::IQPoint* frame = aSignalData.frameStore.getFrame( FRAME_INDEX );
+
+            if( VALUE_INDEX < FRAME_LENGTH )
+            {
+                frame[VALUE_INDEX].i = fltValue;
+            }
+            else
+            {
+                frame[VALUE_INDEX - FRAME_LENGTH].q = fltValue;
+            }
+
+            if( fabs( fltValue ) > aSignalData.maxVal )
+            {
+                aSignalData.maxVal = fabs( fltValue );
+            }
+        }
+
+        valuesNr++;
+
+        const char* commaPtr = static_cast<const char*>( memchr( crtPtr + 1, ',', DATA_END - crtPtr - 1 ) );
+        crtPtr = commaPtr ? commaPtr + 1 : DATA_END;
+    }
+
+    return status && ( EXPECTED_DBL_VALUES == valuesNr );
+}
+
+
+//!************************************************************************
+//! Get the loader of the blocks of the source file, used in index-only
+//! mode and by single-modulation parses
+//!
+//! @returns The block loader
+//!************************************************************************
+Dataset::BlockLoader PklParser::getBlockLoader() const
+{
+    const std::string FILE_NAME = mFileName;
+
+    return [FILE_NAME]( const Dataset::BlockLocation& aLocation, Dataset::SignalData& aSignalData )
+    {
+        return loadBlock( FILE_NAME, aLocation, aSignalData );
+    };
+}
+
+
+//!************************************************************************
+//! Get the decoder of the bytes of one frame located by the sidecar index
+//!
+//! @returns The frame decoder
+//!************************************************************************
+Dataset::FrameDecoder PklParser::getFrameDecoder()
+{
+    const size_t FRAME_BYTES = 2 * Dataset::FRAME_LENGTH.at( Dataset::DATASET_SOURCE_RADIOML_2016_10A ) * sizeof( float );
+
+    return [FRAME_BYTES]( const char* aData, size_t aLength, Dataset::IQPoint* aFrame, float& aMaxVal )
+    {
+        bool status = ( FRAME_BYTES == aLength );
+
+        if( status )
+        {
+            storeFrame( reinterpret_cast<const unsigned char*>( aData ), aFrame, aMaxVal );
+        }
+
+        return status;
+    };
+}
+
+
+//!************************************************************************
+//! Load a block located by an index-only parse
+//!
+//! @returns true if the block could be loaded
+//!************************************************************************
+bool PklParser::loadBlock
+    (
+    const std::string&              aFileName,      //!< input filename
+    const Dataset::BlockLocation&   aLocation,      //!< array payload in the file
+    Dataset::SignalData&            aSignalData     //!< signal data
+    )
+{
+    std::ifstream inputFile( aFileName, std::ios::binary );
+    std::vector<unsigned char> payload( aLocation.length );
+    bool status = inputFile.is_open();
+
+    if( status )
+    {
+        inputFile.seekg( aLocation.offset );
+        inputFile.read( reinterpret_cast<char*>( payload.data() ), aLocation.length );
+
+        status = ( static_cast<std::streamsize>( aLocation.length ) == inputFile.gcount() );
+    }
+
+    const size_t FRAME_BYTES = 2 * Dataset::FRAME_LENGTH.at( Dataset::DATASET_SOURCE_RADIOML_2016_10A ) * sizeof( float );
+
+    if( status )
+    {
+        status = aLocation.length && ( 0 == aLocation.length % FRAME_BYTES )
+              && storeFrames( payload.data(), aLocation.length / FRAME_BYTES, aSignalData );
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Parse a RadioML 2016.10A dataset, from its cache if available.
+//! The first successful parse of the source file writes the cache.
+//! Index-only mode bypasses the cache, which holds all the samples.
+//! Pickles that the native decoder does not recognise are parsed through
+//! PTools instead.
 //!
 //! @returns nothing
 //!************************************************************************
 /* slot */ void PklParser::parseDataset()
+{
+    bool status = !mIndexOnly && mCacheEnabled && loadCache( Dataset::DATASET_SOURCE_RADIOML_2016_10A );
+
+    if( !status )
+    {
+        status = parsePickle( mIndexOnly, false );
+
+        if( !status )
+        {
+            std::cout << "Pickle file " << mFileName << " has an unexpected layout, decoding it with PTools." << std::endl;
+            status = parsePickleText( false );
+        }
+
+        if( status && !mIndexOnly && mCacheEnabled )
+        {
+            saveCache( Dataset::DATASET_SOURCE_RADIOML_2016_10A );
+        }
+    }
+
+    mStatus = status;
+    emit parseFinished();
+}
+
+
+//!************************************************************************
+//! Parse a pickle file using the RadioML 2016.10A dataset syntax.
+//! The numpy arrays are copied from the pickle straight into the frame
+//! stores, without going through text.
+//! In index-only mode only the payload ranges are recorded.
+//! When looking for a single modulation, the arrays of the other
+//! modulations are skipped. The offset of every frame of all arrays and
+//! the maximum value of the converted ones are saved to the sidecar index
+//! of the file.
+//!
+//! @returns true if the file could be parsed
+//!************************************************************************
+bool PklParser::parsePickle
+    (
+    const bool          aIndexOnly,         //!< true to index the blocks without loading them
+    const bool          aSingleModulation   //!< true to keep only the selected modulation
+    )
 {
     mUniqueModVec.clear();
     mUniqueSnrVec.clear();
+    mBlockVec.clear();
+    mLocationVec.clear();
+    mMap.clear();
+
+    const int64_t FRAME_LENGTH = Dataset::FRAME_LENGTH.at( Dataset::DATASET_SOURCE_RADIOML_2016_10A );
+
+    Modulation* modInstance = Modulation::getInstance();
+    PklDecoder decoder;
+
+    SourceIndex sourceIndex( mFileName, Dataset::DATASET_SOURCE_RADIOML_2016_10A );
+    sourceIndex.setDirectory( mSidecarDirectory );
+    size_t itemsNr = 0;
+
+    bool parseFailed = !decoder.decode( mFileName, [&]( const PklDecoder::ArrayItem& aItem )
+    {
+        Modulation::ModulationName modName = modInstance->getModulationName( aItem.modulation );
+
+        // each array is frames x (I,Q) x frame length, 1000 frames in the
+        // original dataset
+        bool status = ( 3 == aItem.shapeVec.size() )
+                   && ( aItem.shapeVec.at( 0 ) > 0 )
+                   && ( 2 == aItem.shapeVec.at( 1 ) )
+                   && ( FRAME_LENGTH == aItem.shapeVec.at( 2 ) );
+
+        const int64_t FRAMES_NR = status ? aItem.shapeVec.at( 0 ) : 0;
+
+        Dataset::ModulationSnrPair modSnrPair = std::make_pair( modName, aItem.snrDb );
+        Dataset::BlockLocation location = { aItem.dataOffset, aItem.dataBytes };
+        float maxVal = -1;
+
+        if( status && ( !aSingleModulation || mSingleModulation == modName ) )
+        {
+            mUniqueModVec.push_back( modName );
+            mUniqueSnrVec.push_back( aItem.snrDb );
+
+            if( aIndexOnly && PklDecoder::NO_OFFSET != aItem.dataOffset )
+            {
+                mLocationVec.emplace_back( modSnrPair, location );
+            }
+            else
+            {
+                Dataset::SignalData signalData;
+                status = storeFrames( aItem.data, FRAMES_NR, signalData );
+
+                if( status )
+                {
+                    maxVal = signalData.maxVal;
+                    mBlockVec.emplace_back( modSnrPair, std::move( signalData ) );
+                }
+            }
+        }
+
+        if( status )
+        {
+            itemsNr++;
+
+            if( PklDecoder::NO_OFFSET != aItem.dataOffset )
+            {
+                const uint64_t FRAME_BYTES = 2 * FRAME_LENGTH * sizeof( float );
+                std::vector<uint64_t> frameOffsetVec( FRAMES_NR );
+
+                for( int64_t crtFrame = 0; crtFrame < FRAMES_NR; crtFrame++ )
+                {
+                    frameOffsetVec.at( crtFrame ) = aItem.dataOffset + crtFrame * FRAME_BYTES;
+                }
+
+                sourceIndex.addBlock( modSnrPair, location, maxVal, frameOffsetVec );
+            }
+        }
+
+        return status;
+    });
+
+    if( !parseFailed && mLocationVec.size() )
+    {
+        mBlockLoader = getBlockLoader();
+    }
+
+    if( parseFailed )
+    {
+        mUniqueModVec.clear();
+        mUniqueSnrVec.clear();
+        mBlockVec.clear();
+        mLocationVec.clear();
+    }
+
+    buildMap( Dataset::DATASET_SOURCE_RADIOML_2016_10A );
+
+    const size_t MODULATIONS_NR = aSingleModulation ? 1 : Dataset::MODULATIONS_NR.at( Dataset::DATASET_SOURCE_RADIOML_2016_10A );
+
+    if( MODULATIONS_NR != mUniqueModVec.size()
+     || Dataset::SNRS_NR.at( Dataset::DATASET_SOURCE_RADIOML_2016_10A ) != mUniqueSnrVec.size()
+      )
+    {
+        parseFailed = true;
+    }
+
+    // transcoded payloads cannot be read back from the file
+    if( !parseFailed && itemsNr == sourceIndex.getBlocksNr() )
+    {
+        sourceIndex.save();
+    }
+
+    return !parseFailed;
+}
+
+
+//!************************************************************************
+//! Parse a pickle file using the RadioML 2016.10A dataset syntax,
+//! through the text representation of the whole file given by PTools.
+//! When looking for a single modulation, the tuples of the other
+//! modulations are skipped.
+//!
+//! @returns true if the file could be parsed
+//!************************************************************************
+bool PklParser::parsePickleText
+    (
+    const bool          aSingleModulation   //!< true to keep only the selected modulation
+    )
+{
+    mUniqueModVec.clear();
+    mUniqueSnrVec.clear();
+    mBlockVec.clear();
+    mLocationVec.clear();
     mMap.clear();
 
     Val pklResult;
@@ -70,12 +408,9 @@ PklParser::PklParser()
     size_t closingModSnrIndex = 0;
     size_t closingArrayIndex = 0;
 
-    const size_t EXPECTED_DBL_VALUES = Dataset::FRAME_LENGTH.at( Dataset::DATASET_SOURCE_RADIOML_2016_10A )
-                                     * Dataset::FRAMES_PER_MOD_SNR_NR.at( Dataset::DATASET_SOURCE_RADIOML_2016_10A )
-                                     * 2;
-
     Modulation* modInstance = Modulation::getInstance();
     Dataset::ModulationSnrPair modSnrPair;
+    std::vector<TupleSpan> tupleSpanVec;
 
     for( size_t i = 0; i < PKL_STR_LEN; i++ )
     {
@@ -125,8 +460,11 @@ PklParser::PklParser()
                 break;
             }
 
-            mUniqueModVec.push_back( modName );
-            mUniqueSnrVec.push_back( snrDb );
+            if( !aSingleModulation || mSingleModulation == modName )
+            {
+                mUniqueModVec.push_back( modName );
+                mUniqueSnrVec.push_back( snrDb );
+            }
 
             modSnrPair = std::make_pair( modName, snrDb );
             i = closingModSnrIndex;
@@ -136,116 +474,23 @@ PklParser::PklParser()
             inArray = true;
 
             closingArrayIndex = PKL_STR.find( ")", i + 1 );
-            std::string arrayStr = PKL_STR.substr( i + 1, closingArrayIndex - i - 1 );
 
-            size_t startArrayIndex = arrayStr.find( "[" );
+            size_t startArrayIndex = PKL_STR.find( "[", i + 1 );
+            size_t closingDataIndex = PKL_STR.find( "]", startArrayIndex + 1 );
 
-            if( std::string::npos != startArrayIndex )
-            {
-                size_t closingArrayIndex = arrayStr.find( "]", startArrayIndex + 1 );
-
-                if( std::string::npos != closingArrayIndex )
-                {
-                    std::vector<float> fltVec;
-                    const std::string DATA_STR = arrayStr.substr( startArrayIndex + 1, closingArrayIndex - startArrayIndex - 1 );
-                    const size_t DATA_STR_LEN = DATA_STR.size();
-
-                    for( size_t j = 0; j < DATA_STR_LEN; j++ )
-                    {
-                        size_t commaIndex = DATA_STR.find( ",", j + 1 );
-                        std::string fltStr;
-                        float fltValue = 0;
-
-                        if( std::string::npos != commaIndex )
-                        {
-                            fltStr = DATA_STR.substr( j, commaIndex - j );
-                            fltValue = ::atof( fltStr.c_str() );
-                            fltVec.push_back( fltValue );
-
-                            j = commaIndex;
-                        }
-                        else // last value
-                        {
-                            fltStr = DATA_STR.substr( j, DATA_STR_LEN - j );
-                            fltValue = ::atof( fltStr.c_str() );
-                            fltVec.push_back( fltValue );
-
-                            j = DATA_STR_LEN;
-                        }
-                    }
-
-                    if( EXPECTED_DBL_VALUES != fltVec.size() )
-                    {
-                        parseFailed = true;
-                        break;
-                    }
-                    else
-                    {
-                        Dataset::SignalData signalData;
-                        signalData.maxVal = 0;
-
-                        for( size_t crtFrame = 0;
-                             crtFrame < Dataset::FRAMES_PER_MOD_SNR_NR.at( Dataset::DATASET_SOURCE_RADIOML_2016_10A );
-                             crtFrame++ )
-                        {
-                            Dataset::FrameData frameData;
-
-                            for( size_t crtPoint = 0;
-                                 crtPoint < Dataset::FRAME_LENGTH.at( Dataset::DATASET_SOURCE_RADIOML_2016_10A );
-                                 crtPoint++ )
-                            {
-                                size_t pointIndex = crtPoint + crtFrame * 2 * Dataset::FRAME_LENGTH.at( Dataset::DATASET_SOURCE_RADIOML_2016_10A );
-                                float iPart = fltVec.at( pointIndex );
-                                float qPart = fltVec.at( pointIndex + Dataset::FRAME_LENGTH.at( Dataset::DATASET_SOURCE_RADIOML_2016_10A ) );
-                                Dataset::IQPoint iqPoint = { iPart, qPart };
-                                frameData.push_back( iqPoint );
-
-                                if( fabs( iPart ) > signalData.maxVal )
-                                {
-                                    signalData.maxVal = fabs( iPart );
-                                }
-
-                                if( fabs( qPart ) > signalData.maxVal )
-                                {
-                                    signalData.maxVal = fabs( qPart );
-                                }
-                            }
-
-                            if( Dataset::FRAME_LENGTH.at( Dataset::DATASET_SOURCE_RADIOML_2016_10A ) != frameData.size() )
-                            {
-                                parseFailed = true;
-                                break;
-                            }
-
-                            signalData.frameDataVec.push_back( frameData );
-                        }
-
-                        if( parseFailed )
-                        {
-                            break;
-                        }
-
-                        if( Dataset::FRAMES_PER_MOD_SNR_NR.at( Dataset::DATASET_SOURCE_RADIOML_2016_10A ) != signalData.frameDataVec.size() )
-                        {
-                            parseFailed = true;
-                            break;
-                        }
-
-                        mMap.insert( std::pair<Dataset::ModulationSnrPair, Dataset::SignalData>( modSnrPair, signalData ) );
-                    }
-                }
-                else
-                {
-                    parseFailed = true;
-                    break;
-                }
-            }
-            else
+            if( std::string::npos == startArrayIndex || std::string::npos == closingDataIndex || closingDataIndex > closingArrayIndex )
             {
                 parseFailed = true;
                 break;
             }
 
+            // the values are decoded later, all tuples at once
+            if( !aSingleModulation || mSingleModulation == modSnrPair.first )
+            {
+                TupleSpan tupleSpan = { modSnrPair, startArrayIndex + 1, closingDataIndex };
+                tupleSpanVec.push_back( tupleSpan );
+            }
+
             i = closingArrayIndex;
 
             inModSnr = false;
@@ -253,26 +498,152 @@ PklParser::PklParser()
         }
     }
 
-    removeDuplicates( mUniqueModVec );
-    removeDuplicates( mUniqueSnrVec );
+    if( !parseFailed )
+    {
+        // each tuple is independent, so they are decoded in parallel
+        std::vector<Dataset::SignalData> signalDataVec( tupleSpanVec.size() );
+        std::unique_ptr<bool[]> decodedArray( new bool[tupleSpanVec.size()]() );
+        WorkerPool workerPool;
+
+        for( size_t i = 0; i < tupleSpanVec.size(); i++ )
+        {
+            workerPool.submit( [&, i]()
+            {
+                decodedArray[i] = decodeTuple( PKL_STR.data() + tupleSpanVec.at( i ).dataStart,
+                                               tupleSpanVec.at( i ).dataEnd - tupleSpanVec.at( i ).dataStart,
+                                               signalDataVec.at( i ) );
+            });
+        }
+
+        workerPool.wait();
+
+        for( size_t i = 0; !parseFailed && i < tupleSpanVec.size(); i++ )
+        {
+            parseFailed = !decodedArray[i];
+
+            if( !parseFailed )
+            {
+                mBlockVec.emplace_back( tupleSpanVec.at( i ).modSnrPair, std::move( signalDataVec.at( i ) ) );
+            }
+        }
+    }
+
+    buildMap( Dataset::DATASET_SOURCE_RADIOML_2016_10A );
+
+    const size_t MODULATIONS_NR = aSingleModulation ? 1 : Dataset::MODULATIONS_NR.at( Dataset::DATASET_SOURCE_RADIOML_2016_10A );
 
-    if( Dataset::MODULATIONS_NR.at( Dataset::DATASET_SOURCE_RADIOML_2016_10A ) != mUniqueModVec.size()
+    if( MODULATIONS_NR != mUniqueModVec.size()
      || Dataset::SNRS_NR.at( Dataset::DATASET_SOURCE_RADIOML_2016_10A ) != mUniqueSnrVec.size()
       )
     {
         parseFailed = true;
     }
 
-    mStatus = !parseFailed;
-    emit parseFinished();
+    return !parseFailed;
 }
 
 
 //!************************************************************************
-//! Parse a dataset looking for a single modulation
+//! Parse a RadioML 2016.10A dataset looking for a single modulation.
+//! The arrays of the modulation are read straight from their payload
+//! ranges, found in the sidecar index of the file. Without an up-to-date
+//! index, the pickle is decoded converting only the arrays of the
+//! modulation, which writes the index.
 //!
 //! @returns nothing
 //!************************************************************************
 /* slot */ void PklParser::parseDatasetSingleModulation()
 {
+    bool status = loadSingleModulation( Dataset::DATASET_SOURCE_RADIOML_2016_10A, getBlockLoader(), getFrameDecoder() );
+
+    if( !status )
+    {
+        status = parsePickle( mIndexOnly, true );
+
+        if( !status )
+        {
+            std::cout << "Pickle file " << mFileName << " has an unexpected layout, decoding it with PTools." << std::endl;
+            status = parsePickleText( true );
+        }
+    }
+
+    if( 1 != mUniqueModVec.size()
+     || Dataset::SNRS_NR.at( Dataset::DATASET_SOURCE_RADIOML_2016_10A ) != mUniqueSnrVec.size()
+      )
+    {
+        status = false;
+    }
+
+    mStatus = status;
+    emit parseFinished();
+}
+
+
+//!************************************************************************
+//! Store one frame of a pickled array, all I values followed by all Q
+//! values, as (I,Q) points
+//!
+//! @returns nothing
+//!************************************************************************
+void PklParser::storeFrame
+    (
+    const unsigned char*            aData,          //!< frame payload, float32
+    Dataset::IQPoint*               aFrame,         //!< frame to fill
+    float&                          aMaxVal         //!< maximum absolute value, updated
+    )
+{
+    const uint16_t FRAME_LENGTH = Dataset::FRAME_LENGTH.at( Dataset::DATASET_SOURCE_RADIOML_2016_10A );
+
+    const unsigned char* iPtr = aData;
+    const unsigned char* qPtr = aData + FRAME_LENGTH * sizeof( float );
+
+    for( size_t crtPoint = 0; crtPoint < FRAME_LENGTH; crtPoint++ )
+    {
+        // the payload is not aligned for float inside a pickle, the copies
+        // compile to plain loads
+        float iPart;
+        float qPart;
+        memcpy( &iPart, iPtr + crtPoint * sizeof( float ), sizeof( float ) );
+        memcpy( &qPart, qPtr + crtPoint * sizeof( float ), sizeof( float ) );
+        aFrame[crtPoint] = { iPart, qPart };
+
+        if( fabs( iPart ) > aMaxVal )
+        {
+            aMaxVal = fabs( iPart );
+        }
+
+        if( fabs( qPart ) > aMaxVal )
+        {
+            aMaxVal = fabs( qPart );
+        }
+    }
+}
+
+
+//!************************************************************************
+//! Store the payload of a frames x (I,Q) x frame length float32 array in
+//! a frame store
+//!
+//! @returns true if the frame store could be allocated
+//!************************************************************************
+bool PklParser::storeFrames
+    (
+    const unsigned char*            aData,          //!< array payload, float32
+    const size_t                    aFramesNr,      //!< number of frames of the array
+    Dataset::SignalData&            aSignalData     //!< signal data
+    )
+{
+    const uint16_t FRAME_LENGTH = Dataset::FRAME_LENGTH.at( Dataset::DATASET_SOURCE_RADIOML_2016_10A );
+    const size_t FRAME_BYTES = 2 * FRAME_LENGTH * sizeof( float );
+
+    aSignalData.maxVal = 0;
+
+    bool status = aSignalData.frameStore.allocate( aFramesNr, FRAME_LENGTH );
+
+    for( size_t crtFrame = 0; status && crtFrame < aFramesNr; crtFrame++ )
+    {
+        storeFrame( aData + crtFrame * FRAME_BYTES, aSignalData.frameStore.getFrame( crtFrame ), aSignalData.maxVal );
+    }
+
+    return status;
 }
@@ -26,6 +26,9 @@ This file contains the definitions for PKL parser.
 
 #include "DatasetParser.h"
 
+#include <string>
+#include <vector>
+
 
 //************************************************************************
 // Class for handling the pickle parser (*.pkl)
@@ -33,6 +36,21 @@ This file contains the definitions for PKL parser.
 class PklParser : public DatasetParser
 {
     Q_OBJECT
+    //************************************************************************
+    // constants and types
+    //************************************************************************
+    public:
+        static const std::vector<Modulation::ModulationName> MODULATION_MAPPING;
+
+    private:
+        typedef struct
+        {
+            Dataset::ModulationSnrPair  modSnrPair;     //!< modulation-SNR key of the tuple
+            size_t                      dataStart;      //!< index of the first value character
+            size_t                      dataEnd;        //!< index past the last value character
+        }TupleSpan;
+
+
     //************************************************************************
     // functions
     //************************************************************************
@@ -46,6 +64,50 @@ class PklParser : public DatasetParser
 
     signals:
         void parseFinished();
+
+    private:
+        static bool decodeTuple
+            (
+            const char*                     aData,          //!< first character of the values
+            const size_t                    aLength,        //!< number of characters of the values
+            Dataset::SignalData&            aSignalData     //!< signal data
+            );
+
+        Dataset::BlockLoader getBlockLoader() const;
+
+        static Dataset::FrameDecoder getFrameDecoder();
+
+        static bool loadBlock
+            (
+            const std::string&              aFileName,      //!< input filename
+            const Dataset::BlockLocation&   aLocation,      //!< array payload in the file
+            Dataset::SignalData&            aSignalData     //!< signal data
+            );
+
+        bool parsePickle
+            (
+            const bool                      aIndexOnly,         //!< true to index the blocks without loading them
+            const bool                      aSingleModulation   //!< true to keep only the selected modulation
+            );
+
+        bool parsePickleText
+            (
+            const bool                      aSingleModulation   //!< true to keep only the selected modulation
+            );
+
+        static void storeFrame
+            (
+            const unsigned char*            aData,          //!< frame payload, float32
+            Dataset::IQPoint*               aFrame,         //!< frame to fill
+            float&                          aMaxVal         //!< maximum absolute value, updated
+            );
+
+        static bool storeFrames
+            (
+            const unsigned char*            aData,          //!< array payload, float32
+            const size_t                    aFramesNr,      //!< number of frames of the array
+            Dataset::SignalData&            aSignalData     //!< signal data
+            );
 };
 
 #endif // PklParser_h
@@ -24,12 +24,15 @@ This file contains the sources for radio modulation transmitter.
 #include "RadioModTx.h"
 #include "./ui_RadioModTx.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <string>
 
+#include <QActionGroup>
 #include <QButtonGroup>
 #include <QFileDialog>
+#include <QInputDialog>
 #include <QMessageBox>
 #include <QString>
 
@@ -52,6 +55,8 @@ RadioModTx::RadioModTx
     , mCsvParserThread( new QThread() )
     , mParserStatus( false )
     , mTxIioScanIndex( -1 )
+    , mTxController( new TxController() )
+    , mTxPlaylist( new TxPlaylist( mTxController ) )
 {
     mMainUi->setupUi( this );
 
@@ -98,6 +103,7 @@ RadioModTx::RadioModTx
     mHdf5Parser->moveToThread( mHdf5ParserThread );
     connect( mHdf5ParserThread, SIGNAL( started() ), mHdf5Parser, SLOT( parseDatasetSingleModulation() ) );
     connect( mHdf5Parser, SIGNAL( parseFinished() ), this, SLOT( handleDatasetParseFinished() ) );
+    connect( mHdf5Parser, SIGNAL( parseProgress(int) ), this, SLOT( handleDatasetParseProgress(int) ) );
     connect( mHdf5Parser, SIGNAL( parseFinished() ), mHdf5ParserThread, SLOT( quit() ) );
 
     mCsvParser->moveToThread( mCsvParserThread );
@@ -110,8 +116,8 @@ RadioModTx::RadioModTx
     //*************************
     mModulationInstance = Modulation::getInstance();
 
-    mMainUi->ModulationTypeValue->clear();
-    mMainUi->ModulationFamilyValue->clear();
+    // modulations of the selected dataset source
+    updateDatasetSrc( mDatasetInstance->getSource() );
 
     connect( mMainUi->ModulationNameComboBox, QOverload<int>::of( &QComboBox::activated ), this, &RadioModTx::handleModulationNameChanged );
     connect( mMainUi->ModulationSnrComboBox, QOverload<int>::of( &QComboBox::activated ), this, &RadioModTx::handleModulationSnrChanged );
@@ -122,7 +128,13 @@ RadioModTx::RadioModTx
     mMainUi->StartFramesButton->setEnabled( false );
     mMainUi->StopFramesButton->setEnabled( false );
 
-    mTxHalInstance = TxHal::getInstance();   
+    connect( mTxController, SIGNAL( contextsScanned() ), this, SLOT( handleContextsScanned() ) );
+    connect( mTxController, SIGNAL( deviceInitialized(bool) ), this, SLOT( updateTxControls() ) );
+    connect( mTxController, SIGNAL( samplingFrequencyUpdated() ), this, SLOT( updateTxControls() ) );
+    connect( mTxController, SIGNAL( streamingStarted(bool,qint64) ), this, SLOT( handleStreamingStarted(bool,qint64) ) );
+    connect( mTxController, SIGNAL( streamingStopped(qint64) ), this, SLOT( handleStreamingStopped(qint64) ) );
+    connect( mTxController, SIGNAL( txRetuned(bool,qint64) ), this, SLOT( handleTxRetuned(bool,qint64) ) );
+
     updateTxList();
 
     connect( mMainUi->FramesTxComboBox, QOverload<int>::of( &QComboBox::activated ), this, &RadioModTx::handleTxChanged );
@@ -133,6 +145,19 @@ RadioModTx::RadioModTx
     connect( mMainUi->StartFramesButton,  SIGNAL( clicked() ), this, SLOT( handleStartTxStreaming() ) );
     connect( mMainUi->StopFramesButton,  SIGNAL( clicked() ), this, SLOT( handleStopTxStreaming() ) );
 
+    connect( mTxPlaylist, SIGNAL( entryFinished(int,qint64,quint64,quint64) ), this, SLOT( handlePlaylistEntryFinished(int,qint64,quint64,quint64) ) );
+    connect( mTxPlaylist, SIGNAL( entryStarted(int,qint64) ), this, SLOT( handlePlaylistEntryStarted(int,qint64) ) );
+    connect( mTxPlaylist, SIGNAL( playlistFinished(bool) ), this, SLOT( handlePlaylistFinished(bool) ) );
+
+    connect( mMainUi->TxPlaylistAction, SIGNAL( triggered() ), this, SLOT( openTxPlaylist() ) );
+    connect( mMainUi->TxSweepAction, SIGNAL( triggered() ), this, SLOT( startTxSweep() ) );
+    mMainUi->TxMenu->setEnabled( false );
+
+    QActionGroup* captureGroup = new QActionGroup( this );
+    captureGroup->addAction( mMainUi->CaptureNoneAction );
+    captureGroup->addAction( mMainUi->CaptureCi16Action );
+    captureGroup->addAction( mMainUi->CaptureCf32Action );
+
     //*************************
     // status bar
     //*************************
@@ -145,10 +170,37 @@ RadioModTx::RadioModTx
 //!************************************************************************
 RadioModTx::~RadioModTx()
 {
+    // the playlist holds the controller HAL lock while switching
+    delete mTxPlaylist;
+
+    // runs the queued commands before returning
+    delete mTxController;
     delete mMainUi;
 }
 
 
+//!************************************************************************
+//! Get the capture format selected in the Tx menu
+//!
+//! @returns The capture format
+//!************************************************************************
+TxCapture::CaptureFormat RadioModTx::getCaptureFormat() const
+{
+    TxCapture::CaptureFormat format = TxCapture::CAPTURE_FORMAT_NONE;
+
+    if( mMainUi->CaptureCi16Action->isChecked() )
+    {
+        format = TxCapture::CAPTURE_FORMAT_CI16;
+    }
+    else if( mMainUi->CaptureCf32Action->isChecked() )
+    {
+        format = TxCapture::CAPTURE_FORMAT_CF32;
+    }
+
+    return format;
+}
+
+
 //!************************************************************************
 //! Handle for changing the Tx LO frequency
 //!
@@ -159,10 +211,7 @@ RadioModTx::~RadioModTx()
     double aFrequencyMhz    //!< LO frequency [MHz]
     )
 {
-    if( mTxHalInstance->isInitialized() )
-    {
-        mTxHalInstance->setTxLoFrequency( aFrequencyMhz * 1.e6 );
-    }
+    mTxController->setTxLoFrequency( aFrequencyMhz * 1.e6 );
 }
 
 
@@ -176,10 +225,32 @@ RadioModTx::~RadioModTx()
     double aGainScale       //!< gain scale [0..1]
     )
 {
-    if( mTxHalInstance->isInitialized() )
+    mTxController->setTxNcoGainScale( aGainScale );
+}
+
+
+//!************************************************************************
+//! Handle for the IIO contexts being scanned by the controller
+//!
+//! @returns nothing
+//!************************************************************************
+/* slot */ void RadioModTx::handleContextsScanned()
+{
+    const std::vector<TxHal::IioScanContext> ISC_VEC = mTxController->getTxState().scanContextVec;
+
+    mMainUi->FramesTxComboBox->clear();
+    size_t iscLen = ISC_VEC.size();
+
+    for( size_t i = 0; i < iscLen; i++ )
     {
-        mTxHalInstance->setTxNcoGainScale( aGainScale );
+        mMainUi->FramesTxComboBox->addItem( QString::fromStdString( ISC_VEC.at( i ).uri ), QVariant::fromValue( i ) );
+        mMainUi->FramesTxComboBox->setItemData( i, QString::fromStdString( ISC_VEC.at( i ).description ), Qt::ToolTipRole );
     }
+
+    mTxIioScanIndex = iscLen ? 0 : -1;
+
+    // the Tx controls are updated once the device is initialized
+    mTxController->initializeTxDevice( mTxIioScanIndex );
 }
 
 
@@ -195,20 +266,20 @@ RadioModTx::~RadioModTx()
     switch( mDatasetType )
     {
         case Dataset::DATASET_SOURCE_RADIOML_2016_10A:
-            mMap = mPklParser->getMap( mParserStatus );
-            mUniqueModVec = mPklParser->getUniqueModVec();
+            mMap = mPklParser->takeMap( mParserStatus );
+            mUniqueModVec = PklParser::MODULATION_MAPPING;
             mUniqueSnrVec = mPklParser->getUniqueSnrVec();
             break;
 
         case Dataset::DATASET_SOURCE_RADIOML_2018_01:
-            mMap = mHdf5Parser->getMap( mParserStatus );
+            mMap = mHdf5Parser->takeMap( mParserStatus );
             mUniqueModVec = Hdf5Parser::MODULATION_MAPPING;
             mUniqueSnrVec = mHdf5Parser->getUniqueSnrVec();
             break;
 
         case Dataset::DATASET_SOURCE_HISARMOD_2019_1:
-            mMap = mCsvParser->getMap( mParserStatus );
-            mUniqueModVec = mCsvParser->getUniqueModVec();
+            mMap = mCsvParser->takeMap( mParserStatus );
+            mUniqueModVec = CsvParser::getModulationVec();
             mUniqueSnrVec = mCsvParser->getUniqueSnrVec();
             break;
 
@@ -216,14 +287,19 @@ RadioModTx::~RadioModTx()
             break;
     }
 
-    mMainUi->statusbar->showMessage( mParserStatus ? "Parsing done." : "Parsing failed." );
+    QString parseMessage = mParserStatus ? "Parsing done." : "Parsing failed.";
+
+    if( mParserStatus && Dataset::DATASET_SOURCE_RADIOML_2018_01 == mDatasetType && mHdf5Parser->getThroughputMBps() > 0 )
+    {
+        parseMessage += " Read at " + QString::number( mHdf5Parser->getThroughputMBps(), 'f', 1 ) + " MB/s.";
+    }
+
+    mMainUi->statusbar->showMessage( parseMessage );
 
     if( mParserStatus )
     {
-        if( mTxHalInstance->isInitialized() )
-        {
-            mTxHalInstance->updateSamplingFrequency( mDatasetType );
-        }
+        // the Tx controls are updated again once the sampling frequency is set
+        mTxController->updateSamplingFrequency( mDatasetType );
 
         updateModulationControls();
         updateSnrControls();        
@@ -233,6 +309,20 @@ RadioModTx::~RadioModTx()
 }
 
 
+//!************************************************************************
+//! Handle for parsing progress updates
+//!
+//! @returns nothing
+//!************************************************************************
+/* slot */ void RadioModTx::handleDatasetParseProgress
+    (
+    int aPercent    //!< parsed part of the file [%]
+    )
+{
+    mMainUi->statusbar->showMessage( "Parsing HDF5 file, please wait... " + QString::number( aPercent ) + " %" );
+}
+
+
 //!************************************************************************
 //! Handle for updates when modulation name changed
 //!
@@ -248,7 +338,8 @@ RadioModTx::~RadioModTx()
     mMainUi->ModulationTypeValue->setText( QString::fromStdString( mModulationInstance->getTypeString( mCrtModulation ) ) );
     mMainUi->ModulationFamilyValue->setText( QString::fromStdString( mModulationInstance->getFamilyString( mCrtModulation ) ) );
 
-    if( Dataset::DATASET_SOURCE_RADIOML_2018_01 == mDatasetType )
+    // a modulation which was not parsed requires opening the dataset again
+    if( !mMap || mMap->getModulationIndex( mCrtModulation ) < 0 )
     {
         mMainUi->StartFramesButton->setEnabled( false );
         mMainUi->StopFramesButton->setEnabled( false );
@@ -270,6 +361,65 @@ RadioModTx::~RadioModTx()
 }
 
 
+//!************************************************************************
+//! Handle for a playlist entry being done, reporting the non-cyclic
+//! streaming running out of data
+//!
+//! @returns nothing
+//!************************************************************************
+/* slot */ void RadioModTx::handlePlaylistEntryFinished
+    (
+    int     aIndex,         //!< entry index
+    qint64  aOnAirUs,       //!< time the entry was transmitted [us]
+    quint64 aPairsNr,       //!< (I,Q) pairs streamed, 0 for a cyclic buffer on hardware
+    quint64 aUnderflowsNr   //!< times non-cyclic streaming ran out of data
+    )
+{
+    if( aUnderflowsNr )
+    {
+        std::cout << "Playlist entry " << aIndex << ": " << aUnderflowsNr << " underflows in " << aOnAirUs / 1000 << " ms, " << aPairsNr << " pairs streamed" << std::endl;
+    }
+}
+
+
+//!************************************************************************
+//! Handle for a playlist entry being transmitted
+//!
+//! @returns nothing
+//!************************************************************************
+/* slot */ void RadioModTx::handlePlaylistEntryStarted
+    (
+    int     aIndex,         //!< entry index
+    qint64  aDeadAirUs      //!< dead air of the switch [us]
+    )
+{
+    mMainUi->statusbar->showMessage( "Playlist entry " + QString::number( aIndex + 1 ) + ", switched in " + QString::number( aDeadAirUs / 1000.0, 'f', 1 ) + " ms." );
+}
+
+
+//!************************************************************************
+//! Handle for the playlist being finished or stopped
+//!
+//! @returns nothing
+//!************************************************************************
+/* slot */ void RadioModTx::handlePlaylistFinished
+    (
+    bool    aStatus         //!< false if an entry could not be transmitted
+    )
+{
+    updateControlsStreamingStopped();
+
+    if( aStatus )
+    {
+        mMainUi->statusbar->showMessage( "Playlist finished.", 3000 );
+    }
+    else
+    {
+        mMainUi->statusbar->showMessage( "Playlist finished, some entries could not be loaded." );
+    }
+}
+
+
 //!************************************************************************
 //! Handle for starting the Tx stream
 //!
@@ -277,22 +427,15 @@ RadioModTx::~RadioModTx()
 //!************************************************************************
 /* slot */ void RadioModTx::handleStartTxStreaming()
 {
-    if( mTxHalInstance->isInitialized() )
+    if( mMap )
     {
-        mMainUi->StartFramesButton->setEnabled( false );
-        mMainUi->StopFramesButton->setEnabled( true );
-
-        mMainUi->DatasetGroupBox->setEnabled( false );
-        mMainUi->ModulationGroupBox->setEnabled( false );
-        mMainUi->FramesTxComboBox->setEnabled( false );
+        updateControlsStreamingStarted();
 
+        // the block is loaded and the Tx buffer filled by the controller
         Dataset::ModulationSnrPair modSnrPair = std::make_pair( mCrtModulation, mCrtSnrDb );
-        mTxHalInstance->getData( mMap.at( modSnrPair ) );
-
-        std::string dfn = makeDumpFilename();
-        mTxHalInstance->getDumpFilename( dfn );
+        mTxController->startStreaming( mMap, modSnrPair, makeSignalInfo(), makeCaptureName(), getCaptureFormat(), mMainUi->FramesContinuousCheckBox->isChecked() );
 
-        mTxHalInstance->startStreaming();
+        mMainUi->statusbar->showMessage( "Starting the Tx stream..." );
     }
 }
 
@@ -304,17 +447,54 @@ RadioModTx::~RadioModTx()
 //!************************************************************************
 /* slot */ void RadioModTx::handleStopTxStreaming()
 {
-    if( mTxHalInstance->isInitialized() )
+    updateControlsStreamingStopped();
+
+    // a running playlist stops the streaming itself
+    if( mTxPlaylist->isRunning() )
     {
-        mMainUi->StartFramesButton->setEnabled( true );
-        mMainUi->StopFramesButton->setEnabled( false );
+        mTxPlaylist->stop();
+    }
+    else
+    {
+        mTxController->stopStreaming();
+    }
+}
 
-        mMainUi->DatasetGroupBox->setEnabled( true );
-        mMainUi->ModulationGroupBox->setEnabled( true );
-        mMainUi->FramesTxComboBox->setEnabled( true );
 
-        mTxHalInstance->stopStreaming();
+//!************************************************************************
+//! Handle for the Tx stream being started by the controller
+//!
+//! @returns nothing
+//!************************************************************************
+/* slot */ void RadioModTx::handleStreamingStarted
+    (
+    bool    aStatus,        //!< true if streaming started
+    qint64  aLatencyUs      //!< latency from the command [us]
+    )
+{
+    if( aStatus )
+    {
+        mMainUi->statusbar->showMessage( "Tx stream started in " + QString::number( aLatencyUs / 1000.0, 'f', 1 ) + " ms." );
     }
+    else
+    {
+        updateControlsStreamingStopped();
+        mMainUi->statusbar->showMessage( "Could not load the signal data." );
+    }
+}
+
+
+//!************************************************************************
+//! Handle for the Tx stream being stopped by the controller
+//!
+//! @returns nothing
+//!************************************************************************
+/* slot */ void RadioModTx::handleStreamingStopped
+    (
+    qint64  aLatencyUs      //!< latency from the command [us]
+    )
+{
+    mMainUi->statusbar->showMessage( "Tx stream stopped in " + QString::number( aLatencyUs / 1000.0, 'f', 1 ) + " ms.", 3000 );
 }
 
 
@@ -329,46 +509,65 @@ RadioModTx::~RadioModTx()
     )
 {
     mTxIioScanIndex = mMainUi->FramesTxComboBox->itemData( aIndex ).value<int>();
-    mTxHalInstance->initializeTxDevice( mTxIioScanIndex );
-    updateTxControls();
+
+    // the Tx controls are updated once the device is initialized
+    mMainUi->StartFramesButton->setEnabled( false );
+    mMainUi->TxMenu->setEnabled( false );
+    mTxController->initializeTxDevice( mTxIioScanIndex );
 }
 
 
 //!************************************************************************
-//! Make the filename for dumping data
+//! Handle for a Tx setting being applied by the controller
 //!
-//! @returns The dump filename
+//! @returns nothing
 //!************************************************************************
-std::string RadioModTx::makeDumpFilename() const
+/* slot */ void RadioModTx::handleTxRetuned
+    (
+    bool    aStatus,        //!< true if the setting was applied
+    qint64  aLatencyUs      //!< latency from the command [us]
+    )
 {
-    std::string dumpFilename;
-
-    switch( mDatasetType )
+    if( aStatus )
     {
-        case Dataset::DATASET_SOURCE_RADIOML_2016_10A:
-            dumpFilename += "RadioML2016.10A";
-            break;
+        mMainUi->statusbar->showMessage( "Tx retuned in " + QString::number( aLatencyUs / 1000.0, 'f', 1 ) + " ms.", 3000 );
+    }
+}
 
-        case Dataset::DATASET_SOURCE_RADIOML_2018_01:
-            dumpFilename += "RadioML2018.01";
-            break;
 
-        case Dataset::DATASET_SOURCE_HISARMOD_2019_1:
-            dumpFilename += "HisarMod2019.1";
-            break;
+//!************************************************************************
+//! Make the capture recording name for the selected modulation-SNR
+//! combination
+//!
+//! @returns The recording name, without the SigMF extension
+//!************************************************************************
+std::string RadioModTx::makeCaptureName() const
+{
+    std::string captureName = Dataset::SOURCE_NAME.at( mDatasetType );
 
-        default:
-            break;
-    }
+    captureName += "_";
+    captureName += Modulation::MODULATION_NAME_ALIAS.at( mCrtModulation ).at( 0 );
+    captureName += "_";
+    captureName += std::to_string( mCrtSnrDb );
+    captureName += "dB";
 
-    dumpFilename += "_";
-    dumpFilename += Modulation::MODULATION_NAME_ALIAS.at( mCrtModulation ).at( 0 );
-    dumpFilename += "_";
-    dumpFilename += std::to_string( mCrtSnrDb );
-    dumpFilename += "dB";
-    dumpFilename += ".txt";
+    return captureName;
+}
+
+
+//!************************************************************************
+//! Make the capture annotation of the selected modulation-SNR combination
+//!
+//! @returns The signal information
+//!************************************************************************
+TxCapture::SignalInfo RadioModTx::makeSignalInfo() const
+{
+    TxCapture::SignalInfo signalInfo = {};
+    signalInfo.dataset = Dataset::SOURCE_NAME.at( mDatasetType );
+    signalInfo.modulation = Modulation::getInstance()->getModulationString( mCrtModulation );
+    signalInfo.snrDb = mCrtSnrDb;
 
-    return dumpFilename;
+    return signalInfo;
 }
 
 
@@ -417,25 +616,70 @@ std::string RadioModTx::makeDumpFilename() const
     {
         inputFile.close();        
 
+        const bool INDEX_ONLY = mMainUi->DatasetIndexOnlyCheckBox->isChecked();
+
         switch( mDatasetType )
         {
             case Dataset::DATASET_SOURCE_RADIOML_2016_10A:
+                mPklParser->setIndexOnly( INDEX_ONLY, Dataset::BLOCK_CACHE_BUDGET_BYTES );
+                mPklParser->setSingleModulation( mCrtModulation );
                 mPklParser->setFile( inputFilename );
+
+                disconnect( mPklParserThread, SIGNAL( started() ), mPklParser, nullptr );
+
+                if( mMainUi->DatasetAllModulationsCheckBox->isChecked() )
+                {
+                    connect( mPklParserThread, SIGNAL( started() ), mPklParser, SLOT( parseDataset() ) );
+                }
+                else
+                {
+                    connect( mPklParserThread, SIGNAL( started() ), mPklParser, SLOT( parseDatasetSingleModulation() ) );
+                }
+
                 mPklParserThread->start();
                 mMainUi->statusbar->showMessage( "Parsing pickle file, please wait... " );
                 updateControlsParseStarted();
                 break;
 
             case Dataset::DATASET_SOURCE_RADIOML_2018_01:
+                mHdf5Parser->setIndexOnly( INDEX_ONLY, Dataset::BLOCK_CACHE_BUDGET_BYTES );
                 mHdf5Parser->setSingleModulation( mCrtModulation );
                 mHdf5Parser->setFile( inputFilename );
+
+                // a full pass makes all modulations available without reopening the file
+                disconnect( mHdf5ParserThread, SIGNAL( started() ), mHdf5Parser, nullptr );
+
+                if( mMainUi->DatasetAllModulationsCheckBox->isChecked() )
+                {
+                    connect( mHdf5ParserThread, SIGNAL( started() ), mHdf5Parser, SLOT( parseDataset() ) );
+                }
+                else
+                {
+                    connect( mHdf5ParserThread, SIGNAL( started() ), mHdf5Parser, SLOT( parseDatasetSingleModulation() ) );
+                }
+
                 mHdf5ParserThread->start();
                 mMainUi->statusbar->showMessage( "Parsing HDF5 file, please wait... " );
                 updateControlsParseStarted();
                 break;
 
             case Dataset::DATASET_SOURCE_HISARMOD_2019_1:
+                mCsvParser->setIndexOnly( INDEX_ONLY, Dataset::BLOCK_CACHE_BUDGET_BYTES );
+                mCsvParser->setSingleModulation( mCrtModulation );
                 mCsvParser->setFile( inputFilename );
+
+                // the sidecar index lets a single modulation be read without parsing the whole file
+                disconnect( mCsvParserThread, SIGNAL( started() ), mCsvParser, nullptr );
+
+                if( mMainUi->DatasetAllModulationsCheckBox->isChecked() )
+                {
+                    connect( mCsvParserThread, SIGNAL( started() ), mCsvParser, SLOT( parseDataset() ) );
+                }
+                else
+                {
+                    connect( mCsvParserThread, SIGNAL( started() ), mCsvParser, SLOT( parseDatasetSingleModulation() ) );
+                }
+
                 mCsvParserThread->start();
                 mMainUi->statusbar->showMessage( "Parsing CSV file, please wait... " );
                 updateControlsParseStarted();
@@ -454,6 +698,90 @@ std::string RadioModTx::makeDumpFilename() const
 }
 
 
+//!************************************************************************
+//! Open a Tx playlist and start transmitting it
+//!
+//! @returns nothing
+//!************************************************************************
+/* slot */ void RadioModTx::openTxPlaylist()
+{
+    QString selectedFilter;
+    QString fileName = QFileDialog::getOpenFileName( this,
+                                                     "Open Tx playlist",
+                                                     "",
+                                                     "Playlist files (*.csv *.txt)",
+                                                     &selectedFilter,
+                                                     QFileDialog::DontUseNativeDialog
+                                                    );
+
+    std::vector<TxPlaylist::Entry> entryVec;
+
+    if( fileName.size() && TxPlaylist::loadEntries( fileName.toStdString(), entryVec ) )
+    {
+        startTxPlaylist( entryVec, fileName.toStdString() );
+    }
+    else if( fileName.size() )
+    {
+        QMessageBox msgBox;
+        msgBox.setText( "Invalid playlist \"" + fileName + "\"." );
+        msgBox.exec();
+    }
+}
+
+
+//!************************************************************************
+//! Start transmitting a playlist
+//!
+//! @returns nothing
+//!************************************************************************
+void RadioModTx::startTxPlaylist
+    (
+    const std::vector<TxPlaylist::Entry>&   aEntryVec,      //!< playlist entries
+    const std::string&                      aBaseName       //!< name of the switch log and of the capture, without extension
+    )
+{
+    // the menu is disabled while streaming, so the playlist has the HAL to itself
+    if( mTxPlaylist->start( mMap, aEntryVec, mMainUi->FramesContinuousCheckBox->isChecked(), false, aBaseName + ".log", Dataset::SOURCE_NAME.at( mDatasetType ), aBaseName, getCaptureFormat() ) )
+    {
+        updateControlsStreamingStarted();
+        mMainUi->statusbar->showMessage( "Playlist started, " + QString::number( aEntryVec.size() ) + " entries." );
+    }
+    else
+    {
+        mMainUi->statusbar->showMessage( "Playlist entries are not in the parsed dataset." );
+    }
+}
+
+
+//!************************************************************************
+//! Start a sweep over the parsed modulation-SNR combinations
+//!
+//! @returns nothing
+//!************************************************************************
+/* slot */ void RadioModTx::startTxSweep()
+{
+    bool isOk = false;
+    const int DWELL_MS = QInputDialog::getInt( this, "Tx sweep", "Dwell time of each combination [ms]:", 1000, 1, 3600000, 100, &isOk );
+
+    if( isOk && mMap )
+    {
+        const std::vector<TxPlaylist::Entry> SWEEP_VEC = TxPlaylist::makeSweep( mUniqueModVec, mUniqueSnrVec, static_cast<uint32_t>( DWELL_MS ), 0 );
+        std::vector<TxPlaylist::Entry> entryVec;
+
+        // only the parsed modulations can be transmitted
+        for( size_t i = 0; i < SWEEP_VEC.size(); i++ )
+        {
+            if( mMap->contains( std::make_pair( SWEEP_VEC.at( i ).modulation, SWEEP_VEC.at( i ).snrDb ) ) )
+            {
+                entryVec.push_back( SWEEP_VEC.at( i ) );
+            }
+        }
+
+        startTxPlaylist( entryVec, Dataset::SOURCE_NAME.at( mDatasetType ) + "_sweep" );
+    }
+}
+
+
 //!************************************************************************
 //! Update UI controls when parsing finished
 //!
@@ -476,6 +804,11 @@ void RadioModTx::updateControlsParseStarted()
 {
     mParserStatus = false;
 
+    // drop the previous snapshot, so that only one dataset is held in memory
+    mMap.reset();
+
+    mTxController->releaseData();
+
     mMainUi->DatasetGroupBox->setEnabled( false );
     mMainUi->ModulationGroupBox->setEnabled( false );
     mMainUi->FramesGroupBox->setEnabled( false );
@@ -488,6 +821,42 @@ void RadioModTx::updateControlsParseStarted()
 }
 
 
+//!************************************************************************
+//! Update UI controls when streaming started
+//!
+//! @returns nothing
+//!************************************************************************
+void RadioModTx::updateControlsStreamingStarted()
+{
+    mMainUi->StartFramesButton->setEnabled( false );
+    mMainUi->StopFramesButton->setEnabled( true );
+
+    mMainUi->DatasetGroupBox->setEnabled( false );
+    mMainUi->ModulationGroupBox->setEnabled( false );
+    mMainUi->FramesTxComboBox->setEnabled( false );
+    mMainUi->FramesContinuousCheckBox->setEnabled( false );
+    mMainUi->TxMenu->setEnabled( false );
+}
+
+
+//!************************************************************************
+//! Update UI controls when streaming stopped
+//!
+//! @returns nothing
+//!************************************************************************
+void RadioModTx::updateControlsStreamingStopped()
+{
+    mMainUi->StartFramesButton->setEnabled( true );
+    mMainUi->StopFramesButton->setEnabled( false );
+
+    mMainUi->DatasetGroupBox->setEnabled( true );
+    mMainUi->ModulationGroupBox->setEnabled( true );
+    mMainUi->FramesTxComboBox->setEnabled( true );
+    mMainUi->FramesContinuousCheckBox->setEnabled( true );
+    mMainUi->TxMenu->setEnabled( true );
+}
+
+
 //!************************************************************************
 //! Update the dataset source
 //!
@@ -501,37 +870,52 @@ void RadioModTx::updateControlsParseStarted()
     mParserStatus = false;
     mDatasetInstance->getSource() = static_cast<Dataset::DatasetSource>( aIndex );
 
-    if( Dataset::DATASET_SOURCE_RADIOML_2018_01 == mDatasetInstance->getSource() )
+    // the modulations of each dataset are known, so that a single one can be selected before opening it
+    switch( mDatasetInstance->getSource() )
     {
-        mMainUi->ModulationNameComboBox->clear();
-        mUniqueModVec = Hdf5Parser::MODULATION_MAPPING;
+        case Dataset::DATASET_SOURCE_RADIOML_2016_10A:
+            mUniqueModVec = PklParser::MODULATION_MAPPING;
+            break;
 
-        for( size_t i = 0; i < mUniqueModVec.size(); i++ )
-        {
-            Modulation::ModulationName modName = mUniqueModVec.at( i );
-            std::string modNameString = mModulationInstance->getModulationString( modName );
-            mMainUi->ModulationNameComboBox->addItem( QString::fromStdString( modNameString ), QVariant::fromValue( static_cast<int>( modName ) ) );
-        }
+        case Dataset::DATASET_SOURCE_RADIOML_2018_01:
+            mUniqueModVec = Hdf5Parser::MODULATION_MAPPING;
+            break;
+
+        case Dataset::DATASET_SOURCE_HISARMOD_2019_1:
+            mUniqueModVec = CsvParser::getModulationVec();
+            break;
+
+        default:
+            mUniqueModVec.clear();
+            break;
+    }
+
+    mMainUi->ModulationNameComboBox->clear();
+
+    for( size_t i = 0; i < mUniqueModVec.size(); i++ )
+    {
+        Modulation::ModulationName modName = mUniqueModVec.at( i );
+        std::string modNameString = mModulationInstance->getModulationString( modName );
+        mMainUi->ModulationNameComboBox->addItem( QString::fromStdString( modNameString ), QVariant::fromValue( static_cast<int>( modName ) ) );
+    }
 
+    if( mUniqueModVec.size() )
+    {
         mCrtModulation = static_cast<Modulation::ModulationName>( mMainUi->ModulationNameComboBox->itemData( 0 ).value<int>() );
 
         mMainUi->ModulationTypeValue->setText( QString::fromStdString( mModulationInstance->getTypeString( mCrtModulation ) ) );
         mMainUi->ModulationFamilyValue->setText( QString::fromStdString( mModulationInstance->getFamilyString( mCrtModulation ) ) );
-
-        mMainUi->ModulationSnrComboBox->clear();
     }
     else
     {
-        mMainUi->ModulationNameComboBox->clear();
-        mUniqueModVec.clear();
         mCrtModulation = Modulation::NAME_UNKNOWN;
 
         mMainUi->ModulationTypeValue->clear();
         mMainUi->ModulationFamilyValue->clear();
-
-        mMainUi->ModulationSnrComboBox->clear();
     }
 
+    mMainUi->ModulationSnrComboBox->clear();
+
     mMainUi->StartFramesButton->setEnabled( false );
     mMainUi->StopFramesButton->setEnabled( false );
 }
@@ -551,15 +935,10 @@ void RadioModTx::updateModulationControls()
         mMainUi->ModulationNameComboBox->addItem( QString::fromStdString( modNameString ), QVariant::fromValue( static_cast<int>( modName ) ) );
     }
 
-    if( Dataset::DATASET_SOURCE_RADIOML_2018_01 != mDatasetType )
-    {
-        mCrtModulation = static_cast<Modulation::ModulationName>( mMainUi->ModulationNameComboBox->itemData( 0 ).value<int>() );
-    }
-    else
-    {
-        int crtIndex = mMainUi->ModulationNameComboBox->findData( mCrtModulation );
-        mMainUi->ModulationNameComboBox->setCurrentIndex( crtIndex );
-    }
+    // keep the modulation selected before opening the dataset
+    int crtIndex = std::max( mMainUi->ModulationNameComboBox->findData( mCrtModulation ), 0 );
+    mMainUi->ModulationNameComboBox->setCurrentIndex( crtIndex );
+    mCrtModulation = static_cast<Modulation::ModulationName>( mMainUi->ModulationNameComboBox->itemData( crtIndex ).value<int>() );
 
     mMainUi->ModulationTypeValue->setText( QString::fromStdString( mModulationInstance->getTypeString( mCrtModulation ) ) );
     mMainUi->ModulationFamilyValue->setText( QString::fromStdString( mModulationInstance->getFamilyString( mCrtModulation ) ) );
@@ -588,24 +967,21 @@ void RadioModTx::updateSnrControls()
 //!
 //! @returns nothing
 //!************************************************************************
-void RadioModTx::updateTxControls()
+/* slot */ void RadioModTx::updateTxControls()
 {
-    bool isInit = mTxHalInstance->isInitialized();
+    const TxController::TxState TX_STATE = mTxController->getTxState();
+    bool isInit = TX_STATE.isInitialized;
 
     mMainUi->FloSpinBox->setEnabled( isInit );
 
     // LO frequency
-    AdiTrx::IntegerRange txFloRangeHz = mTxHalInstance->getTxLoFrequencyRange();
-    mMainUi->FloSpinBox->setMinimum( txFloRangeHz.min / 1.e6 );
-    mMainUi->FloSpinBox->setMaximum( txFloRangeHz.max / 1.e6 );
+    mMainUi->FloSpinBox->setMinimum( TX_STATE.loFrequencyRange.min / 1.e6 );
+    mMainUi->FloSpinBox->setMaximum( TX_STATE.loFrequencyRange.max / 1.e6 );
     mMainUi->FloSpinBox->setSingleStep( 1 ); // 1 MHz
-
-    int64_t frequencyHz = 0;
-    mTxHalInstance->getTxLoFrequency( frequencyHz );
-    mMainUi->FloSpinBox->setValue( frequencyHz / 1.e6 );
+    mMainUi->FloSpinBox->setValue( TX_STATE.loFrequency / 1.e6 );
 
     // NCO gain
-    if( TxHal::TX_DEVICE_AD9081 == mTxHalInstance->getTxDevice() )
+    if( TxHal::TX_DEVICE_AD9081 == TX_STATE.txDevice )
     {
         mMainUi->NcoGainLabel->setVisible( true );
         mMainUi->NcoGainSpinBox->setVisible( true );
@@ -613,14 +989,7 @@ void RadioModTx::updateTxControls()
         mMainUi->NcoGainLabel->setEnabled( isInit );
         mMainUi->NcoGainSpinBox->setEnabled( isInit );
 
-        double ncoGainScale = 0;
-
-        if( isInit )
-        {
-            mTxHalInstance->getTxNcoGainScale( ncoGainScale );
-        }
-
-        mMainUi->NcoGainSpinBox->setValue( ncoGainScale );
+        mMainUi->NcoGainSpinBox->setValue( TX_STATE.ncoGainScale );
     }
     else
     {
@@ -629,21 +998,17 @@ void RadioModTx::updateTxControls()
     }
 
     // sampling frequency
-    mTxHalInstance->getTxSamplingFrequency( frequencyHz );
-    mMainUi->FsampValue->setText( QString::number( frequencyHz / 1.e6, 'f', 3 ) + " MHz" );
+    mMainUi->FsampValue->setText( QString::number( TX_STATE.samplingFrequency / 1.e6, 'f', 3 ) + " MHz" );
 
     // BW
-    int64_t bwHz = 0;
-    mTxHalInstance->getTxBandwidth( bwHz );
-    mMainUi->BwValue->setText( QString::number( bwHz / 1.e6, 'f', 3 ) + " MHz" );
+    mMainUi->BwValue->setText( QString::number( TX_STATE.bandwidth / 1.e6, 'f', 3 ) + " MHz" );
 
     // Gain
-    double gainDb = 0;
-    mTxHalInstance->getTxHwGain( gainDb );
-    mMainUi->GainValue->setText( QString::number( gainDb, 'f', 2 ) + " dB" );
+    mMainUi->GainValue->setText( QString::number( TX_STATE.hwGain, 'f', 2 ) + " dB" );
 
     // buttons
     mMainUi->StartFramesButton->setEnabled( mParserStatus && isInit );
+    mMainUi->TxMenu->setEnabled( mParserStatus && isInit );
     mMainUi->StopFramesButton->setEnabled( false );
 }
 
@@ -655,19 +1020,6 @@ void RadioModTx::updateTxControls()
 //!************************************************************************
 /* slot */ void RadioModTx::updateTxList()
 {
-    mTxHalInstance->updateIioScanContexts();
-
-    std::vector<TxHal::IioScanContext> iscVec = mTxHalInstance->getIioScanContexts();
-    mMainUi->FramesTxComboBox->clear();
-    size_t iscLen = iscVec.size();
-
-    for( size_t i = 0; i < iscLen; i++ )
-    {
-        mMainUi->FramesTxComboBox->addItem( QString::fromStdString( iscVec.at( i ).uri ), QVariant::fromValue( i ) );
-        mMainUi->FramesTxComboBox->setItemData( i, QString::fromStdString( iscVec.at( i ).description ), Qt::ToolTipRole );
-    }
-
-    mTxIioScanIndex = iscLen ? 0 : -1;
-    mTxHalInstance->initializeTxDevice( mTxIioScanIndex );
-    updateTxControls();
+    // the list is filled once the controller has scanned the contexts
+    mTxController->scanContexts();
 }
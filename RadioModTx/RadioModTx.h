@@ -29,7 +29,10 @@ This file contains the definitions for radio modulation transmitter.
 #include "Hdf5Parser.h"
 #include "Modulation.h"
 #include "PklParser.h"
+#include "TxCapture.h"
+#include "TxController.h"
 #include "TxHal.h"
+#include "TxPlaylist.h"
 
 #include <QMainWindow>
 #include <QThread>
@@ -66,13 +69,21 @@ class RadioModTx : public QMainWindow
         ~RadioModTx();
 
     private:
-        std::string makeDumpFilename() const;
+        TxCapture::CaptureFormat getCaptureFormat() const;
+
+        std::string makeCaptureName() const;
+
+        TxCapture::SignalInfo makeSignalInfo() const;
 
         void updateModulationControls();
 
-        void updateSnrControls();
+        void startTxPlaylist
+            (
+            const std::vector<TxPlaylist::Entry>&   aEntryVec,      //!< playlist entries
+            const std::string&                      aBaseName       //!< name of the switch log and of the capture, without extension
+            );
 
-        void updateTxControls();
+        void updateSnrControls();
 
         void updateTxList();
 
@@ -87,8 +98,15 @@ class RadioModTx : public QMainWindow
             double aGainScale       //!< gain scale [0..1]
             );
 
+        void handleContextsScanned();
+
         void handleDatasetParseFinished();
 
+        void handleDatasetParseProgress
+            (
+            int aPercent    //!< parsed part of the file [%]
+            );
+
         void handleModulationNameChanged
             (
             int aIndex  //!< index
@@ -99,10 +117,46 @@ class RadioModTx : public QMainWindow
             int aIndex  //!< index
             );
 
+        void handlePlaylistEntryFinished
+            (
+            int     aIndex,         //!< entry index
+            qint64  aOnAirUs,       //!< time the entry was transmitted [us]
+            quint64 aPairsNr,       //!< (I,Q) pairs streamed, 0 for a cyclic buffer on hardware
+            quint64 aUnderflowsNr   //!< times non-cyclic streaming ran out of data
+            );
+
+        void handlePlaylistEntryStarted
+            (
+            int     aIndex,         //!< entry index
+            qint64  aDeadAirUs      //!< dead air of the switch [us]
+            );
+
+        void handlePlaylistFinished
+            (
+            bool    aStatus         //!< false if an entry could not be transmitted
+            );
+
         void handleStartTxStreaming();
 
         void handleStopTxStreaming();
 
+        void handleStreamingStarted
+            (
+            bool    aStatus,        //!< true if streaming started
+            qint64  aLatencyUs      //!< latency from the command [us]
+            );
+
+        void handleStreamingStopped
+            (
+            qint64  aLatencyUs      //!< latency from the command [us]
+            );
+
+        void handleTxRetuned
+            (
+            bool    aStatus,        //!< true if the setting was applied
+            qint64  aLatencyUs      //!< latency from the command [us]
+            );
+
         void handleTxChanged
             (
             int aIndex  //!< index
@@ -110,15 +164,25 @@ class RadioModTx : public QMainWindow
 
         void openDatasetSrc();
 
+        void openTxPlaylist();
+
+        void startTxSweep();
+
         void updateControlsParseFinished();
 
         void updateControlsParseStarted();
 
+        void updateControlsStreamingStarted();
+
+        void updateControlsStreamingStopped();
+
         void updateDatasetSrc
             (
             int aIndex  //!< index
             );
 
+        void updateTxControls();
+
 
     //************************************************************************
     // variables
@@ -141,12 +205,13 @@ class RadioModTx : public QMainWindow
 
         bool                                    mParserStatus;          //!< true if parser was successful
 
-        TxHal*                                  mTxHalInstance;         //!< Tx HAL
         int                                     mTxIioScanIndex;        //!< IIO scan context for Tx
+        TxController*                           mTxController;          //!< runs the Tx HAL commands off the GUI thread
+        TxPlaylist*                             mTxPlaylist;            //!< switches the Tx signal through a playlist
 
         std::vector<Modulation::ModulationName> mUniqueModVec;          //!< vector with unique modulations
         std::vector<int>                        mUniqueSnrVec;          //!< vector with unique SNRs
-        Dataset::ModulationSnrSignalDataMap     mMap;                   //!< map with data signals for modulation-SNR combinations
+        Dataset::Snapshot                       mMap;                   //!< snapshot with data signals for modulation-SNR combinations
 
         Modulation::ModulationName              mCrtModulation;         //!< selected modulation
         int                                     mCrtSnrDb;              //!< selected SNR [dB]
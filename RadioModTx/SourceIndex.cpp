@@ -0,0 +1,532 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+/*
+SourceIndex.cpp
+
+This file contains the sources for source index.
+*/
+
+#include "SourceIndex.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+const std::string SourceIndex::FILE_EXTENSION = ".amri";
+
+static const char INDEX_MAGIC[8] = { 'A', 'M', 'R', 'I', 'N', 'D', 'E', 'X' };
+
+
+//!************************************************************************
+//! Constructor
+//!************************************************************************
+SourceIndex::SourceIndex
+    (
+    const std::string&              aSourceFileName,    //!< dataset source file
+    const Dataset::DatasetSource    aSource             //!< dataset source
+    )
+    : mSourceFileName( aSourceFileName )
+    , mSource( aSource )
+{
+}
+
+
+//!************************************************************************
+//! Add a block to the index
+//!
+//! @returns nothing
+//!************************************************************************
+void SourceIndex::addBlock
+    (
+    const Dataset::ModulationSnrPair&   aPair,          //!< modulation-SNR combination
+    const Dataset::BlockLocation&       aLocation,      //!< block location in the source file
+    const float                         aMaxVal,        //!< maximum absolute value, negative if not measured
+    const std::vector<uint64_t>&        aFrameOffsetVec //!< file offset of each frame of the block
+    )
+{
+    BlockEntry entry;
+    memset( &entry, 0, sizeof( BlockEntry ) );
+    entry.modulation = aPair.first;
+    entry.snrDb = aPair.second;
+    entry.offset = aLocation.offset;
+    entry.length = aLocation.length;
+    entry.firstFrame = mFrameOffsetVec.size();
+    entry.framesNr = aFrameOffsetVec.size();
+    entry.maxVal = aMaxVal;
+
+    mBlockVec.push_back( entry );
+    mFrameOffsetVec.insert( mFrameOffsetVec.end(), aFrameOffsetVec.begin(), aFrameOffsetVec.end() );
+}
+
+
+//!************************************************************************
+//! Find a block of the index
+//!
+//! @returns The block number, -1 if the block is not indexed
+//!************************************************************************
+int SourceIndex::findBlock
+    (
+    const Dataset::ModulationSnrPair&   aPair           //!< modulation-SNR combination
+    ) const
+{
+    int block = -1;
+
+    for( size_t i = 0; block < 0 && i < mBlockVec.size(); i++ )
+    {
+        if( aPair.first == mBlockVec.at( i ).modulation && aPair.second == mBlockVec.at( i ).snrDb )
+        {
+            block = i;
+        }
+    }
+
+    return block;
+}
+
+
+//!************************************************************************
+//! Get the number of blocks of the index
+//!
+//! @returns The number of blocks
+//!************************************************************************
+size_t SourceIndex::getBlocksNr() const
+{
+    return mBlockVec.size();
+}
+
+
+//!************************************************************************
+//! Get the name of the index file
+//!
+//! @returns The source file name followed by the index extension, in the
+//! directory of the source file or in the one set by setDirectory()
+//!************************************************************************
+std::string SourceIndex::getFileName() const
+{
+    std::string fileName = mSourceFileName + FILE_EXTENSION;
+
+    if( mDirectory.size() )
+    {
+        fileName = mDirectory + "/" + fileName.substr( fileName.find_last_of( '/' ) + 1 );
+    }
+
+    return fileName;
+}
+
+
+//!************************************************************************
+//! Get a fingerprint of the source file contents: FNV-1a over evenly
+//! spread samples, the first and the last bytes of the file included
+//!
+//! @returns true if the source file could be read
+//!************************************************************************
+bool SourceIndex::getFingerprint
+    (
+    const uint64_t                      aSize,          //!< size of the source file [bytes]
+    uint64_t&                           aFingerprint    //!< fingerprint of the source file contents
+    ) const
+{
+    const uint64_t FNV_PRIME = 0x100000001B3;
+
+    int fd = open( mSourceFileName.c_str(), O_RDONLY );
+    bool status = ( fd >= 0 );
+
+    const uint64_t SAMPLE_BYTES = std::min( static_cast<uint64_t>( FINGERPRINT_SAMPLE_BYTES ), aSize );
+    unsigned char sample[FINGERPRINT_SAMPLE_BYTES];
+
+    aFingerprint = 0xCBF29CE484222325 ^ aSize;
+
+    for( size_t i = 0; status && i < FINGERPRINT_SAMPLES_NR; i++ )
+    {
+        const uint64_t OFFSET = ( aSize - SAMPLE_BYTES ) * i / ( FINGERPRINT_SAMPLES_NR - 1 );
+        status = ( static_cast<ssize_t>( SAMPLE_BYTES ) == pread( fd, sample, SAMPLE_BYTES, OFFSET ) );
+
+        for( size_t j = 0; status && j < SAMPLE_BYTES; j++ )
+        {
+            aFingerprint = ( aFingerprint ^ sample[j] ) * FNV_PRIME;
+        }
+    }
+
+    if( fd >= 0 )
+    {
+        close( fd );
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Get the location of a frame in the source file
+//!
+//! @returns true if the frame is indexed
+//!************************************************************************
+bool SourceIndex::getFrameLocation
+    (
+    const size_t                        aBlock,         //!< block number
+    const size_t                        aFrame,         //!< frame number within the block
+    Dataset::BlockLocation&             aLocation       //!< frame location in the source file
+    ) const
+{
+    bool status = ( aBlock < mBlockVec.size() ) && ( aFrame < mBlockVec.at( aBlock ).framesNr );
+
+    if( status )
+    {
+        const BlockEntry& entry = mBlockVec.at( aBlock );
+        const size_t FRAME_INDEX = entry.firstFrame + aFrame;
+
+        // a frame ends where the next one starts, the last one with the block
+        const uint64_t FRAME_END = ( aFrame + 1 < entry.framesNr ) ? mFrameOffsetVec.at( FRAME_INDEX + 1 ) : entry.offset + entry.length;
+
+        aLocation.offset = mFrameOffsetVec.at( FRAME_INDEX );
+        aLocation.length = FRAME_END - aLocation.offset;
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Get the number of frames of a block
+//!
+//! @returns The number of frames, 0 for an unknown block
+//!************************************************************************
+size_t SourceIndex::getFramesNr
+    (
+    const size_t                        aBlock          //!< block number
+    ) const
+{
+    return ( aBlock < mBlockVec.size() ) ? mBlockVec.at( aBlock ).framesNr : 0;
+}
+
+
+//!************************************************************************
+//! Get the locations of all blocks of the index
+//!
+//! @returns The located modulation-SNR blocks
+//!************************************************************************
+Dataset::ModulationSnrLocationVec SourceIndex::getLocationVec() const
+{
+    Dataset::ModulationSnrLocationVec locationVec;
+
+    for( size_t i = 0; i < mBlockVec.size(); i++ )
+    {
+        const BlockEntry& entry = mBlockVec.at( i );
+        Dataset::ModulationSnrPair modSnrPair = std::make_pair( static_cast<Modulation::ModulationName>( entry.modulation ), entry.snrDb );
+        Dataset::BlockLocation location = { entry.offset, entry.length };
+        locationVec.emplace_back( modSnrPair, location );
+    }
+
+    return locationVec;
+}
+
+
+//!************************************************************************
+//! Get the maximum absolute value of a block
+//!
+//! @returns The maximum absolute value, negative if not measured
+//!************************************************************************
+float SourceIndex::getMaxVal
+    (
+    const size_t                        aBlock          //!< block number
+    ) const
+{
+    return ( aBlock < mBlockVec.size() ) ? mBlockVec.at( aBlock ).maxVal : -1;
+}
+
+
+//!************************************************************************
+//! Get the fingerprint of the source file contents, which identifies the
+//! dataset independently of its name and modification time
+//!
+//! @returns true if the source file can be read
+//!************************************************************************
+bool SourceIndex::getSourceFingerprint
+    (
+    uint64_t&                           aFingerprint    //!< fingerprint of the source file contents
+    ) const
+{
+    uint64_t sourceSize = 0;
+    int64_t sourceMtime = 0;
+
+    return getSourceInfo( sourceSize, sourceMtime ) && getFingerprint( sourceSize, aFingerprint );
+}
+
+
+//!************************************************************************
+//! Get the size and modification time of the source file, used to detect
+//! a stale index
+//!
+//! @returns true if the source file can be queried
+//!************************************************************************
+bool SourceIndex::getSourceInfo
+    (
+    uint64_t&                           aSize,          //!< size of the source file [bytes]
+    int64_t&                            aMtime          //!< modification time of the source file [ns]
+    ) const
+{
+    struct stat sourceStat;
+    bool status = ( 0 == stat( mSourceFileName.c_str(), &sourceStat ) );
+
+    if( status )
+    {
+        aSize = sourceStat.st_size;
+        aMtime = static_cast<int64_t>( sourceStat.st_mtim.tv_sec ) * 1000000000 + sourceStat.st_mtim.tv_nsec;
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Load the index file.
+//! The size, the modification time and the fingerprint of the source file
+//! must all match the ones recorded in the index.
+//!
+//! @returns true if a valid, up-to-date index could be loaded
+//!************************************************************************
+bool SourceIndex::load()
+{
+    const std::string INDEX_FILE_NAME = getFileName();
+
+    uint64_t sourceSize = 0;
+    int64_t sourceMtime = 0;
+    bool status = getSourceInfo( sourceSize, sourceMtime );
+
+    std::ifstream indexFile;
+    struct stat indexStat;
+    Header header;
+
+    mBlockVec.clear();
+    mFrameOffsetVec.clear();
+
+    if( status )
+    {
+        indexFile.open( INDEX_FILE_NAME, std::ios::binary );
+        status = indexFile.is_open() && ( 0 == stat( INDEX_FILE_NAME.c_str(), &indexStat ) );
+    }
+
+    if( status )
+    {
+        indexFile.read( reinterpret_cast<char*>( &header ), sizeof( Header ) );
+
+        status = indexFile.good()
+              && ( header.framesNr <= static_cast<uint64_t>( indexStat.st_size ) / sizeof( uint64_t ) )
+              && ( static_cast<uint64_t>( indexStat.st_size ) == sizeof( Header ) + header.blocksNr * sizeof( BlockEntry ) + header.framesNr * sizeof( uint64_t ) )
+              && ( 0 == memcmp( header.magic, INDEX_MAGIC, sizeof( INDEX_MAGIC ) ) )
+              && ( VERSION == header.version )
+              && ( BYTE_ORDER_MARK == header.byteOrder )
+              && ( static_cast<uint32_t>( mSource ) == header.source )
+              && ( sourceSize == header.sourceSize )
+              && ( sourceMtime == header.sourceMtime );
+
+        if( status )
+        {
+            uint64_t fingerprint = 0;
+            status = getFingerprint( sourceSize, fingerprint ) && ( fingerprint == header.fingerprint );
+        }
+
+        if( !status )
+        {
+            std::cout << "Source index " << INDEX_FILE_NAME << " is stale or invalid, indexing the source file." << std::endl;
+        }
+    }
+
+    if( status )
+    {
+        mBlockVec.resize( header.blocksNr );
+        indexFile.read( reinterpret_cast<char*>( mBlockVec.data() ), mBlockVec.size() * sizeof( BlockEntry ) );
+
+        mFrameOffsetVec.resize( header.framesNr );
+        indexFile.read( reinterpret_cast<char*>( mFrameOffsetVec.data() ), mFrameOffsetVec.size() * sizeof( uint64_t ) );
+
+        status = indexFile.good();
+
+        for( size_t i = 0; status && i < mBlockVec.size(); i++ )
+        {
+            const BlockEntry& entry = mBlockVec.at( i );
+
+            status = ( entry.modulation >= 0 && entry.modulation <= Modulation::NAME_256QAM )
+                  && ( entry.length > 0 )
+                  && ( entry.offset <= sourceSize )
+                  && ( entry.length <= sourceSize - entry.offset )
+                  && ( entry.firstFrame <= header.framesNr )
+                  && ( entry.framesNr <= header.framesNr - entry.firstFrame );
+
+            // the frames follow each other within the block
+            uint64_t frameOffset = entry.offset;
+
+            for( size_t j = 0; status && j < entry.framesNr; j++ )
+            {
+                status = ( mFrameOffsetVec.at( entry.firstFrame + j ) >= frameOffset )
+                      && ( mFrameOffsetVec.at( entry.firstFrame + j ) < entry.offset + entry.length );
+
+                frameOffset = mFrameOffsetVec.at( entry.firstFrame + j );
+            }
+        }
+
+        if( !status )
+        {
+            std::cout << "Source index " << INDEX_FILE_NAME << " is corrupted, indexing the source file." << std::endl;
+        }
+    }
+
+    if( !status )
+    {
+        mBlockVec.clear();
+        mFrameOffsetVec.clear();
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Read frames of a block from the source file, with one pread() per
+//! frame. The frames are scaled like the whole block when its maximum
+//! absolute value was measured; a frame exceeding that maximum means the
+//! index no longer matches the file.
+//!
+//! @returns true if all frames could be read, decoded and are within the
+//! block maximum
+//!************************************************************************
+bool SourceIndex::readFrames
+    (
+    const size_t                        aBlock,         //!< block number
+    const std::vector<size_t>&          aFrameVec,      //!< frame numbers within the block
+    const Dataset::FrameDecoder&        aDecoder,       //!< decoder of the frame bytes
+    Dataset::SignalData&                aSignalData     //!< signal data with the frames
+    ) const
+{
+    const uint16_t FRAME_LENGTH = Dataset::FRAME_LENGTH.at( mSource );
+
+    int fd = open( mSourceFileName.c_str(), O_RDONLY );
+    bool status = ( fd >= 0 ) && aFrameVec.size() && aSignalData.frameStore.allocate( aFrameVec.size(), FRAME_LENGTH );
+
+    std::vector<char> frameBytes;
+
+    aSignalData.maxVal = 0;
+
+    for( size_t i = 0; status && i < aFrameVec.size(); i++ )
+    {
+        Dataset::BlockLocation location;
+        status = getFrameLocation( aBlock, aFrameVec.at( i ), location );
+
+        if( status )
+        {
+            frameBytes.resize( location.length );
+            status = ( static_cast<ssize_t>( location.length ) == pread( fd, frameBytes.data(), location.length, location.offset ) );
+        }
+
+        if( status )
+        {
+            status = aDecoder( frameBytes.data(), frameBytes.size(), aSignalData.frameStore.getFrame( i ), aSignalData.maxVal );
+        }
+    }
+
+    if( status && getMaxVal( aBlock ) >= 0 )
+    {
+        status = ( aSignalData.maxVal <= getMaxVal( aBlock ) );
+        aSignalData.maxVal = getMaxVal( aBlock );
+    }
+
+    if( fd >= 0 )
+    {
+        close( fd );
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Save the index file.
+//! The file is written under a temporary name and renamed when complete,
+//! so that a reader never sees a partially written index.
+//!
+//! @returns true if the index could be written
+//!************************************************************************
+bool SourceIndex::save() const
+{
+    const std::string INDEX_FILE_NAME = getFileName();
+    const std::string TMP_FILE_NAME = INDEX_FILE_NAME + ".tmp";
+
+    Header header;
+    memset( &header, 0, sizeof( Header ) );
+    memcpy( header.magic, INDEX_MAGIC, sizeof( INDEX_MAGIC ) );
+    header.version = VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.source = static_cast<uint32_t>( mSource );
+    header.blocksNr = mBlockVec.size();
+    header.framesNr = mFrameOffsetVec.size();
+
+    bool status = getSourceInfo( header.sourceSize, header.sourceMtime )
+               && getFingerprint( header.sourceSize, header.fingerprint );
+
+    std::ofstream indexFile;
+
+    if( status )
+    {
+        indexFile.open( TMP_FILE_NAME, std::ios::binary | std::ios::trunc );
+        status = indexFile.is_open();
+    }
+
+    if( status )
+    {
+        indexFile.write( reinterpret_cast<const char*>( &header ), sizeof( Header ) );
+        indexFile.write( reinterpret_cast<const char*>( mBlockVec.data() ), mBlockVec.size() * sizeof( BlockEntry ) );
+        indexFile.write( reinterpret_cast<const char*>( mFrameOffsetVec.data() ), mFrameOffsetVec.size() * sizeof( uint64_t ) );
+        indexFile.close();
+        status = !indexFile.fail();
+    }
+
+    if( status )
+    {
+        status = ( 0 == std::rename( TMP_FILE_NAME.c_str(), INDEX_FILE_NAME.c_str() ) );
+    }
+
+    if( !status )
+    {
+        std::remove( TMP_FILE_NAME.c_str() );
+        std::cout << "Could not write source index " << INDEX_FILE_NAME << std::endl;
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Set the directory of the index file, instead of the one of the source
+//! file, for instance to keep the source directory untouched
+//!
+//! @returns nothing
+//!************************************************************************
+void SourceIndex::setDirectory
+    (
+    const std::string&              aDirectory          //!< directory of the index file, empty for the one of the source file
+    )
+{
+    mDirectory = aDirectory;
+}
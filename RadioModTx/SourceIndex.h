@@ -0,0 +1,188 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+/*
+SourceIndex.h
+
+This file contains the definitions for source index.
+*/
+
+#ifndef SourceIndex_h
+#define SourceIndex_h
+
+#include "Dataset.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+//************************************************************************
+// Class for handling the sidecar index of a text or pickle dataset
+// (*.amri). The index is written next to the source file by a parse and
+// records where each modulation-SNR block lives in it, down to the byte
+// offset of every frame: a CSV line or a frame of a pickled array. Any
+// frame can then be read with a single pread(), without scanning the
+// file again.
+//
+// The index is tied to its source file by size and modification time;
+// a fingerprint of sampled contents is checked on top of them. A sampled
+// fingerprint cannot vouch for a modified file, so any change of the
+// modification time, even by a copy, has the file indexed again.
+//
+// Layout (native byte order):
+//  - Header
+//  - block table (BlockEntry x blocksNr)
+//  - frame table (uint64 file offset x framesNr)
+//************************************************************************
+class SourceIndex
+{
+    //************************************************************************
+    // constants and types
+    //************************************************************************
+    public:
+        static const std::string FILE_EXTENSION;    //!< index file extension
+
+        static const uint32_t VERSION = 2;          //!< index format version
+
+    private:
+        static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+        static const size_t FINGERPRINT_SAMPLES_NR = 16;            //!< number of sampled ranges
+        static const size_t FINGERPRINT_SAMPLE_BYTES = 4096;        //!< size of a sampled range [bytes]
+
+        typedef struct
+        {
+            char        magic[8];           //!< "AMRINDEX"
+            uint32_t    version;            //!< format version
+            uint32_t    byteOrder;          //!< byte order mark
+            uint32_t    source;             //!< dataset source
+            uint32_t    blocksNr;           //!< number of modulation-SNR blocks
+            uint64_t    framesNr;           //!< number of frames of all blocks
+            uint64_t    sourceSize;         //!< size of the source file [bytes]
+            int64_t     sourceMtime;        //!< modification time of the source file [ns]
+            uint64_t    fingerprint;        //!< fingerprint of the source file contents
+        }Header;
+
+        typedef struct
+        {
+            int32_t     modulation;         //!< modulation name
+            int32_t     snrDb;              //!< SNR [dB]
+            uint64_t    offset;             //!< first byte of the block in the source file
+            uint64_t    length;             //!< number of bytes of the block
+            uint64_t    firstFrame;         //!< first entry of the block in the frame table
+            uint32_t    framesNr;           //!< number of frames of the block
+            float       maxVal;             //!< maximum absolute value, negative if not measured
+        }BlockEntry;
+
+
+    //************************************************************************
+    // functions
+    //************************************************************************
+    public:
+        SourceIndex
+            (
+            const std::string&              aSourceFileName,    //!< dataset source file
+            const Dataset::DatasetSource    aSource             //!< dataset source
+            );
+
+        void addBlock
+            (
+            const Dataset::ModulationSnrPair&   aPair,          //!< modulation-SNR combination
+            const Dataset::BlockLocation&       aLocation,      //!< block location in the source file
+            const float                         aMaxVal,        //!< maximum absolute value, negative if not measured
+            const std::vector<uint64_t>&        aFrameOffsetVec //!< file offset of each frame of the block
+            );
+
+        int findBlock
+            (
+            const Dataset::ModulationSnrPair&   aPair           //!< modulation-SNR combination
+            ) const;
+
+        size_t getBlocksNr() const;
+
+        std::string getFileName() const;
+
+        bool getFrameLocation
+            (
+            const size_t                        aBlock,         //!< block number
+            const size_t                        aFrame,         //!< frame number within the block
+            Dataset::BlockLocation&             aLocation       //!< frame location in the source file
+            ) const;
+
+        size_t getFramesNr
+            (
+            const size_t                        aBlock          //!< block number
+            ) const;
+
+        Dataset::ModulationSnrLocationVec getLocationVec() const;
+
+        float getMaxVal
+            (
+            const size_t                        aBlock          //!< block number
+            ) const;
+
+        bool getSourceFingerprint
+            (
+            uint64_t&                           aFingerprint    //!< fingerprint of the source file contents
+            ) const;
+
+        bool load();
+
+        bool readFrames
+            (
+            const size_t                        aBlock,         //!< block number
+            const std::vector<size_t>&          aFrameVec,      //!< frame numbers within the block
+            const Dataset::FrameDecoder&        aDecoder,       //!< decoder of the frame bytes
+            Dataset::SignalData&                aSignalData     //!< signal data with the frames
+            ) const;
+
+        bool save() const;
+
+        void setDirectory
+            (
+            const std::string&                  aDirectory      //!< directory of the index file, empty for the one of the source file
+            );
+
+    private:
+        bool getFingerprint
+            (
+            const uint64_t                      aSize,          //!< size of the source file [bytes]
+            uint64_t&                           aFingerprint    //!< fingerprint of the source file contents
+            ) const;
+
+        bool getSourceInfo
+            (
+            uint64_t&                           aSize,          //!< size of the source file [bytes]
+            int64_t&                            aMtime          //!< modification time of the source file [ns]
+            ) const;
+
+
+    //************************************************************************
+    // variables
+    //************************************************************************
+    private:
+        std::string                 mSourceFileName;    //!< dataset source file
+        Dataset::DatasetSource      mSource;            //!< dataset source
+        std::string                 mDirectory;         //!< directory of the index file, empty for the one of the source file
+
+        std::vector<BlockEntry>     mBlockVec;          //!< block table
+        std::vector<uint64_t>       mFrameOffsetVec;    //!< frame table
+};
+
+#endif // SourceIndex_h
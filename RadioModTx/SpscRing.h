@@ -0,0 +1,152 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+/*
+SpscRing.h
+
+This file contains the definitions for single-producer single-consumer ring.
+*/
+
+#ifndef SpscRing_h
+#define SpscRing_h
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+
+//************************************************************************
+// Class for a lock-free ring of fixed capacity, with exactly one thread
+// pushing and one thread popping.
+//
+// The capacity is rounded up to a power of two. reset() must only be
+// called while neither thread is using the ring.
+//************************************************************************
+template<typename T>
+class SpscRing
+{
+    //************************************************************************
+    // constants and types
+    //************************************************************************
+    private:
+        static const size_t CACHE_LINE_BYTES = 64;     //!< keeps the indexes on separate cache lines
+
+
+    //************************************************************************
+    // functions
+    //************************************************************************
+    public:
+        SpscRing()
+            : mMask( 0 )
+            , mHead( 0 )
+            , mTail( 0 )
+        {
+        }
+
+        SpscRing( const SpscRing& ) = delete;
+        SpscRing& operator=( const SpscRing& ) = delete;
+
+        //!************************************************************************
+        //! Get the capacity of the ring
+        //!
+        //! @returns The number of items the ring can hold
+        //!************************************************************************
+        size_t getCapacity() const
+        {
+            return mItemVec.size();
+        }
+
+        //!************************************************************************
+        //! Pop the oldest item, from the consumer thread
+        //!
+        //! @returns true if an item was popped, false if the ring is empty
+        //!************************************************************************
+        bool pop
+            (
+            T&                  aItem           //!< popped item
+            )
+        {
+            const size_t HEAD = mHead.load( std::memory_order_relaxed );
+            const bool STATUS = HEAD != mTail.load( std::memory_order_acquire );
+
+            if( STATUS )
+            {
+                aItem = mItemVec[HEAD & mMask];
+                mHead.store( HEAD + 1, std::memory_order_release );
+            }
+
+            return STATUS;
+        }
+
+        //!************************************************************************
+        //! Push an item, from the producer thread
+        //!
+        //! @returns true if the item was pushed, false if the ring is full
+        //!************************************************************************
+        bool push
+            (
+            const T&            aItem           //!< item to push
+            )
+        {
+            const size_t TAIL = mTail.load( std::memory_order_relaxed );
+            const bool STATUS = TAIL - mHead.load( std::memory_order_acquire ) < mItemVec.size();
+
+            if( STATUS )
+            {
+                mItemVec[TAIL & mMask] = aItem;
+                mTail.store( TAIL + 1, std::memory_order_release );
+            }
+
+            return STATUS;
+        }
+
+        //!************************************************************************
+        //! Empty the ring and set its capacity
+        //!
+        //! @returns nothing
+        //!************************************************************************
+        void reset
+            (
+            const size_t        aCapacity       //!< minimum number of items
+            )
+        {
+            size_t capacity = 1;
+
+            while( capacity < aCapacity )
+            {
+                capacity <<= 1;
+            }
+
+            mItemVec.assign( capacity, T() );
+            mMask = capacity - 1;
+            mHead.store( 0, std::memory_order_relaxed );
+            mTail.store( 0, std::memory_order_relaxed );
+        }
+
+
+    //************************************************************************
+    // variables
+    //************************************************************************
+    private:
+        std::vector<T>                                  mItemVec;       //!< ring storage
+        size_t                                          mMask;          //!< index mask, capacity - 1
+
+        alignas( CACHE_LINE_BYTES ) std::atomic<size_t> mHead;          //!< next item to pop, written by the consumer
+        alignas( CACHE_LINE_BYTES ) std::atomic<size_t> mTail;          //!< next item to push, written by the producer
+};
+
+#endif // SpscRing_h
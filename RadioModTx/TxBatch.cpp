@@ -0,0 +1,648 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+
+/*
+TxBatch.cpp
+
+This file contains the sources for headless batch transmitter.
+*/
+
+#include "TxBatch.h"
+#include "CsvParser.h"
+#include "Hdf5Parser.h"
+#include "PklParser.h"
+#include "WaveformCache.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+
+std::atomic<bool> TxBatch::sStopRequested( false );
+
+//!************************************************************************
+//! Constructor
+//!************************************************************************
+TxBatch::TxBatch()
+    : mDatasetSource( Dataset::DATASET_SOURCE_RADIOML_2016_10A )
+    , mTxHal( TxHal::getInstance() )
+    , mTxPlaylist( &mTxController )
+    , mPlaylistStatus( true )
+    , mParseSeconds( 0 )
+    , mInitSeconds( 0 )
+    , mTransmitSeconds( 0 )
+{
+    // the handlers run in the playlist thread, there is no event loop
+    QObject::connect( &mTxPlaylist, &TxPlaylist::entryStarted, &mTxPlaylist, [this]( int aIndex, qint64 aDeadAirUs )
+    {
+        const TxPlaylist::Entry& entry = mEntryVec.at( aIndex );
+        std::lock_guard<std::mutex> lock( mStatsMutex );
+
+        mEntryStatsVec.push_back( { aIndex, aDeadAirUs, 0, 0, 0 } );
+
+        std::cout << "Entry " << aIndex << " " << Modulation::getInstance()->getModulationString( entry.modulation ) << " " << entry.snrDb << " dB"
+                  << ": dead air " << aDeadAirUs << " us" << std::endl;
+    }, Qt::DirectConnection );
+
+    QObject::connect( &mTxPlaylist, &TxPlaylist::entryFinished, &mTxPlaylist, [this]( int aIndex, qint64 aOnAirUs, quint64 aPairsNr, quint64 aUnderflowsNr )
+    {
+        std::lock_guard<std::mutex> lock( mStatsMutex );
+
+        if( mEntryStatsVec.size() && aIndex == mEntryStatsVec.back().index )
+        {
+            mEntryStatsVec.back().onAirUs = aOnAirUs;
+            mEntryStatsVec.back().pairsNr = aPairsNr;
+            mEntryStatsVec.back().underflowsNr = aUnderflowsNr;
+        }
+
+        const double SAMPLES_PER_SEC = aOnAirUs > 0 ? aPairsNr * 1e6 / aOnAirUs : 0;
+
+        std::cout << "Entry " << aIndex << ": " << std::fixed << std::setprecision( 3 ) << aOnAirUs / 1e6 << " s on air, "
+                  << aPairsNr << " samples, " << SAMPLES_PER_SEC / 1e6 << " MS/s, "
+                  << SAMPLES_PER_SEC * WaveformCache::PAIR_BYTES / 1e6 << " MB/s, "
+                  << aUnderflowsNr << " underflows" << std::defaultfloat << std::endl;
+    }, Qt::DirectConnection );
+
+    QObject::connect( &mTxPlaylist, &TxPlaylist::playlistFinished, &mTxPlaylist, [this]( bool aStatus )
+    {
+        mPlaylistStatus.store( aStatus );
+    }, Qt::DirectConnection );
+}
+
+
+//!************************************************************************
+//! Get an option as a flag: 1, true, yes or on
+//!
+//! @returns The flag
+//!************************************************************************
+bool TxBatch::getFlag
+    (
+    const std::string&      aKey,           //!< option key
+    const bool              aDefault        //!< value if the option is not set
+    ) const
+{
+    bool flag = aDefault;
+    auto it = mOptionMap.find( aKey );
+
+    if( mOptionMap.end() != it )
+    {
+        flag = ( "1" == it->second || "true" == it->second || "yes" == it->second || "on" == it->second );
+    }
+
+    return flag;
+}
+
+
+//!************************************************************************
+//! Get an option as a real number
+//!
+//! @returns true if the option is not set or is a number
+//!************************************************************************
+bool TxBatch::getDouble
+    (
+    const std::string&      aKey,           //!< option key
+    const double            aDefault,       //!< value if the option is not set
+    double&                 aValue          //!< option value
+    ) const
+{
+    bool status = true;
+    auto it = mOptionMap.find( aKey );
+    aValue = aDefault;
+
+    if( mOptionMap.end() != it )
+    {
+        char* end = nullptr;
+        aValue = std::strtod( it->second.c_str(), &end );
+        status = it->second.size() && '\0' == *end;
+
+        if( !status )
+        {
+            std::cout << "Invalid number for " << aKey << ": " << it->second << std::endl;
+        }
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Get an option as an integer
+//!
+//! @returns true if the option is not set or is an integer
+//!************************************************************************
+bool TxBatch::getInteger
+    (
+    const std::string&      aKey,           //!< option key
+    const int64_t           aDefault,       //!< value if the option is not set
+    int64_t&                aValue          //!< option value
+    ) const
+{
+    bool status = true;
+    auto it = mOptionMap.find( aKey );
+    aValue = aDefault;
+
+    if( mOptionMap.end() != it )
+    {
+        char* end = nullptr;
+        aValue = std::strtoll( it->second.c_str(), &end, 10 );
+        status = it->second.size() && '\0' == *end;
+
+        if( !status )
+        {
+            std::cout << "Invalid integer for " << aKey << ": " << it->second << std::endl;
+        }
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Get an option as a string
+//!
+//! @returns The option value
+//!************************************************************************
+std::string TxBatch::getString
+    (
+    const std::string&      aKey,           //!< option key
+    const std::string&      aDefault        //!< value if the option is not set
+    ) const
+{
+    auto it = mOptionMap.find( aKey );
+    return ( mOptionMap.end() != it ) ? it->second : aDefault;
+}
+
+
+//!************************************************************************
+//! Open the Tx device given by its URI and apply the Tx settings
+//!
+//! @returns true if the device is initialized and the settings applied
+//!************************************************************************
+bool TxBatch::initializeDevice()
+{
+    const std::string URI = getString( "uri", "" );
+    int64_t loFrequency = 0;
+    double ncoGainScale = 0;
+
+    bool status = getInteger( "lo_hz", 0, loFrequency ) && getDouble( "nco_gain", -1, ncoGainScale );
+
+    if( status && URI.empty() )
+    {
+        std::cout << "No Tx device, set uri" << std::endl;
+        status = false;
+    }
+
+    if( status )
+    {
+        const std::chrono::steady_clock::time_point START = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> txHalLock = mTxController.lockTxHal();
+
+        const int INDEX = mTxHal->addIioContext( URI );
+        status = INDEX >= 0 && mTxHal->initializeTxDevice( INDEX );
+
+        if( status )
+        {
+            mTxHal->updateSamplingFrequency( mDatasetSource );
+
+            if( loFrequency )
+            {
+                status = mTxHal->setTxLoFrequency( loFrequency );
+            }
+
+            if( status && ncoGainScale >= 0 )
+            {
+                status = mTxHal->setTxNcoGainScale( ncoGainScale );
+            }
+
+            if( !status )
+            {
+                std::cout << "Cannot apply the Tx settings" << std::endl;
+            }
+        }
+        else
+        {
+            std::cout << "Cannot initialize the Tx device " << URI << std::endl;
+        }
+
+        mInitSeconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - START ).count();
+
+        if( status )
+        {
+            int64_t samplingFrequency = 0;
+            mTxHal->getTxSamplingFrequency( samplingFrequency );
+            mTxHal->getTxLoFrequency( loFrequency );
+
+            std::cout << "Tx device " << URI << " initialized in " << std::fixed << std::setprecision( 1 ) << mInitSeconds * 1000 << " ms"
+                      << std::defaultfloat << ", sampling " << samplingFrequency << " Hz, LO " << loFrequency << " Hz" << std::endl;
+        }
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Load the configuration options from a file of "key = value" lines.
+//! Empty lines and text after '#' are ignored.
+//!
+//! @returns true if all the lines are valid
+//!************************************************************************
+bool TxBatch::loadConfig
+    (
+    const std::string&      aFileName       //!< configuration file
+    )
+{
+    std::ifstream configFile( aFileName );
+    bool status = configFile.is_open();
+
+    if( status )
+    {
+        std::string line;
+        size_t lineNr = 0;
+
+        while( status && std::getline( configFile, line ) )
+        {
+            lineNr++;
+            line = trim( line.substr( 0, line.find( '#' ) ) );
+
+            if( line.size() )
+            {
+                status = setOption( line );
+
+                if( !status )
+                {
+                    std::cout << aFileName << ":" << lineNr << ": expected \"key = value\"" << std::endl;
+                }
+            }
+        }
+    }
+    else
+    {
+        std::cout << "Cannot open the configuration " << aFileName << std::endl;
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Parse the dataset file in the calling thread
+//!
+//! @returns true if the dataset is parsed
+//!************************************************************************
+bool TxBatch::loadDataset()
+{
+    const std::string DATASET_NAME = getString( "dataset", "" );
+    const std::string FILE_NAME = getString( "dataset_file", "" );
+    const std::string MODULATION_NAME = getString( "modulation", "" );
+    const Modulation::ModulationName MODULATION = Modulation::getInstance()->getModulationName( MODULATION_NAME );
+    int64_t budgetMb = 0;
+    bool found = false;
+
+    for( auto it = Dataset::SOURCE_NAME.begin(); !found && it != Dataset::SOURCE_NAME.end(); it++ )
+    {
+        found = DATASET_NAME == it->second;
+        mDatasetSource = it->first;
+    }
+
+    bool status = getInteger( "block_cache_mb", Dataset::BLOCK_CACHE_BUDGET_BYTES / 1048576, budgetMb );
+
+    if( status && ( !found || FILE_NAME.empty() ) )
+    {
+        std::cout << "Set dataset to RadioML2016.10A, RadioML2018.01 or HisarMod2019.1, and dataset_file" << std::endl;
+        status = false;
+    }
+
+    if( status && MODULATION_NAME.size() && Modulation::NAME_UNKNOWN == MODULATION )
+    {
+        std::cout << "Unknown modulation " << MODULATION_NAME << std::endl;
+        status = false;
+    }
+
+    if( status )
+    {
+        std::unique_ptr<DatasetParser> parser;
+        Hdf5Parser* hdf5Parser = nullptr;
+
+        switch( mDatasetSource )
+        {
+            case Dataset::DATASET_SOURCE_RADIOML_2016_10A:
+                parser.reset( new PklParser() );
+                break;
+
+            case Dataset::DATASET_SOURCE_RADIOML_2018_01:
+                hdf5Parser = new Hdf5Parser();
+                parser.reset( hdf5Parser );
+                break;
+
+            case Dataset::DATASET_SOURCE_HISARMOD_2019_1:
+                parser.reset( new CsvParser() );
+                break;
+
+            default:
+                break;
+        }
+
+        Dataset::getInstance()->getSource() = mDatasetSource;
+
+        const std::chrono::steady_clock::time_point START = std::chrono::steady_clock::now();
+
+        parser->setIndexOnly( getFlag( "index_only", true ), static_cast<size_t>( std::max( budgetMb, static_cast<int64_t>( 1 ) ) ) * 1048576 );
+        parser->setFile( FILE_NAME );
+
+        if( MODULATION_NAME.size() )
+        {
+            parser->setSingleModulation( MODULATION );
+            parser->parseDatasetSingleModulation();
+        }
+        else
+        {
+            parser->parseDataset();
+        }
+
+        mMap = parser->takeMap( status );
+        mParseSeconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - START ).count();
+
+        status = status && mMap && !mMap->empty();
+
+        if( status )
+        {
+            std::cout << "Parsed " << FILE_NAME << " in " << std::fixed << std::setprecision( 3 ) << mParseSeconds << " s" << std::defaultfloat
+                      << ": " << mMap->getModulationsNr() << " modulations, " << mMap->getSnrsNr() << " SNRs";
+
+            if( hdf5Parser && hdf5Parser->getThroughputMBps() > 0 )
+            {
+                std::cout << ", read at " << std::fixed << std::setprecision( 1 ) << hdf5Parser->getThroughputMBps() << " MB/s" << std::defaultfloat;
+            }
+
+            std::cout << std::endl;
+        }
+        else
+        {
+            std::cout << "Cannot parse " << FILE_NAME << std::endl;
+        }
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Load the transmit plan: a playlist file, or a sweep over the parsed
+//! modulation-SNR combinations
+//!
+//! @returns true if the plan has entries
+//!************************************************************************
+bool TxBatch::loadPlan
+    (
+    std::vector<TxPlaylist::Entry>& aEntryVec   //!< playlist entries
+    )
+{
+    const std::string PLAYLIST_FILE_NAME = getString( "playlist", "" );
+    int64_t sweepDwellMs = 0;
+
+    bool status = getInteger( "sweep_dwell_ms", 0, sweepDwellMs );
+    aEntryVec.clear();
+
+    if( status && PLAYLIST_FILE_NAME.size() )
+    {
+        status = TxPlaylist::loadEntries( PLAYLIST_FILE_NAME, aEntryVec );
+    }
+    else if( status && sweepDwellMs > 0 )
+    {
+        // the sweep stays on the LO set with the device, a retune per entry would only add dead air
+        const std::vector<TxPlaylist::Entry> SWEEP_VEC = TxPlaylist::makeSweep( mMap->getModulationVec(), mMap->getSnrVec(), static_cast<uint32_t>( sweepDwellMs ), 0 );
+
+        // only the parsed combinations can be transmitted
+        for( size_t i = 0; i < SWEEP_VEC.size(); i++ )
+        {
+            if( mMap->contains( std::make_pair( SWEEP_VEC.at( i ).modulation, SWEEP_VEC.at( i ).snrDb ) ) )
+            {
+                aEntryVec.push_back( SWEEP_VEC.at( i ) );
+            }
+        }
+    }
+    else if( status )
+    {
+        std::cout << "No transmit plan, set playlist or sweep_dwell_ms" << std::endl;
+        status = false;
+    }
+
+    status = status && aEntryVec.size();
+    return status;
+}
+
+
+//!************************************************************************
+//! Print the timing and throughput statistics of the run
+//!
+//! @returns nothing
+//!************************************************************************
+void TxBatch::printSummary() const
+{
+    std::lock_guard<std::mutex> lock( mStatsMutex );
+
+    int64_t deadAirMinUs = 0;
+    int64_t deadAirMaxUs = 0;
+    int64_t deadAirSumUs = 0;
+    int64_t onAirUs = 0;
+    uint64_t pairsNr = 0;
+    uint64_t underflowsNr = 0;
+
+    for( size_t i = 0; i < mEntryStatsVec.size(); i++ )
+    {
+        const EntryStats& stats = mEntryStatsVec.at( i );
+
+        deadAirMinUs = i ? std::min( deadAirMinUs, stats.deadAirUs ) : stats.deadAirUs;
+        deadAirMaxUs = std::max( deadAirMaxUs, stats.deadAirUs );
+        deadAirSumUs += stats.deadAirUs;
+        onAirUs += stats.onAirUs;
+        pairsNr += stats.pairsNr;
+        underflowsNr += stats.underflowsNr;
+    }
+
+    const size_t ENTRIES_NR = mEntryStatsVec.size();
+    const double SAMPLES_PER_SEC = onAirUs > 0 ? pairsNr * 1e6 / onAirUs : 0;
+
+    std::cout << std::fixed << std::setprecision( 3 );
+    std::cout << "Summary" << std::endl;
+    std::cout << "  dataset parsed:     " << mParseSeconds << " s" << std::endl;
+    std::cout << "  device initialized: " << mInitSeconds * 1000 << " ms" << std::endl;
+    std::cout << "  entries started:    " << ENTRIES_NR << " in " << mTransmitSeconds << " s" << std::endl;
+    std::cout << "  dead air [us]:      min " << deadAirMinUs << ", avg " << ( ENTRIES_NR ? deadAirSumUs / static_cast<int64_t>( ENTRIES_NR ) : 0 ) << ", max " << deadAirMaxUs << std::endl;
+    std::cout << "  samples streamed:   " << pairsNr << ", " << SAMPLES_PER_SEC / 1e6 << " MS/s, " << SAMPLES_PER_SEC * WaveformCache::PAIR_BYTES / 1e6 << " MB/s" << std::endl;
+    std::cout << "  underflows:         " << underflowsNr << std::endl;
+    std::cout << std::defaultfloat;
+}
+
+
+//!************************************************************************
+//! Request the transmission to stop, safe from a signal handler
+//!
+//! @returns nothing
+//!************************************************************************
+void TxBatch::requestStop()
+{
+    sStopRequested.store( true );
+}
+
+
+//!************************************************************************
+//! Run the batch: parse the dataset, open the device and transmit the plan
+//!
+//! @returns true if every step succeeded
+//!************************************************************************
+bool TxBatch::run()
+{
+    const std::string CACHE_DIRECTORY = getString( "waveform_cache_dir", "" );
+    int64_t cacheBudgetMb = 0;
+
+    bool status = getInteger( "waveform_cache_mb", WaveformCache::DEFAULT_BUDGET_BYTES / 1048576, cacheBudgetMb );
+
+    if( status )
+    {
+        WaveformCache::getInstance()->setBudgetBytes( static_cast<size_t>( std::max( cacheBudgetMb, static_cast<int64_t>( 0 ) ) ) * 1048576 );
+        WaveformCache::getInstance()->setDiskDirectory( CACHE_DIRECTORY );
+    }
+
+    status = status && loadDataset();
+    status = status && initializeDevice();
+
+    std::vector<TxPlaylist::Entry> entryVec;
+    status = status && loadPlan( entryVec );
+
+    if( status )
+    {
+        status = transmit( entryVec );
+        printSummary();
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Set an option from a "key = value" string
+//!
+//! @returns true if the string has a key and a value
+//!************************************************************************
+bool TxBatch::setOption
+    (
+    const std::string&      aLine           //!< "key = value"
+    )
+{
+    const size_t SEPARATOR = aLine.find( '=' );
+    bool status = std::string::npos != SEPARATOR;
+
+    if( status )
+    {
+        const std::string KEY = trim( aLine.substr( 0, SEPARATOR ) );
+        const std::string VALUE = trim( aLine.substr( SEPARATOR + 1 ) );
+
+        status = KEY.size() && VALUE.size();
+
+        if( status )
+        {
+            mOptionMap[KEY] = VALUE;
+        }
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Transmit the plan through the playlist, until its end or a stop request
+//!
+//! @returns true if every entry was transmitted
+//!************************************************************************
+bool TxBatch::transmit
+    (
+    const std::vector<TxPlaylist::Entry>& aEntryVec     //!< playlist entries
+    )
+{
+    const std::string CAPTURE = getString( "capture", "none" );
+    const std::string DATASET_NAME = Dataset::SOURCE_NAME.at( mDatasetSource );
+    TxCapture::CaptureFormat captureFormat = TxCapture::CAPTURE_FORMAT_NONE;
+    bool status = true;
+
+    if( "ci16" == CAPTURE )
+    {
+        captureFormat = TxCapture::CAPTURE_FORMAT_CI16;
+    }
+    else if( "cf32" == CAPTURE )
+    {
+        captureFormat = TxCapture::CAPTURE_FORMAT_CF32;
+    }
+    else if( "none" != CAPTURE )
+    {
+        std::cout << "Invalid capture " << CAPTURE << ", expected none, ci16 or cf32" << std::endl;
+        status = false;
+    }
+
+    if( status )
+    {
+        mEntryVec = aEntryVec;
+        mEntryStatsVec.clear();
+        mPlaylistStatus.store( true );
+
+        const std::chrono::steady_clock::time_point START = std::chrono::steady_clock::now();
+
+        status = mTxPlaylist.start( mMap, mEntryVec, getFlag( "continuous", false ), getFlag( "loop", false ), getString( "log", "" ),
+                                    DATASET_NAME, getString( "capture_name", DATASET_NAME + "_batch" ), captureFormat );
+
+        if( status )
+        {
+            std::cout << "Transmitting " << mEntryVec.size() << " entries" << std::endl;
+
+            while( mTxPlaylist.isRunning() && !sStopRequested.load() )
+            {
+                std::this_thread::sleep_for( std::chrono::milliseconds( static_cast<unsigned int>( STOP_POLL_INTERVAL_MS ) ) );
+            }
+
+            // joins the scheduler, which may still be emitting
+            mTxPlaylist.stop();
+            status = mPlaylistStatus.load();
+        }
+
+        mTransmitSeconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - START ).count();
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Remove the leading and trailing whitespace
+//!
+//! @returns The trimmed string
+//!************************************************************************
+std::string TxBatch::trim
+    (
+    const std::string&      aString         //!< string
+    )
+{
+    const size_t FIRST = aString.find_first_not_of( " \t\r\n" );
+    const size_t LAST = aString.find_last_not_of( " \t\r\n" );
+
+    return ( std::string::npos == FIRST ) ? "" : aString.substr( FIRST, LAST - FIRST + 1 );
+}
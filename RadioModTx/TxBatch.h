@@ -0,0 +1,163 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+
+/*
+TxBatch.h
+
+This file contains the definitions for headless batch transmitter.
+*/
+
+#ifndef TxBatch_h
+#define TxBatch_h
+
+#include "Dataset.h"
+#include "TxCapture.h"
+#include "TxController.h"
+#include "TxHal.h"
+#include "TxPlaylist.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+//************************************************************************
+// Class for transmitting without a GUI, driven by a configuration file
+// of "key = value" lines (see the RadioModTxBatch usage for the keys).
+//
+// The dataset is parsed in the calling thread, the device is opened by
+// its URI without scanning, and the transmit plan, a playlist file or a
+// sweep over the parsed combinations, runs through TxPlaylist. Timing
+// and throughput statistics are printed per entry and at the end.
+//************************************************************************
+class TxBatch
+{
+    //************************************************************************
+    // constants and types
+    //************************************************************************
+    private:
+        static const unsigned int STOP_POLL_INTERVAL_MS = 100;     //!< interval of the stop request checks [ms]
+
+        typedef struct
+        {
+            int             index;          //!< entry index
+            int64_t         deadAirUs;      //!< dead air of the switch [us]
+            int64_t         onAirUs;        //!< time the entry was transmitted [us]
+            uint64_t        pairsNr;        //!< (I,Q) pairs streamed
+            uint64_t        underflowsNr;   //!< times non-cyclic streaming ran out of data
+        }EntryStats;
+
+
+    //************************************************************************
+    // functions
+    //************************************************************************
+    public:
+        TxBatch();
+
+        bool loadConfig
+            (
+            const std::string&      aFileName       //!< configuration file
+            );
+
+        static void requestStop();
+
+        bool run();
+
+        bool setOption
+            (
+            const std::string&      aLine           //!< "key = value"
+            );
+
+    private:
+        bool getFlag
+            (
+            const std::string&      aKey,           //!< option key
+            const bool              aDefault        //!< value if the option is not set
+            ) const;
+
+        bool getDouble
+            (
+            const std::string&      aKey,           //!< option key
+            const double            aDefault,       //!< value if the option is not set
+            double&                 aValue          //!< option value
+            ) const;
+
+        bool getInteger
+            (
+            const std::string&      aKey,           //!< option key
+            const int64_t           aDefault,       //!< value if the option is not set
+            int64_t&                aValue          //!< option value
+            ) const;
+
+        std::string getString
+            (
+            const std::string&      aKey,           //!< option key
+            const std::string&      aDefault        //!< value if the option is not set
+            ) const;
+
+        bool initializeDevice();
+
+        bool loadDataset();
+
+        bool loadPlan
+            (
+            std::vector<TxPlaylist::Entry>& aEntryVec   //!< playlist entries
+            );
+
+        void printSummary() const;
+
+        bool transmit
+            (
+            const std::vector<TxPlaylist::Entry>& aEntryVec     //!< playlist entries
+            );
+
+        static std::string trim
+            (
+            const std::string&      aString         //!< string
+            );
+
+
+    //************************************************************************
+    // variables
+    //************************************************************************
+    private:
+        static std::atomic<bool>            sStopRequested;     //!< set from the signal handler
+
+        std::map<std::string, std::string>  mOptionMap;         //!< configuration options
+
+        Dataset::DatasetSource              mDatasetSource;     //!< dataset source
+        Dataset::Snapshot                   mMap;               //!< snapshot with data signals for modulation-SNR combinations
+
+        TxHal*                              mTxHal;             //!< Tx HAL
+        TxController                        mTxController;      //!< owns the HAL lock
+        TxPlaylist                          mTxPlaylist;        //!< transmits the plan
+
+        std::vector<TxPlaylist::Entry>      mEntryVec;          //!< transmitted entries
+        std::atomic<bool>                   mPlaylistStatus;    //!< false if an entry could not be transmitted
+        std::vector<EntryStats>             mEntryStatsVec;     //!< statistics of the entries started, in order
+        mutable std::mutex                  mStatsMutex;        //!< protects the statistics
+        double                              mParseSeconds;      //!< dataset parsing time [s]
+        double                              mInitSeconds;       //!< device initialization time [s]
+        double                              mTransmitSeconds;   //!< plan transmission time [s]
+};
+
+#endif // TxBatch_h
@@ -0,0 +1,549 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+
+/*
+TxCapture.cpp
+
+This file contains the sources for Tx capture.
+*/
+
+#include "TxCapture.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+
+//!************************************************************************
+//! Constructor
+//!************************************************************************
+TxCapture::TxCapture()
+    : mFormat( CAPTURE_FORMAT_NONE )
+    , mSampleRate( 0 )
+    , mFd( -1 )
+    , mConvertBuf( nullptr )
+    , mCrtChunk( 0 )
+    , mCrtBytes( 0 )
+    , mHasCrtChunk( false )
+    , mQueuedPairsNr( 0 )
+    , mWrittenPairsNr( 0 )
+    , mDroppedPairsNr( 0 )
+    , mWriteFailed( false )
+    , mOpen( false )
+    , mStopping( false )
+{
+}
+
+
+//!************************************************************************
+//! Destructor
+//!************************************************************************
+TxCapture::~TxCapture()
+{
+    close();
+}
+
+
+//!************************************************************************
+//! Annotate the samples written from now on with the signal streamed.
+//! A new capture segment is started when the LO frequency changes.
+//!
+//! @returns nothing
+//!************************************************************************
+void TxCapture::annotate
+    (
+    const SignalInfo&       aInfo           //!< signal from now on
+    )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+
+    if( mOpen )
+    {
+        // a segment with no samples yet is retuned in place
+        if( mQueuedPairsNr == mSegmentVec.back().sampleStart )
+        {
+            mSegmentVec.back().loFrequency = aInfo.loFrequency;
+        }
+        else if( aInfo.loFrequency != mSegmentVec.back().loFrequency )
+        {
+            mSegmentVec.push_back( { mQueuedPairsNr, aInfo.loFrequency, makeDatetime() } );
+        }
+
+        // nothing was written for the previous signal
+        if( mAnnotationVec.size() && mQueuedPairsNr == mAnnotationVec.back().sampleStart )
+        {
+            mAnnotationVec.pop_back();
+        }
+
+        mAnnotationVec.push_back( { mQueuedPairsNr, aInfo } );
+    }
+}
+
+
+//!************************************************************************
+//! Stop recording: flush the pairs, wait for the writer and write the
+//! SigMF metadata
+//!
+//! @returns nothing
+//!************************************************************************
+void TxCapture::close()
+{
+    bool wasOpen = false;
+
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        wasOpen = mOpen;
+
+        if( mHasCrtChunk && mCrtBytes )
+        {
+            mFilledChunkQueue.push_back( { mCrtChunk, mCrtBytes } );
+        }
+
+        mHasCrtChunk = false;
+        mOpen = false;
+        mStopping = true;
+    }
+
+    mWriterCv.notify_all();
+
+    if( mThread.joinable() )
+    {
+        mThread.join();
+    }
+
+    if( mFd >= 0 )
+    {
+        ::close( mFd );
+        mFd = -1;
+    }
+
+    if( wasOpen )
+    {
+        if( !writeMetadata() )
+        {
+            std::cout << "Cannot write the capture metadata " << mBaseName << ".sigmf-meta" << std::endl;
+        }
+
+        if( mDroppedPairsNr || mWriteFailed )
+        {
+            std::cout << "Capture " << mBaseName << ": " << mWrittenPairsNr << " samples written, "
+                      << mDroppedPairsNr << " dropped" << ( mWriteFailed ? ", write failed" : "" ) << std::endl;
+        }
+    }
+
+    for( size_t i = 0; i < mChunkVec.size(); i++ )
+    {
+        std::free( mChunkVec.at( i ) );
+    }
+
+    std::free( mConvertBuf );
+
+    mChunkVec.clear();
+    mConvertBuf = nullptr;
+    mFreeChunkQueue.clear();
+    mFilledChunkQueue.clear();
+}
+
+
+//!************************************************************************
+//! Escape a string for a JSON value
+//!
+//! @returns The escaped string
+//!************************************************************************
+std::string TxCapture::escapeJson
+    (
+    const std::string&      aString         //!< string
+    )
+{
+    std::string escaped;
+
+    for( size_t i = 0; i < aString.size(); i++ )
+    {
+        const char CRT_CHAR = aString.at( i );
+
+        if( '"' == CRT_CHAR || '\\' == CRT_CHAR )
+        {
+            escaped += '\\';
+            escaped += CRT_CHAR;
+        }
+        else if( static_cast<unsigned char>( CRT_CHAR ) < 0x20 )
+        {
+            char hex[8] = "";
+            snprintf( hex, sizeof( hex ), "\\u%04x", CRT_CHAR );
+            escaped += hex;
+        }
+        else
+        {
+            escaped += CRT_CHAR;
+        }
+    }
+
+    return escaped;
+}
+
+
+//!************************************************************************
+//! Get the number of pairs dropped because the writer fell behind
+//!
+//! @returns The number of dropped pairs
+//!************************************************************************
+uint64_t TxCapture::getDroppedPairsNr() const
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    return mDroppedPairsNr;
+}
+
+
+//!************************************************************************
+//! Get the number of pairs written to the data file
+//!
+//! @returns The number of written pairs
+//!************************************************************************
+uint64_t TxCapture::getWrittenPairsNr() const
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    return mWrittenPairsNr;
+}
+
+
+//!************************************************************************
+//! Check if recording
+//!
+//! @returns true if the capture is open
+//!************************************************************************
+bool TxCapture::isOpen() const
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    return mOpen;
+}
+
+
+//!************************************************************************
+//! Make the current time as an ISO 8601 UTC timestamp
+//!
+//! @returns The timestamp
+//!************************************************************************
+std::string TxCapture::makeDatetime()
+{
+    const std::chrono::system_clock::time_point NOW = std::chrono::system_clock::now();
+    const std::time_t NOW_TIME = std::chrono::system_clock::to_time_t( NOW );
+    const long long MS = std::chrono::duration_cast<std::chrono::milliseconds>( NOW.time_since_epoch() ).count() % 1000;
+    struct tm utcTime = {};
+    char datetime[40] = "";
+
+    gmtime_r( &NOW_TIME, &utcTime );
+    const size_t LENGTH = strftime( datetime, sizeof( datetime ), "%Y-%m-%dT%H:%M:%S", &utcTime );
+    snprintf( datetime + LENGTH, sizeof( datetime ) - LENGTH, ".%03lldZ", MS );
+
+    return datetime;
+}
+
+
+//!************************************************************************
+//! Start recording to <aBaseName>.sigmf-data and <aBaseName>.sigmf-meta.
+//! A recording in progress is closed first.
+//!
+//! @returns true if the data file is created
+//!************************************************************************
+bool TxCapture::open
+    (
+    const std::string&      aBaseName,      //!< recording name, without the SigMF extension
+    const CaptureFormat     aFormat,        //!< sample format of the recording
+    const int64_t           aSampleRate,    //!< sampling frequency [Hz]
+    const int64_t           aLoFrequency,   //!< Tx LO frequency [Hz]
+    const std::string&      aHardware       //!< description of the Tx device
+    )
+{
+    close();
+
+    bool status = aBaseName.size() && CAPTURE_FORMAT_NONE != aFormat;
+
+    if( status )
+    {
+        const std::string DATA_FILE_NAME = aBaseName + ".sigmf-data";
+        mFd = ::open( DATA_FILE_NAME.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+        status = mFd >= 0;
+
+        if( !status )
+        {
+            std::cout << "Cannot create capture file " << DATA_FILE_NAME << std::endl;
+        }
+    }
+
+    for( size_t i = 0; status && i < CHUNKS_NR; i++ )
+    {
+        mChunkVec.push_back( static_cast<uint8_t*>( std::aligned_alloc( CHUNK_ALIGNMENT, CHUNK_BYTES ) ) );
+        mFreeChunkQueue.push_back( i );
+        status = nullptr != mChunkVec.back();
+    }
+
+    // the cf32 samples take twice the size of the ci16 chunk
+    if( status && CAPTURE_FORMAT_CF32 == aFormat )
+    {
+        mConvertBuf = static_cast<uint8_t*>( std::aligned_alloc( CHUNK_ALIGNMENT, 2 * CHUNK_BYTES ) );
+        status = nullptr != mConvertBuf;
+    }
+
+    if( status )
+    {
+        mBaseName = aBaseName;
+        mFormat = aFormat;
+        mSampleRate = aSampleRate;
+        mHardware = aHardware;
+
+        mSegmentVec.assign( 1, { 0, aLoFrequency, makeDatetime() } );
+        mAnnotationVec.clear();
+        mHasCrtChunk = false;
+        mCrtBytes = 0;
+        mQueuedPairsNr = 0;
+        mWrittenPairsNr = 0;
+        mDroppedPairsNr = 0;
+        mWriteFailed = false;
+        mStopping = false;
+        mOpen = true;
+
+        mThread = std::thread( &TxCapture::run, this );
+    }
+    else
+    {
+        close();
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Writer thread: write the filled chunks to the data file, converted to
+//! the recording format, one write per chunk
+//!
+//! @returns nothing
+//!************************************************************************
+void TxCapture::run()
+{
+    const float CF32_SCALE = 1.0f / 32768;
+    std::unique_lock<std::mutex> lock( mMutex );
+
+    while( true )
+    {
+        mWriterCv.wait( lock, [this]{ return mStopping || mFilledChunkQueue.size(); } );
+
+        if( mFilledChunkQueue.empty() )
+        {
+            break;
+        }
+
+        const FilledChunk CHUNK = mFilledChunkQueue.front();
+        mFilledChunkQueue.pop_front();
+        const bool SKIP = mWriteFailed;
+
+        lock.unlock();
+
+        const uint8_t* data = mChunkVec.at( CHUNK.index );
+        size_t bytesNr = CHUNK.bytesNr;
+
+        if( CAPTURE_FORMAT_CF32 == mFormat )
+        {
+            for( size_t i = 0; i < CHUNK.bytesNr / sizeof( int16_t ); i++ )
+            {
+                int16_t sample = 0;
+                memcpy( &sample, data + i * sizeof( int16_t ), sizeof( sample ) );
+
+                const float VALUE = sample * CF32_SCALE;
+                memcpy( mConvertBuf + i * sizeof( float ), &VALUE, sizeof( VALUE ) );
+            }
+
+            data = mConvertBuf;
+            bytesNr = 2 * CHUNK.bytesNr;
+        }
+
+        bool status = !SKIP;
+
+        while( status && bytesNr )
+        {
+            const ssize_t WRITTEN = ::write( mFd, data, bytesNr );
+            status = WRITTEN > 0 || ( WRITTEN < 0 && EINTR == errno );
+
+            if( WRITTEN > 0 )
+            {
+                data += WRITTEN;
+                bytesNr -= WRITTEN;
+            }
+        }
+
+        lock.lock();
+
+        mFreeChunkQueue.push_back( CHUNK.index );
+
+        if( status )
+        {
+            mWrittenPairsNr += CHUNK.bytesNr / PAIR_BYTES;
+        }
+        else
+        {
+            mWriteFailed = true;
+        }
+    }
+}
+
+
+//!************************************************************************
+//! Record pairs pushed to the Tx buffer. Only copies them to a chunk, the
+//! pairs not fitting in the free chunks are dropped.
+//!
+//! @returns nothing
+//!************************************************************************
+void TxCapture::write
+    (
+    const uint8_t*          aPairs,         //!< packed DAC pairs, I first, little-endian, MSB-justified
+    const size_t            aPairsNr        //!< number of pairs
+    )
+{
+    bool chunkFilled = false;
+
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        size_t doneNr = 0;
+
+        while( mOpen && doneNr < aPairsNr )
+        {
+            if( !mHasCrtChunk )
+            {
+                if( mFreeChunkQueue.empty() )
+                {
+                    mDroppedPairsNr += aPairsNr - doneNr;
+                    break;
+                }
+
+                mCrtChunk = mFreeChunkQueue.front();
+                mFreeChunkQueue.pop_front();
+                mCrtBytes = 0;
+                mHasCrtChunk = true;
+            }
+
+            const size_t COPY_NR = std::min( aPairsNr - doneNr, ( CHUNK_BYTES - mCrtBytes ) / PAIR_BYTES );
+
+            memcpy( mChunkVec.at( mCrtChunk ) + mCrtBytes, aPairs + doneNr * PAIR_BYTES, COPY_NR * PAIR_BYTES );
+            mCrtBytes += COPY_NR * PAIR_BYTES;
+            mQueuedPairsNr += COPY_NR;
+            doneNr += COPY_NR;
+
+            if( CHUNK_BYTES == mCrtBytes )
+            {
+                mFilledChunkQueue.push_back( { mCrtChunk, mCrtBytes } );
+                mHasCrtChunk = false;
+                chunkFilled = true;
+            }
+        }
+    }
+
+    if( chunkFilled )
+    {
+        mWriterCv.notify_one();
+    }
+}
+
+
+//!************************************************************************
+//! Write the SigMF metadata of the recording
+//!
+//! @returns true if the metadata file is written
+//!************************************************************************
+bool TxCapture::writeMetadata() const
+{
+    std::ostringstream meta;
+
+    meta << "{\n";
+    meta << "    \"global\": {\n";
+    meta << "        \"core:datatype\": \"" << ( CAPTURE_FORMAT_CF32 == mFormat ? "cf32_le" : "ci16_le" ) << "\",\n";
+    meta << "        \"core:sample_rate\": " << mSampleRate << ",\n";
+    meta << "        \"core:version\": \"1.0.0\",\n";
+    meta << "        \"core:num_channels\": 1,\n";
+    meta << "        \"core:recorder\": \"RadioModTx\",\n";
+    meta << "        \"core:hw\": \"" << escapeJson( mHardware ) << "\",\n";
+    meta << "        \"core:description\": \"Samples pushed to the Tx DAC\",\n";
+    meta << "        \"core:extensions\": [ { \"name\": \"radiomodtx\", \"version\": \"1.0.0\", \"optional\": true } ],\n";
+    meta << "        \"radiomodtx:dropped_samples\": " << mDroppedPairsNr << "\n";
+    meta << "    },\n";
+
+    meta << "    \"captures\": [";
+
+    for( size_t i = 0; i < mSegmentVec.size(); i++ )
+    {
+        const Segment& segment = mSegmentVec.at( i );
+
+        meta << ( i ? ",\n" : "\n" );
+        meta << "        { \"core:sample_start\": " << segment.sampleStart
+             << ", \"core:frequency\": " << segment.loFrequency
+             << ", \"core:datetime\": \"" << segment.datetime << "\" }";
+    }
+
+    meta << "\n    ],\n";
+    meta << "    \"annotations\": [";
+
+    // the samples lost by a failed write are not in the file
+    const uint64_t SAMPLES_NR = std::min( mQueuedPairsNr, mWrittenPairsNr );
+    bool first = true;
+
+    for( size_t i = 0; i < mAnnotationVec.size(); i++ )
+    {
+        const Annotation& annotation = mAnnotationVec.at( i );
+        const uint64_t END = std::min( ( i + 1 < mAnnotationVec.size() ) ? mAnnotationVec.at( i + 1 ).sampleStart : mQueuedPairsNr, SAMPLES_NR );
+
+        if( annotation.sampleStart < END )
+        {
+            const SignalInfo& info = annotation.info;
+
+            meta << ( first ? "\n" : ",\n" );
+            meta << "        { \"core:sample_start\": " << annotation.sampleStart
+                 << ", \"core:sample_count\": " << END - annotation.sampleStart
+                 << ", \"core:label\": \"" << escapeJson( info.modulation ) << "\""
+                 << ", \"core:comment\": \"" << escapeJson( info.dataset + " " + info.modulation ) << " " << info.snrDb << " dB\""
+                 << ", \"radiomodtx:dataset\": \"" << escapeJson( info.dataset ) << "\""
+                 << ", \"radiomodtx:modulation\": \"" << escapeJson( info.modulation ) << "\""
+                 << ", \"radiomodtx:snr_db\": " << info.snrDb << " }";
+
+            first = false;
+        }
+    }
+
+    meta << "\n    ]\n";
+    meta << "}\n";
+
+    std::ofstream metaFile( mBaseName + ".sigmf-meta", std::ios::trunc );
+    bool status = metaFile.is_open();
+
+    if( status )
+    {
+        metaFile << meta.str();
+        metaFile.close();
+        status = !metaFile.fail();
+    }
+
+    return status;
+}
@@ -0,0 +1,184 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+
+/*
+TxCapture.h
+
+This file contains the definitions for Tx capture.
+*/
+
+#ifndef TxCapture_h
+#define TxCapture_h
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+//************************************************************************
+// Class for recording the DAC samples pushed to the Tx buffer as a SigMF
+// recording: <base>.sigmf-data with the samples, as complex 16-bit
+// integers (ci16_le) or complex floats (cf32_le), and <base>.sigmf-meta
+// with the sample rate, the LO frequency of each capture segment and an
+// annotation per signal (dataset, modulation, SNR).
+//
+// The Tx path only copies the pairs into preallocated, page-aligned
+// chunks. Full chunks are converted and written by a background thread
+// with one large write each. The Tx path never waits for the disk: when
+// no chunk is free, the pairs are dropped and counted.
+//************************************************************************
+class TxCapture
+{
+    //************************************************************************
+    // constants and types
+    //************************************************************************
+    public:
+        typedef enum
+        {
+            CAPTURE_FORMAT_NONE,
+            CAPTURE_FORMAT_CI16,
+            CAPTURE_FORMAT_CF32
+        }CaptureFormat;
+
+        typedef struct
+        {
+            std::string     dataset;        //!< dataset name
+            std::string     modulation;     //!< modulation name
+            int             snrDb;          //!< SNR [dB]
+            int64_t         loFrequency;    //!< Tx LO frequency [Hz]
+        }SignalInfo;
+
+        static const size_t PAIR_BYTES = 2 * sizeof( int16_t );    //!< size of a DAC (I,Q) pair [bytes]
+
+    private:
+        static const size_t CHUNK_BYTES = 4 * 1048576;              //!< size of a chunk of pairs [bytes]
+        static const size_t CHUNKS_NR = 16;                         //!< chunks queued for the writer
+        static const size_t CHUNK_ALIGNMENT = 4096;                 //!< alignment of the chunks [bytes]
+
+        typedef struct
+        {
+            uint64_t        sampleStart;    //!< first sample of the segment
+            int64_t         loFrequency;    //!< Tx LO frequency [Hz]
+            std::string     datetime;       //!< start time, ISO 8601 UTC
+        }Segment;
+
+        typedef struct
+        {
+            uint64_t        sampleStart;    //!< first sample of the annotation
+            SignalInfo      info;           //!< signal recorded
+        }Annotation;
+
+        typedef struct
+        {
+            size_t          index;          //!< chunk index
+            size_t          bytesNr;        //!< bytes filled in the chunk
+        }FilledChunk;
+
+
+    //************************************************************************
+    // functions
+    //************************************************************************
+    public:
+        TxCapture();
+
+        ~TxCapture();
+
+        TxCapture( const TxCapture& ) = delete;
+        TxCapture& operator=( const TxCapture& ) = delete;
+
+        void annotate
+            (
+            const SignalInfo&       aInfo           //!< signal from now on
+            );
+
+        void close();
+
+        uint64_t getDroppedPairsNr() const;
+
+        uint64_t getWrittenPairsNr() const;
+
+        bool isOpen() const;
+
+        bool open
+            (
+            const std::string&      aBaseName,      //!< recording name, without the SigMF extension
+            const CaptureFormat     aFormat,        //!< sample format of the recording
+            const int64_t           aSampleRate,    //!< sampling frequency [Hz]
+            const int64_t           aLoFrequency,   //!< Tx LO frequency [Hz]
+            const std::string&      aHardware       //!< description of the Tx device
+            );
+
+        void write
+            (
+            const uint8_t*          aPairs,         //!< packed DAC pairs, I first, little-endian, MSB-justified
+            const size_t            aPairsNr        //!< number of pairs
+            );
+
+    private:
+        static std::string escapeJson
+            (
+            const std::string&      aString         //!< string
+            );
+
+        static std::string makeDatetime();
+
+        void run();
+
+        bool writeMetadata() const;
+
+
+    //************************************************************************
+    // variables
+    //************************************************************************
+    private:
+        std::string                 mBaseName;          //!< recording name, without the SigMF extension
+        CaptureFormat               mFormat;            //!< sample format of the recording
+        int64_t                     mSampleRate;        //!< sampling frequency [Hz]
+        std::string                 mHardware;          //!< description of the Tx device
+        int                         mFd;                //!< data file descriptor
+
+        std::vector<uint8_t*>       mChunkVec;          //!< aligned chunks of pairs
+        uint8_t*                    mConvertBuf;        //!< aligned buffer for the cf32 conversion
+        std::deque<size_t>          mFreeChunkQueue;    //!< chunks free for the Tx path
+        std::deque<FilledChunk>     mFilledChunkQueue;  //!< chunks ready to be written
+        size_t                      mCrtChunk;          //!< chunk being filled
+        size_t                      mCrtBytes;          //!< bytes filled in the current chunk
+        bool                        mHasCrtChunk;       //!< true if a chunk is being filled
+
+        std::vector<Segment>        mSegmentVec;        //!< capture segments
+        std::vector<Annotation>     mAnnotationVec;     //!< annotations
+
+        uint64_t                    mQueuedPairsNr;     //!< pairs accepted, i.e. index of the next sample
+        uint64_t                    mWrittenPairsNr;    //!< pairs written to the data file
+        uint64_t                    mDroppedPairsNr;    //!< pairs dropped for lack of a free chunk
+        bool                        mWriteFailed;       //!< true if a write to the data file failed
+
+        mutable std::mutex          mMutex;             //!< protects the chunks and the counters
+        std::condition_variable     mWriterCv;          //!< signals a filled chunk or the stop
+        bool                        mOpen;              //!< true while recording
+        bool                        mStopping;          //!< true when the writer has to exit
+
+        std::thread                 mThread;            //!< writer thread
+};
+
+#endif // TxCapture_h
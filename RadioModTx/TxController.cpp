@@ -0,0 +1,448 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+/*
+TxController.cpp
+
+This file contains the sources for Tx controller.
+*/
+
+#include "TxController.h"
+#include "DatasetIndex.h"
+
+#include <iostream>
+#include <utility>
+
+
+//!************************************************************************
+//! Constructor
+//!************************************************************************
+TxController::TxController()
+    : mTxHal( TxHal::getInstance() )
+    , mTxState()
+    , mStopping( false )
+{
+    mTxState.txDevice = TxHal::TX_DEVICE_UNKNOWN;
+
+    mThread = std::thread( &TxController::run, this );
+}
+
+
+//!************************************************************************
+//! Destructor. The queued commands are executed before the worker exits.
+//!************************************************************************
+TxController::~TxController()
+{
+    {
+        std::lock_guard<std::mutex> lock( mQueueMutex );
+        mStopping = true;
+    }
+
+    mQueueCv.notify_all();
+    mThread.join();
+}
+
+
+//!************************************************************************
+//! Queue a command for the worker
+//!
+//! @returns nothing
+//!************************************************************************
+void TxController::enqueue
+    (
+    Command aCommand            //!< command to queue
+    )
+{
+    aCommand.issueTime = std::chrono::steady_clock::now();
+
+    {
+        std::lock_guard<std::mutex> lock( mQueueMutex );
+        mCommandQueue.push_back( std::move( aCommand ) );
+    }
+
+    mQueueCv.notify_one();
+}
+
+
+//!************************************************************************
+//! Execute a command on the HAL and report its completion
+//!
+//! @returns nothing
+//!************************************************************************
+void TxController::execute
+    (
+    const Command& aCommand     //!< command to execute
+    )
+{
+    bool status = false;
+
+    {
+        std::lock_guard<std::mutex> lock( mTxHalMutex );
+
+        switch( aCommand.type )
+        {
+            case COMMAND_INITIALIZE:
+                status = mTxHal->initializeTxDevice( aCommand.scanIndex );
+                publishState();
+                break;
+
+            case COMMAND_RELEASE_DATA:
+                mTxHal->getData( nullptr );
+                status = true;
+                break;
+
+            case COMMAND_SCAN_CONTEXTS:
+                mTxHal->updateIioScanContexts();
+                publishState();
+                status = true;
+                break;
+
+            case COMMAND_SET_LO_FREQUENCY:
+                status = mTxHal->isInitialized() && mTxHal->setTxLoFrequency( aCommand.frequency );
+                publishState();
+                break;
+
+            case COMMAND_SET_NCO_GAIN_SCALE:
+                status = mTxHal->isInitialized() && mTxHal->setTxNcoGainScale( aCommand.gainScale );
+                publishState();
+                break;
+
+            case COMMAND_START:
+            {
+                // loads the block from the source file in index-only mode
+                Dataset::SignalDataPtr signalData;
+
+                if( mTxHal->isInitialized() && aCommand.snapshot )
+                {
+                    signalData = aCommand.snapshot->getBlock( aCommand.pair );
+                }
+
+                status = nullptr != signalData;
+
+                if( status )
+                {
+                    // a failed capture does not prevent streaming
+                    if( TxCapture::CAPTURE_FORMAT_NONE == aCommand.captureFormat )
+                    {
+                        mTxHal->stopCapture();
+                    }
+                    else if( !mTxHal->startCapture( aCommand.captureName, aCommand.captureFormat ) )
+                    {
+                        std::cout << "Cannot start the capture " << aCommand.captureName << std::endl;
+                    }
+
+                    mTxHal->getData( signalData );
+                    mTxHal->setContinuousStreaming( aCommand.continuous );
+                    mTxHal->annotateCapture( aCommand.signalInfo );
+                    mTxHal->startStreaming();
+                }
+                break;
+            }
+
+            case COMMAND_STOP:
+                status = mTxHal->isInitialized();
+
+                if( status )
+                {
+                    mTxHal->stopStreaming();
+                    mTxHal->stopCapture();
+                }
+                break;
+
+            case COMMAND_UPDATE_SAMPLING_FREQUENCY:
+                status = mTxHal->isInitialized();
+
+                if( status )
+                {
+                    mTxHal->updateSamplingFrequency( aCommand.datasetSource );
+                }
+
+                publishState();
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    const qint64 LATENCY_US = std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - aCommand.issueTime ).count();
+
+    switch( aCommand.type )
+    {
+        case COMMAND_INITIALIZE:
+            emit deviceInitialized( status );
+            break;
+
+        case COMMAND_SCAN_CONTEXTS:
+            emit contextsScanned();
+            break;
+
+        case COMMAND_SET_LO_FREQUENCY:
+        case COMMAND_SET_NCO_GAIN_SCALE:
+            emit txRetuned( status, LATENCY_US );
+            break;
+
+        case COMMAND_START:
+            emit streamingStarted( status, LATENCY_US );
+            break;
+
+        case COMMAND_STOP:
+            emit streamingStopped( LATENCY_US );
+            break;
+
+        case COMMAND_UPDATE_SAMPLING_FREQUENCY:
+            emit samplingFrequencyUpdated();
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+//!************************************************************************
+//! Get the Tx settings published by the worker after its last command.
+//! Never waits for the HAL, so it can be called from the GUI thread.
+//!
+//! @returns The Tx settings
+//!************************************************************************
+TxController::TxState TxController::getTxState() const
+{
+    std::lock_guard<std::mutex> lock( mStateMutex );
+    return mTxState;
+}
+
+
+//!************************************************************************
+//! Queue the initialization of a Tx device
+//!
+//! @returns nothing
+//!************************************************************************
+void TxController::initializeTxDevice
+    (
+    const int aIndex            //!< IIO scan context index
+    )
+{
+    Command command = {};
+    command.type = COMMAND_INITIALIZE;
+    command.scanIndex = aIndex;
+
+    enqueue( command );
+}
+
+
+//!************************************************************************
+//! Lock the HAL, for reading it outside the worker
+//!
+//! @returns The lock, held until destroyed
+//!************************************************************************
+std::unique_lock<std::mutex> TxController::lockTxHal()
+{
+    return std::unique_lock<std::mutex>( mTxHalMutex );
+}
+
+
+//!************************************************************************
+//! Read the Tx settings from the HAL and publish them. Called by the
+//! worker while holding the HAL lock.
+//!
+//! @returns nothing
+//!************************************************************************
+void TxController::publishState()
+{
+    TxState state = {};
+    state.isInitialized = mTxHal->isInitialized();
+    state.txDevice = mTxHal->getTxDevice();
+    state.loFrequencyRange = mTxHal->getTxLoFrequencyRange();
+    mTxHal->getTxLoFrequency( state.loFrequency );
+
+    if( state.isInitialized && TxHal::TX_DEVICE_AD9081 == state.txDevice )
+    {
+        mTxHal->getTxNcoGainScale( state.ncoGainScale );
+    }
+
+    mTxHal->getTxSamplingFrequency( state.samplingFrequency );
+    mTxHal->getTxBandwidth( state.bandwidth );
+    mTxHal->getTxHwGain( state.hwGain );
+    state.scanContextVec = mTxHal->getIioScanContexts();
+
+    std::lock_guard<std::mutex> lock( mStateMutex );
+    mTxState = std::move( state );
+}
+
+
+//!************************************************************************
+//! Queue the release of the signal data held by the HAL
+//!
+//! @returns nothing
+//!************************************************************************
+void TxController::releaseData()
+{
+    Command command = {};
+    command.type = COMMAND_RELEASE_DATA;
+
+    enqueue( command );
+}
+
+
+//!************************************************************************
+//! Worker loop: execute the queued commands in order
+//!
+//! @returns nothing
+//!************************************************************************
+void TxController::run()
+{
+    std::unique_lock<std::mutex> lock( mQueueMutex );
+
+    while( true )
+    {
+        mQueueCv.wait( lock, [this]{ return mStopping || mCommandQueue.size(); } );
+
+        if( mCommandQueue.empty() )
+        {
+            break;
+        }
+
+        Command command = std::move( mCommandQueue.front() );
+        mCommandQueue.pop_front();
+
+        // a retune directly followed by one of the same kind is obsolete,
+        // any other command in between keeps it
+        const bool OBSOLETE = ( COMMAND_SET_LO_FREQUENCY == command.type || COMMAND_SET_NCO_GAIN_SCALE == command.type )
+                           && mCommandQueue.size()
+                           && ( command.type == mCommandQueue.front().type );
+
+        if( !OBSOLETE )
+        {
+            lock.unlock();
+            execute( command );
+            lock.lock();
+        }
+    }
+}
+
+
+//!************************************************************************
+//! Queue a scan of the IIO contexts. The contexts are published in the
+//! Tx settings once contextsScanned() is emitted.
+//!
+//! @returns nothing
+//!************************************************************************
+void TxController::scanContexts()
+{
+    Command command = {};
+    command.type = COMMAND_SCAN_CONTEXTS;
+
+    enqueue( command );
+}
+
+
+//!************************************************************************
+//! Queue a change of the Tx LO frequency
+//!
+//! @returns nothing
+//!************************************************************************
+void TxController::setTxLoFrequency
+    (
+    const int64_t aFrequency    //!< frequency [Hz]
+    )
+{
+    Command command = {};
+    command.type = COMMAND_SET_LO_FREQUENCY;
+    command.frequency = aFrequency;
+
+    enqueue( command );
+}
+
+
+//!************************************************************************
+//! Queue a change of the Tx NCO gain scale
+//!
+//! @returns nothing
+//!************************************************************************
+void TxController::setTxNcoGainScale
+    (
+    const double aGainScale     //!< gain scale [0..1]
+    )
+{
+    Command command = {};
+    command.type = COMMAND_SET_NCO_GAIN_SCALE;
+    command.gainScale = aGainScale;
+
+    enqueue( command );
+}
+
+
+//!************************************************************************
+//! Queue the start of the streaming of a modulation-SNR combination. The
+//! block is taken from the snapshot by the worker, loading it if needed.
+//!
+//! @returns nothing
+//!************************************************************************
+void TxController::startStreaming
+    (
+    const Dataset::Snapshot&            aSnapshot,      //!< dataset snapshot
+    const Dataset::ModulationSnrPair&   aPair,          //!< modulation-SNR combination
+    const TxCapture::SignalInfo&        aSignalInfo,    //!< signal annotated in the capture
+    const std::string&                  aCaptureName,   //!< capture recording name, without the SigMF extension
+    const TxCapture::CaptureFormat      aCaptureFormat, //!< capture sample format, none for no capture
+    const bool                          aContinuous     //!< true for non-cyclic streaming
+    )
+{
+    Command command = {};
+    command.type = COMMAND_START;
+    command.snapshot = aSnapshot;
+    command.pair = aPair;
+    command.signalInfo = aSignalInfo;
+    command.captureName = aCaptureName;
+    command.captureFormat = aCaptureFormat;
+    command.continuous = aContinuous;
+
+    enqueue( command );
+}
+
+
+//!************************************************************************
+//! Queue the stop of the streaming
+//!
+//! @returns nothing
+//!************************************************************************
+void TxController::stopStreaming()
+{
+    Command command = {};
+    command.type = COMMAND_STOP;
+
+    enqueue( command );
+}
+
+
+//!************************************************************************
+//! Queue the update of the sampling frequency for a dataset
+//!
+//! @returns nothing
+//!************************************************************************
+void TxController::updateSamplingFrequency
+    (
+    const Dataset::DatasetSource aDatasetSource     //!< dataset
+    )
+{
+    Command command = {};
+    command.type = COMMAND_UPDATE_SAMPLING_FREQUENCY;
+    command.datasetSource = aDatasetSource;
+
+    enqueue( command );
+}
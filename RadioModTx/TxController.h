@@ -0,0 +1,219 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+/*
+TxController.h
+
+This file contains the definitions for Tx controller.
+*/
+
+#ifndef TxController_h
+#define TxController_h
+
+#include "Dataset.h"
+#include "TxCapture.h"
+#include "TxHal.h"
+
+#include <QObject>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+//************************************************************************
+// Class for driving the Tx HAL asynchronously.
+//
+// Commands (initialize, start, stop, retune...) are queued by the caller
+// and executed in order by a worker thread, so that loading the frames,
+// filling the Tx buffer and the blocking IIO calls never run on the GUI
+// thread. Completion is reported through signals carrying the latency
+// from the command being queued to the HAL call returning. Back-to-back
+// retunes of the same kind are coalesced, only the latest one is applied;
+// any other command in between, such as a start, keeps them apart.
+//
+// After each command the worker publishes a copy of the Tx settings,
+// which the GUI reads through getTxState() without ever waiting for an
+// IIO call. The HAL is only touched by the worker, other non-GUI threads
+// reading it have to hold lockTxHal().
+//************************************************************************
+class TxController : public QObject
+{
+    Q_OBJECT
+
+    //************************************************************************
+    // constants and types
+    //************************************************************************
+    public:
+        typedef struct
+        {
+            bool                                isInitialized;      //!< true if the device is initialized
+            TxHal::TxDevice                     txDevice;           //!< selected device
+            AdiTrx::IntegerRange                loFrequencyRange;   //!< LO frequency range [Hz]
+            int64_t                             loFrequency;        //!< LO frequency [Hz]
+            double                              ncoGainScale;       //!< NCO gain scale [0..1]
+            int64_t                             samplingFrequency;  //!< sampling frequency [Hz]
+            int64_t                             bandwidth;          //!< bandwidth [Hz]
+            double                              hwGain;             //!< hardware gain [dB]
+            std::vector<TxHal::IioScanContext>  scanContextVec;     //!< IIO scan contexts
+        }TxState;
+
+    private:
+        typedef enum
+        {
+            COMMAND_INITIALIZE,
+            COMMAND_RELEASE_DATA,
+            COMMAND_SCAN_CONTEXTS,
+            COMMAND_SET_LO_FREQUENCY,
+            COMMAND_SET_NCO_GAIN_SCALE,
+            COMMAND_START,
+            COMMAND_STOP,
+            COMMAND_UPDATE_SAMPLING_FREQUENCY
+        }CommandType;
+
+        typedef struct
+        {
+            CommandType                             type;           //!< command type
+            std::chrono::steady_clock::time_point   issueTime;      //!< time the command was queued
+            int                                     scanIndex;      //!< IIO scan context index
+            int64_t                                 frequency;      //!< LO frequency [Hz]
+            double                                  gainScale;      //!< NCO gain scale [0..1]
+            Dataset::DatasetSource                  datasetSource;  //!< dataset setting the sampling frequency
+            Dataset::Snapshot                       snapshot;       //!< dataset snapshot to stream from
+            Dataset::ModulationSnrPair              pair;           //!< modulation-SNR combination to stream
+            TxCapture::SignalInfo                   signalInfo;     //!< signal annotated in the capture
+            std::string                             captureName;    //!< capture recording name
+            TxCapture::CaptureFormat                captureFormat;  //!< capture sample format, none for no capture
+            bool                                    continuous;     //!< true for non-cyclic streaming
+        }Command;
+
+
+    //************************************************************************
+    // functions
+    //************************************************************************
+    public:
+        TxController();
+
+        ~TxController();
+
+        TxState getTxState() const;
+
+        void initializeTxDevice
+            (
+            const int aIndex            //!< IIO scan context index
+            );
+
+        std::unique_lock<std::mutex> lockTxHal();
+
+        void releaseData();
+
+        void scanContexts();
+
+        void setTxLoFrequency
+            (
+            const int64_t aFrequency    //!< frequency [Hz]
+            );
+
+        void setTxNcoGainScale
+            (
+            const double aGainScale     //!< gain scale [0..1]
+            );
+
+        void startStreaming
+            (
+            const Dataset::Snapshot&            aSnapshot,      //!< dataset snapshot
+            const Dataset::ModulationSnrPair&   aPair,          //!< modulation-SNR combination
+            const TxCapture::SignalInfo&        aSignalInfo,    //!< signal annotated in the capture
+            const std::string&                  aCaptureName,   //!< capture recording name, without the SigMF extension
+            const TxCapture::CaptureFormat      aCaptureFormat, //!< capture sample format, none for no capture
+            const bool                          aContinuous     //!< true for non-cyclic streaming
+            );
+
+        void stopStreaming();
+
+        void updateSamplingFrequency
+            (
+            const Dataset::DatasetSource aDatasetSource     //!< dataset
+            );
+
+    signals:
+        void contextsScanned();
+
+        void deviceInitialized
+            (
+            bool aStatus                //!< true if the device is initialized
+            );
+
+        void samplingFrequencyUpdated();
+
+        void streamingStarted
+            (
+            bool    aStatus,            //!< true if streaming started
+            qint64  aLatencyUs          //!< latency from the command [us]
+            );
+
+        void streamingStopped
+            (
+            qint64  aLatencyUs          //!< latency from the command [us]
+            );
+
+        void txRetuned
+            (
+            bool    aStatus,            //!< true if the setting was applied
+            qint64  aLatencyUs          //!< latency from the command [us]
+            );
+
+    private:
+        void enqueue
+            (
+            Command aCommand            //!< command to queue
+            );
+
+        void execute
+            (
+            const Command& aCommand     //!< command to execute
+            );
+
+        void publishState();
+
+        void run();
+
+
+    //************************************************************************
+    // variables
+    //************************************************************************
+    private:
+        TxHal*                          mTxHal;             //!< Tx HAL
+        std::mutex                      mTxHalMutex;        //!< serializes the HAL accesses
+
+        TxState                         mTxState;           //!< Tx settings published by the worker
+        mutable std::mutex              mStateMutex;        //!< protects the published settings, never held during IIO calls
+
+        std::deque<Command>             mCommandQueue;      //!< queued commands
+        std::mutex                      mQueueMutex;        //!< protects the command queue
+        std::condition_variable         mQueueCv;           //!< signals a queued command
+        bool                            mStopping;          //!< true when the worker has to exit
+
+        std::thread                     mThread;            //!< worker executing the commands
+};
+
+#endif // TxController_h
@@ -24,6 +24,7 @@ This file contains the sources for transmitter HAL.
 #include "TxHal.h"
 
 #include <algorithm>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 
@@ -45,10 +46,16 @@ const std::string TxHal::DEFAULT_IP_URI = "ip:10.0.0.2";
 //! Constructor
 //!************************************************************************
 TxHal::TxHal()
-    : mTxDevice( TX_DEVICE_UNKNOWN )
+    : mIioScanContextsCount( 0 )
+    , mTxDevice( TX_DEVICE_UNKNOWN )
+    , mSimTxDevice( TX_DEVICE_UNKNOWN )
     , mIsInitialized( false )
 {
-    updateIioScanContexts();
+    // the capture only records while open
+    mTrxAd9361.setCapture( &mCapture );
+    mTrxAd9081.setCapture( &mCapture );
+    mTrxAdrv9009.setCapture( &mCapture );
+    mTrxSim.setCapture( &mCapture );
 }
 
 
@@ -68,6 +75,106 @@ TxHal* TxHal::getInstance()
 }
 
 
+//!************************************************************************
+//! Add an IIO context given by its URI to the scan contexts, without
+//! scanning. The Tx device is identified from the devices of the context;
+//! unlike the default IP context of a scan, an AD9361 is also recognized,
+//! since a URI given explicitly has no scan description to identify it.
+//!
+//! @returns The index of the context, -1 if it has no known Tx device
+//!************************************************************************
+int TxHal::addIioContext
+    (
+    const std::string& aUri     //!< URI
+    )
+{
+    IioScanContext isc;
+    isc.uri = aUri;
+
+    if( AdiTrxSim::isSimulatedUri( aUri ) )
+    {
+        std::string deviceName = aUri.substr( AdiTrxSim::URI_PREFIX.size() );
+        std::transform( deviceName.begin(), deviceName.end(), deviceName.begin(), ::toupper );
+        isc.description = "Simulated " + deviceName;
+    }
+    else
+    {
+        isc.description = describeContext( aUri, true );
+    }
+
+    int index = -1;
+
+    if( isc.description.size() )
+    {
+        mIioScanContextsVec.push_back( isc );
+        mIioScanContextsCount = mIioScanContextsVec.size();
+        index = static_cast<int>( mIioScanContextsCount ) - 1;
+    }
+
+    return index;
+}
+
+
+//!************************************************************************
+//! Annotate the capture with the signal streamed from now on, at the
+//! current LO frequency
+//!
+//! @returns nothing
+//!************************************************************************
+void TxHal::annotateCapture
+    (
+    TxCapture::SignalInfo aInfo     //!< signal streamed
+    )
+{
+    if( mIsInitialized && mCapture.isOpen() )
+    {
+        getTxLoFrequency( aInfo.loFrequency );
+        mCapture.annotate( aInfo );
+    }
+}
+
+
+//!************************************************************************
+//! Describe the Tx device of a context by one of its name IDs. An ADRV9009
+//! or an AD9081/AD9082 is recognized by its Tx HPC device; an AD9361 by
+//! its ad9361-phy device, only when asked for, as the AD9361 boards found
+//! by a scan are already described by it.
+//!
+//! @returns The description, empty if the context cannot be created or
+//! has no known Tx device
+//!************************************************************************
+std::string TxHal::describeContext
+    (
+    const std::string& aUri,        //!< URI
+    const bool         aWithAd9361  //!< true to also recognize an AD9361
+    ) const
+{
+    std::string description;
+    struct iio_context* iioCtx = iio_create_context_from_uri( aUri.c_str() );
+
+    if( iioCtx )
+    {
+        if( iio_context_find_device( iioCtx, "axi-adrv9009-tx-hpc" ) )
+        {
+            description = TX_DEVICE_NAME_IDS.at( TX_DEVICE_ADRV9009 ).at( 0 );
+        }
+        else if( iio_context_find_device( iioCtx, "axi-ad9081-tx-hpc" )
+              || iio_context_find_device( iioCtx, "axi-ad9082-tx-hpc" ) )
+        {
+            description = TX_DEVICE_NAME_IDS.at( TX_DEVICE_AD9081 ).at( 0 );
+        }
+        else if( aWithAd9361 && iio_context_find_device( iioCtx, "ad9361-phy" ) )
+        {
+            description = TX_DEVICE_NAME_IDS.at( TX_DEVICE_AD9361 ).at( 0 );
+        }
+
+        iio_context_destroy( iioCtx );
+    }
+
+    return description;
+}
+
+
 //!************************************************************************
 //! Get the signal data for a modulation-SNR combination
 //!
@@ -75,7 +182,7 @@ TxHal* TxHal::getInstance()
 //!************************************************************************
 void TxHal::getData
     (
-    Dataset::SignalData& aSignalData    //!< signal data for a modulation-SNR combination
+    const Dataset::SignalDataPtr& aSignalData   //!< signal data for a modulation-SNR combination
     )
 {
     switch( mTxDevice )
@@ -92,6 +199,10 @@ void TxHal::getData
             mTrxAdrv9009.getSignalData( aSignalData );
             break;
 
+        case TX_DEVICE_SIM:
+            mTrxSim.getSignalData( aSignalData );
+            break;
+
         default:
             break;
     }
@@ -99,27 +210,43 @@ void TxHal::getData
 
 
 //!************************************************************************
-//! Get the name of the file where to dump data
+//! Get the IIO scan contexts
+//!
+//! @returns The vector with IIO scan contexts
+//!************************************************************************
+std::vector<TxHal::IioScanContext> TxHal::getIioScanContexts() const
+{
+    return mIioScanContextsVec;
+}
+
+
+//!************************************************************************
+//! Get the sequence of signal data for non-cyclic streaming, empty for
+//! the current signal data
 //!
 //! @returns nothing
 //!************************************************************************
-void TxHal::getDumpFilename
+void TxHal::getSequence
     (
-    std::string& aFilename      //!< filename
+    const std::vector<Dataset::SignalDataPtr>& aSequenceVec    //!< signal data streamed in order
     )
 {
     switch( mTxDevice )
     {
         case TX_DEVICE_AD9361:
-            mTrxAd9361.getDumpFilename( aFilename );
+            mTrxAd9361.getSignalSequence( aSequenceVec );
             break;
 
         case TX_DEVICE_AD9081:
-            mTrxAd9081.getDumpFilename( aFilename );
+            mTrxAd9081.getSignalSequence( aSequenceVec );
             break;
 
         case TX_DEVICE_ADRV9009:
-            mTrxAdrv9009.getDumpFilename( aFilename );
+            mTrxAdrv9009.getSignalSequence( aSequenceVec );
+            break;
+
+        case TX_DEVICE_SIM:
+            mTrxSim.getSignalSequence( aSequenceVec );
             break;
 
         default:
@@ -129,13 +256,72 @@ void TxHal::getDumpFilename
 
 
 //!************************************************************************
-//! Get the IIO scan contexts
+//! Get the number of (I,Q) pairs streamed, as counted by the device
 //!
-//! @returns The vector with IIO scan contexts
+//! @returns The number of pairs streamed since the stream started
 //!************************************************************************
-std::vector<TxHal::IioScanContext> TxHal::getIioScanContexts() const
+uint64_t TxHal::getStreamPairsNr() const
 {
-    return mIioScanContextsVec;
+    uint64_t pairsNr = 0;
+
+    switch( mTxDevice )
+    {
+        case TX_DEVICE_AD9361:
+            pairsNr = mTrxAd9361.getStreamPairsNr();
+            break;
+
+        case TX_DEVICE_AD9081:
+            pairsNr = mTrxAd9081.getStreamPairsNr();
+            break;
+
+        case TX_DEVICE_ADRV9009:
+            pairsNr = mTrxAdrv9009.getStreamPairsNr();
+            break;
+
+        case TX_DEVICE_SIM:
+            pairsNr = mTrxSim.getStreamPairsNr();
+            break;
+
+        default:
+            break;
+    }
+
+    return pairsNr;
+}
+
+
+//!************************************************************************
+//! Get the number of times non-cyclic streaming ran out of converted data
+//!
+//! @returns The number of underflows since the stream started
+//!************************************************************************
+uint64_t TxHal::getStreamUnderflowsNr() const
+{
+    uint64_t underflowsNr = 0;
+
+    switch( mTxDevice )
+    {
+        case TX_DEVICE_AD9361:
+            underflowsNr = mTrxAd9361.getStreamUnderflowsNr();
+            break;
+
+        case TX_DEVICE_AD9081:
+            underflowsNr = mTrxAd9081.getStreamUnderflowsNr();
+            break;
+
+        case TX_DEVICE_ADRV9009:
+            underflowsNr = mTrxAdrv9009.getStreamUnderflowsNr();
+            break;
+
+        case TX_DEVICE_SIM:
+            underflowsNr = mTrxSim.getStreamUnderflowsNr();
+            break;
+
+        default:
+            break;
+    }
+
+    return underflowsNr;
 }
 
 
@@ -165,6 +351,10 @@ bool TxHal::getTxBandwidth
             status = mTrxAdrv9009.getTxBandwidth( aBandwidth );
             break;
 
+        case TX_DEVICE_SIM:
+            status = mTrxSim.getTxBandwidth( aBandwidth );
+            break;
+
         default:
             break;
     }
@@ -180,7 +370,7 @@ bool TxHal::getTxBandwidth
 //!************************************************************************
 TxHal::TxDevice TxHal::getTxDevice() const
 {
-    return mTxDevice;
+    return ( TX_DEVICE_SIM == mTxDevice ) ? mSimTxDevice : mTxDevice;
 }
 
 
@@ -210,6 +400,10 @@ bool TxHal::getTxHwGain
             status = mTrxAdrv9009.getTxHwGain( aHwGainDb );
             break;
 
+        case TX_DEVICE_SIM:
+            status = mTrxSim.getTxHwGain( aHwGainDb );
+            break;
+
         default:
             break;
     }
@@ -244,6 +438,10 @@ bool TxHal::getTxLoFrequency
             status = mTrxAdrv9009.getTxLoFrequency( aFrequency );
             break;
 
+        case TX_DEVICE_SIM:
+            status = mTrxSim.getTxLoFrequency( aFrequency );
+            break;
+
         default:
             break;
     }
@@ -276,6 +474,10 @@ AdiTrx::IntegerRange TxHal::getTxLoFrequencyRange() const
             freqRange = mTrxAdrv9009.getTxLoFrequencyRange();
             break;
 
+        case TX_DEVICE_SIM:
+            freqRange = mTrxSim.getTxLoFrequencyRange();
+            break;
+
         default:
             break;
     }
@@ -310,6 +512,10 @@ bool TxHal::getTxNcoGainScale
             status = mTrxAdrv9009.getTxNcoGainScale( aGainScale );
             break;
 
+        case TX_DEVICE_SIM:
+            status = mTrxSim.getTxNcoGainScale( aGainScale );
+            break;
+
         default:
             break;
     }
@@ -344,6 +550,10 @@ bool TxHal::getTxSamplingFrequency
             status = mTrxAdrv9009.getTxSamplingFrequency( aFrequency );
             break;
 
+        case TX_DEVICE_SIM:
+            status = mTrxSim.getTxSamplingFrequency( aFrequency );
+            break;
+
         default:
             break;
     }
@@ -364,6 +574,8 @@ bool TxHal::initializeTxDevice
 {
     if( mIsInitialized )
     {
+        stopCapture();
+
         switch( mTxDevice )
         {
             case TX_DEVICE_AD9361:
@@ -378,6 +590,10 @@ bool TxHal::initializeTxDevice
                 mTrxAdrv9009.freeResources();
                 break;
 
+            case TX_DEVICE_SIM:
+                mTrxSim.freeResources();
+                break;
+
             default:
                 break;
         }
@@ -385,6 +601,8 @@ bool TxHal::initializeTxDevice
 
     bool status = false;
     mTxDevice = TX_DEVICE_UNKNOWN;
+    mSimTxDevice = TX_DEVICE_UNKNOWN;
+    mTxDeviceDescription.clear();
     mIsInitialized = false;
 
     if( aIndex >= 0 && aIndex < mIioScanContextsCount )
@@ -418,6 +636,18 @@ bool TxHal::initializeTxDevice
         }
 
         status = found;
+
+        // the emulated device stays visible through getTxDevice()
+        if( status && AdiTrxSim::isSimulatedUri( mIioScanContextsVec.at( aIndex ).uri ) )
+        {
+            mSimTxDevice = mTxDevice;
+            mTxDevice = TX_DEVICE_SIM;
+        }
+
+        if( status )
+        {
+            mTxDeviceDescription = descr;
+        }
     }
 
     if( status )
@@ -436,6 +666,10 @@ bool TxHal::initializeTxDevice
                 status = mTrxAdrv9009.initialize( mIioScanContextsVec.at( aIndex ).uri );
                 break;
 
+            case TX_DEVICE_SIM:
+                status = mTrxSim.initialize( mIioScanContextsVec.at( aIndex ).uri );
+                break;
+
             default:
                 break;
         }
@@ -485,6 +719,88 @@ bool TxHal::isInitialized() const
 }
 
 
+//!************************************************************************
+//! Check if the Tx device is emulated
+//!
+//! @returns true for a simulated device
+//!************************************************************************
+bool TxHal::isSimulated() const
+{
+    return TX_DEVICE_SIM == mTxDevice;
+}
+
+
+//!************************************************************************
+//! Select cyclic or non-cyclic streaming, used from the next start
+//!
+//! @returns nothing
+//!************************************************************************
+//! Write the signal data transmitted next in the DAC format of the device,
+//! so that the following getData() and startStreaming() only copy it.
+//! Only the waveform cache is written, not the device, so it can be called
+//! without the HAL lock while the device and the streaming mode are kept.
+//!
+//! @returns nothing
+//!************************************************************************
+void TxHal::prerenderData
+    (
+    const Dataset::SignalDataPtr& aSignalData   //!< signal data transmitted next
+    ) const
+{
+    switch( mTxDevice )
+    {
+        case TX_DEVICE_AD9361:
+            mTrxAd9361.prerenderSignalData( aSignalData );
+            break;
+
+        case TX_DEVICE_AD9081:
+            mTrxAd9081.prerenderSignalData( aSignalData );
+            break;
+
+        case TX_DEVICE_ADRV9009:
+            mTrxAdrv9009.prerenderSignalData( aSignalData );
+            break;
+
+        case TX_DEVICE_SIM:
+            mTrxSim.prerenderSignalData( aSignalData );
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+//!************************************************************************
+void TxHal::setContinuousStreaming
+    (
+    const bool aEnable          //!< true for non-cyclic streaming
+    )
+{
+    switch( mTxDevice )
+    {
+        case TX_DEVICE_AD9361:
+            mTrxAd9361.setContinuousStreaming( aEnable );
+            break;
+
+        case TX_DEVICE_AD9081:
+            mTrxAd9081.setContinuousStreaming( aEnable );
+            break;
+
+        case TX_DEVICE_ADRV9009:
+            mTrxAdrv9009.setContinuousStreaming( aEnable );
+            break;
+
+        case TX_DEVICE_SIM:
+            mTrxSim.setContinuousStreaming( aEnable );
+            break;
+
+        default:
+            break;
+    }
+}
+
+
 //!************************************************************************
 //! Set the Tx LO frequency [Hz]
 //!
@@ -511,6 +827,10 @@ bool TxHal::setTxLoFrequency
             status = mTrxAdrv9009.setTxLoFrequency( aFrequency );
             break;
 
+        case TX_DEVICE_SIM:
+            status = mTrxSim.setTxLoFrequency( aFrequency );
+            break;
+
         default:
             break;
     }
@@ -545,6 +865,10 @@ bool TxHal::setTxNcoGainScale
             status = mTrxAdrv9009.setTxNcoGainScale( aGainScale );
             break;
 
+        case TX_DEVICE_SIM:
+            status = mTrxSim.setTxNcoGainScale( aGainScale );
+            break;
+
         default:
             break;
     }
@@ -579,6 +903,10 @@ bool TxHal::setTxSamplingFrequency
             // intentionally do nothing
             break;
 
+        case TX_DEVICE_SIM:
+            status = mTrxSim.setTxSamplingFrequency( aFrequency );
+            break;
+
         default:
             break;
     }
@@ -587,6 +915,33 @@ bool TxHal::setTxSamplingFrequency
 }
 
 
+//!************************************************************************
+//! Start recording the pairs pushed to the Tx buffer as a SigMF recording,
+//! at the current sampling and LO frequencies
+//!
+//! @returns true if the recording is started
+//!************************************************************************
+bool TxHal::startCapture
+    (
+    const std::string&                  aBaseName,  //!< recording name, without the SigMF extension
+    const TxCapture::CaptureFormat      aFormat     //!< sample format of the recording
+    )
+{
+    int64_t samplingFrequency = 0;
+    int64_t loFrequency = 0;
+
+    bool status = mIsInitialized && getTxSamplingFrequency( samplingFrequency );
+
+    if( status )
+    {
+        getTxLoFrequency( loFrequency );
+        status = mCapture.open( aBaseName, aFormat, samplingFrequency, loFrequency, mTxDeviceDescription );
+    }
+
+    return status;
+}
+
+
 //!************************************************************************
 //! Start the streaming
 //!
@@ -608,12 +963,27 @@ void TxHal::startStreaming()
             mTrxAdrv9009.startTxStreaming();
             break;
 
+        case TX_DEVICE_SIM:
+            mTrxSim.startTxStreaming();
+            break;
+
         default:
             break;
     }
 }
 
 
+//!************************************************************************
+//! Stop recording the pairs pushed to the Tx buffer
+//!
+//! @returns nothing
+//!************************************************************************
+void TxHal::stopCapture()
+{
+    mCapture.close();
+}
+
+
 //!************************************************************************
 //! Stop the streaming
 //!
@@ -635,6 +1005,10 @@ void TxHal::stopStreaming()
             mTrxAdrv9009.stopTxStreaming();
             break;
 
+        case TX_DEVICE_SIM:
+            mTrxSim.stopTxStreaming();
+            break;
+
         default:
             break;
     }
@@ -673,28 +1047,25 @@ void TxHal::updateIioScanContexts()
         }
 
         isc.uri = DEFAULT_IP_URI;
-        isc.description = "";
-
-        struct iio_context* iioCtx = iio_create_context_from_uri( isc.uri.c_str() );
+        isc.description = describeContext( isc.uri, false );
 
-        if( iioCtx )
+        if( isc.description.size() )
         {
-            if( iio_context_find_device( iioCtx, "axi-adrv9009-tx-hpc" ) )
-            {
-                isc.description = TX_DEVICE_NAME_IDS.at( TX_DEVICE_ADRV9009 ).at( 0 );
-            }
-            else if( iio_context_find_device( iioCtx, "axi-ad9081-tx-hpc" )
-                  || iio_context_find_device( iioCtx, "axi-ad9082-tx-hpc" ) )
-            {
-                isc.description = TX_DEVICE_NAME_IDS.at( TX_DEVICE_AD9081 ).at( 0 );
-            }
+            mIioScanContextsVec.push_back( isc );
+        }
+    }
 
-            iio_context_destroy( iioCtx );
+    // simulated devices, for running without hardware
+    if( std::getenv( "RADIOMODTX_SIM" ) )
+    {
+        const std::vector<std::string> SIM_NAME_VEC = { "AD9361", "AD9081", "ADRV9009" };
 
-            if( isc.description.size() )
-            {
-                mIioScanContextsVec.push_back( isc );
-            }
+        for( size_t i = 0; i < SIM_NAME_VEC.size(); i++ )
+        {
+            IioScanContext isc;
+            isc.uri = AdiTrxSim::URI_PREFIX + SIM_NAME_VEC.at( i );
+            isc.description = "Simulated " + SIM_NAME_VEC.at( i );
+            mIioScanContextsVec.push_back( isc );
         }
     }
 
@@ -744,6 +1115,14 @@ void TxHal::updateSamplingFrequency
                 // intentionally do nothing
                 break;
 
+            case TX_DEVICE_SIM:
+                {
+                    // rejected when emulating a device with a fixed sampling frequency
+                    const int64_t MIN_FREQ_HZ = 2500000;
+                    mTrxSim.setTxSamplingFrequency( MIN_FREQ_HZ * toMinRatio );
+                }
+                break;
+
             default:
                 break;
         }
@@ -27,6 +27,8 @@ This file contains the definitions for transmitter HAL.
 #include "AdiTrxAd9361.h"
 #include "AdiTrxAdrv9009.h"
 #include "AdiTrxAd9081.h"
+#include "AdiTrxSim.h"
+#include "TxCapture.h"
 
 #include <iio.h>
 
@@ -51,7 +53,9 @@ class TxHal
 
             TX_DEVICE_AD9361,
             TX_DEVICE_AD9081,
-            TX_DEVICE_ADRV9009
+            TX_DEVICE_ADRV9009,
+
+            TX_DEVICE_SIM
         }TxDevice;
 
         static const std::map<TxDevice, std::vector<std::string>> TX_DEVICE_NAME_IDS;
@@ -74,18 +78,32 @@ class TxHal
 
         static TxHal* getInstance();
 
-        void getData
+        int addIioContext
             (
-            Dataset::SignalData& aSignalData    //!< signal data for a modulation-SNR combination
+            const std::string& aUri     //!< URI
             );
 
-        void getDumpFilename
+        void annotateCapture
             (
-            std::string& aFilename      //!< filename
+            TxCapture::SignalInfo aInfo     //!< signal streamed
+            );
+
+        void getData
+            (
+            const Dataset::SignalDataPtr& aSignalData   //!< signal data for a modulation-SNR combination
             );
 
         std::vector<IioScanContext> getIioScanContexts() const;
 
+        void getSequence
+            (
+            const std::vector<Dataset::SignalDataPtr>& aSequenceVec    //!< signal data streamed in order
+            );
+
+        uint64_t getStreamPairsNr() const;
+
+        uint64_t getStreamUnderflowsNr() const;
+
         bool getTxBandwidth
             (
             int64_t& aBandwidth         //!< bandwidth [Hz]
@@ -122,6 +140,18 @@ class TxHal
 
         bool isInitialized() const;
 
+        bool isSimulated() const;
+
+        void prerenderData
+            (
+            const Dataset::SignalDataPtr& aSignalData   //!< signal data transmitted next
+            ) const;
+
+        void setContinuousStreaming
+            (
+            const bool aEnable          //!< true for non-cyclic streaming
+            );
+
         bool setTxLoFrequency
             (
             const int64_t aFrequency    //!< frequency [Hz]
@@ -137,8 +167,16 @@ class TxHal
             const int64_t aFrequency    //!< frequency [Hz]
             );
 
+        bool startCapture
+            (
+            const std::string&                  aBaseName,  //!< recording name, without the SigMF extension
+            const TxCapture::CaptureFormat      aFormat     //!< sample format of the recording
+            );
+
         void startStreaming();
 
+        void stopCapture();
+
         void stopStreaming();
 
         void updateIioScanContexts();
@@ -149,6 +187,12 @@ class TxHal
             );
 
     private:
+        std::string describeContext
+            (
+            const std::string& aUri,        //!< URI
+            const bool         aWithAd9361  //!< true to also recognize an AD9361
+            ) const;
+
         bool isAllowedContext
             (
             const std::string aUri  //!< URI
@@ -165,11 +209,16 @@ class TxHal
         size_t                      mIioScanContextsCount;  //!< number of scan contextst
 
         TxDevice                    mTxDevice;              //!< selected device for transmit
+        TxDevice                    mSimTxDevice;           //!< device emulated when the selected device is simulated
+        std::string                 mTxDeviceDescription;   //!< description of the selected device
         bool                        mIsInitialized;         //!< true if Tx devices initialized
 
+        TxCapture                   mCapture;               //!< capture of the pushed pairs, outlives the transceivers
+
         AdiTrxAd9361                mTrxAd9361;             //!< AD9361 transceiver
         AdiTrxAdrv9009              mTrxAdrv9009;           //!< ADRV9009 transceiver
         AdiTrxAd9081                mTrxAd9081;             //!< AD9081 transceiver
+        AdiTrxSim                   mTrxSim;                //!< simulated transceiver
 };
 
 #endif // TxHal_h
@@ -0,0 +1,442 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+/*
+TxPlaylist.cpp
+
+This file contains the sources for Tx playlist.
+*/
+
+#include "TxPlaylist.h"
+#include "DatasetIndex.h"
+
+#include <cstdio>
+#include <ctime>
+#include <future>
+#include <iostream>
+#include <sstream>
+
+
+//!************************************************************************
+//! Constructor
+//!************************************************************************
+TxPlaylist::TxPlaylist
+    (
+    TxController*   aTxController   //!< controller owning the HAL lock
+    )
+    : mTxController( aTxController )
+    , mTxHal( TxHal::getInstance() )
+    , mContinuous( false )
+    , mLoop( false )
+    , mStopRequested( false )
+    , mRunning( false )
+{
+}
+
+
+//!************************************************************************
+//! Destructor
+//!************************************************************************
+TxPlaylist::~TxPlaylist()
+{
+    stop();
+}
+
+
+//!************************************************************************
+//! Check if the playlist is being transmitted
+//!
+//! @returns true if the scheduler runs
+//!************************************************************************
+bool TxPlaylist::isRunning() const
+{
+    return mRunning.load();
+}
+
+
+//!************************************************************************
+//! Load playlist entries from a text file. Each line holds
+//! "modulation,SNR [dB],dwell [ms]" and an optional ",LO [Hz]"; empty
+//! lines and lines starting with '#' are skipped.
+//!
+//! @returns true if every line is valid
+//!************************************************************************
+bool TxPlaylist::loadEntries
+    (
+    const std::string&      aFileName,      //!< playlist file, one "modulation,SNR,dwell ms[,LO Hz]" per line
+    std::vector<Entry>&     aEntryVec       //!< playlist entries
+    )
+{
+    aEntryVec.clear();
+
+    Modulation* modulation = Modulation::getInstance();
+    std::ifstream playlistFile( aFileName );
+    bool status = playlistFile.is_open();
+    std::string crtLine;
+    size_t lineNr = 0;
+
+    if( !status )
+    {
+        std::cout << "Cannot open playlist " << aFileName << std::endl;
+    }
+
+    while( status && std::getline( playlistFile, crtLine ) )
+    {
+        lineNr++;
+
+        const size_t FIRST = crtLine.find_first_not_of( " \t\r" );
+
+        if( std::string::npos == FIRST || '#' == crtLine.at( FIRST ) )
+        {
+            continue;
+        }
+
+        std::vector<std::string> fieldVec;
+        std::stringstream lineStream( crtLine );
+        std::string field;
+
+        while( std::getline( lineStream, field, ',' ) )
+        {
+            const size_t BEGIN = field.find_first_not_of( " \t\r" );
+            const size_t END = field.find_last_not_of( " \t\r" );
+            fieldVec.push_back( ( std::string::npos == BEGIN ) ? "" : field.substr( BEGIN, END - BEGIN + 1 ) );
+        }
+
+        Entry entry = {};
+        status = fieldVec.size() >= 3 && fieldVec.size() <= 4;
+
+        if( status )
+        {
+            char* end = nullptr;
+
+            entry.modulation = modulation->getModulationName( fieldVec.at( 0 ) );
+            entry.snrDb = static_cast<int>( strtol( fieldVec.at( 1 ).c_str(), &end, 10 ) );
+            status = Modulation::NAME_UNKNOWN != entry.modulation && fieldVec.at( 1 ).size() && '\0' == *end;
+
+            const long DWELL_MS = strtol( fieldVec.at( 2 ).c_str(), &end, 10 );
+            status = status && DWELL_MS > 0 && '\0' == *end;
+            entry.dwellMs = static_cast<uint32_t>( DWELL_MS );
+
+            if( status && 4 == fieldVec.size() )
+            {
+                // allows 2.4e9
+                entry.loFrequency = static_cast<int64_t>( strtod( fieldVec.at( 3 ).c_str(), &end ) );
+                status = entry.loFrequency > 0 && '\0' == *end;
+            }
+        }
+
+        if( status )
+        {
+            aEntryVec.push_back( entry );
+        }
+        else
+        {
+            std::cout << "Invalid playlist line " << lineNr << ": " << crtLine << std::endl;
+        }
+    }
+
+    return status && aEntryVec.size();
+}
+
+
+//!************************************************************************
+//! Write a switch to the log
+//!
+//! @returns nothing
+//!************************************************************************
+void TxPlaylist::logSwitch
+    (
+    const size_t                                aIndex,         //!< entry index
+    const std::chrono::system_clock::time_point aSwitchTime,    //!< time the new signal was pushed
+    const int64_t                               aDeadAirUs      //!< dead air of the switch [us]
+    )
+{
+    if( mLogFile.is_open() )
+    {
+        const Entry& entry = mEntryVec.at( aIndex );
+        const int64_t SWITCH_US = std::chrono::duration_cast<std::chrono::microseconds>( aSwitchTime.time_since_epoch() ).count();
+        const time_t SWITCH_SEC = static_cast<time_t>( SWITCH_US / 1000000 );
+        struct tm utcTime = {};
+        char timeStr[40] = "";
+
+        gmtime_r( &SWITCH_SEC, &utcTime );
+        strftime( timeStr, sizeof( timeStr ), "%Y-%m-%dT%H:%M:%S", &utcTime );
+
+        char fractionStr[16] = "";
+        snprintf( fractionStr, sizeof( fractionStr ), ".%06lldZ", static_cast<long long>( SWITCH_US % 1000000 ) );
+
+        mLogFile << aIndex << ","
+                 << Modulation::getInstance()->getModulationString( entry.modulation ) << ","
+                 << entry.snrDb << ","
+                 << entry.loFrequency << ","
+                 << timeStr << fractionStr << ","
+                 << aDeadAirUs << std::endl;
+    }
+}
+
+
+//!************************************************************************
+//! Make a sweep over all combinations of modulations and SNRs
+//!
+//! @returns The playlist entries
+//!************************************************************************
+std::vector<TxPlaylist::Entry> TxPlaylist::makeSweep
+    (
+    const std::vector<Modulation::ModulationName>&  aModVec,        //!< modulations, outer loop
+    const std::vector<int>&                         aSnrVec,        //!< SNRs, inner loop
+    const uint32_t                                  aDwellMs,       //!< dwell time of each entry [ms]
+    const int64_t                                   aLoFrequency    //!< LO frequency [Hz], 0 to keep the current one
+    )
+{
+    std::vector<Entry> entryVec;
+
+    for( size_t i = 0; i < aModVec.size(); i++ )
+    {
+        for( size_t j = 0; j < aSnrVec.size(); j++ )
+        {
+            Entry entry = { aModVec.at( i ), aSnrVec.at( j ), aDwellMs, aLoFrequency };
+            entryVec.push_back( entry );
+        }
+    }
+
+    return entryVec;
+}
+
+
+//!************************************************************************
+//! Scheduler thread: switch to each entry, prefetching and converting the
+//! next block while the current one is transmitted
+//!
+//! @returns nothing
+//!************************************************************************
+void TxPlaylist::run()
+{
+    // loads the block and writes it in the DAC format, so that the switch only copies it;
+    // the HAL lock keeps the device and its format from changing during the conversion
+    auto loadBlock = [this]( const size_t aIndex )
+    {
+        const Dataset::Snapshot SNAPSHOT = mSnapshot;
+        const Dataset::ModulationSnrPair PAIR = std::make_pair( mEntryVec.at( aIndex ).modulation, mEntryVec.at( aIndex ).snrDb );
+        const TxHal* TX_HAL = mTxHal;
+        TxController* txController = mTxController;
+
+        return std::async( std::launch::async, [SNAPSHOT, PAIR, TX_HAL, txController]
+        {
+            Dataset::SignalDataPtr signalData = SNAPSHOT->getBlock( PAIR );
+
+            std::unique_lock<std::mutex> txHalLock = txController->lockTxHal();
+            TX_HAL->prerenderData( signalData );
+
+            return signalData;
+        } );
+    };
+
+    bool status = true;
+    bool done = false;
+    size_t crtEntry = 0;
+    std::future<Dataset::SignalDataPtr> nextBlock = loadBlock( crtEntry );
+
+    while( !done )
+    {
+        const Entry& entry = mEntryVec.at( crtEntry );
+        Dataset::SignalDataPtr signalData = nextBlock.get();
+
+        size_t nextEntry = crtEntry + 1;
+        const bool LAST = ( mEntryVec.size() == nextEntry ) && !mLoop;
+
+        if( mEntryVec.size() == nextEntry )
+        {
+            nextEntry = 0;
+        }
+
+        const std::chrono::steady_clock::time_point SWITCH_START = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point switchEnd = SWITCH_START;
+
+        if( signalData )
+        {
+            {
+                std::unique_lock<std::mutex> txHalLock = mTxController->lockTxHal();
+
+                if( entry.loFrequency )
+                {
+                    mTxHal->setTxLoFrequency( entry.loFrequency );
+                }
+
+                const TxCapture::SignalInfo SIGNAL_INFO = { mDatasetName, Modulation::getInstance()->getModulationString( entry.modulation ), entry.snrDb, 0 };
+
+                mTxHal->getData( signalData );
+                mTxHal->annotateCapture( SIGNAL_INFO );
+                mTxHal->startStreaming();
+            }
+
+            switchEnd = std::chrono::steady_clock::now();
+            const int64_t DEAD_AIR_US = std::chrono::duration_cast<std::chrono::microseconds>( switchEnd - SWITCH_START ).count();
+
+            logSwitch( crtEntry, std::chrono::system_clock::now(), DEAD_AIR_US );
+            emit entryStarted( static_cast<int>( crtEntry ), DEAD_AIR_US );
+        }
+        else
+        {
+            // the previous signal keeps playing for the dwell time
+            std::cout << "Playlist entry " << crtEntry << ": could not load the signal data" << std::endl;
+            status = false;
+        }
+
+        // the next block loads and is converted while this one is transmitted,
+        // launched after the switch so that it does not hold the HAL lock meanwhile
+        if( !LAST )
+        {
+            nextBlock = loadBlock( nextEntry );
+        }
+
+        {
+            std::unique_lock<std::mutex> lock( mMutex );
+            done = mStopCv.wait_until( lock, SWITCH_START + std::chrono::milliseconds( entry.dwellMs ), [this]{ return mStopRequested; } );
+        }
+
+        // the counters restart with the next entry
+        if( signalData )
+        {
+            uint64_t pairsNr = 0;
+            uint64_t underflowsNr = 0;
+
+            {
+                std::unique_lock<std::mutex> txHalLock = mTxController->lockTxHal();
+                pairsNr = mTxHal->getStreamPairsNr();
+                underflowsNr = mTxHal->getStreamUnderflowsNr();
+            }
+
+            const int64_t ON_AIR_US = std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - switchEnd ).count();
+            emit entryFinished( static_cast<int>( crtEntry ), ON_AIR_US, pairsNr, underflowsNr );
+        }
+
+        done = done || LAST;
+        crtEntry = nextEntry;
+    }
+
+    {
+        std::unique_lock<std::mutex> txHalLock = mTxController->lockTxHal();
+        mTxHal->stopStreaming();
+        mTxHal->stopCapture();
+    }
+
+    if( mLogFile.is_open() )
+    {
+        mLogFile.close();
+    }
+
+    mRunning.store( false );
+    emit playlistFinished( status );
+}
+
+
+//!************************************************************************
+//! Start transmitting a playlist from a dataset snapshot
+//!
+//! @returns true if the playlist is valid and the scheduler started
+//!************************************************************************
+bool TxPlaylist::start
+    (
+    const Dataset::Snapshot&        aSnapshot,      //!< dataset snapshot
+    const std::vector<Entry>&       aEntryVec,      //!< playlist entries
+    const bool                      aContinuous,    //!< true for non-cyclic streaming
+    const bool                      aLoop,          //!< true to restart after the last entry
+    const std::string&              aLogFileName,   //!< switch log, empty for none
+    const std::string&              aDatasetName,   //!< dataset name, for the capture annotations
+    const std::string&              aCaptureName,   //!< capture recording name, without the SigMF extension
+    const TxCapture::CaptureFormat  aCaptureFormat  //!< capture sample format, none for no capture
+    )
+{
+    stop();
+
+    bool status = aSnapshot && aEntryVec.size();
+
+    for( size_t i = 0; status && i < aEntryVec.size(); i++ )
+    {
+        const Entry& entry = aEntryVec.at( i );
+        status = entry.dwellMs > 0 && aSnapshot->contains( std::make_pair( entry.modulation, entry.snrDb ) );
+
+        if( !status )
+        {
+            std::cout << "Playlist entry " << i << " is not in the dataset" << std::endl;
+        }
+    }
+
+    if( status && aLogFileName.size() )
+    {
+        mLogFile.open( aLogFileName );
+        status = mLogFile.is_open();
+
+        if( status )
+        {
+            mLogFile << "entry,modulation,snr_db,lo_hz,switch_utc,dead_air_us" << std::endl;
+        }
+        else
+        {
+            std::cout << "Cannot create playlist log " << aLogFileName << std::endl;
+        }
+    }
+
+    if( status )
+    {
+        mSnapshot = aSnapshot;
+        mEntryVec = aEntryVec;
+        mContinuous = aContinuous;
+        mLoop = aLoop;
+        mDatasetName = aDatasetName;
+        mStopRequested = false;
+
+        {
+            std::unique_lock<std::mutex> txHalLock = mTxController->lockTxHal();
+            mTxHal->setContinuousStreaming( mContinuous );
+
+            // a failed capture does not prevent the playlist
+            if( TxCapture::CAPTURE_FORMAT_NONE != aCaptureFormat && !mTxHal->startCapture( aCaptureName, aCaptureFormat ) )
+            {
+                std::cout << "Cannot start the capture " << aCaptureName << std::endl;
+            }
+        }
+
+        mRunning.store( true );
+        mThread = std::thread( &TxPlaylist::run, this );
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Stop the playlist, waiting for the scheduler to stop the streaming
+//!
+//! @returns nothing
+//!************************************************************************
+void TxPlaylist::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        mStopRequested = true;
+    }
+
+    mStopCv.notify_all();
+
+    if( mThread.joinable() )
+    {
+        mThread.join();
+    }
+
+    mSnapshot.reset();
+}
@@ -0,0 +1,170 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+/*
+TxPlaylist.h
+
+This file contains the definitions for Tx playlist.
+*/
+
+#ifndef TxPlaylist_h
+#define TxPlaylist_h
+
+#include "Dataset.h"
+#include "Modulation.h"
+#include "TxCapture.h"
+#include "TxController.h"
+
+#include <QObject>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+//************************************************************************
+// Class for transmitting a playlist of modulation-SNR combinations
+// unattended, each for a dwell time, optionally at its own LO frequency.
+//
+// A scheduler thread switches the Tx HAL from one entry to the next,
+// while a prefetch task loads the block of the following entry from the
+// dataset snapshot and, for cyclic streaming, writes it in the DAC format
+// into the waveform cache. The switch then holds the LO retune, the copy
+// of the DAC samples into a new Tx buffer and its push; non-cyclic
+// streaming restarts its engine, which converts the samples on the fly.
+// Each switch is written to a log with its UTC time and its dead air, the
+// time between the previous signal being dropped and the new one being
+// pushed. When capturing, each entry is annotated in the recording.
+//************************************************************************
+class TxPlaylist : public QObject
+{
+    Q_OBJECT
+
+    //************************************************************************
+    // constants and types
+    //************************************************************************
+    public:
+        typedef struct
+        {
+            Modulation::ModulationName  modulation;     //!< modulation
+            int                         snrDb;          //!< SNR [dB]
+            uint32_t                    dwellMs;        //!< dwell time [ms]
+            int64_t                     loFrequency;    //!< LO frequency [Hz], 0 to keep the current one
+        }Entry;
+
+
+    //************************************************************************
+    // functions
+    //************************************************************************
+    public:
+        TxPlaylist
+            (
+            TxController*               aTxController   //!< controller owning the HAL lock
+            );
+
+        ~TxPlaylist();
+
+        bool isRunning() const;
+
+        static bool loadEntries
+            (
+            const std::string&          aFileName,      //!< playlist file, one "modulation,SNR,dwell ms[,LO Hz]" per line
+            std::vector<Entry>&         aEntryVec       //!< playlist entries
+            );
+
+        static std::vector<Entry> makeSweep
+            (
+            const std::vector<Modulation::ModulationName>&  aModVec,        //!< modulations, outer loop
+            const std::vector<int>&                         aSnrVec,        //!< SNRs, inner loop
+            const uint32_t                                  aDwellMs,       //!< dwell time of each entry [ms]
+            const int64_t                                   aLoFrequency    //!< LO frequency [Hz], 0 to keep the current one
+            );
+
+        bool start
+            (
+            const Dataset::Snapshot&        aSnapshot,      //!< dataset snapshot
+            const std::vector<Entry>&       aEntryVec,      //!< playlist entries
+            const bool                      aContinuous,    //!< true for non-cyclic streaming
+            const bool                      aLoop,          //!< true to restart after the last entry
+            const std::string&              aLogFileName,   //!< switch log, empty for none
+            const std::string&              aDatasetName,   //!< dataset name, for the capture annotations
+            const std::string&              aCaptureName,   //!< capture recording name, without the SigMF extension
+            const TxCapture::CaptureFormat  aCaptureFormat  //!< capture sample format, none for no capture
+            );
+
+        void stop();
+
+    signals:
+        void entryFinished
+            (
+            int     aIndex,             //!< entry index
+            qint64  aOnAirUs,           //!< time the entry was transmitted [us]
+            quint64 aPairsNr,           //!< (I,Q) pairs streamed, 0 for a cyclic buffer on hardware
+            quint64 aUnderflowsNr       //!< times non-cyclic streaming ran out of data
+            );
+
+        void entryStarted
+            (
+            int     aIndex,             //!< entry index
+            qint64  aDeadAirUs          //!< dead air of the switch [us]
+            );
+
+        void playlistFinished
+            (
+            bool    aStatus             //!< false if an entry could not be transmitted
+            );
+
+    private:
+        void logSwitch
+            (
+            const size_t                                aIndex,         //!< entry index
+            const std::chrono::system_clock::time_point aSwitchTime,    //!< time the new signal was pushed
+            const int64_t                               aDeadAirUs      //!< dead air of the switch [us]
+            );
+
+        void run();
+
+
+    //************************************************************************
+    // variables
+    //************************************************************************
+    private:
+        TxController*                   mTxController;      //!< controller owning the HAL lock
+        TxHal*                          mTxHal;             //!< Tx HAL
+
+        Dataset::Snapshot               mSnapshot;          //!< dataset snapshot
+        std::vector<Entry>              mEntryVec;          //!< playlist entries
+        bool                            mContinuous;        //!< true for non-cyclic streaming
+        bool                            mLoop;              //!< true to restart after the last entry
+        std::ofstream                   mLogFile;           //!< switch log
+        std::string                     mDatasetName;       //!< dataset name, for the capture annotations
+
+        std::mutex                      mMutex;             //!< protects the stop request
+        std::condition_variable         mStopCv;            //!< wakes the dwell wait
+        bool                            mStopRequested;     //!< true when the scheduler has to exit
+        std::atomic<bool>               mRunning;           //!< true while the scheduler runs
+
+        std::thread                     mThread;            //!< scheduler
+};
+
+#endif // TxPlaylist_h
@@ -0,0 +1,287 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+/*
+TxStreamEngine.cpp
+
+This file contains the sources for Tx stream engine.
+*/
+
+#include "TxStreamEngine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+
+//!************************************************************************
+//! Constructor
+//!************************************************************************
+TxStreamEngine::TxStreamEngine()
+    : mTxBuf( nullptr )
+    , mFirstChannel( nullptr )
+    , mPairsNr( 0 )
+    , mWriter( nullptr )
+    , mCapture( nullptr )
+    , mRunning( false )
+    , mBuffersPushed( 0 )
+    , mUnderflowsNr( 0 )
+{
+}
+
+
+//!************************************************************************
+//! Destructor
+//!************************************************************************
+TxStreamEngine::~TxStreamEngine()
+{
+    stop();
+}
+
+
+//!************************************************************************
+//! Get the number of Tx buffers pushed since the start
+//!
+//! @returns The number of pushed buffers
+//!************************************************************************
+uint64_t TxStreamEngine::getBuffersPushed() const
+{
+    return mBuffersPushed.load();
+}
+
+
+//!************************************************************************
+//! Get the number of times the pusher found no filled block ready, i.e.
+//! the producer fell behind the DAC
+//!
+//! @returns The number of underflows
+//!************************************************************************
+uint64_t TxStreamEngine::getUnderflowsNr() const
+{
+    return mUnderflowsNr.load();
+}
+
+
+//!************************************************************************
+//! Check if the engine is streaming
+//!
+//! @returns true if the threads are running
+//!************************************************************************
+bool TxStreamEngine::isRunning() const
+{
+    return mRunning.load();
+}
+
+
+//!************************************************************************
+//! Producer thread: convert the sequence into host blocks, looping over it
+//!
+//! @returns nothing
+//!************************************************************************
+void TxStreamEngine::produce()
+{
+    const size_t BLOCK_BYTES = mPairsNr * PAIR_BYTES;
+    size_t crtItem = 0;
+    size_t crtPoint = 0;
+    size_t block = 0;
+
+    while( mRunning.load( std::memory_order_relaxed ) )
+    {
+        if( mFreeRing.pop( block ) )
+        {
+            uint8_t* blockData = mBlockVec.data() + block * BLOCK_BYTES;
+            size_t filledNr = 0;
+
+            // a block may span several items of the sequence
+            while( filledNr < mPairsNr )
+            {
+                const Dataset::SignalData& signalData = *mSequenceVec.at( crtItem );
+                const size_t ITEM_POINTS_NR = signalData.frameStore.getPointsNr();
+                const size_t POINTS_NR = std::min( ITEM_POINTS_NR - crtPoint, mPairsNr - filledNr );
+                const double SCALE = Dataset::getScale( signalData );
+
+                mWriter( signalData.frameStore.data() + crtPoint, POINTS_NR, SCALE, blockData + filledNr * PAIR_BYTES, PAIR_BYTES );
+
+                filledNr += POINTS_NR;
+                crtPoint += POINTS_NR;
+
+                if( ITEM_POINTS_NR == crtPoint )
+                {
+                    crtPoint = 0;
+                    crtItem = ( crtItem + 1 ) % mSequenceVec.size();
+                }
+            }
+
+            // never full, both rings hold every block
+            mFilledRing.push( block );
+        }
+        else
+        {
+            std::this_thread::sleep_for( std::chrono::microseconds( POLL_INTERVAL_US ) );
+        }
+    }
+}
+
+
+//!************************************************************************
+//! Pusher thread: copy the filled blocks into the Tx buffer and push it
+//! back to back. Each push blocks until the kernel has a free buffer.
+//!
+//! @returns nothing
+//!************************************************************************
+void TxStreamEngine::pushBlocks()
+{
+    const size_t BLOCK_BYTES = mPairsNr * PAIR_BYTES;
+    bool starved = false;
+    size_t block = 0;
+
+    while( mRunning.load( std::memory_order_relaxed ) )
+    {
+        if( mFilledRing.pop( block ) )
+        {
+            const uint8_t* blockData = mBlockVec.data() + block * BLOCK_BYTES;
+            uint8_t* dataBuf = static_cast< uint8_t* >( iio_buffer_first( mTxBuf, mFirstChannel ) );
+            const std::ptrdiff_t STEP = iio_buffer_step( mTxBuf );
+
+            if( static_cast<std::ptrdiff_t>( PAIR_BYTES ) == STEP )
+            {
+                memcpy( dataBuf, blockData, BLOCK_BYTES );
+            }
+            else
+            {
+                for( size_t i = 0; i < mPairsNr; i++ )
+                {
+                    memcpy( dataBuf + i * STEP, blockData + i * PAIR_BYTES, PAIR_BYTES );
+                }
+            }
+
+            if( mCapture )
+            {
+                mCapture->write( blockData, mPairsNr );
+            }
+
+            mFreeRing.push( block );
+            starved = false;
+
+            if( iio_buffer_push( mTxBuf ) < 0 )
+            {
+                if( mRunning.load() )
+                {
+                    std::cout << "Tx buffer push failed, streaming stopped" << std::endl;
+                }
+
+                mRunning.store( false );
+            }
+            else
+            {
+                mBuffersPushed++;
+            }
+        }
+        else
+        {
+            if( !starved && mBuffersPushed.load( std::memory_order_relaxed ) )
+            {
+                mUnderflowsNr++;
+            }
+
+            starved = true;
+            std::this_thread::sleep_for( std::chrono::microseconds( POLL_INTERVAL_US ) );
+        }
+    }
+}
+
+
+//!************************************************************************
+//! Start streaming a sequence of signal data through a non-cyclic Tx
+//! buffer, looping over the sequence until stopped
+//!
+//! @returns true if the threads are started
+//!************************************************************************
+bool TxStreamEngine::start
+    (
+    struct iio_buffer*                          aTxBuf,         //!< non-cyclic Tx buffer
+    const struct iio_channel*                   aFirstChannel,  //!< channel leading each pair
+    const size_t                                aPairsNr,       //!< (I,Q) pairs of the Tx buffer
+    const std::vector<Dataset::SignalDataPtr>&  aSequenceVec,   //!< signal data to stream, in order
+    const SampleWriter                          aWriter,        //!< writer of the DAC samples
+    const size_t                                aBlocksNr,      //!< number of host blocks
+    TxCapture*                                  aCapture        //!< capture of the pushed blocks, null for none
+    )
+{
+    stop();
+
+    bool status = aTxBuf && aFirstChannel && aPairsNr && aWriter && aBlocksNr && aSequenceVec.size();
+
+    for( size_t i = 0; status && i < aSequenceVec.size(); i++ )
+    {
+        status = aSequenceVec.at( i ) && aSequenceVec.at( i )->frameStore.getPointsNr();
+    }
+
+    if( status )
+    {
+        mTxBuf = aTxBuf;
+        mFirstChannel = aFirstChannel;
+        mPairsNr = aPairsNr;
+        mSequenceVec = aSequenceVec;
+        mWriter = aWriter;
+        mCapture = aCapture;
+
+        mBlockVec.assign( aBlocksNr * aPairsNr * PAIR_BYTES, 0 );
+        mFreeRing.reset( aBlocksNr );
+        mFilledRing.reset( aBlocksNr );
+
+        for( size_t i = 0; i < aBlocksNr; i++ )
+        {
+            mFreeRing.push( i );
+        }
+
+        mBuffersPushed.store( 0 );
+        mUnderflowsNr.store( 0 );
+        mRunning.store( true );
+
+        mProducerThread = std::thread( &TxStreamEngine::produce, this );
+        mPusherThread = std::thread( &TxStreamEngine::pushBlocks, this );
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Stop streaming. A blocked push is cancelled, so the Tx buffer cannot
+//! be used afterwards and has to be recreated.
+//!
+//! @returns nothing
+//!************************************************************************
+void TxStreamEngine::stop()
+{
+    mRunning.store( false );
+
+    if( mPusherThread.joinable() )
+    {
+        iio_buffer_cancel( mTxBuf );
+        mPusherThread.join();
+    }
+
+    if( mProducerThread.joinable() )
+    {
+        mProducerThread.join();
+    }
+
+    mSequenceVec.clear();
+}
@@ -0,0 +1,131 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+/*
+TxStreamEngine.h
+
+This file contains the definitions for Tx stream engine.
+*/
+
+#ifndef TxStreamEngine_h
+#define TxStreamEngine_h
+
+#include "Dataset.h"
+#include "SpscRing.h"
+#include "TxCapture.h"
+
+#include <iio.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+
+//************************************************************************
+// Class for streaming a sequence of signal data through a non-cyclic Tx
+// buffer, without gaps.
+//
+// A producer thread converts the sequence, looping over it, into host
+// blocks of DAC samples. A pusher thread copies each filled block into
+// the IIO buffer and pushes it back to back, so the kernel buffers
+// queued behind the DMA are kept full. The two threads exchange block
+// indexes through lock-free rings. Each pushed block is also handed to
+// the capture, if any.
+//************************************************************************
+class TxStreamEngine
+{
+    //************************************************************************
+    // constants and types
+    //************************************************************************
+    public:
+        typedef void ( *SampleWriter )
+            (
+            const Dataset::IQPoint*     aPoints,        //!< first point
+            const size_t                aPointsNr,      //!< number of points
+            const double                aScale,         //!< scale of the points to [-1..1]
+            uint8_t*                    aBuffer,        //!< first pair of the buffer
+            const std::ptrdiff_t        aStep           //!< step between pairs of the buffer [bytes]
+            );
+
+    private:
+        static const size_t PAIR_BYTES = 2 * sizeof( int16_t );    //!< size of a packed (I,Q) pair [bytes]
+        static constexpr unsigned int POLL_INTERVAL_US = 50;        //!< wait when a ring is empty [us]
+
+
+    //************************************************************************
+    // functions
+    //************************************************************************
+    public:
+        TxStreamEngine();
+
+        ~TxStreamEngine();
+
+        TxStreamEngine( const TxStreamEngine& ) = delete;
+        TxStreamEngine& operator=( const TxStreamEngine& ) = delete;
+
+        uint64_t getBuffersPushed() const;
+
+        uint64_t getUnderflowsNr() const;
+
+        bool isRunning() const;
+
+        bool start
+            (
+            struct iio_buffer*                          aTxBuf,         //!< non-cyclic Tx buffer
+            const struct iio_channel*                   aFirstChannel,  //!< channel leading each pair
+            const size_t                                aPairsNr,       //!< (I,Q) pairs of the Tx buffer
+            const std::vector<Dataset::SignalDataPtr>&  aSequenceVec,   //!< signal data to stream, in order
+            const SampleWriter                          aWriter,        //!< writer of the DAC samples
+            const size_t                                aBlocksNr,      //!< number of host blocks
+            TxCapture*                                  aCapture        //!< capture of the pushed blocks, null for none
+            );
+
+        void stop();
+
+    private:
+        void produce();
+
+        void pushBlocks();
+
+
+    //************************************************************************
+    // variables
+    //************************************************************************
+    private:
+        struct iio_buffer*                      mTxBuf;             //!< non-cyclic Tx buffer
+        const struct iio_channel*               mFirstChannel;      //!< channel leading each pair
+        size_t                                  mPairsNr;           //!< (I,Q) pairs per block
+
+        std::vector<Dataset::SignalDataPtr>     mSequenceVec;       //!< signal data to stream, in order
+        SampleWriter                            mWriter;            //!< writer of the DAC samples
+        TxCapture*                              mCapture;           //!< capture of the pushed blocks, null for none
+
+        std::vector<uint8_t>                    mBlockVec;          //!< host blocks of DAC samples
+        SpscRing<size_t>                        mFreeRing;          //!< blocks free for the producer
+        SpscRing<size_t>                        mFilledRing;        //!< blocks ready to be pushed
+
+        std::atomic<bool>                       mRunning;           //!< true while the threads run
+        std::atomic<uint64_t>                   mBuffersPushed;     //!< buffers pushed since start
+        std::atomic<uint64_t>                   mUnderflowsNr;      //!< times no filled block was ready
+
+        std::thread                             mProducerThread;    //!< converts the sequence
+        std::thread                             mPusherThread;      //!< pushes the Tx buffer
+};
+
+#endif // TxStreamEngine_h
@@ -0,0 +1,493 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+/*
+WaveformCache.cpp
+
+This file contains the sources for waveform cache.
+*/
+
+#include "WaveformCache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <utility>
+
+#include <sys/stat.h>
+
+
+const std::string WaveformCache::KEY_FILE_EXTENSION = ".key";
+
+WaveformCache* WaveformCache::sInstance = nullptr;
+
+
+//!************************************************************************
+//! Constructor
+//!************************************************************************
+WaveformCache::WaveformCache()
+    : mBudgetBytes( DEFAULT_BUDGET_BYTES )
+    , mResidentBytes( 0 )
+    , mHitsNr( 0 )
+{
+}
+
+
+//!************************************************************************
+//! Drop the least recently used waveforms until a new one fits the budget.
+//! The mutex must be held by the caller.
+//!
+//! @returns nothing
+//!************************************************************************
+void WaveformCache::evict
+    (
+    const size_t                    aIncomingBytes  //!< size of the waveform to be added [bytes]
+    )
+{
+    while( mLruList.size() && mResidentBytes + aIncomingBytes > mBudgetBytes )
+    {
+        auto it = mEntryMap.find( mLruList.back() );
+
+        mResidentBytes -= it->second.waveform->size();
+        mEntryMap.erase( it );
+        mLruList.pop_back();
+    }
+}
+
+
+//!************************************************************************
+//! Find a waveform in memory, then on disk. A waveform on disk is only
+//! used if it was converted from a block with the same hash.
+//!
+//! @returns The DAC samples, nullptr if the waveform is not cached
+//!************************************************************************
+WaveformCache::WaveformPtr WaveformCache::find
+    (
+    const Key&                      aKey,           //!< waveform key
+    const Dataset::SignalData&      aSignalData     //!< signal data of the waveform
+    )
+{
+    const size_t BYTES_NR = aSignalData.frameStore.getPointsNr() * PAIR_BYTES;
+    WaveformPtr waveform;
+    std::string fileName;
+
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        auto it = mEntryMap.find( hashKey( aKey ) );
+
+        if( mEntryMap.end() != it && isSameKey( aKey, it->second.key ) )
+        {
+            mLruList.splice( mLruList.begin(), mLruList, it->second.lruIt );
+            waveform = it->second.waveform;
+            mHitsNr++;
+        }
+        else if( mDiskDirectory.size() && aKey.sourceFingerprint )
+        {
+            fileName = getFileName( aKey );
+        }
+    }
+
+    if( !waveform && fileName.size() )
+    {
+        struct stat fileStat;
+        bool status = ( 0 == stat( fileName.c_str(), &fileStat ) )
+                   && ( BYTES_NR == static_cast<size_t>( fileStat.st_size ) )
+                   && readKeyFile( fileName, aKey, hashBlock( aSignalData ) );
+
+        if( status )
+        {
+            std::vector<uint8_t> sampleVec( BYTES_NR );
+            std::ifstream waveformFile( fileName, std::ios::binary );
+
+            waveformFile.read( reinterpret_cast<char*>( sampleVec.data() ), BYTES_NR );
+            status = waveformFile.good();
+
+            if( status )
+            {
+                waveform = insert( aKey, std::move( sampleVec ), nullptr );
+
+                std::lock_guard<std::mutex> lock( mMutex );
+                mHitsNr++;
+            }
+            else
+            {
+                std::cout << "Could not read waveform " << fileName << ", converting the signal data." << std::endl;
+            }
+        }
+    }
+
+    return waveform;
+}
+
+
+//!************************************************************************
+//! Get the memory budget
+//!
+//! @returns The memory budget [bytes]
+//!************************************************************************
+size_t WaveformCache::getBudgetBytes() const
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    return mBudgetBytes;
+}
+
+
+//!************************************************************************
+//! Get the directory of the persisted waveforms
+//!
+//! @returns The directory, empty if waveforms are kept in memory only
+//!************************************************************************
+std::string WaveformCache::getDiskDirectory() const
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    return mDiskDirectory;
+}
+
+
+//!************************************************************************
+//! Get the name of the file of a persisted waveform.
+//! The mutex must be held by the caller.
+//!
+//! @returns The filename
+//!************************************************************************
+std::string WaveformCache::getFileName
+    (
+    const Key&                      aKey            //!< waveform key
+    ) const
+{
+    char nameStr[128] = "";
+    snprintf( nameStr, sizeof( nameStr ), "%016llx_%d_%d_%016llx_%04x_%016llx.ci16",
+              static_cast<unsigned long long>( aKey.sourceFingerprint ),
+              static_cast<int>( aKey.modulation ),
+              static_cast<int>( aKey.snrDb ),
+              static_cast<unsigned long long>( aKey.fingerprint ),
+              static_cast<unsigned int>( aKey.formatId ),
+              static_cast<unsigned long long>( aKey.scaleBits ) );
+
+    return mDiskDirectory + "/" + nameStr;
+}
+
+
+//!************************************************************************
+//! Get the number of waveforms served without conversion
+//!
+//! @returns The number of cache hits
+//!************************************************************************
+uint64_t WaveformCache::getHitsNr() const
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    return mHitsNr;
+}
+
+
+//!************************************************************************
+//! Get the single instance
+//!
+//! @returns The single instance
+//!************************************************************************
+WaveformCache* WaveformCache::getInstance()
+{
+    if( !sInstance )
+    {
+        sInstance = new WaveformCache;
+    }
+
+    return sInstance;
+}
+
+
+//!************************************************************************
+//! Get the memory used by the resident waveforms
+//!
+//! @returns The resident size [bytes]
+//!************************************************************************
+size_t WaveformCache::getResidentBytes() const
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    return mResidentBytes;
+}
+
+
+//!************************************************************************
+//! Hash all the points of a block. Only waveforms on disk are checked
+//! against it, their source file may have been edited since.
+//!
+//! @returns The hash
+//!************************************************************************
+uint64_t WaveformCache::hashBlock
+    (
+    const Dataset::SignalData&      aSignalData     //!< signal data
+    )
+{
+    const uint64_t FNV_PRIME = 0x100000001B3;
+    const size_t POINTS_NR = aSignalData.frameStore.getPointsNr();
+    const Dataset::IQPoint* points = aSignalData.frameStore.data();
+
+    uint64_t hash = 0xCBF29CE484222325 ^ POINTS_NR;
+
+    for( size_t i = 0; i < POINTS_NR; i++ )
+    {
+        uint64_t pointBits = 0;
+        memcpy( &pointBits, points + i, sizeof( pointBits ) );
+        hash = ( hash ^ pointBits ) * FNV_PRIME;
+    }
+
+    return hash;
+}
+
+
+//!************************************************************************
+//! Hash a key to the map key
+//!
+//! @returns The hash
+//!************************************************************************
+uint64_t WaveformCache::hashKey
+    (
+    const Key&                      aKey            //!< waveform key
+    )
+{
+    const uint64_t FNV_PRIME = 0x100000001B3;
+
+    uint64_t hash = aKey.fingerprint;
+    hash = ( hash ^ aKey.sourceFingerprint ) * FNV_PRIME;
+    hash = ( hash ^ static_cast<uint32_t>( aKey.modulation ) ) * FNV_PRIME;
+    hash = ( hash ^ static_cast<uint32_t>( aKey.snrDb ) ) * FNV_PRIME;
+    hash = ( hash ^ aKey.formatId ) * FNV_PRIME;
+    hash = ( hash ^ aKey.scaleBits ) * FNV_PRIME;
+
+    return hash;
+}
+
+
+//!************************************************************************
+//! Insert a waveform, evicting others if needed, and persist it
+//!
+//! @returns The resident DAC samples for the key
+//!************************************************************************
+WaveformCache::WaveformPtr WaveformCache::insert
+    (
+    const Key&                      aKey,           //!< waveform key
+    std::vector<uint8_t>&&          aSampleVec,     //!< DAC samples
+    const Dataset::SignalData*      aPersistedData  //!< signal data of a waveform to write to disk, nullptr to keep it in memory only
+    )
+{
+    WaveformPtr waveform = std::make_shared<const std::vector<uint8_t>>( std::move( aSampleVec ) );
+    std::string fileName;
+
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        const uint64_t HASH = hashKey( aKey );
+        auto it = mEntryMap.find( HASH );
+
+        // a colliding key replaces the resident waveform
+        if( mEntryMap.end() != it )
+        {
+            mResidentBytes -= it->second.waveform->size();
+            mLruList.erase( it->second.lruIt );
+            mEntryMap.erase( it );
+        }
+
+        evict( waveform->size() );
+
+        mLruList.push_front( HASH );
+        mEntryMap[HASH] = { aKey, waveform, mLruList.begin() };
+        mResidentBytes += waveform->size();
+
+        if( aPersistedData && mDiskDirectory.size() && aKey.sourceFingerprint )
+        {
+            fileName = getFileName( aKey );
+        }
+    }
+
+    if( fileName.size() )
+    {
+        const KeyFile KEY_FILE = { aKey, hashBlock( *aPersistedData ) };
+
+        // the key file is written last, so that a reader never trusts a partial waveform
+        const bool STATUS = writeFile( fileName, waveform->data(), waveform->size() )
+                         && writeFile( fileName + KEY_FILE_EXTENSION, &KEY_FILE, sizeof( KEY_FILE ) );
+
+        if( !STATUS )
+        {
+            std::cout << "Could not write waveform " << fileName << std::endl;
+        }
+    }
+
+    return waveform;
+}
+
+
+//!************************************************************************
+//! Compare all the fields of two keys
+//!
+//! @returns true if the keys are identical
+//!************************************************************************
+bool WaveformCache::isSameKey
+    (
+    const Key&                      aKey,           //!< waveform key
+    const Key&                      aOtherKey       //!< key compared with
+    )
+{
+    return ( aKey.sourceFingerprint == aOtherKey.sourceFingerprint )
+        && ( aKey.modulation == aOtherKey.modulation )
+        && ( aKey.snrDb == aOtherKey.snrDb )
+        && ( aKey.fingerprint == aOtherKey.fingerprint )
+        && ( aKey.scaleBits == aOtherKey.scaleBits )
+        && ( aKey.formatId == aOtherKey.formatId );
+}
+
+
+//!************************************************************************
+//! Make the key of signal data written in a DAC format.
+//! The source fingerprint and the modulation-SNR combination identify the
+//! block; the block fingerprint covers its size, its maximum and points
+//! sampled evenly over it, catching a block changed in memory.
+//!
+//! @returns The key
+//!************************************************************************
+WaveformCache::Key WaveformCache::makeKey
+    (
+    const Dataset::SignalData&      aSignalData,    //!< signal data
+    const uint32_t                  aFormatId,      //!< DAC format
+    const double                    aScale          //!< scale of the points to [-1..1]
+    )
+{
+    const uint64_t FNV_PRIME = 0x100000001B3;
+    const size_t POINTS_NR = aSignalData.frameStore.getPointsNr();
+    const Dataset::IQPoint* points = aSignalData.frameStore.data();
+
+    uint32_t maxValBits = 0;
+    memcpy( &maxValBits, &aSignalData.maxVal, sizeof( maxValBits ) );
+
+    Key key = {};
+    key.sourceFingerprint = aSignalData.origin.sourceFingerprint;
+    key.modulation = aSignalData.origin.modulation;
+    key.snrDb = aSignalData.origin.snrDb;
+    key.fingerprint = 0xCBF29CE484222325 ^ POINTS_NR;
+    key.fingerprint = ( key.fingerprint ^ aSignalData.frameStore.getFrameLength() ) * FNV_PRIME;
+    key.fingerprint = ( key.fingerprint ^ maxValBits ) * FNV_PRIME;
+
+    const size_t SAMPLES_NR = std::min( POINTS_NR, static_cast<size_t>( FINGERPRINT_POINTS_NR ) );
+
+    for( size_t i = 0; i < SAMPLES_NR; i++ )
+    {
+        uint64_t pointBits = 0;
+        memcpy( &pointBits, points + i * POINTS_NR / SAMPLES_NR, sizeof( pointBits ) );
+        key.fingerprint = ( key.fingerprint ^ pointBits ) * FNV_PRIME;
+    }
+
+    key.formatId = aFormatId;
+    memcpy( &key.scaleBits, &aScale, sizeof( key.scaleBits ) );
+
+    return key;
+}
+
+
+//!************************************************************************
+//! Read the key file of a persisted waveform and check it against the
+//! expected key and block hash
+//!
+//! @returns true if the ci16 file holds the waveform of the key
+//!************************************************************************
+bool WaveformCache::readKeyFile
+    (
+    const std::string&              aFileName,      //!< name of the ci16 file
+    const Key&                      aKey,           //!< expected waveform key
+    const uint64_t                  aBlockHash      //!< expected hash of the block
+    )
+{
+    KeyFile fileKey = {};
+    std::ifstream keyFile( aFileName + KEY_FILE_EXTENSION, std::ios::binary );
+
+    keyFile.read( reinterpret_cast<char*>( &fileKey ), sizeof( fileKey ) );
+    bool status = keyFile.good()
+               && isSameKey( aKey, fileKey.key )
+               && ( aBlockHash == fileKey.blockHash );
+
+    if( !status )
+    {
+        std::cout << "Waveform " << aFileName << " does not match its key, converting the signal data." << std::endl;
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Set the memory budget, evicting waveforms if needed
+//!
+//! @returns nothing
+//!************************************************************************
+void WaveformCache::setBudgetBytes
+    (
+    const size_t                    aBudgetBytes    //!< memory budget [bytes]
+    )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    mBudgetBytes = aBudgetBytes;
+    evict( 0 );
+}
+
+
+//!************************************************************************
+//! Set the directory where waveforms are persisted
+//!
+//! @returns nothing
+//!************************************************************************
+void WaveformCache::setDiskDirectory
+    (
+    const std::string&              aDirectory      //!< directory of the ci16 files, empty for memory only
+    )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    mDiskDirectory = aDirectory;
+}
+
+
+//!************************************************************************
+//! Write a file under a temporary name, then rename it, so that a reader
+//! never sees a partial file
+//!
+//! @returns true if the file was written
+//!************************************************************************
+bool WaveformCache::writeFile
+    (
+    const std::string&              aFileName,      //!< file name
+    const void*                     aData,          //!< file contents
+    const size_t                    aBytesNr        //!< size of the contents [bytes]
+    )
+{
+    const std::string TMP_FILE_NAME = aFileName + ".tmp";
+    std::ofstream outFile( TMP_FILE_NAME, std::ios::binary | std::ios::trunc );
+    bool status = outFile.is_open();
+
+    if( status )
+    {
+        outFile.write( static_cast<const char*>( aData ), aBytesNr );
+        outFile.close();
+        status = !outFile.fail() && ( 0 == std::rename( TMP_FILE_NAME.c_str(), aFileName.c_str() ) );
+    }
+
+    if( !status )
+    {
+        std::remove( TMP_FILE_NAME.c_str() );
+    }
+
+    return status;
+}
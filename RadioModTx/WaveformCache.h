@@ -0,0 +1,236 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+/*
+WaveformCache.h
+
+This file contains the definitions for waveform cache.
+*/
+
+#ifndef WaveformCache_h
+#define WaveformCache_h
+
+#include "Dataset.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+//************************************************************************
+// Class for caching signal data already written as DAC samples, so that
+// transmitting a block again costs a single copy into the Tx buffer.
+//
+// A waveform is keyed by the fingerprint of the source file, the
+// modulation-SNR combination, a fingerprint of the block contents, the DAC
+// format and the scale. Waveforms are kept in a least recently used list,
+// within a memory budget, and can also be persisted as raw interleaved
+// 16-bit files (ci16) in a directory, which outlive the application. Each
+// ci16 file has a .key file holding its full key and a hash of the whole
+// block, both checked before the samples are used, since a source file
+// edited in place may keep the sampled fingerprints. Signal data of an
+// unknown source is never persisted.
+//************************************************************************
+class WaveformCache
+{
+    //************************************************************************
+    // constants and types
+    //************************************************************************
+    public:
+        static const size_t PAIR_BYTES = 2 * sizeof( int16_t );        //!< size of a DAC (I,Q) pair [bytes]
+        static const size_t DEFAULT_BUDGET_BYTES = 256 * 1048576;     //!< default memory budget [bytes]
+
+        typedef std::shared_ptr<const std::vector<uint8_t>> WaveformPtr;
+
+    private:
+        static const size_t FINGERPRINT_POINTS_NR = 256;              //!< points sampled for the block fingerprint
+
+        static const std::string KEY_FILE_EXTENSION;                   //!< extension of the key file of a ci16 file
+
+        typedef struct
+        {
+            uint64_t                        sourceFingerprint;  //!< fingerprint of the source file, 0 if unknown
+            int32_t                         modulation;         //!< modulation name
+            int32_t                         snrDb;              //!< SNR [dB]
+            uint64_t                        fingerprint;        //!< fingerprint of the block contents
+            uint64_t                        scaleBits;          //!< bits of the scale
+            uint32_t                        formatId;           //!< DAC format
+            uint32_t                        reserved;           //!< reserved
+        }Key;
+
+        typedef struct
+        {
+            Key                             key;                //!< full key
+            uint64_t                        blockHash;          //!< hash of all the points of the block
+        }KeyFile;
+
+        typedef struct
+        {
+            Key                             key;            //!< full key, checked on hits
+            WaveformPtr                     waveform;       //!< DAC samples
+            std::list<uint64_t>::iterator   lruIt;          //!< position in the LRU list
+        }Entry;
+
+
+    //************************************************************************
+    // functions
+    //************************************************************************
+    public:
+        static WaveformCache* getInstance();
+
+        template<typename DacFormatT>
+        WaveformPtr get
+            (
+            const Dataset::SignalData&      aSignalData,    //!< signal data
+            const double                    aScale          //!< scale of the points to [-1..1]
+            );
+
+        size_t getBudgetBytes() const;
+
+        std::string getDiskDirectory() const;
+
+        uint64_t getHitsNr() const;
+
+        size_t getResidentBytes() const;
+
+        void setBudgetBytes
+            (
+            const size_t                    aBudgetBytes    //!< memory budget [bytes]
+            );
+
+        void setDiskDirectory
+            (
+            const std::string&              aDirectory      //!< directory of the ci16 files, empty for memory only
+            );
+
+    private:
+        WaveformCache();
+
+        void evict
+            (
+            const size_t                    aIncomingBytes  //!< size of the waveform to be added [bytes]
+            );
+
+        WaveformPtr find
+            (
+            const Key&                      aKey,           //!< waveform key
+            const Dataset::SignalData&      aSignalData     //!< signal data of the waveform
+            );
+
+        std::string getFileName
+            (
+            const Key&                      aKey            //!< waveform key
+            ) const;
+
+        static uint64_t hashBlock
+            (
+            const Dataset::SignalData&      aSignalData     //!< signal data
+            );
+
+        static uint64_t hashKey
+            (
+            const Key&                      aKey            //!< waveform key
+            );
+
+        WaveformPtr insert
+            (
+            const Key&                      aKey,           //!< waveform key
+            std::vector<uint8_t>&&          aSampleVec,     //!< DAC samples
+            const Dataset::SignalData*      aPersistedData  //!< signal data of a waveform to write to disk, nullptr to keep it in memory only
+            );
+
+        static bool isSameKey
+            (
+            const Key&                      aKey,           //!< waveform key
+            const Key&                      aOtherKey       //!< key compared with
+            );
+
+        static Key makeKey
+            (
+            const Dataset::SignalData&      aSignalData,    //!< signal data
+            const uint32_t                  aFormatId,      //!< DAC format
+            const double                    aScale          //!< scale of the points to [-1..1]
+            );
+
+        static bool readKeyFile
+            (
+            const std::string&              aFileName,      //!< name of the ci16 file
+            const Key&                      aKey,           //!< expected waveform key
+            const uint64_t                  aBlockHash      //!< expected hash of the block
+            );
+
+        static bool writeFile
+            (
+            const std::string&              aFileName,      //!< file name
+            const void*                     aData,          //!< file contents
+            const size_t                    aBytesNr        //!< size of the contents [bytes]
+            );
+
+
+    //************************************************************************
+    // variables
+    //************************************************************************
+    private:
+        static WaveformCache*                   sInstance;      //!< singleton
+
+        size_t                                  mBudgetBytes;   //!< memory budget [bytes]
+        size_t                                  mResidentBytes; //!< memory used by resident waveforms [bytes]
+        uint64_t                                mHitsNr;        //!< waveforms served without conversion
+        std::string                             mDiskDirectory; //!< directory of the ci16 files, empty for memory only
+
+        std::list<uint64_t>                     mLruList;       //!< key hashes, most recently used first
+        std::unordered_map<uint64_t, Entry>     mEntryMap;      //!< resident waveforms
+
+        mutable std::mutex                      mMutex;         //!< protects all the above
+};
+
+
+//!************************************************************************
+//! Get the DAC samples of signal data, converting them only if they are
+//! neither resident nor on disk
+//!
+//! @returns The DAC samples, one pair every PAIR_BYTES
+//!************************************************************************
+template<typename DacFormatT>
+WaveformCache::WaveformPtr WaveformCache::get
+    (
+    const Dataset::SignalData&      aSignalData,    //!< signal data
+    const double                    aScale          //!< scale of the points to [-1..1]
+    )
+{
+    const Key KEY = makeKey( aSignalData, DacFormatT::FORMAT_ID, aScale );
+    const size_t POINTS_NR = aSignalData.frameStore.getPointsNr();
+    WaveformPtr waveform = find( KEY, aSignalData );
+
+    if( !waveform )
+    {
+        // converted outside the lock, a concurrent conversion of the same key replaces this one
+        std::vector<uint8_t> sampleVec( POINTS_NR * PAIR_BYTES );
+        DacFormatT::write( aSignalData.frameStore.data(), POINTS_NR, aScale, sampleVec.data(), PAIR_BYTES );
+
+        waveform = insert( KEY, std::move( sampleVec ), &aSignalData );
+    }
+
+    return waveform;
+}
+
+#endif // WaveformCache_h
@@ -0,0 +1,148 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+/*
+WorkerPool.cpp
+
+This file contains the sources for worker pool.
+*/
+
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <utility>
+
+
+//!************************************************************************
+//! Constructor
+//!************************************************************************
+WorkerPool::WorkerPool
+    (
+    const size_t    aThreadsNr      //!< number of threads, 0 for one per core
+    )
+    : mPendingNr( 0 )
+    , mStopping( false )
+{
+    size_t threadsNr = aThreadsNr;
+
+    if( 0 == threadsNr )
+    {
+        threadsNr = std::max( std::thread::hardware_concurrency(), 1u );
+    }
+
+    for( size_t i = 0; i < threadsNr; i++ )
+    {
+        mThreadVec.emplace_back( &WorkerPool::run, this );
+    }
+}
+
+
+//!************************************************************************
+//! Destructor
+//!************************************************************************
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        mStopping = true;
+    }
+
+    mTaskCv.notify_all();
+
+    for( size_t i = 0; i < mThreadVec.size(); i++ )
+    {
+        mThreadVec.at( i ).join();
+    }
+}
+
+
+//!************************************************************************
+//! Get the number of worker threads
+//!
+//! @returns The number of worker threads
+//!************************************************************************
+size_t WorkerPool::getThreadsNr() const
+{
+    return mThreadVec.size();
+}
+
+
+//!************************************************************************
+//! Worker thread loop
+//!
+//! @returns nothing
+//!************************************************************************
+void WorkerPool::run()
+{
+    std::unique_lock<std::mutex> lock( mMutex );
+
+    while( true )
+    {
+        mTaskCv.wait( lock, [this]{ return mStopping || mTaskQueue.size(); } );
+
+        if( mTaskQueue.empty() )
+        {
+            break;
+        }
+
+        std::function<void()> task = std::move( mTaskQueue.front() );
+        mTaskQueue.pop_front();
+
+        lock.unlock();
+        task();
+        lock.lock();
+
+        mPendingNr--;
+
+        if( 0 == mPendingNr )
+        {
+            mDoneCv.notify_all();
+        }
+    }
+}
+
+
+//!************************************************************************
+//! Submit a task to the pool
+//!
+//! @returns nothing
+//!************************************************************************
+void WorkerPool::submit
+    (
+    std::function<void()>   aTask       //!< task to run
+    )
+{
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        mTaskQueue.push_back( std::move( aTask ) );
+        mPendingNr++;
+    }
+
+    mTaskCv.notify_one();
+}
+
+
+//!************************************************************************
+//! Wait for all submitted tasks to complete
+//!
+//! @returns nothing
+//!************************************************************************
+void WorkerPool::wait()
+{
+    std::unique_lock<std::mutex> lock( mMutex );
+    mDoneCv.wait( lock, [this]{ return 0 == mPendingNr; } );
+}
@@ -0,0 +1,84 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+/*
+WorkerPool.h
+
+This file contains the definitions for worker pool.
+*/
+
+#ifndef WorkerPool_h
+#define WorkerPool_h
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+//************************************************************************
+// Class for handling a fixed pool of worker threads.
+// Tasks are run in submission order by the first free worker; wait()
+// blocks until all submitted tasks have completed.
+//************************************************************************
+class WorkerPool
+{
+    //************************************************************************
+    // functions
+    //************************************************************************
+    public:
+        explicit WorkerPool
+            (
+            const size_t    aThreadsNr = 0      //!< number of threads, 0 for one per core
+            );
+
+        ~WorkerPool();
+
+        WorkerPool( const WorkerPool& ) = delete;
+        WorkerPool& operator=( const WorkerPool& ) = delete;
+
+        size_t getThreadsNr() const;
+
+        void submit
+            (
+            std::function<void()>   aTask       //!< task to run
+            );
+
+        void wait();
+
+    private:
+        void run();
+
+
+    //************************************************************************
+    // variables
+    //************************************************************************
+    private:
+        std::vector<std::thread>            mThreadVec;     //!< worker threads
+        std::deque<std::function<void()>>   mTaskQueue;     //!< tasks not started yet
+        size_t                              mPendingNr;     //!< tasks not completed yet
+        bool                                mStopping;      //!< true when the workers must exit
+
+        std::mutex                          mMutex;         //!< protects all the above
+        std::condition_variable             mTaskCv;        //!< signals a new task or stopping
+        std::condition_variable             mDoneCv;        //!< signals that all tasks completed
+};
+
+#endif // WorkerPool_h
@@ -0,0 +1,108 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+
+/*
+mainBatch.cpp
+This file contains the main application for the headless batch transmitter.
+*/
+
+#include "TxBatch.h"
+
+#include <csignal>
+#include <iostream>
+
+
+//!************************************************************************
+//! Handler of SIGINT and SIGTERM
+//!
+//! @returns nothing
+//!************************************************************************
+static void handleStopSignal
+    (
+    int     aSignal     //!< signal number
+    )
+{
+    (void)aSignal;
+    TxBatch::requestStop();
+}
+
+
+//!************************************************************************
+//! Main application
+//!
+//! @returns: 0 if the batch completed, 1 otherwise
+//!************************************************************************
+int main
+    (
+    int     argc,
+    char*   argv[]
+    )
+{
+    int exitCode = 1;
+
+    if( argc < 2 )
+    {
+        std::cout << "Usage: " << argv[0] << " <config file> [key=value ...]" << std::endl
+                  << "Keys:" << std::endl
+                  << "  dataset              RadioML2016.10A, RadioML2018.01 or HisarMod2019.1" << std::endl
+                  << "  dataset_file         dataset file" << std::endl
+                  << "  modulation           parse only this modulation" << std::endl
+                  << "  index_only           1 to index the dataset instead of loading it (default 1)" << std::endl
+                  << "  block_cache_mb       block cache budget of an indexed dataset" << std::endl
+                  << "  uri                  Tx device, e.g. ip:192.168.2.1 or sim:ad9361" << std::endl
+                  << "  lo_hz                Tx LO frequency" << std::endl
+                  << "  nco_gain             Tx NCO gain scale" << std::endl
+                  << "  playlist             playlist file" << std::endl
+                  << "  sweep_dwell_ms       sweep all parsed modulations and SNRs instead" << std::endl
+                  << "  continuous           1 for non-cyclic streaming" << std::endl
+                  << "  loop                 1 to repeat the plan until stopped" << std::endl
+                  << "  log                  playlist log file" << std::endl
+                  << "  capture              none, ci16 or cf32" << std::endl
+                  << "  capture_name         base name of the SigMF capture" << std::endl
+                  << "  waveform_cache_mb    waveform cache budget" << std::endl
+                  << "  waveform_cache_dir   waveform cache directory" << std::endl;
+    }
+    else
+    {
+        TxBatch batch;
+        bool status = batch.loadConfig( argv[1] );
+
+        // the command line overrides the configuration file
+        for( int i = 2; status && i < argc; i++ )
+        {
+            status = batch.setOption( argv[i] );
+
+            if( !status )
+            {
+                std::cout << "Expected key=value: " << argv[i] << std::endl;
+            }
+        }
+
+        if( status )
+        {
+            std::signal( SIGINT, handleStopSignal );
+            std::signal( SIGTERM, handleStopSignal );
+
+            status = batch.run();
+        }
+
+        exitCode = status ? 0 : 1;
+    }
+
+    return exitCode;
+}
@@ -0,0 +1,101 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+
+/*
+mainBench.cpp
+This file contains the main application for the microbenchmarks.
+*/
+
+#include "Benchmark.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+
+//!************************************************************************
+//! Main application
+//!
+//! @returns: 0 if all the cases run succeeded, 1 otherwise
+//!************************************************************************
+int main
+    (
+    int     argc,
+    char*   argv[]
+    )
+{
+    Benchmark benchmark;
+    std::string jsonFileName;
+    bool status = true;
+    bool usage = false;
+
+    for( int i = 1; status && !usage && i < argc; i++ )
+    {
+        usage = ( 0 == strcmp( argv[i], "-h" ) || 0 == strcmp( argv[i], "--help" ) );
+
+        if( !usage && 0 == strncmp( argv[i], "json=", 5 ) )
+        {
+            jsonFileName = argv[i] + 5;
+        }
+        else if( !usage )
+        {
+            status = benchmark.setOption( argv[i] );
+            usage = !status;
+        }
+    }
+
+    if( usage )
+    {
+        std::cout << "Usage: " << argv[0] << " [key=value ...]" << std::endl
+                  << "Keys:" << std::endl
+                  << "  pkl                  RadioML 2016.10A pickle to parse" << std::endl
+                  << "  hdf5                 RadioML 2018.01 HDF5 file to parse" << std::endl
+                  << "  csv                  HisarMod 2019.1 CSV file to parse" << std::endl
+                  << "  modulation           parse only this modulation" << std::endl
+                  << "  iterations           timed iterations of each case (default 5)" << std::endl
+                  << "  conversion_points    points converted to DAC samples per iteration" << std::endl
+                  << "  lookups              dataset index lookups per iteration" << std::endl
+                  << "  name_lookups         modulation name lookups per iteration" << std::endl
+                  << "  cases                comma separated prefixes of the cases to run" << std::endl
+                  << "  json                 file for the JSON results (default stdout)" << std::endl
+                  << "The cache and sidecar index of the parsed files are kept in a temporary directory." << std::endl
+                  << "Dataset files of any scale can be written by RadioModTxGen." << std::endl;
+    }
+    else
+    {
+        status = benchmark.run();
+
+        if( jsonFileName.size() )
+        {
+            std::ofstream jsonFile( jsonFileName );
+            benchmark.writeJson( jsonFile );
+
+            if( !jsonFile.good() )
+            {
+                std::cerr << "Cannot write " << jsonFileName << std::endl;
+                status = false;
+            }
+        }
+        else
+        {
+            benchmark.writeJson( std::cout );
+        }
+    }
+
+    return status ? 0 : 1;
+}
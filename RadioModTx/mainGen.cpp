@@ -0,0 +1,81 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+
+/*
+mainGen.cpp
+This file contains the main application for the synthetic dataset generator.
+*/
+
+#include "DatasetGenerator.h"
+
+#include <cstring>
+#include <iostream>
+
+
+//!************************************************************************
+//! Main application
+//!
+//! @returns: 0 if the dataset could be written, 1 otherwise
+//!************************************************************************
+int main
+    (
+    int     argc,
+    char*   argv[]
+    )
+{
+    DatasetGenerator generator;
+    bool status = true;
+    bool usage = false;
+
+    for( int i = 1; status && !usage && i < argc; i++ )
+    {
+        usage = ( 0 == strcmp( argv[i], "-h" ) || 0 == strcmp( argv[i], "--help" ) );
+
+        if( !usage )
+        {
+            status = generator.setOption( argv[i] );
+            usage = !status;
+        }
+    }
+
+    if( usage )
+    {
+        std::cout << "Usage: " << argv[0] << " format=pkl|hdf5|csv output=FILE [key=value ...]" << std::endl
+                  << "Keys:" << std::endl
+                  << "  format               pkl (RadioML 2016.10A), hdf5 (RadioML 2018.01) or csv (HisarMod 2019.1)" << std::endl
+                  << "  output               file to write, overwritten" << std::endl
+                  << "  scale                frames per modulation-SNR combination, times the original dataset (default 1)" << std::endl
+                  << "  frames               frames per modulation-SNR combination, overrides scale" << std::endl
+                  << "  frame_length         (I,Q) points per frame (default: the original dataset)" << std::endl
+                  << "  snr_min              lowest SNR [dB] (default -20), pkl and hdf5 only" << std::endl
+                  << "  snr_step             SNR step [dB] (default 2), pkl and hdf5 only" << std::endl
+                  << "  snrs_nr              number of SNRs (default: the original dataset), pkl and hdf5 only" << std::endl
+                  << "  hdf5_layout          contiguous or chunked (default contiguous)" << std::endl
+                  << "  chunk_rows           rows per HDF5 chunk (default 32)" << std::endl
+                  << "  deflate              HDF5 deflate level 0..9, implies chunked (default 0)" << std::endl
+                  << "  seed                 seed of the frames (default 2024)" << std::endl
+                  << "The parsers only accept the frame length and SNR grid of the original datasets." << std::endl
+                  << "A csv file comes with a .frames file giving its frames per block to the parser." << std::endl;
+    }
+    else
+    {
+        status = generator.run();
+    }
+
+    return status ? 0 : 1;
+}
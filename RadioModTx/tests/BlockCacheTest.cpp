@@ -0,0 +1,330 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+
+/*
+BlockCacheTest.cpp
+
+This file contains the unit tests of the cache of blocks loaded on demand.
+*/
+
+#include "TestCheck.h"
+#include "BlockCache.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+
+//************************************************************************
+// Class for testing the block cache: blocks are kept within the budget,
+// the least recently used being evicted first, and each one is loaded
+// once however many threads ask for it
+//************************************************************************
+class BlockCacheTest
+{
+    //************************************************************************
+    // constants and types
+    //************************************************************************
+    private:
+        static const size_t FRAMES_NR = 4;          //!< frames per block, the location length of the loader
+        static const uint16_t FRAME_LENGTH = 32;    //!< (I,Q) points per frame
+        static const size_t BLOCKS_NR = 3;          //!< blocks within the budget
+        static const size_t THREADS_NR = 8;         //!< threads asking for the same block
+        static const uint64_t FAILING_OFFSET = 99;  //!< location offset the loader fails on
+
+
+    //************************************************************************
+    // functions
+    //************************************************************************
+    public:
+        BlockCacheTest();
+
+        bool run();
+
+    private:
+        bool checkConcurrentLoad();
+
+        bool checkEviction();
+
+        bool checkFailedLoad();
+
+        bool checkOversizedBlock();
+
+        Dataset::SignalDataPtr get
+            (
+            BlockCache&             aBlockCache,    //!< block cache
+            const size_t            aKey,           //!< block key, also the location offset
+            const size_t            aFramesNr       //!< frames of the block
+            );
+
+        bool isBlock
+            (
+            const Dataset::SignalDataPtr&   aSignalData,    //!< block handed out by the cache
+            const size_t                    aKey            //!< block key
+            ) const;
+
+
+    //************************************************************************
+    // variables
+    //************************************************************************
+    private:
+        Dataset::BlockLoader        mLoader;        //!< loader filling a block with its location offset
+        std::atomic<size_t>         mLoadsNr;       //!< number of loads
+        size_t                      mBlockBytes;    //!< size of a block of FRAMES_NR frames [bytes]
+};
+
+
+//!************************************************************************
+//! Constructor
+//!************************************************************************
+BlockCacheTest::BlockCacheTest()
+    : mLoadsNr( 0 )
+    , mBlockBytes( 0 )
+{
+    mLoader = [this]( const Dataset::BlockLocation& aLocation, Dataset::SignalData& aSignalData )
+    {
+        // slow enough for the concurrent requests to overlap
+        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+        mLoadsNr++;
+
+        bool status = ( FAILING_OFFSET != aLocation.offset ) && aSignalData.frameStore.allocate( aLocation.length, FRAME_LENGTH );
+
+        for( size_t i = 0; status && i < aSignalData.frameStore.getPointsNr(); i++ )
+        {
+            aSignalData.frameStore.data()[i] = { static_cast<float>( aLocation.offset ), 0 };
+        }
+
+        return status;
+    };
+
+    FrameStore frameStore;
+    frameStore.allocate( FRAMES_NR, FRAME_LENGTH );
+    mBlockBytes = frameStore.getSizeBytes();
+}
+
+
+//!************************************************************************
+//! Check that concurrent requests for a block not resident load it once
+//! and all get the same block
+//!
+//! @returns true if the block was loaded once
+//!************************************************************************
+bool BlockCacheTest::checkConcurrentLoad()
+{
+    BlockCache blockCache( mLoader, BLOCKS_NR * mBlockBytes );
+    std::vector<Dataset::SignalDataPtr> signalDataVec( THREADS_NR );
+    std::vector<std::thread> threadVec;
+
+    mLoadsNr = 0;
+
+    for( size_t t = 0; t < THREADS_NR; t++ )
+    {
+        threadVec.emplace_back( [&, t]()
+        {
+            signalDataVec.at( t ) = get( blockCache, 5, FRAMES_NR );
+        });
+    }
+
+    for( std::thread& thread : threadVec )
+    {
+        thread.join();
+    }
+
+    bool status = check( 1 == mLoadsNr, "one load for concurrent requests" );
+
+    for( size_t t = 0; status && t < THREADS_NR; t++ )
+    {
+        status = check( signalDataVec.at( t ) == signalDataVec.front(), "same block for thread " + std::to_string( t ) );
+    }
+
+    return status && check( isBlock( signalDataVec.front(), 5 ), "concurrently loaded block" );
+}
+
+
+//!************************************************************************
+//! Check the least recently used eviction within the budget
+//!
+//! @returns true if the right blocks were evicted
+//!************************************************************************
+bool BlockCacheTest::checkEviction()
+{
+    BlockCache blockCache( mLoader, BLOCKS_NR * mBlockBytes );
+
+    mLoadsNr = 0;
+
+    // 0, 1 and 2 fill the budget, 0 is then the most recently used
+    const Dataset::SignalDataPtr FIRST_BLOCK = get( blockCache, 0, FRAMES_NR );
+    get( blockCache, 1, FRAMES_NR );
+    get( blockCache, 2, FRAMES_NR );
+
+    bool status = check( 3 == mLoadsNr, "blocks loaded" )
+               && check( BLOCKS_NR * mBlockBytes == blockCache.getResidentBytes(), "resident bytes of a full cache" )
+               && check( FIRST_BLOCK == get( blockCache, 0, FRAMES_NR ), "resident block handed out again" )
+               && check( 3 == mLoadsNr, "no load for a resident block" );
+
+    // 3 evicts 1, the least recently used
+    const Dataset::SignalDataPtr FOURTH_BLOCK = get( blockCache, 3, FRAMES_NR );
+
+    status = status
+          && check( 4 == mLoadsNr, "block loaded into a full cache" )
+          && check( BLOCKS_NR * mBlockBytes == blockCache.getResidentBytes(), "resident bytes after an eviction" );
+
+    get( blockCache, 0, FRAMES_NR );
+    get( blockCache, 2, FRAMES_NR );
+    get( blockCache, 3, FRAMES_NR );
+
+    status = status && check( 4 == mLoadsNr, "blocks kept by an eviction" );
+
+    // 1 is loaded again and evicts 0
+    get( blockCache, 1, FRAMES_NR );
+
+    status = status && check( 5 == mLoadsNr, "evicted block loaded again" );
+
+    // shrinking the budget evicts 2, the least recently used; an evicted block still held stays valid
+    blockCache.setBudgetBytes( 2 * mBlockBytes );
+
+    status = status
+          && check( 2 * mBlockBytes == blockCache.getResidentBytes(), "resident bytes after a smaller budget" )
+          && check( isBlock( FIRST_BLOCK, 0 ), "evicted block still held" );
+
+    get( blockCache, 3, FRAMES_NR );
+    get( blockCache, 1, FRAMES_NR );
+
+    status = status && check( 5 == mLoadsNr, "blocks kept by a smaller budget" );
+
+    get( blockCache, 0, FRAMES_NR );
+
+    return status
+        && check( 6 == mLoadsNr, "block evicted by a smaller budget" )
+        && check( isBlock( FOURTH_BLOCK, 3 ), "block held through the evictions" );
+}
+
+
+//!************************************************************************
+//! Check that a block failing to load is neither handed out nor kept
+//!
+//! @returns true if the failed block is reported
+//!************************************************************************
+bool BlockCacheTest::checkFailedLoad()
+{
+    BlockCache blockCache( mLoader, BLOCKS_NR * mBlockBytes );
+
+    mLoadsNr = 0;
+
+    return check( nullptr == get( blockCache, FAILING_OFFSET, FRAMES_NR ), "failed block not handed out" )
+        && check( 0 == blockCache.getResidentBytes(), "failed block not kept" )
+        && check( nullptr == get( blockCache, FAILING_OFFSET, FRAMES_NR ) && 2 == mLoadsNr, "failed block loaded again" );
+}
+
+
+//!************************************************************************
+//! Check that a block larger than the budget is handed out without
+//! evicting the resident ones
+//!
+//! @returns true if the block is handed out and not kept
+//!************************************************************************
+bool BlockCacheTest::checkOversizedBlock()
+{
+    BlockCache blockCache( mLoader, BLOCKS_NR * mBlockBytes );
+
+    mLoadsNr = 0;
+    get( blockCache, 0, FRAMES_NR );
+
+    const Dataset::SignalDataPtr OVERSIZED_BLOCK = get( blockCache, 1, ( BLOCKS_NR + 1 ) * FRAMES_NR );
+
+    bool status = check( isBlock( OVERSIZED_BLOCK, 1 ), "oversized block handed out" )
+               && check( mBlockBytes == blockCache.getResidentBytes(), "oversized block not kept" );
+
+    get( blockCache, 0, FRAMES_NR );
+    get( blockCache, 1, ( BLOCKS_NR + 1 ) * FRAMES_NR );
+
+    return status && check( 3 == mLoadsNr, "oversized block loaded again, resident block kept" );
+}
+
+
+//!************************************************************************
+//! Get a block, its key being the offset of its location
+//!
+//! @returns The block, null if it could not be loaded
+//!************************************************************************
+Dataset::SignalDataPtr BlockCacheTest::get
+    (
+    BlockCache&             aBlockCache,    //!< block cache
+    const size_t            aKey,           //!< block key, also the location offset
+    const size_t            aFramesNr       //!< frames of the block
+    )
+{
+    const Dataset::BlockLocation LOCATION = { aKey, aFramesNr };
+    const Dataset::SignalOrigin ORIGIN = { 1, Modulation::NAME_BPSK, static_cast<int32_t>( aKey ) };
+
+    return aBlockCache.get( aKey, LOCATION, ORIGIN );
+}
+
+
+//!************************************************************************
+//! Check that a block handed out by the cache is the one of a key
+//!
+//! @returns true if the block has the points and origin of the key
+//!************************************************************************
+bool BlockCacheTest::isBlock
+    (
+    const Dataset::SignalDataPtr&   aSignalData,    //!< block handed out by the cache
+    const size_t                    aKey            //!< block key
+    ) const
+{
+    bool status = aSignalData
+               && ( aSignalData->frameStore.getPointsNr() > 0 )
+               && ( static_cast<int32_t>( aKey ) == aSignalData->origin.snrDb );
+
+    for( size_t i = 0; status && i < aSignalData->frameStore.getPointsNr(); i++ )
+    {
+        status = ( static_cast<float>( aKey ) == aSignalData->frameStore.data()[i].i );
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Run all the checks
+//!
+//! @returns true if all the checks passed
+//!************************************************************************
+bool BlockCacheTest::run()
+{
+    bool status = checkEviction();
+    status = checkOversizedBlock() && status;
+    status = checkFailedLoad() && status;
+    status = checkConcurrentLoad() && status;
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Main application
+//!
+//! @returns: 0 if all the checks passed, 1 otherwise
+//!************************************************************************
+int main()
+{
+    BlockCacheTest blockCacheTest;
+
+    return blockCacheTest.run() ? 0 : 1;
+}
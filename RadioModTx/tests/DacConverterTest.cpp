@@ -0,0 +1,274 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+
+/*
+DacConverterTest.cpp
+
+This file contains the unit tests of the DAC sample converter.
+*/
+
+#include "TestCheck.h"
+#include "DacConverter.h"
+#include "DacFormat.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+
+//************************************************************************
+// Class for testing the DAC converter: the vector kernels supported by
+// the CPU must write the same samples as the scalar one
+//************************************************************************
+class DacConverterTest
+{
+    //************************************************************************
+    // constants and types
+    //************************************************************************
+    private:
+        static const size_t POINTS_NR = 1027;       //!< points converted, not a multiple of the vector widths
+        static const uint32_t RANDOM_SEED = 2024;   //!< seed of the random points
+
+
+    //************************************************************************
+    // functions
+    //************************************************************************
+    public:
+        static bool run();
+
+    private:
+        static bool checkFormats
+            (
+            const std::vector<Dataset::IQPoint>&    aPointVec   //!< points to convert
+            );
+
+        static bool checkKernels
+            (
+            const std::vector<Dataset::IQPoint>&    aPointVec   //!< points to convert
+            );
+
+        static bool checkStrided
+            (
+            const std::vector<Dataset::IQPoint>&    aPointVec   //!< points to convert
+            );
+
+        static bool checkValues();
+
+        static std::vector<Dataset::IQPoint> getPoints();
+};
+
+
+//!************************************************************************
+//! Check the formats not matching the host layout against the samples of
+//! the kernel, byte-swapped and with Q first
+//!
+//! @returns true if the samples match
+//!************************************************************************
+bool DacConverterTest::checkFormats
+    (
+    const std::vector<Dataset::IQPoint>&    aPointVec   //!< points to convert
+    )
+{
+    typedef DacFormat<12, DAC_JUSTIFY_MSB, DAC_ENDIAN_LITTLE, DAC_INTERLEAVE_IQ> HostFormat;
+    typedef DacFormat<12, DAC_JUSTIFY_MSB, DAC_ENDIAN_BIG, DAC_INTERLEAVE_QI> SwappedFormat;
+
+    const double SCALE = 0.9;
+
+    std::vector<int16_t> hostVec( 2 * aPointVec.size() );
+    std::vector<int16_t> swappedVec( 2 * aPointVec.size() );
+
+    HostFormat::write( aPointVec.data(), aPointVec.size(), SCALE, reinterpret_cast<uint8_t*>( hostVec.data() ), 2 * sizeof( int16_t ) );
+    SwappedFormat::write( aPointVec.data(), aPointVec.size(), SCALE, reinterpret_cast<uint8_t*>( swappedVec.data() ), 2 * sizeof( int16_t ) );
+
+    bool status = true;
+
+    for( size_t i = 0; status && i < aPointVec.size(); i++ )
+    {
+        status = check( static_cast<int16_t>( __builtin_bswap16( hostVec.at( 2 * i + 1 ) ) ) == swappedVec.at( 2 * i )
+                        && static_cast<int16_t>( __builtin_bswap16( hostVec.at( 2 * i ) ) ) == swappedVec.at( 2 * i + 1 ),
+                        "big-endian QI sample of point " + std::to_string( i ) );
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Check each vector kernel supported by the CPU against the scalar one,
+//! for the shifts of the supported DACs
+//!
+//! @returns true if all the kernels write the same samples
+//!************************************************************************
+bool DacConverterTest::checkKernels
+    (
+    const std::vector<Dataset::IQPoint>&    aPointVec   //!< points to convert
+    )
+{
+    const int SHIFT_VEC[] = { 0, 2, 4 };
+    const float FULL_SCALE_VEC[] = { 32767, 8191, 2047 };
+
+    bool status = true;
+
+    for( size_t s = 0; s < sizeof( SHIFT_VEC ) / sizeof( SHIFT_VEC[0] ); s++ )
+    {
+        const float FULL_SCALE = FULL_SCALE_VEC[s];
+
+        std::vector<int16_t> scalarVec( 2 * aPointVec.size() );
+        DacConverter::convertScalar( aPointVec.data(), aPointVec.size(), FULL_SCALE, FULL_SCALE, SHIFT_VEC[s], scalarVec.data() );
+
+        if( DacConverter::getKernel() >= DacConverter::KERNEL_SSE2 )
+        {
+            std::vector<int16_t> sse2Vec( 2 * aPointVec.size() );
+            DacConverter::convertSse2( aPointVec.data(), aPointVec.size(), FULL_SCALE, FULL_SCALE, SHIFT_VEC[s], sse2Vec.data() );
+
+            status = check( scalarVec == sse2Vec, "SSE2 kernel, shift " + std::to_string( SHIFT_VEC[s] ) ) && status;
+        }
+
+        if( DacConverter::getKernel() >= DacConverter::KERNEL_AVX2 )
+        {
+            std::vector<int16_t> avx2Vec( 2 * aPointVec.size() );
+            DacConverter::convertAvx2( aPointVec.data(), aPointVec.size(), FULL_SCALE, FULL_SCALE, SHIFT_VEC[s], avx2Vec.data() );
+
+            status = check( scalarVec == avx2Vec, "AVX2 kernel, shift " + std::to_string( SHIFT_VEC[s] ) ) && status;
+        }
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Check a strided buffer, longer than a block of the strided conversion:
+//! the pairs must match a packed buffer and the bytes between them must
+//! not be written
+//!
+//! @returns true if the buffer is right
+//!************************************************************************
+bool DacConverterTest::checkStrided
+    (
+    const std::vector<Dataset::IQPoint>&    aPointVec   //!< points to convert
+    )
+{
+    const int16_t FULL_SCALE = 2047;
+    const int SHIFT = 4;
+    const std::ptrdiff_t STEP = 4 * sizeof( int16_t );
+    const uint8_t FILL = 0xA5;
+
+    std::vector<int16_t> packedVec( 2 * aPointVec.size() );
+    std::vector<uint8_t> stridedVec( aPointVec.size() * STEP, FILL );
+
+    DacConverter::convert( aPointVec.data(), aPointVec.size(), FULL_SCALE, FULL_SCALE, SHIFT, reinterpret_cast<uint8_t*>( packedVec.data() ), 2 * sizeof( int16_t ) );
+    DacConverter::convert( aPointVec.data(), aPointVec.size(), FULL_SCALE, FULL_SCALE, SHIFT, stridedVec.data(), STEP );
+
+    bool status = true;
+
+    for( size_t i = 0; status && i < aPointVec.size(); i++ )
+    {
+        const uint8_t* PAIR = stridedVec.data() + i * STEP;
+
+        status = check( 0 == memcmp( PAIR, packedVec.data() + 2 * i, 2 * sizeof( int16_t ) ), "strided pair " + std::to_string( i ) )
+              && check( FILL == PAIR[4] && FILL == PAIR[5] && FILL == PAIR[6] && FILL == PAIR[7], "bytes after strided pair " + std::to_string( i ) );
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Check the samples of the dispatched kernel for known values: truncation
+//! toward zero, saturation and NaN
+//!
+//! @returns true if the samples are right
+//!************************************************************************
+bool DacConverterTest::checkValues()
+{
+    const float NAN_VALUE = std::numeric_limits<float>::quiet_NaN();
+    const float INFINITE = std::numeric_limits<float>::infinity();
+
+    // 12-bit DAC, MSB-justified: 1023.5 truncates to 1023, 2.0 saturates to 2047
+    const std::vector<Dataset::IQPoint> POINT_VEC = { { 0.5f, -0.5f }, { 2.0f, -2.0f }, { INFINITE, -INFINITE }, { NAN_VALUE, 0.0f } };
+    const std::vector<int16_t> EXPECTED_VEC = { 1023 * 16, -1023 * 16, 2047 * 16, -2047 * 16, 2047 * 16, -2047 * 16, 2047 * 16, 0 };
+
+    std::vector<int16_t> sampleVec( 2 * POINT_VEC.size() );
+    DacConverter::convert( POINT_VEC.data(), POINT_VEC.size(), 2047, 2047, 4, reinterpret_cast<uint8_t*>( sampleVec.data() ), 2 * sizeof( int16_t ) );
+
+    return check( EXPECTED_VEC == sampleVec, std::string( "known values, " ) + DacConverter::getKernelName() + " kernel" );
+}
+
+
+//!************************************************************************
+//! Get points over the DAC range and beyond, with the special values
+//! the kernels must saturate
+//!
+//! @returns The points
+//!************************************************************************
+std::vector<Dataset::IQPoint> DacConverterTest::getPoints()
+{
+    std::mt19937 generator( RANDOM_SEED );
+    std::uniform_real_distribution<float> distribution( -1.5f, 1.5f );
+    std::vector<Dataset::IQPoint> pointVec( POINTS_NR );
+
+    for( size_t i = 0; i < POINTS_NR; i++ )
+    {
+        pointVec.at( i ).i = distribution( generator );
+        pointVec.at( i ).q = distribution( generator );
+    }
+
+    const float SPECIAL_VEC[] = { 0.0f, -0.0f, 1.0f, -1.0f, 1e-6f, -1e-6f,
+                                  std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+                                  std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::max() };
+
+    for( size_t i = 0; i < sizeof( SPECIAL_VEC ) / sizeof( SPECIAL_VEC[0] ); i++ )
+    {
+        pointVec.at( 2 * i ).i = SPECIAL_VEC[i];
+        pointVec.at( 2 * i + 1 ).q = SPECIAL_VEC[i];
+    }
+
+    return pointVec;
+}
+
+
+//!************************************************************************
+//! Run all the checks
+//!
+//! @returns true if all the checks passed
+//!************************************************************************
+bool DacConverterTest::run()
+{
+    const std::vector<Dataset::IQPoint> POINT_VEC = getPoints();
+
+    bool status = checkKernels( POINT_VEC );
+    status = checkStrided( POINT_VEC ) && status;
+    status = checkFormats( POINT_VEC ) && status;
+    status = checkValues() && status;
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Main application
+//!
+//! @returns: 0 if all the checks passed, 1 otherwise
+//!************************************************************************
+int main()
+{
+    return DacConverterTest::run() ? 0 : 1;
+}
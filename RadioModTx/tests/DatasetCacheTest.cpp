@@ -0,0 +1,259 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+
+/*
+DatasetCacheTest.cpp
+
+This file contains the unit tests of the native binary dataset cache.
+*/
+
+#include "TestCheck.h"
+#include "DatasetCache.h"
+#include "DatasetIndex.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+
+#include <unistd.h>
+
+
+//************************************************************************
+// Class for testing the dataset cache: a saved index must load back with
+// the same blocks, and a cache older than its source must be rejected
+//************************************************************************
+class DatasetCacheTest
+{
+    //************************************************************************
+    // constants and types
+    //************************************************************************
+    private:
+        static const size_t FRAMES_NR = 3;          //!< frames per block
+        static const uint16_t FRAME_LENGTH = 16;    //!< (I,Q) points per frame
+
+
+    //************************************************************************
+    // functions
+    //************************************************************************
+    public:
+        static bool run();
+
+    private:
+        static bool checkRoundTrip
+            (
+            const std::string&      aSourceFileName     //!< dataset source file
+            );
+
+        static bool checkStale
+            (
+            const std::string&      aSourceFileName     //!< dataset source file
+            );
+
+        static Dataset::SignalData getSignalData
+            (
+            const int               aSeed               //!< seed of the point values
+            );
+
+        static bool isSame
+            (
+            const Dataset::SignalData&  aSignalData,    //!< loaded signal data
+            const Dataset::SignalData&  aExpected       //!< saved signal data
+            );
+};
+
+
+//!************************************************************************
+//! Check that a saved index loads back with the same modulations, SNRs
+//! and blocks, the blocks absent from the index being left out
+//!
+//! @returns true if the loaded cache matches the index
+//!************************************************************************
+bool DatasetCacheTest::checkRoundTrip
+    (
+    const std::string&      aSourceFileName     //!< dataset source file
+    )
+{
+    const std::vector<Modulation::ModulationName> MOD_VEC = { Modulation::NAME_BPSK, Modulation::NAME_QPSK };
+    const std::vector<int> SNR_VEC = { -20, -18, -16 };
+
+    DatasetIndex index;
+    index.build( MOD_VEC, SNR_VEC );
+
+    // (QPSK, -16 dB) is left absent
+    for( size_t m = 0; m < MOD_VEC.size(); m++ )
+    {
+        for( size_t s = 0; s < SNR_VEC.size(); s++ )
+        {
+            if( m + 1 < MOD_VEC.size() || s + 1 < SNR_VEC.size() )
+            {
+                index.insert( std::make_pair( MOD_VEC.at( m ), SNR_VEC.at( s ) ), getSignalData( m * SNR_VEC.size() + s ) );
+            }
+        }
+    }
+
+    DatasetCache cache( aSourceFileName, Dataset::DATASET_SOURCE_HISARMOD_2019_1 );
+    cache.setDirectory( aSourceFileName.substr( 0, aSourceFileName.rfind( '/' ) ) );
+
+    std::vector<Modulation::ModulationName> modVec;
+    std::vector<int> snrVec;
+    Dataset::ModulationSnrSignalDataVec blockVec;
+
+    bool status = check( cache.save( index ), "cache saved" )
+               && check( cache.load( modVec, snrVec, blockVec ), "cache loaded" )
+               && check( MOD_VEC == modVec, "loaded modulations" )
+               && check( SNR_VEC == snrVec, "loaded SNRs" )
+               && check( index.size() == blockVec.size(), "loaded blocks" );
+
+    for( size_t i = 0; status && i < blockVec.size(); i++ )
+    {
+        const Dataset::ModulationSnrPair& PAIR = blockVec.at( i ).first;
+
+        status = check( index.contains( PAIR ), "loaded block " + std::to_string( i ) + " in the index" )
+              && check( isSame( blockVec.at( i ).second, index.at( PAIR ) ), "samples of loaded block " + std::to_string( i ) );
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Check that a cache is rejected once its source file has changed
+//!
+//! @returns true if the stale cache is rejected
+//!************************************************************************
+bool DatasetCacheTest::checkStale
+    (
+    const std::string&      aSourceFileName     //!< dataset source file
+    )
+{
+    DatasetCache cache( aSourceFileName, Dataset::DATASET_SOURCE_HISARMOD_2019_1 );
+    cache.setDirectory( aSourceFileName.substr( 0, aSourceFileName.rfind( '/' ) ) );
+
+    std::ofstream sourceFile( aSourceFileName, std::ios::binary | std::ios::app );
+    sourceFile << "appended line" << std::endl;
+    sourceFile.close();
+
+    std::vector<Modulation::ModulationName> modVec;
+    std::vector<int> snrVec;
+    Dataset::ModulationSnrSignalDataVec blockVec;
+
+    return check( !cache.load( modVec, snrVec, blockVec ), "stale cache rejected" )
+        && check( modVec.empty() && snrVec.empty() && blockVec.empty(), "nothing returned from a stale cache" );
+}
+
+
+//!************************************************************************
+//! Get a block with distinct point values
+//!
+//! @returns The signal data of the block
+//!************************************************************************
+Dataset::SignalData DatasetCacheTest::getSignalData
+    (
+    const int               aSeed               //!< seed of the point values
+    )
+{
+    Dataset::SignalData signalData;
+    signalData.maxVal = 0;
+    signalData.frameStore.allocate( FRAMES_NR, FRAME_LENGTH );
+
+    Dataset::IQPoint* points = signalData.frameStore.data();
+
+    for( size_t i = 0; i < signalData.frameStore.getPointsNr(); i++ )
+    {
+        points[i].i = 0.001f * ( aSeed * 1000 + i );
+        points[i].q = -0.002f * ( aSeed * 1000 + i );
+        signalData.maxVal = std::max( signalData.maxVal, -points[i].q );
+    }
+
+    return signalData;
+}
+
+
+//!************************************************************************
+//! Compare a loaded block with the saved one
+//!
+//! @returns true if the frames, the samples and the maximum are the same
+//!************************************************************************
+bool DatasetCacheTest::isSame
+    (
+    const Dataset::SignalData&  aSignalData,    //!< loaded signal data
+    const Dataset::SignalData&  aExpected       //!< saved signal data
+    )
+{
+    const FrameStore& FRAME_STORE = aSignalData.frameStore;
+    const FrameStore& EXPECTED_STORE = aExpected.frameStore;
+
+    bool status = ( aExpected.maxVal == aSignalData.maxVal )
+               && ( EXPECTED_STORE.getFramesNr() == FRAME_STORE.getFramesNr() )
+               && ( EXPECTED_STORE.getFrameLength() == FRAME_STORE.getFrameLength() );
+
+    for( size_t i = 0; status && i < EXPECTED_STORE.getPointsNr(); i++ )
+    {
+        status = ( EXPECTED_STORE.data()[i].i == FRAME_STORE.data()[i].i )
+              && ( EXPECTED_STORE.data()[i].q == FRAME_STORE.data()[i].q );
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Run all the checks on a source file in a temporary directory
+//!
+//! @returns true if all the checks passed
+//!************************************************************************
+bool DatasetCacheTest::run()
+{
+    char directoryTemplate[] = "/tmp/DatasetCacheTest.XXXXXX";
+    const char* DIRECTORY = mkdtemp( directoryTemplate );
+    bool status = check( nullptr != DIRECTORY, "temporary directory created" );
+
+    if( status )
+    {
+        const std::string SOURCE_FILE_NAME = std::string( DIRECTORY ) + "/source.csv";
+
+        std::ofstream sourceFile( SOURCE_FILE_NAME, std::ios::binary );
+        sourceFile << "source file contents" << std::endl;
+        sourceFile.close();
+
+        status = checkRoundTrip( SOURCE_FILE_NAME );
+        status = checkStale( SOURCE_FILE_NAME ) && status;
+
+        DatasetCache cache( SOURCE_FILE_NAME, Dataset::DATASET_SOURCE_HISARMOD_2019_1 );
+        cache.setDirectory( DIRECTORY );
+
+        std::remove( cache.getFileName().c_str() );
+        std::remove( SOURCE_FILE_NAME.c_str() );
+        rmdir( DIRECTORY );
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Main application
+//!
+//! @returns: 0 if all the checks passed, 1 otherwise
+//!************************************************************************
+int main()
+{
+    return DatasetCacheTest::run() ? 0 : 1;
+}
@@ -0,0 +1,225 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+
+/*
+DatasetGeneratorTest.cpp
+
+This file contains the unit tests of the synthetic datasets read back by
+the parsers.
+*/
+
+#include "TestCheck.h"
+#include "CsvParser.h"
+#include "DatasetGenerator.h"
+#include "Hdf5Parser.h"
+#include "PklParser.h"
+#include "SourceIndex.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include <unistd.h>
+
+
+//************************************************************************
+// Class for testing the synthetic datasets: each file written by the
+// generator must be parsed back with all its blocks, frames and SNRs
+//************************************************************************
+class DatasetGeneratorTest
+{
+    //************************************************************************
+    // functions
+    //************************************************************************
+    public:
+        static bool run();
+
+    private:
+        static bool checkDataset
+            (
+            const std::string&                  aDirectory,     //!< directory of the dataset file
+            const Dataset::DatasetSource        aSource,        //!< dataset source
+            const std::vector<std::string>&     aOptionVec,     //!< generator options, besides format and output
+            const size_t                        aFramesNr,      //!< frames per block set by the options
+            const std::vector<int>&             aSnrVec         //!< SNRs set by the options
+            );
+
+        static std::vector<int> getSnrVec
+            (
+            const int                           aSnrMinDb,      //!< lowest SNR [dB]
+            const int                           aSnrStepDb,     //!< SNR step [dB]
+            const size_t                        aSnrsNr         //!< number of SNRs
+            );
+};
+
+
+//!************************************************************************
+//! Generate a dataset file, parse it and check the parsed blocks
+//!
+//! @returns true if the file is parsed back as generated
+//!************************************************************************
+bool DatasetGeneratorTest::checkDataset
+    (
+    const std::string&                  aDirectory,     //!< directory of the dataset file
+    const Dataset::DatasetSource        aSource,        //!< dataset source
+    const std::vector<std::string>&     aOptionVec,     //!< generator options, besides format and output
+    const size_t                        aFramesNr,      //!< frames per block set by the options
+    const std::vector<int>&             aSnrVec         //!< SNRs set by the options
+    )
+{
+    std::string format;
+    std::unique_ptr<DatasetParser> parser;
+
+    switch( aSource )
+    {
+        case Dataset::DATASET_SOURCE_RADIOML_2016_10A:
+            format = "pkl";
+            parser.reset( new PklParser() );
+            break;
+
+        case Dataset::DATASET_SOURCE_RADIOML_2018_01:
+            format = "hdf5";
+            parser.reset( new Hdf5Parser() );
+            break;
+
+        default:
+            format = "csv";
+            parser.reset( new CsvParser() );
+            break;
+    }
+
+    const std::string FILE_NAME = aDirectory + "/dataset." + format;
+
+    DatasetGenerator generator;
+    bool status = generator.setOption( "format=" + format ) && generator.setOption( "output=" + FILE_NAME );
+
+    for( size_t i = 0; status && i < aOptionVec.size(); i++ )
+    {
+        status = generator.setOption( aOptionVec.at( i ) );
+    }
+
+    status = check( status && generator.run(), format + " dataset written" );
+
+    // the cache is not used, the index goes to the temporary directory
+    parser->setIndexOnly( false, Dataset::BLOCK_CACHE_BUDGET_BYTES );
+    parser->setCacheEnabled( false );
+    parser->setSidecarDirectory( aDirectory );
+    parser->setFile( FILE_NAME );
+
+    if( status )
+    {
+        parser->parseDataset();
+    }
+
+    bool parseStatus = false;
+    const Dataset::Snapshot MAP = parser->takeMap( parseStatus );
+
+    std::vector<int> snrVec = MAP ? MAP->getSnrVec() : std::vector<int>();
+    std::sort( snrVec.begin(), snrVec.end() );
+
+    status = status
+          && check( parseStatus && MAP, format + " dataset parsed" )
+          && check( Dataset::MODULATIONS_NR.at( aSource ) == MAP->getModulationsNr(), format + " modulations" )
+          && check( aSnrVec == snrVec, format + " SNRs" )
+          && check( MAP->getModulationsNr() * MAP->getSnrsNr() == MAP->size(), format + " blocks" );
+
+    for( size_t m = 0; status && m < MAP->getModulationsNr(); m++ )
+    {
+        for( size_t s = 0; status && s < MAP->getSnrsNr(); s++ )
+        {
+            const Dataset::SignalData* SIGNAL_DATA = MAP->getSignalData( m, s );
+
+            status = check( nullptr != SIGNAL_DATA, format + " block " + std::to_string( m ) + "/" + std::to_string( s ) + " present" )
+                  && check( aFramesNr == SIGNAL_DATA->frameStore.getFramesNr(), format + " frames of block " + std::to_string( m ) + "/" + std::to_string( s ) )
+                  && check( Dataset::FRAME_LENGTH.at( aSource ) == SIGNAL_DATA->frameStore.getFrameLength(), format + " frame length of block " + std::to_string( m ) + "/" + std::to_string( s ) )
+                  && check( SIGNAL_DATA->maxVal > 0, format + " maximum of block " + std::to_string( m ) + "/" + std::to_string( s ) );
+        }
+    }
+
+    std::remove( FILE_NAME.c_str() );
+    std::remove( ( FILE_NAME + CsvParser::FRAMES_FILE_EXTENSION ).c_str() );
+    std::remove( ( aDirectory + "/dataset." + format + SourceIndex::FILE_EXTENSION ).c_str() );
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Get an SNR grid
+//!
+//! @returns The SNRs, in increasing order
+//!************************************************************************
+std::vector<int> DatasetGeneratorTest::getSnrVec
+    (
+    const int                           aSnrMinDb,      //!< lowest SNR [dB]
+    const int                           aSnrStepDb,     //!< SNR step [dB]
+    const size_t                        aSnrsNr         //!< number of SNRs
+    )
+{
+    std::vector<int> snrVec;
+
+    for( size_t i = 0; i < aSnrsNr; i++ )
+    {
+        snrVec.push_back( aSnrMinDb + static_cast<int>( i ) * aSnrStepDb );
+    }
+
+    return snrVec;
+}
+
+
+//!************************************************************************
+//! Run all the checks, the datasets in a temporary directory
+//!
+//! @returns true if all the checks passed
+//!************************************************************************
+bool DatasetGeneratorTest::run()
+{
+    char directoryTemplate[] = "/tmp/DatasetGeneratorTest.XXXXXX";
+    const char* DIRECTORY = mkdtemp( directoryTemplate );
+    bool status = check( nullptr != DIRECTORY, "temporary directory created" );
+
+    if( status )
+    {
+        // the pickle keys carry the SNRs, another grid of as many SNRs is read back
+        status = checkDataset( DIRECTORY, Dataset::DATASET_SOURCE_RADIOML_2016_10A,
+                               { "frames=3", "snr_min=-10", "snr_step=3" }, 3, getSnrVec( -10, 3, Dataset::SNRS_NR.at( Dataset::DATASET_SOURCE_RADIOML_2016_10A ) ) );
+
+        status = checkDataset( DIRECTORY, Dataset::DATASET_SOURCE_RADIOML_2018_01,
+                               { "frames=2", "hdf5_layout=chunked", "chunk_rows=7" }, 2, getSnrVec( -20, 2, Dataset::SNRS_NR.at( Dataset::DATASET_SOURCE_RADIOML_2018_01 ) ) ) && status;
+
+        status = checkDataset( DIRECTORY, Dataset::DATASET_SOURCE_HISARMOD_2019_1,
+                               { "frames=1" }, 1, getSnrVec( CsvParser::SNR_MIN_DB, CsvParser::SNR_STEP_DB, Dataset::SNRS_NR.at( Dataset::DATASET_SOURCE_HISARMOD_2019_1 ) ) ) && status;
+
+        rmdir( DIRECTORY );
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Main application
+//!
+//! @returns: 0 if all the checks passed, 1 otherwise
+//!************************************************************************
+int main()
+{
+    return DatasetGeneratorTest::run() ? 0 : 1;
+}
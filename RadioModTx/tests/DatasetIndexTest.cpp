@@ -0,0 +1,236 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+
+/*
+DatasetIndexTest.cpp
+
+This file contains the unit tests of the dense modulation-SNR index.
+*/
+
+#include "TestCheck.h"
+#include "BlockCache.h"
+#include "DatasetIndex.h"
+
+#include <memory>
+#include <stdexcept>
+
+
+//************************************************************************
+// Class for testing the dataset index: ordinals of the modulations and
+// SNRs, resident and lazy blocks, and the origin stamped on them
+//************************************************************************
+class DatasetIndexTest
+{
+    //************************************************************************
+    // constants and types
+    //************************************************************************
+    private:
+        static const uint64_t SOURCE_FINGERPRINT = 0xABCD;  //!< fingerprint of the source file
+        static const size_t FRAMES_NR = 2;                  //!< frames per block
+        static const uint16_t FRAME_LENGTH = 8;             //!< (I,Q) points per frame
+
+
+    //************************************************************************
+    // functions
+    //************************************************************************
+    public:
+        static bool run();
+
+    private:
+        static bool checkLazyBlocks
+            (
+            const std::shared_ptr<DatasetIndex>&    aIndex      //!< index built by checkOrdinals()
+            );
+
+        static bool checkOrdinals
+            (
+            const std::shared_ptr<DatasetIndex>&    aIndex      //!< empty index
+            );
+
+        static bool checkResidentBlocks
+            (
+            const std::shared_ptr<DatasetIndex>&    aIndex      //!< index built by checkOrdinals()
+            );
+
+        static bool isOrigin
+            (
+            const Dataset::SignalData&          aSignalData,    //!< signal data
+            const Dataset::ModulationSnrPair&   aPair           //!< expected modulation-SNR combination
+            );
+};
+
+
+//!************************************************************************
+//! Check the blocks loaded on demand: absent until a block cache is set,
+//! then loaded with their origin
+//!
+//! @returns true if the lazy blocks behave as expected
+//!************************************************************************
+bool DatasetIndexTest::checkLazyBlocks
+    (
+    const std::shared_ptr<DatasetIndex>&    aIndex      //!< index built by checkOrdinals()
+    )
+{
+    const Dataset::ModulationSnrPair PAIR = std::make_pair( Modulation::NAME_QPSK, 10 );
+    const Dataset::BlockLocation LOCATION = { 100, FRAMES_NR };
+
+    bool status = check( !aIndex->insertLocation( std::make_pair( Modulation::NAME_QPSK, -10 ), { 0, 0 } ), "empty location refused" )
+               && check( aIndex->insertLocation( PAIR, LOCATION ), "location inserted" )
+               && check( aIndex->contains( PAIR ) && aIndex->isLazy( 0, 2 ), "lazy block present" )
+               && check( nullptr == aIndex->getSignalData( 0, 2 ), "no signal data for a lazy block" )
+               && check( nullptr == aIndex->getBlock( PAIR ), "no lazy block without a block cache" );
+
+    bool outOfRange = false;
+
+    try
+    {
+        aIndex->at( PAIR );
+    }
+    catch( const std::out_of_range& )
+    {
+        outOfRange = true;
+    }
+
+    status = status && check( outOfRange, "lazy block out of range of at()" );
+
+    const Dataset::BlockLoader LOADER = []( const Dataset::BlockLocation& aLocation, Dataset::SignalData& aSignalData )
+    {
+        aSignalData.maxVal = aLocation.offset;
+        return aSignalData.frameStore.allocate( aLocation.length, FRAME_LENGTH );
+    };
+
+    aIndex->setBlockCache( std::make_shared<BlockCache>( LOADER, Dataset::BLOCK_CACHE_BUDGET_BYTES ) );
+
+    const Dataset::SignalDataPtr BLOCK = aIndex->getBlock( PAIR );
+
+    return status
+        && check( nullptr != BLOCK, "lazy block loaded" )
+        && check( BLOCK && FRAMES_NR == BLOCK->frameStore.getFramesNr() && LOCATION.offset == BLOCK->maxVal, "lazy block loaded from its location" )
+        && check( BLOCK && isOrigin( *BLOCK, PAIR ), "origin of the lazy block" )
+        && check( BLOCK == aIndex->getBlock( PAIR ), "lazy block kept by the block cache" );
+}
+
+
+//!************************************************************************
+//! Check the ordinals of the modulations and SNRs, in the order given to
+//! build() and with gaps between the SNRs
+//!
+//! @returns true if the ordinals are right
+//!************************************************************************
+bool DatasetIndexTest::checkOrdinals
+    (
+    const std::shared_ptr<DatasetIndex>&    aIndex      //!< empty index
+    )
+{
+    aIndex->build( { Modulation::NAME_QPSK, Modulation::NAME_BPSK }, { -10, 0, 10 } );
+    aIndex->setSourceFingerprint( SOURCE_FINGERPRINT );
+
+    return check( aIndex->empty() && 0 == aIndex->size(), "built index empty" )
+        && check( 2 == aIndex->getModulationsNr() && 3 == aIndex->getSnrsNr(), "built index dimensions" )
+        && check( 0 == aIndex->getModulationIndex( Modulation::NAME_QPSK ), "ordinal of the first modulation" )
+        && check( 1 == aIndex->getModulationIndex( Modulation::NAME_BPSK ), "ordinal of the second modulation" )
+        && check( -1 == aIndex->getModulationIndex( Modulation::NAME_8PSK ), "ordinal of an absent modulation" )
+        && check( 0 == aIndex->getSnrIndex( -10 ) && 1 == aIndex->getSnrIndex( 0 ) && 2 == aIndex->getSnrIndex( 10 ), "ordinals of the SNRs" )
+        && check( -1 == aIndex->getSnrIndex( 5 ), "ordinal of an SNR between two others" )
+        && check( -1 == aIndex->getSnrIndex( -12 ) && -1 == aIndex->getSnrIndex( 12 ), "ordinals of SNRs out of the range" );
+}
+
+
+//!************************************************************************
+//! Check the resident blocks: inserted only within the grid, counted once,
+//! stamped with their origin and kept alive by the blocks handed out
+//!
+//! @returns true if the resident blocks behave as expected
+//!************************************************************************
+bool DatasetIndexTest::checkResidentBlocks
+    (
+    const std::shared_ptr<DatasetIndex>&    aIndex      //!< index built by checkOrdinals()
+    )
+{
+    const Dataset::ModulationSnrPair PAIR = std::make_pair( Modulation::NAME_BPSK, 0 );
+
+    Dataset::SignalData signalData;
+    signalData.frameStore.allocate( FRAMES_NR, FRAME_LENGTH );
+    signalData.maxVal = 0.5;
+
+    Dataset::SignalData otherSignalData = signalData;
+    Dataset::SignalData outsideSignalData = signalData;
+
+    bool status = check( aIndex->insert( PAIR, std::move( signalData ) ), "block inserted" )
+               && check( !aIndex->insert( std::make_pair( Modulation::NAME_BPSK, 20 ), std::move( outsideSignalData ) ), "block outside the grid refused" )
+               && check( aIndex->insert( PAIR, std::move( otherSignalData ) ), "block inserted again" )
+               && check( 1 == aIndex->size() && !aIndex->empty(), "block counted once" )
+               && check( aIndex->contains( PAIR ) && !aIndex->contains( std::make_pair( Modulation::NAME_QPSK, 0 ) ), "present blocks" )
+               && check( aIndex->isPresent( 1, 1 ) && !aIndex->isLazy( 1, 1 ), "resident block present" )
+               && check( &aIndex->at( PAIR ) == aIndex->getSignalData( 1, 1 ), "resident block by pair and by ordinals" )
+               && check( 0.5 == aIndex->at( PAIR ).maxVal && FRAMES_NR == aIndex->at( PAIR ).frameStore.getFramesNr(), "resident block contents" )
+               && check( isOrigin( aIndex->at( PAIR ), PAIR ), "origin of the resident block" );
+
+    const Dataset::SignalDataPtr BLOCK = aIndex->getBlock( PAIR );
+
+    return status
+        && check( BLOCK.get() == &aIndex->at( PAIR ), "resident block handed out in place" )
+        && check( aIndex.use_count() > 1, "index kept alive by a handed out block" );
+}
+
+
+//!************************************************************************
+//! Check the origin stamped on signal data
+//!
+//! @returns true if the origin is the source file and the pair
+//!************************************************************************
+bool DatasetIndexTest::isOrigin
+    (
+    const Dataset::SignalData&          aSignalData,    //!< signal data
+    const Dataset::ModulationSnrPair&   aPair           //!< expected modulation-SNR combination
+    )
+{
+    return ( SOURCE_FINGERPRINT == aSignalData.origin.sourceFingerprint )
+        && ( aPair.first == aSignalData.origin.modulation )
+        && ( aPair.second == aSignalData.origin.snrDb );
+}
+
+
+//!************************************************************************
+//! Run all the checks
+//!
+//! @returns true if all the checks passed
+//!************************************************************************
+bool DatasetIndexTest::run()
+{
+    const std::shared_ptr<DatasetIndex> INDEX = std::make_shared<DatasetIndex>();
+
+    bool status = checkOrdinals( INDEX )
+               && checkResidentBlocks( INDEX )
+               && checkLazyBlocks( INDEX );
+
+    INDEX->clear();
+
+    return status && check( INDEX->empty() && 0 == INDEX->getModulationsNr(), "cleared index" );
+}
+
+
+//!************************************************************************
+//! Main application
+//!
+//! @returns: 0 if all the checks passed, 1 otherwise
+//!************************************************************************
+int main()
+{
+    return DatasetIndexTest::run() ? 0 : 1;
+}
@@ -0,0 +1,409 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+
+/*
+SourceIndexTest.cpp
+
+This file contains the unit tests of the sidecar index of a source file.
+*/
+
+#include "TestCheck.h"
+#include "SourceIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+//************************************************************************
+// Class for testing the source index: a saved index must load back with
+// the same blocks and frame offsets, read the frames from the source file,
+// and reject a touched or changed source file
+//************************************************************************
+class SourceIndexTest
+{
+    //************************************************************************
+    // constants and types
+    //************************************************************************
+    private:
+        static constexpr Dataset::DatasetSource SOURCE = Dataset::DATASET_SOURCE_RADIOML_2016_10A;    //!< source of the frame length
+
+        static const size_t BLOCKS_NR = 2;          //!< blocks of the source file
+        static const size_t FRAMES_NR = 3;          //!< frames per block
+        static const size_t HEADER_BYTES = 16;      //!< bytes before the first block
+
+
+    //************************************************************************
+    // functions
+    //************************************************************************
+    public:
+        static bool run();
+
+    private:
+        static bool checkChangedSource
+            (
+            const std::string&      aSourceFileName     //!< dataset source file
+            );
+
+        static bool checkReadFrames
+            (
+            const std::string&      aSourceFileName     //!< dataset source file
+            );
+
+        static bool checkRoundTrip
+            (
+            const std::string&      aSourceFileName     //!< dataset source file
+            );
+
+        static bool checkTouchedSource
+            (
+            const std::string&      aSourceFileName     //!< dataset source file
+            );
+
+        static Dataset::ModulationSnrPair getPair
+            (
+            const size_t            aBlock              //!< block number
+            );
+
+        static float getValue
+            (
+            const size_t            aBlock,             //!< block number
+            const size_t            aFrame,             //!< frame number within the block
+            const size_t            aPoint              //!< point number within the frame
+            );
+
+        static bool setMtime
+            (
+            const std::string&      aFileName,          //!< file to touch
+            const struct timespec&  aMtime              //!< modification time
+            );
+
+        static bool writeSource
+            (
+            const std::string&      aSourceFileName     //!< dataset source file
+            );
+};
+
+
+//!************************************************************************
+//! Check that the index is rejected once the contents of the source file
+//! have changed, its size and modification time being the same
+//!
+//! @returns true if the index is rejected
+//!************************************************************************
+bool SourceIndexTest::checkChangedSource
+    (
+    const std::string&      aSourceFileName     //!< dataset source file
+    )
+{
+    struct stat sourceStat;
+    bool status = check( 0 == stat( aSourceFileName.c_str(), &sourceStat ), "source file found" );
+
+    std::fstream sourceFile( aSourceFileName, std::ios::binary | std::ios::in | std::ios::out );
+    sourceFile.seekp( HEADER_BYTES );
+    sourceFile.put( 0x7F );
+    sourceFile.close();
+
+    SourceIndex sourceIndex( aSourceFileName, SOURCE );
+    sourceIndex.setDirectory( aSourceFileName.substr( 0, aSourceFileName.rfind( '/' ) ) );
+
+    // the modification time is set back, only the fingerprint tells the change
+    return status
+        && check( setMtime( aSourceFileName, sourceStat.st_mtim ), "modification time restored" )
+        && check( !sourceIndex.load(), "index of a changed source rejected" )
+        && check( 0 == sourceIndex.getBlocksNr(), "no blocks from a rejected index" );
+}
+
+
+//!************************************************************************
+//! Check the frames read through a loaded index against the source file
+//!
+//! @returns true if the frames and the maximum are right
+//!************************************************************************
+bool SourceIndexTest::checkReadFrames
+    (
+    const std::string&      aSourceFileName     //!< dataset source file
+    )
+{
+    const uint16_t FRAME_LENGTH = Dataset::FRAME_LENGTH.at( SOURCE );
+    const std::vector<size_t> FRAME_VEC = { 2, 0 };
+
+    // raw float (I,Q) points
+    const Dataset::FrameDecoder DECODER = [FRAME_LENGTH]( const char* aBytes, size_t aBytesNr, Dataset::IQPoint* aPoints, float& aMaxVal )
+    {
+        const bool STATUS = ( FRAME_LENGTH * sizeof( Dataset::IQPoint ) == aBytesNr );
+
+        for( size_t i = 0; STATUS && i < FRAME_LENGTH; i++ )
+        {
+            memcpy( &aPoints[i], aBytes + i * sizeof( Dataset::IQPoint ), sizeof( Dataset::IQPoint ) );
+            aMaxVal = std::max( aMaxVal, std::max( std::fabs( aPoints[i].i ), std::fabs( aPoints[i].q ) ) );
+        }
+
+        return STATUS;
+    };
+
+    SourceIndex sourceIndex( aSourceFileName, SOURCE );
+    sourceIndex.setDirectory( aSourceFileName.substr( 0, aSourceFileName.rfind( '/' ) ) );
+
+    bool status = check( sourceIndex.load(), "index loaded" );
+
+    for( size_t b = 0; status && b < BLOCKS_NR; b++ )
+    {
+        Dataset::SignalData signalData;
+        status = check( sourceIndex.readFrames( b, FRAME_VEC, DECODER, signalData ), "frames of block " + std::to_string( b ) + " read" )
+              && check( FRAME_VEC.size() == signalData.frameStore.getFramesNr(), "frames read from block " + std::to_string( b ) );
+
+        for( size_t f = 0; status && f < FRAME_VEC.size(); f++ )
+        {
+            const Dataset::IQPoint* FRAME = signalData.frameStore.getFrame( f );
+
+            for( size_t p = 0; status && p < FRAME_LENGTH; p++ )
+            {
+                status = check( getValue( b, FRAME_VEC.at( f ), p ) == FRAME[p].i && -getValue( b, FRAME_VEC.at( f ), p ) == FRAME[p].q,
+                                "point " + std::to_string( p ) + " of frame " + std::to_string( FRAME_VEC.at( f ) ) + " of block " + std::to_string( b ) );
+            }
+        }
+
+        // block 0 has its maximum recorded, block 1 gets the one of the frames read
+        const float EXPECTED_MAX_VAL = b ? getValue( b, FRAME_VEC.front(), FRAME_LENGTH - 1 ) : getValue( b, FRAMES_NR - 1, FRAME_LENGTH - 1 );
+        status = status && check( EXPECTED_MAX_VAL == signalData.maxVal, "maximum of block " + std::to_string( b ) );
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Check that a saved index loads back with the same blocks and frames
+//!
+//! @returns true if the loaded index matches the saved one
+//!************************************************************************
+bool SourceIndexTest::checkRoundTrip
+    (
+    const std::string&      aSourceFileName     //!< dataset source file
+    )
+{
+    const uint64_t FRAME_BYTES = Dataset::FRAME_LENGTH.at( SOURCE ) * sizeof( Dataset::IQPoint );
+    const uint64_t BLOCK_BYTES = FRAMES_NR * FRAME_BYTES;
+    const std::string DIRECTORY = aSourceFileName.substr( 0, aSourceFileName.rfind( '/' ) );
+
+    SourceIndex savedIndex( aSourceFileName, SOURCE );
+    savedIndex.setDirectory( DIRECTORY );
+
+    for( size_t b = 0; b < BLOCKS_NR; b++ )
+    {
+        const Dataset::BlockLocation LOCATION = { HEADER_BYTES + b * BLOCK_BYTES, BLOCK_BYTES };
+        std::vector<uint64_t> frameOffsetVec;
+
+        for( size_t f = 0; f < FRAMES_NR; f++ )
+        {
+            frameOffsetVec.push_back( LOCATION.offset + f * FRAME_BYTES );
+        }
+
+        // the maximum of block 1 is left unmeasured
+        const float MAX_VAL = b ? -1 : getValue( b, FRAMES_NR - 1, Dataset::FRAME_LENGTH.at( SOURCE ) - 1 );
+        savedIndex.addBlock( getPair( b ), LOCATION, MAX_VAL, frameOffsetVec );
+    }
+
+    SourceIndex sourceIndex( aSourceFileName, SOURCE );
+    sourceIndex.setDirectory( DIRECTORY );
+
+    bool status = check( savedIndex.save(), "index saved" )
+               && check( sourceIndex.load(), "index loaded" )
+               && check( BLOCKS_NR == sourceIndex.getBlocksNr(), "loaded blocks" )
+               && check( -1 == sourceIndex.findBlock( std::make_pair( Modulation::NAME_8PSK, 0 ) ), "absent block not found" );
+
+    const Dataset::ModulationSnrLocationVec LOCATION_VEC = sourceIndex.getLocationVec();
+
+    for( size_t b = 0; status && b < BLOCKS_NR; b++ )
+    {
+        Dataset::BlockLocation frameLocation;
+
+        status = check( static_cast<int>( b ) == sourceIndex.findBlock( getPair( b ) ), "block " + std::to_string( b ) + " found" )
+              && check( FRAMES_NR == sourceIndex.getFramesNr( b ), "frames of block " + std::to_string( b ) )
+              && check( getPair( b ) == LOCATION_VEC.at( b ).first, "pair of block " + std::to_string( b ) )
+              && check( HEADER_BYTES + b * BLOCK_BYTES == LOCATION_VEC.at( b ).second.offset, "offset of block " + std::to_string( b ) )
+              && check( BLOCK_BYTES == LOCATION_VEC.at( b ).second.length, "length of block " + std::to_string( b ) )
+              && check( sourceIndex.getFrameLocation( b, FRAMES_NR - 1, frameLocation ), "location of the last frame of block " + std::to_string( b ) )
+              && check( HEADER_BYTES + b * BLOCK_BYTES + ( FRAMES_NR - 1 ) * FRAME_BYTES == frameLocation.offset
+                        && FRAME_BYTES == frameLocation.length, "last frame of block " + std::to_string( b ) )
+              && check( !sourceIndex.getFrameLocation( b, FRAMES_NR, frameLocation ), "frame past the end of block " + std::to_string( b ) );
+    }
+
+    return status
+        && check( sourceIndex.getMaxVal( 0 ) == getValue( 0, FRAMES_NR - 1, Dataset::FRAME_LENGTH.at( SOURCE ) - 1 ), "maximum of block 0" )
+        && check( sourceIndex.getMaxVal( 1 ) < 0, "unmeasured maximum of block 1" );
+}
+
+
+//!************************************************************************
+//! Check that the index is rejected once the source file was touched, and
+//! loads again with the modification time it records
+//!
+//! @returns true if the index follows the modification time
+//!************************************************************************
+bool SourceIndexTest::checkTouchedSource
+    (
+    const std::string&      aSourceFileName     //!< dataset source file
+    )
+{
+    const struct timespec TOUCHED_MTIME = { 1000000000, 0 };
+
+    SourceIndex sourceIndex( aSourceFileName, SOURCE );
+    sourceIndex.setDirectory( aSourceFileName.substr( 0, aSourceFileName.rfind( '/' ) ) );
+
+    struct stat sourceStat;
+
+    return check( 0 == stat( aSourceFileName.c_str(), &sourceStat ), "source file found" )
+        && check( setMtime( aSourceFileName, TOUCHED_MTIME ), "source file touched" )
+        && check( !sourceIndex.load(), "index of a touched source rejected" )
+        && check( setMtime( aSourceFileName, sourceStat.st_mtim ), "modification time restored" )
+        && check( sourceIndex.load(), "index loaded with the modification time restored" )
+        && check( BLOCKS_NR == sourceIndex.getBlocksNr(), "blocks with the modification time restored" );
+}
+
+
+//!************************************************************************
+//! Get the modulation-SNR combination of a block
+//!
+//! @returns The modulation-SNR pair
+//!************************************************************************
+Dataset::ModulationSnrPair SourceIndexTest::getPair
+    (
+    const size_t            aBlock              //!< block number
+    )
+{
+    return std::make_pair( aBlock ? Modulation::NAME_QPSK : Modulation::NAME_BPSK, -10 + 2 * static_cast<int>( aBlock ) );
+}
+
+
+//!************************************************************************
+//! Get the I value of a point of the source file, its Q value being the
+//! opposite. The values grow through the file.
+//!
+//! @returns The I value
+//!************************************************************************
+float SourceIndexTest::getValue
+    (
+    const size_t            aBlock,             //!< block number
+    const size_t            aFrame,             //!< frame number within the block
+    const size_t            aPoint              //!< point number within the frame
+    )
+{
+    return 0.001f * ( ( aBlock * FRAMES_NR + aFrame ) * Dataset::FRAME_LENGTH.at( SOURCE ) + aPoint + 1 );
+}
+
+
+//!************************************************************************
+//! Set the modification time of a file
+//!
+//! @returns true if the time could be set
+//!************************************************************************
+bool SourceIndexTest::setMtime
+    (
+    const std::string&      aFileName,          //!< file to touch
+    const struct timespec&  aMtime              //!< modification time
+    )
+{
+    const struct timespec TIMES[2] = { aMtime, aMtime };
+
+    return 0 == utimensat( AT_FDCWD, aFileName.c_str(), TIMES, 0 );
+}
+
+
+//!************************************************************************
+//! Write a source file: a header, then the blocks of raw float (I,Q) frames
+//!
+//! @returns true if the file could be written
+//!************************************************************************
+bool SourceIndexTest::writeSource
+    (
+    const std::string&      aSourceFileName     //!< dataset source file
+    )
+{
+    std::ofstream sourceFile( aSourceFileName, std::ios::binary );
+    const std::vector<char> HEADER( HEADER_BYTES, 'H' );
+
+    sourceFile.write( HEADER.data(), HEADER.size() );
+
+    for( size_t b = 0; b < BLOCKS_NR; b++ )
+    {
+        for( size_t f = 0; f < FRAMES_NR; f++ )
+        {
+            for( size_t p = 0; p < Dataset::FRAME_LENGTH.at( SOURCE ); p++ )
+            {
+                const Dataset::IQPoint POINT = { getValue( b, f, p ), -getValue( b, f, p ) };
+                sourceFile.write( reinterpret_cast<const char*>( &POINT ), sizeof( POINT ) );
+            }
+        }
+    }
+
+    return sourceFile.good();
+}
+
+
+//!************************************************************************
+//! Run all the checks on a source file in a temporary directory
+//!
+//! @returns true if all the checks passed
+//!************************************************************************
+bool SourceIndexTest::run()
+{
+    char directoryTemplate[] = "/tmp/SourceIndexTest.XXXXXX";
+    const char* DIRECTORY = mkdtemp( directoryTemplate );
+    bool status = check( nullptr != DIRECTORY, "temporary directory created" );
+
+    if( status )
+    {
+        const std::string SOURCE_FILE_NAME = std::string( DIRECTORY ) + "/source.pkl";
+
+        status = check( writeSource( SOURCE_FILE_NAME ), "source file written" )
+              && checkRoundTrip( SOURCE_FILE_NAME )
+              && checkReadFrames( SOURCE_FILE_NAME )
+              && checkTouchedSource( SOURCE_FILE_NAME )
+              && checkChangedSource( SOURCE_FILE_NAME );
+
+        SourceIndex sourceIndex( SOURCE_FILE_NAME, SOURCE );
+        sourceIndex.setDirectory( DIRECTORY );
+
+        std::remove( sourceIndex.getFileName().c_str() );
+        std::remove( SOURCE_FILE_NAME.c_str() );
+        rmdir( DIRECTORY );
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Main application
+//!
+//! @returns: 0 if all the checks passed, 1 otherwise
+//!************************************************************************
+int main()
+{
+    return SourceIndexTest::run() ? 0 : 1;
+}
@@ -0,0 +1,185 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+
+/*
+SpscRingTest.cpp
+
+This file contains the unit tests of the single-producer single-consumer ring.
+*/
+
+#include "TestCheck.h"
+#include "SpscRing.h"
+
+#include <cstdint>
+#include <thread>
+
+
+//************************************************************************
+// Class for testing the ring: capacity, full and empty rings, order of
+// the items across the wrap-around and between two threads
+//************************************************************************
+class SpscRingTest
+{
+    //************************************************************************
+    // constants and types
+    //************************************************************************
+    private:
+        static const size_t REQUESTED_CAPACITY = 5;     //!< capacity asked for, not a power of two
+        static const size_t ROUNDED_CAPACITY = 8;       //!< capacity of the ring
+        static const uint64_t ITEMS_NR = 1000000;       //!< items passed between the threads
+
+
+    //************************************************************************
+    // functions
+    //************************************************************************
+    public:
+        static bool run();
+
+    private:
+        static bool checkSingleThread();
+
+        static bool checkTwoThreads();
+};
+
+
+//!************************************************************************
+//! Check the capacity, a full and an empty ring and the order of the items
+//! over several wrap-arounds, from one thread
+//!
+//! @returns true if the ring behaves as expected
+//!************************************************************************
+bool SpscRingTest::checkSingleThread()
+{
+    SpscRing<uint64_t> ring;
+    uint64_t item = 0;
+
+    bool status = check( 0 == ring.getCapacity(), "capacity before reset" )
+               && check( !ring.push( 1 ), "push to a ring without capacity" )
+               && check( !ring.pop( item ), "pop from a ring without capacity" );
+
+    ring.reset( REQUESTED_CAPACITY );
+
+    status = status && check( ROUNDED_CAPACITY == ring.getCapacity(), "capacity rounded up to a power of two" );
+
+    uint64_t pushedNr = 0;
+    uint64_t poppedNr = 0;
+
+    // three items at a time, the indexes wrap around the ring
+    for( size_t round = 0; status && round < 4 * ROUNDED_CAPACITY; round++ )
+    {
+        for( size_t i = 0; status && i < 3; i++ )
+        {
+            status = check( ring.push( pushedNr++ ), "push to a ring with room" );
+        }
+
+        for( size_t i = 0; status && i < 3; i++ )
+        {
+            status = check( ring.pop( item ) && poppedNr++ == item, "items popped in order" );
+        }
+    }
+
+    for( size_t i = 0; status && i < ROUNDED_CAPACITY; i++ )
+    {
+        status = check( ring.push( pushedNr++ ), "push up to the capacity" );
+    }
+
+    status = status && check( !ring.push( pushedNr ), "push to a full ring" );
+
+    for( size_t i = 0; status && i < ROUNDED_CAPACITY; i++ )
+    {
+        status = check( ring.pop( item ) && poppedNr++ == item, "items of a full ring popped in order" );
+    }
+
+    status = status && check( !ring.pop( item ), "pop from an empty ring" );
+
+    ring.push( pushedNr );
+    ring.reset( ROUNDED_CAPACITY );
+
+    return status && check( !ring.pop( item ), "ring emptied by reset" );
+}
+
+
+//!************************************************************************
+//! Check that the items pushed by one thread are popped by another, all
+//! of them and in order
+//!
+//! @returns true if the consumer got every item in order
+//!************************************************************************
+bool SpscRingTest::checkTwoThreads()
+{
+    SpscRing<uint64_t> ring;
+    ring.reset( REQUESTED_CAPACITY );
+
+    std::thread producer( [&ring]()
+    {
+        for( uint64_t i = 0; i < ITEMS_NR; i++ )
+        {
+            while( !ring.push( i ) )
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    // all the items are popped whatever their order, so that the producer ends
+    bool status = true;
+    uint64_t expectedItem = 0;
+
+    while( expectedItem < ITEMS_NR )
+    {
+        uint64_t item = 0;
+
+        if( ring.pop( item ) )
+        {
+            status = ( expectedItem++ == item ) && status;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    producer.join();
+
+    return check( status, "items popped in order by the consumer thread" );
+}
+
+
+//!************************************************************************
+//! Run all the checks
+//!
+//! @returns true if all the checks passed
+//!************************************************************************
+bool SpscRingTest::run()
+{
+    bool status = checkSingleThread();
+    status = checkTwoThreads() && status;
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Main application
+//!
+//! @returns: 0 if all the checks passed, 1 otherwise
+//!************************************************************************
+int main()
+{
+    return SpscRingTest::run() ? 0 : 1;
+}
@@ -0,0 +1,51 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+
+/*
+TestCheck.h
+
+This file contains the definitions for the checks of the unit tests.
+*/
+
+#ifndef TestCheck_h
+#define TestCheck_h
+
+#include <iostream>
+#include <string>
+
+
+//!************************************************************************
+//! Report a failed check of a unit test on the console
+//!
+//! @returns aCondition
+//!************************************************************************
+inline bool check
+    (
+    const bool          aCondition,     //!< checked condition
+    const std::string&  aDescription    //!< what is checked
+    )
+{
+    if( !aCondition )
+    {
+        std::cout << "FAILED: " << aDescription << std::endl;
+    }
+
+    return aCondition;
+}
+
+#endif // TestCheck_h
@@ -0,0 +1,316 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2024 Mihai Ursu                                                 //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+
+/*
+WaveformCacheTest.cpp
+
+This file contains the unit tests of the cache of DAC-ready waveforms.
+*/
+
+#include "TestCheck.h"
+#include "DacFormat.h"
+#include "WaveformCache.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include <dirent.h>
+#include <unistd.h>
+
+
+//************************************************************************
+// Class for testing the waveform cache: identical samples of different
+// modulation-SNR combinations, scales or DAC formats must not share a
+// waveform, and a ci16 file must only be loaded with a matching key file
+//************************************************************************
+class WaveformCacheTest
+{
+    //************************************************************************
+    // constants and types
+    //************************************************************************
+    private:
+        typedef DacFormat<16, DAC_JUSTIFY_MSB, DAC_ENDIAN_LITTLE, DAC_INTERLEAVE_IQ> Format16;
+        typedef DacFormat<12, DAC_JUSTIFY_MSB, DAC_ENDIAN_LITTLE, DAC_INTERLEAVE_IQ> Format12;
+
+        static const size_t FRAMES_NR = 4;          //!< frames per block
+        static const uint16_t FRAME_LENGTH = 128;   //!< (I,Q) points per frame
+        static const uint64_t SOURCE_FINGERPRINT = 0x1234;  //!< fingerprint of the source file of the blocks
+        static const size_t MODIFIED_KEY_OFFSET = 8;        //!< offset of the modulation in a key file
+        static const size_t EDITED_POINT = 1;               //!< point between those sampled for the block fingerprint
+
+
+    //************************************************************************
+    // functions
+    //************************************************************************
+    public:
+        static bool run();
+
+    private:
+        static bool checkDisk
+            (
+            const std::string&      aDirectory      //!< directory of the ci16 files
+            );
+
+        static bool checkKeys();
+
+        static std::vector<std::string> getFileNames
+            (
+            const std::string&      aDirectory,     //!< directory of the files
+            const std::string&      aExtension      //!< extension of the files
+            );
+
+        static Dataset::SignalData getSignalData
+            (
+            const uint64_t          aSourceFingerprint, //!< fingerprint of the source file, 0 if unknown
+            const int32_t           aSnrDb              //!< SNR [dB]
+            );
+
+        static void reset();
+};
+
+
+//!************************************************************************
+//! Check the ci16 files: a waveform dropped from memory is loaded from
+//! its file, not if its key file or the whole block does not match, and
+//! the waveforms of an unknown source are never written
+//!
+//! @returns true if the files are written and loaded as expected
+//!************************************************************************
+bool WaveformCacheTest::checkDisk
+    (
+    const std::string&      aDirectory      //!< directory of the ci16 files
+    )
+{
+    WaveformCache* waveformCache = WaveformCache::getInstance();
+    waveformCache->setDiskDirectory( aDirectory );
+
+    const Dataset::SignalData SIGNAL_DATA = getSignalData( SOURCE_FINGERPRINT, 10 );
+    const WaveformCache::WaveformPtr WAVEFORM = waveformCache->get<Format16>( SIGNAL_DATA, 1.0 );
+    const uint64_t HITS_NR = waveformCache->getHitsNr();
+
+    bool status = check( 1 == getFileNames( aDirectory, ".ci16" ).size(), "ci16 file written" )
+               && check( 1 == getFileNames( aDirectory, ".key" ).size(), "key file written" );
+
+    reset();
+
+    const WaveformCache::WaveformPtr LOADED_WAVEFORM = waveformCache->get<Format16>( SIGNAL_DATA, 1.0 );
+
+    status = status
+          && check( HITS_NR + 1 == waveformCache->getHitsNr(), "waveform loaded from its file" )
+          && check( *WAVEFORM == *LOADED_WAVEFORM, "samples loaded from the file" );
+
+    // a key file of another modulation
+    const std::vector<std::string> KEY_FILE_VEC = getFileNames( aDirectory, ".key" );
+
+    for( size_t i = 0; status && i < KEY_FILE_VEC.size(); i++ )
+    {
+        std::fstream keyFile( KEY_FILE_VEC.at( i ), std::ios::binary | std::ios::in | std::ios::out );
+        const int32_t MODULATION = Modulation::NAME_QPSK;
+
+        keyFile.seekp( MODIFIED_KEY_OFFSET );
+        keyFile.write( reinterpret_cast<const char*>( &MODULATION ), sizeof( MODULATION ) );
+        status = check( keyFile.good(), "key file modified" );
+    }
+
+    reset();
+
+    const WaveformCache::WaveformPtr CONVERTED_WAVEFORM = waveformCache->get<Format16>( SIGNAL_DATA, 1.0 );
+
+    status = status
+          && check( HITS_NR + 1 == waveformCache->getHitsNr(), "file with a mismatching key file ignored" )
+          && check( *WAVEFORM == *CONVERTED_WAVEFORM, "samples converted again" );
+
+    // a block edited between the points sampled for its fingerprint
+    Dataset::SignalData editedSignalData = getSignalData( SOURCE_FINGERPRINT, 10 );
+    editedSignalData.frameStore.data()[EDITED_POINT] = { 0, 0 };
+
+    reset();
+
+    const WaveformCache::WaveformPtr EDITED_WAVEFORM = waveformCache->get<Format16>( editedSignalData, 1.0 );
+
+    status = status
+          && check( HITS_NR + 1 == waveformCache->getHitsNr(), "file of an edited block ignored" )
+          && check( *WAVEFORM != *EDITED_WAVEFORM, "edited block converted" );
+
+    // a source without fingerprint
+    waveformCache->get<Format16>( getSignalData( 0, 12 ), 1.0 );
+
+    status = status && check( 1 == getFileNames( aDirectory, ".ci16" ).size(), "no file for an unknown source" );
+
+    reset();
+    waveformCache->get<Format16>( getSignalData( 0, 12 ), 1.0 );
+
+    return status && check( HITS_NR + 1 == waveformCache->getHitsNr(), "unknown source not loaded from disk" );
+}
+
+
+//!************************************************************************
+//! Check the memory keys: the same block hits, the same samples under
+//! another SNR, scale or DAC format do not
+//!
+//! @returns true if the waveforms are keyed as expected
+//!************************************************************************
+bool WaveformCacheTest::checkKeys()
+{
+    WaveformCache* waveformCache = WaveformCache::getInstance();
+    waveformCache->setDiskDirectory( "" );
+    reset();
+
+    const uint64_t HITS_NR = waveformCache->getHitsNr();
+    const WaveformCache::WaveformPtr WAVEFORM = waveformCache->get<Format16>( getSignalData( SOURCE_FINGERPRINT, 10 ), 1.0 );
+
+    bool status = check( HITS_NR == waveformCache->getHitsNr(), "first waveform converted" )
+               && check( WAVEFORM == waveformCache->get<Format16>( getSignalData( SOURCE_FINGERPRINT, 10 ), 1.0 ), "same block served from memory" )
+               && check( HITS_NR + 1 == waveformCache->getHitsNr(), "hit of the same block" );
+
+    const WaveformCache::WaveformPtr OTHER_SNR_WAVEFORM = waveformCache->get<Format16>( getSignalData( SOURCE_FINGERPRINT, 12 ), 1.0 );
+    const WaveformCache::WaveformPtr OTHER_SOURCE_WAVEFORM = waveformCache->get<Format16>( getSignalData( SOURCE_FINGERPRINT + 1, 10 ), 1.0 );
+    const WaveformCache::WaveformPtr OTHER_SCALE_WAVEFORM = waveformCache->get<Format16>( getSignalData( SOURCE_FINGERPRINT, 10 ), 0.5 );
+    const WaveformCache::WaveformPtr OTHER_FORMAT_WAVEFORM = waveformCache->get<Format12>( getSignalData( SOURCE_FINGERPRINT, 10 ), 1.0 );
+
+    return status
+        && check( HITS_NR + 1 == waveformCache->getHitsNr(), "no hit for another SNR, source, scale or format" )
+        && check( WAVEFORM != OTHER_SNR_WAVEFORM && *WAVEFORM == *OTHER_SNR_WAVEFORM, "same samples of another SNR" )
+        && check( WAVEFORM != OTHER_SOURCE_WAVEFORM, "waveform of another source" )
+        && check( *WAVEFORM != *OTHER_SCALE_WAVEFORM, "samples of another scale" )
+        && check( *WAVEFORM != *OTHER_FORMAT_WAVEFORM, "samples of another format" );
+}
+
+
+//!************************************************************************
+//! Get the names of the files of a directory with an extension
+//!
+//! @returns The file names, with the directory
+//!************************************************************************
+std::vector<std::string> WaveformCacheTest::getFileNames
+    (
+    const std::string&      aDirectory,     //!< directory of the files
+    const std::string&      aExtension      //!< extension of the files
+    )
+{
+    std::vector<std::string> fileNameVec;
+    DIR* directory = opendir( aDirectory.c_str() );
+
+    for( struct dirent* entry = directory ? readdir( directory ) : nullptr; entry; entry = readdir( directory ) )
+    {
+        const std::string NAME = entry->d_name;
+
+        if( NAME.size() > aExtension.size() && 0 == NAME.compare( NAME.size() - aExtension.size(), aExtension.size(), aExtension ) )
+        {
+            fileNameVec.push_back( aDirectory + "/" + NAME );
+        }
+    }
+
+    if( directory )
+    {
+        closedir( directory );
+    }
+
+    return fileNameVec;
+}
+
+
+//!************************************************************************
+//! Get a block of BPSK frames, the same samples for any source and SNR
+//!
+//! @returns The signal data of the block
+//!************************************************************************
+Dataset::SignalData WaveformCacheTest::getSignalData
+    (
+    const uint64_t          aSourceFingerprint, //!< fingerprint of the source file, 0 if unknown
+    const int32_t           aSnrDb              //!< SNR [dB]
+    )
+{
+    Dataset::SignalData signalData;
+    signalData.frameStore.allocate( FRAMES_NR, FRAME_LENGTH );
+    signalData.maxVal = 1;
+    signalData.origin = { aSourceFingerprint, Modulation::NAME_BPSK, aSnrDb };
+
+    for( size_t i = 0; i < signalData.frameStore.getPointsNr(); i++ )
+    {
+        signalData.frameStore.data()[i] = { 0.001f * i, -0.001f * i };
+    }
+
+    return signalData;
+}
+
+
+//!************************************************************************
+//! Drop the resident waveforms
+//!
+//! @returns nothing
+//!************************************************************************
+void WaveformCacheTest::reset()
+{
+    WaveformCache::getInstance()->setBudgetBytes( 0 );
+    WaveformCache::getInstance()->setBudgetBytes( WaveformCache::DEFAULT_BUDGET_BYTES );
+}
+
+
+//!************************************************************************
+//! Run all the checks, the ci16 files in a temporary directory
+//!
+//! @returns true if all the checks passed
+//!************************************************************************
+bool WaveformCacheTest::run()
+{
+    char directoryTemplate[] = "/tmp/WaveformCacheTest.XXXXXX";
+    const char* DIRECTORY = mkdtemp( directoryTemplate );
+
+    bool status = checkKeys();
+    status = check( nullptr != DIRECTORY, "temporary directory created" ) && status;
+
+    if( DIRECTORY )
+    {
+        reset();
+        status = checkDisk( DIRECTORY ) && status;
+
+        WaveformCache::getInstance()->setDiskDirectory( "" );
+
+        const std::vector<std::string> CI16_FILE_VEC = getFileNames( DIRECTORY, ".ci16" );
+        const std::vector<std::string> KEY_FILE_VEC = getFileNames( DIRECTORY, ".key" );
+
+        for( const std::string& fileName : CI16_FILE_VEC )
+        {
+            std::remove( fileName.c_str() );
+        }
+
+        for( const std::string& fileName : KEY_FILE_VEC )
+        {
+            std::remove( fileName.c_str() );
+        }
+
+        rmdir( DIRECTORY );
+    }
+
+    return status;
+}
+
+
+//!************************************************************************
+//! Main application
+//!
+//! @returns: 0 if all the checks passed, 1 otherwise
+//!************************************************************************
+int main()
+{
+    return WaveformCacheTest::run() ? 0 : 1;
+}